@@ -21,6 +21,12 @@
  * @file   rohc_gen_stream.c
  * @brief  Generate an (un)compressed stream for performance testing
  * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * By default, the program generates one or several IPv4/UDP/RTP streams.
+ * With the --workload option, the program generates many concurrent TCP,
+ * UDP, RTP and ESP flows over IPv4 and IPv6 instead, see workload.h for
+ * details. Such workloads stress the context lookup, eviction and W-LSB
+ * encoding of the compressor.
  */
 
 #include "config.h" /* for HAVE_*_H and PACKAGE_BUGREPORT */
@@ -61,11 +67,19 @@ for ./configure ? If yes, check configure output and config.log"
 #include <rohc/rohc.h>
 #include <rohc/rohc_comp.h>
 
+#include "workload.h"
+
 
 
 /** The length (in bytes) of the Ethernet header */
 #define ETHER_HDR_LEN  14
 
+/** The maximum length (in bytes) of the ROHC packets */
+#define MAX_ROHC_LEN  (WORKLOAD_PACKET_MAX_LEN * 2)
+
+/** The number of packets in the in-memory ring of workloads */
+#define WORKLOAD_RING_SIZE  1024U
+
 
 /* prototypes of private functions */
 static void usage(void);
@@ -77,6 +91,27 @@ static bool build_stream(const char *const filename,
                          const size_t wlsb_width,
                          const size_t max_contexts)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
+static bool build_workload(const char *const filename,
+                           const char *const stream_type,
+                           const unsigned long max_packets,
+                           const struct workload_config *const config,
+                           const int use_large_cid,
+                           const size_t wlsb_width,
+                           const size_t max_contexts)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+
+static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts)
+	__attribute__((warn_unused_result));
+static bool write_packet(pcap_dumper_t *const dumper,
+                         struct rohc_comp *const comp,
+                         const struct rohc_buf ip_packet,
+                         const unsigned long counter)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool parse_mix(const char *const mix_str,
+                      struct workload_config *const config)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
 
 static void print_rohc_traces(void *const priv_ctxt,
                               const rohc_trace_level_t level,
@@ -121,6 +156,8 @@ int main(int argc, char *argv[])
 	int max_contexts = ROHC_SMALL_CID_MAX + 1;
 	int wlsb_width = 4;
 	int streams_nr = 1;
+	bool use_workload = false;
+	struct workload_config workload_config;
 	int is_failure = 1;
 	int use_large_cid;
 	int args_used;
@@ -128,6 +165,9 @@ int main(int argc, char *argv[])
 	/* set to quiet mode by default */
 	is_verbose = 0;
 
+	/* use the default workload unless options change it */
+	workload_config_init(&workload_config);
+
 	/* parse program arguments, print the help message in case of failure */
 	if(argc <= 1)
 	{
@@ -198,6 +238,88 @@ int main(int argc, char *argv[])
 			streams_nr = atoi(argv[1]);
 			args_used++;
 		}
+		else if(!strcmp(*argv, "--workload"))
+		{
+			/* generate many concurrent flows instead of RTP streams */
+			use_workload = true;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--flows"))
+		{
+			/* get the number of concurrent flows of the workload */
+			workload_config.flows_nr = strtoul(argv[1], NULL, 10);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--zipf"))
+		{
+			/* get the exponent of the popularity law of the workload */
+			workload_config.zipf_exponent = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--lifetime"))
+		{
+			/* get the mean number of packets per flow of the workload */
+			workload_config.lifetime = strtoul(argv[1], NULL, 10);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--rate"))
+		{
+			/* get the packet rate of the workload */
+			workload_config.rate = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--mix"))
+		{
+			/* get the protocol mix of the workload */
+			if(!parse_mix(argv[1], &workload_config))
+			{
+				fprintf(stderr, "invalid protocol mix '%s'\n", argv[1]);
+				usage();
+				goto error;
+			}
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--ipv6"))
+		{
+			/* get the percentage of IPv6 flows of the workload */
+			workload_config.ipv6_pct = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--ipv6-ext"))
+		{
+			/* get the percentage of IPv6 flows with extension headers */
+			workload_config.ipv6_ext_pct = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--loss"))
+		{
+			/* get the percentage of lost packets of the workload */
+			workload_config.loss_pct = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--reorder"))
+		{
+			/* get the percentage of late packets of the workload */
+			workload_config.reorder_pct = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--reorder-depth"))
+		{
+			/* get how many packets may overtake a late packet */
+			workload_config.reorder_depth = strtoul(argv[1], NULL, 10);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--tcp-window-change"))
+		{
+			/* get the percentage of TCP segments that change the window */
+			workload_config.tcp_window_change_pct = atof(argv[1]);
+			args_used++;
+		}
+		else if(argc > 1 && !strcmp(*argv, "--seed"))
+		{
+			/* get the seed of the workload */
+			workload_config.seed = strtoull(argv[1], NULL, 10);
+			args_used++;
+		}
 		else if(stream_type == NULL)
 		{
 			/* get the type of the stream to perform */
@@ -298,8 +420,17 @@ int main(int argc, char *argv[])
 	}
 
 	/* test ROHC compression/decompression with the packets from the file */
-	if(!build_stream(filename, stream_type, max_packets, streams_nr,
-	                 use_large_cid, wlsb_width, max_contexts))
+	if(use_workload)
+	{
+		if(!build_workload(filename, stream_type, max_packets, &workload_config,
+		                   use_large_cid, wlsb_width, max_contexts))
+		{
+			fprintf(stderr, "failed to build workload\n");
+			goto error;
+		}
+	}
+	else if(!build_stream(filename, stream_type, max_packets, streams_nr,
+	                      use_large_cid, wlsb_width, max_contexts))
 	{
 		fprintf(stderr, "failed to build stream\n");
 		goto error;
@@ -322,6 +453,7 @@ static void usage(void)
 	       "Usage: rohc_gen_stream [General options]\n"
 	       "   or: rohc_gen_stream uncomp MAX OUTPUT\n"
 	       "   or: rohc_gen_stream [Compression options] comp MAX OUTPUT\n"
+	       "   or: rohc_gen_stream --workload [Workload options] uncomp|comp MAX OUTPUT\n"
 	       "\n"
 	       "Options:\n"
 	       "General options:\n"
@@ -334,6 +466,35 @@ static void usage(void)
 	       "      --max-contexts NUM  The maximum number of ROHC contexts to\n"
 	       "                          simultaneously use during the test\n"
 	       "      --wlsb-width NUM    The width of the WLSB window to use\n"
+	       "Workload options:\n"
+	       "      --workload          Generate many concurrent TCP, UDP, RTP\n"
+	       "                          and ESP flows instead of RTP streams\n"
+	       "      --flows NUM         The number of concurrent flows\n"
+	       "                          (default: 1000)\n"
+	       "      --zipf S            The exponent of the Zipf popularity of\n"
+	       "                          flows, 0 for uniform (default: 1.0)\n"
+	       "      --lifetime NUM      The mean number of packets per flow,\n"
+	       "                          0 for endless flows (default: 100)\n"
+	       "      --rate NUM          The mean arrival rate of packets in\n"
+	       "                          packets per second (default: 100000)\n"
+	       "      --mix U,R,T,E       The weights of UDP, RTP, TCP and ESP\n"
+	       "                          in new flows (default: 20,20,50,10)\n"
+	       "      --ipv6 PCT          The percentage of IPv6 flows\n"
+	       "                          (default: 20)\n"
+	       "      --ipv6-ext PCT      The percentage of IPv6 flows with\n"
+	       "                          extension headers (default: 50)\n"
+	       "      --loss PCT          The percentage of lost packets\n"
+	       "                          (default: 0)\n"
+	       "      --reorder PCT       The percentage of late packets\n"
+	       "                          (default: 0)\n"
+	       "      --reorder-depth NUM The maximum number of packets that\n"
+	       "                          overtake a late packet (default: 3),\n"
+	       "                          late packets still held at the end\n"
+	       "                          are appended after the MAX packets\n"
+	       "      --tcp-window-change PCT\n"
+	       "                          The percentage of TCP segments that\n"
+	       "                          change the window (default: 1)\n"
+	       "      --seed NUM          The seed of the workload (default: 1)\n"
 	       "Mandatory parameters:\n"
 	       "  MAX                     The number of packets to generate\n"
 	       "  OUTPUT                  The name of the output file with the\n"
@@ -345,6 +506,10 @@ static void usage(void)
 	       "  rohc_gen_stream comp 500 rohc.pcap    Generate 500 RTP packets,\n"
 	       "                                        compress them, then store\n"
 	       "                                        them in file rohc.pcap\n"
+	       "  rohc_gen_stream --workload --flows 50000 --loss 1 uncomp 1000000 flows.pcap\n"
+	       "                                        Generate 1000000 packets of\n"
+	       "                                        50000 concurrent flows with\n"
+	       "                                        1%% of losses\n"
 	       "\n"
 	       "Report bugs to <" PACKAGE_BUGREPORT ">.\n");
 }
@@ -374,7 +539,6 @@ static bool build_stream(const char *const filename,
 	const rohc_cid_type_t cid_type =
 		(use_large_cid ? ROHC_LARGE_CID : ROHC_SMALL_CID);
 	bool is_success = false;
-	rohc_status_t status;
 
 	pcap_t *pcap;
 	pcap_dumper_t *dumper;
@@ -405,44 +569,11 @@ static bool build_stream(const char *const filename,
 	if(strcmp(stream_type, "comp") == 0)
 	{
 		/* create the compressor */
-		comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
+		comp = create_compressor(cid_type, wlsb_width, max_contexts);
 		if(comp == NULL)
 		{
-			fprintf(stderr, "cannot create the compressor\n");
 			goto close_dumper;
 		}
-
-		/* set the callback for traces on compressor */
-		if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
-		{
-			fprintf(stderr, "failed to set the callback for traces on "
-			        "compressor\n");
-			goto destroy_comp;
-		}
-
-		/* enable profiles */
-		if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
-		                              ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
-		                              ROHC_PROFILE_UDPLITE, ROHC_PROFILE_RTP,
-		                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
-		{
-			fprintf(stderr, "failed to enable the compression profiles\n");
-			goto destroy_comp;
-		}
-
-		/* set the WLSB window width on compressor */
-		if(!rohc_comp_set_wlsb_window_width(comp, wlsb_width))
-		{
-			fprintf(stderr, "failed to set the WLSB window width on compressor\n");
-			goto destroy_comp;
-		}
-
-		/* set UDP ports dedicated to RTP traffic */
-		if(!rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
-		{
-			fprintf(stderr, "failed to set RTP detection callback on compressor\n");
-			goto destroy_comp;
-		}
 	}
 
 	/* build the stream, and save it in the PCAP dump */
@@ -453,27 +584,14 @@ static bool build_stream(const char *const filename,
 		                          sizeof(struct udphdr) +
 		                          sizeof(struct rtphdr) +
 		                          payload_len;
-		uint8_t buffer[ETHER_HDR_LEN + packet_len];
-		struct rohc_buf packet =
-			rohc_buf_init_empty(buffer, ETHER_HDR_LEN + packet_len);
-
-		const size_t rohc_max_len = packet_len * 2;
-		uint8_t output[ETHER_HDR_LEN + rohc_max_len];
-		struct rohc_buf rohc_packet =
-			rohc_buf_init_empty(output, ETHER_HDR_LEN + rohc_max_len);
+		uint8_t buffer[packet_len];
+		struct rohc_buf packet = rohc_buf_init_empty(buffer, packet_len);
 
-		struct pcap_pkthdr header = { .ts = { .tv_sec = 0, .tv_usec = 0 } };
 		struct ipv4_hdr *ipv4;
 		struct udphdr *udp;
 		struct rtphdr *rtp;
 		size_t i;
 
-		/* skip the Ethernet header, it will be written later */
-		packet.len += ETHER_HDR_LEN;
-		rohc_buf_pull(&packet, ETHER_HDR_LEN);
-		rohc_packet.len += ETHER_HDR_LEN;
-		rohc_buf_pull(&rohc_packet, ETHER_HDR_LEN);
-
 		/* build IPv4 header */
 		packet.len += sizeof(struct ipv4_hdr);
 		ipv4 = (struct ipv4_hdr *) rohc_buf_data(packet);
@@ -524,44 +642,158 @@ static bool build_stream(const char *const filename,
 
 		rohc_buf_push(&packet, packet_len);
 
-		if(strcmp(stream_type, "comp") == 0)
+		/* compress the packet if requested, then save it in the PCAP dump */
+		if(!write_packet(dumper, comp, packet, counter))
+		{
+			goto destroy_comp;
+		}
+	}
+
+	is_success = true;
+
+destroy_comp:
+	if(comp != NULL)
+	{
+		rohc_comp_free(comp);
+	}
+close_dumper:
+	pcap_dump_close(dumper);
+close_pcap:
+	pcap_close(pcap);
+error:
+	return is_success;
+}
+
+
+/**
+ * @brief Build an (un)compressed workload of many concurrent flows
+ *
+ * The packets are generated by batches in an in-memory ring, then saved in
+ * the PCAP dump.
+ *
+ * @param filename       The name of the PCAP file to output the workload
+ * @param stream_type    The type of stream to generate: uncomp or comp
+ * @param max_packets    The number of packets to generate
+ * @param config         The configuration of the workload
+ * @param use_large_cid  Whether the compressor shall use large CIDs
+ * @param wlsb_width     The width of the WLSB window to use
+ * @param max_contexts   The maximum number of ROHC contexts to use
+ * @return               true in case of success,
+ *                       false in case of failure
+ */
+static bool build_workload(const char *const filename,
+                           const char *const stream_type,
+                           const unsigned long max_packets,
+                           const struct workload_config *const config,
+                           const int use_large_cid,
+                           const size_t wlsb_width,
+                           const size_t max_contexts)
+{
+	const rohc_cid_type_t cid_type =
+		(use_large_cid ? ROHC_LARGE_CID : ROHC_SMALL_CID);
+	bool is_success = false;
+
+	pcap_t *pcap;
+	pcap_dumper_t *dumper;
+
+	struct workload *workload;
+	struct workload_ring ring;
+	struct workload_stats stats;
+	unsigned long counter = 0;
+	size_t i;
+
+	struct rohc_comp *comp = NULL;
+
+	printf("generate %lu %s packets of %lu concurrent flows in '%s'...\n",
+	       max_packets, stream_type, config->flows_nr, filename);
+
+	/* create the workload */
+	workload = workload_new(config);
+	if(workload == NULL)
+	{
+		fprintf(stderr, "failed to create the workload, check the workload "
+		        "options\n");
+		goto error;
+	}
+	if(!workload_ring_init(&ring, WORKLOAD_RING_SIZE))
+	{
+		fprintf(stderr, "failed to allocate the ring of packets\n");
+		goto free_workload;
+	}
+
+	/* create a PCAP context for output */
+	pcap = pcap_open_dead(DLT_EN10MB, 0 /* infinite snaplen */);
+	if(pcap == NULL)
+	{
+		fprintf(stderr, "failed to create a pcap context\n");
+		goto free_ring;
+	}
+
+	/* open the PCAP dump file */
+	dumper = pcap_dump_open(pcap, filename);
+	if(dumper == NULL)
+	{
+		fprintf(stderr, "failed to open dump file\n");
+		goto close_pcap;
+	}
+
+	if(strcmp(stream_type, "comp") == 0)
+	{
+		/* create the compressor */
+		comp = create_compressor(cid_type, wlsb_width, max_contexts);
+		if(comp == NULL)
 		{
-			/* compress packet */
-			status = rohc_compress4(comp, packet, &rohc_packet);
-			if(status != ROHC_STATUS_OK)
+			goto close_dumper;
+		}
+	}
+
+	/* generate the workload by batches, and save them in the PCAP dump */
+	while(counter < max_packets)
+	{
+		if(workload_fill_ring(workload, &ring, max_packets - counter) == 0)
+		{
+			fprintf(stderr, "failed to generate packet #%lu\n", counter + 1);
+			goto destroy_comp;
+		}
+		for(i = 0; i < ring.nr; i++)
+		{
+			const struct rohc_buf packet =
+				rohc_buf_init_full(ring.packets[i].data, ring.packets[i].len,
+				                   ring.packets[i].time);
+
+			counter++;
+			if(!write_packet(dumper, comp, packet, counter))
 			{
-				fprintf(stderr, "failed to compress packet #%lu\n", counter);
 				goto destroy_comp;
 			}
+		}
+	}
 
-			/* build Linux cooked header */
-			rohc_buf_push(&rohc_packet, ETHER_HDR_LEN);
-			memset(rohc_buf_data(rohc_packet), 0, ETHER_HDR_LEN);
-			rohc_buf_byte_at(rohc_packet, ETHER_HDR_LEN - 2) =
-				ROHC_ETHERTYPE & 0xff;
-			rohc_buf_byte_at(rohc_packet, ETHER_HDR_LEN - 1) =
-				(ROHC_ETHERTYPE >> 8) & 0xff;
+	/* do not drop the late packets still held by the workload */
+	while(workload_flush(workload, &ring.packets[0]))
+	{
+		const struct rohc_buf packet =
+			rohc_buf_init_full(ring.packets[0].data, ring.packets[0].len,
+			                   ring.packets[0].time);
 
-			/* write the packet in the PCAP dump */
-			header.caplen = rohc_packet.len;
-			header.len = rohc_packet.len;
-			pcap_dump((u_char *) dumper, &header, rohc_buf_data(rohc_packet));
-		}
-		else
+		counter++;
+		if(!write_packet(dumper, comp, packet, counter))
 		{
-			/* build Linux cooked header */
-			rohc_buf_push(&packet, ETHER_HDR_LEN);
-			memset(rohc_buf_data(packet), 0, ETHER_HDR_LEN);
-			rohc_buf_byte_at(packet, ETHER_HDR_LEN - 2) = 0x08;
-			rohc_buf_byte_at(packet, ETHER_HDR_LEN - 1) = 0x00;
-
-			/* write the packet in the PCAP dump */
-			header.caplen = packet.len;
-			header.len = packet.len;
-			pcap_dump((u_char *) dumper, &header, rohc_buf_data(packet));
+			goto destroy_comp;
 		}
 	}
 
+	/* print the statistics of the workload */
+	workload_get_stats(workload, &stats);
+	printf("%lu flows started:", stats.flows_nr);
+	for(i = 0; i < WORKLOAD_PROTO_MAX; i++)
+	{
+		printf(" %lu %s", stats.flows_per_proto[i], workload_get_proto_descr(i));
+	}
+	printf(", %lu over IPv6\n", stats.flows_ipv6_nr);
+	printf("%lu packets built: %lu lost, %lu reordered\n", stats.packets_nr,
+	       stats.lost_nr, stats.reordered_nr);
+
 	is_success = true;
 
 destroy_comp:
@@ -573,11 +805,190 @@ close_dumper:
 	pcap_dump_close(dumper);
 close_pcap:
 	pcap_close(pcap);
+free_ring:
+	workload_ring_free(&ring);
+free_workload:
+	workload_free(workload);
 error:
 	return is_success;
 }
 
 
+/**
+ * @brief Create the compressor used to generate compressed streams
+ *
+ * @param cid_type      The type of CIDs the compressor shall use
+ * @param wlsb_width    The width of the WLSB window to use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @return              The new compressor, NULL in case of error
+ */
+static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts)
+{
+	struct rohc_comp *comp;
+
+	/* create the compressor */
+	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "cannot create the compressor\n");
+		goto error;
+	}
+
+	/* set the callback for traces on compressor */
+	if(!rohc_comp_set_traces_cb2(comp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "compressor\n");
+		goto destroy_comp;
+	}
+
+	/* enable profiles */
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_UDP, ROHC_PROFILE_IP,
+	                              ROHC_PROFILE_UDPLITE, ROHC_PROFILE_RTP,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto destroy_comp;
+	}
+
+	/* set the WLSB window width on compressor */
+	if(!rohc_comp_set_wlsb_window_width(comp, wlsb_width))
+	{
+		fprintf(stderr, "failed to set the WLSB window width on compressor\n");
+		goto destroy_comp;
+	}
+
+	/* set UDP ports dedicated to RTP traffic */
+	if(!rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
+	{
+		fprintf(stderr, "failed to set RTP detection callback on compressor\n");
+		goto destroy_comp;
+	}
+
+	return comp;
+
+destroy_comp:
+	rohc_comp_free(comp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Compress the given IP packet if requested, then save it in the dump
+ *
+ * @param dumper     The PCAP dump to write the packet to
+ * @param comp       The compressor, NULL to save the IP packet uncompressed
+ * @param ip_packet  The IP packet to save
+ * @param counter    The number of the packet (traces only)
+ * @return           true in case of success,
+ *                   false in case of failure
+ */
+static bool write_packet(pcap_dumper_t *const dumper,
+                         struct rohc_comp *const comp,
+                         const struct rohc_buf ip_packet,
+                         const unsigned long counter)
+{
+	uint8_t output[ETHER_HDR_LEN + MAX_ROHC_LEN];
+	struct rohc_buf frame = rohc_buf_init_empty(output, ETHER_HDR_LEN + MAX_ROHC_LEN);
+	struct pcap_pkthdr header;
+
+	/* skip the Ethernet header, it will be written later */
+	frame.len += ETHER_HDR_LEN;
+	rohc_buf_pull(&frame, ETHER_HDR_LEN);
+
+	if(comp != NULL)
+	{
+		/* compress packet */
+		const rohc_status_t status = rohc_compress4(comp, ip_packet, &frame);
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "failed to compress packet #%lu\n", counter);
+			return false;
+		}
+
+		/* build Ethernet header */
+		rohc_buf_push(&frame, ETHER_HDR_LEN);
+		memset(rohc_buf_data(frame), 0, ETHER_HDR_LEN);
+		rohc_buf_byte_at(frame, ETHER_HDR_LEN - 2) = ROHC_ETHERTYPE & 0xff;
+		rohc_buf_byte_at(frame, ETHER_HDR_LEN - 1) = (ROHC_ETHERTYPE >> 8) & 0xff;
+	}
+	else
+	{
+		/* copy packet */
+		rohc_buf_append_buf(&frame, ip_packet);
+
+		/* build Ethernet header */
+		rohc_buf_push(&frame, ETHER_HDR_LEN);
+		memset(rohc_buf_data(frame), 0, ETHER_HDR_LEN);
+		if(((rohc_buf_byte(ip_packet) >> 4) & 0x0f) == 6)
+		{
+			rohc_buf_byte_at(frame, ETHER_HDR_LEN - 2) = 0x86;
+			rohc_buf_byte_at(frame, ETHER_HDR_LEN - 1) = 0xdd;
+		}
+		else
+		{
+			rohc_buf_byte_at(frame, ETHER_HDR_LEN - 2) = 0x08;
+			rohc_buf_byte_at(frame, ETHER_HDR_LEN - 1) = 0x00;
+		}
+	}
+
+	/* write the packet in the PCAP dump */
+	header.ts.tv_sec = ip_packet.time.sec;
+	header.ts.tv_usec = ip_packet.time.nsec / 1000;
+	header.caplen = frame.len;
+	header.len = frame.len;
+	pcap_dump((u_char *) dumper, &header, rohc_buf_data(frame));
+
+	return true;
+}
+
+
+/**
+ * @brief Parse the protocol mix of a workload
+ *
+ * The protocol mix is given as 4 comma-separated weights for UDP, RTP, TCP
+ * and ESP flows, eg. "20,20,50,10".
+ *
+ * @param mix_str  The protocol mix to parse
+ * @param config   OUT: The workload configuration to update
+ * @return         true if the protocol mix is valid, false otherwise
+ */
+static bool parse_mix(const char *const mix_str,
+                      struct workload_config *const config)
+{
+	unsigned int weights[WORKLOAD_PROTO_MAX];
+	unsigned int total = 0;
+	const char *str = mix_str;
+	size_t i;
+
+	for(i = 0; i < WORKLOAD_PROTO_MAX; i++)
+	{
+		char *end;
+
+		weights[i] = strtoul(str, &end, 10);
+		if(end == str ||
+		   (i < (WORKLOAD_PROTO_MAX - 1) && (*end) != ',') ||
+		   (i == (WORKLOAD_PROTO_MAX - 1) && (*end) != '\0'))
+		{
+			return false;
+		}
+		total += weights[i];
+		str = end + 1;
+	}
+	if(total == 0)
+	{
+		return false;
+	}
+
+	memcpy(config->mix, weights, sizeof(weights));
+
+	return true;
+}
+
 /**
  * @brief Callback to print traces of the ROHC library
  *
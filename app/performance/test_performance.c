@@ -55,6 +55,18 @@
  *
  * The program outputs the time elapsed for (de)compression all packets, the
  * number of (de)compressed packets and the average elapsed time per packet.
+ *
+ * Latency mode
+ * ------------
+ *
+ * With the --latency option, the program first loads the whole capture in
+ * memory, so that neither the disk nor libpcap are measured. It then
+ * (de)compresses the first packets without measuring them to warm up the
+ * contexts (see --warmup), and times every other call to rohc_compress4()
+ * or rohc_decompress3() with the monotonic clock. The p50, p90, p99, p99.9
+ * and maximum latencies are reported for all packets, per profile, and per
+ * profile and packet type. The --json option writes the same report in the
+ * JSON format for automated processing.
  */
 
 #include "config.h" /* for HAVE_*_H */
@@ -71,7 +83,9 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include <assert.h>
 
 /* include for the PCAP library */
@@ -109,6 +123,54 @@ for ./configure ? If yes, check configure output and config.log"
 /** The minimum Ethernet length (in bytes) */
 #define ETHER_FRAME_MIN_LEN  60U
 
+/** The default number of warm-up packets in latency mode */
+#define PERF_WARMUP_DEFAULT  100U
+
+/** The number of percentiles reported in latency mode */
+#define PERF_PCTS_NR  4U
+
+
+/** The percentiles reported in latency mode */
+static const struct
+{
+	const char *name;       /**< The name of the percentile */
+	unsigned int permille;  /**< The percentile (in 1/1000) */
+} perf_pcts[PERF_PCTS_NR] =
+{
+	{ "p50",   500 },
+	{ "p90",   900 },
+	{ "p99",   990 },
+	{ "p99.9", 999 },
+};
+
+
+/** One packet of the capture preloaded in memory, link layer excluded */
+struct perf_packet
+{
+	uint8_t *data;  /**< The packet data */
+	size_t len;     /**< The length (in bytes) of the packet data */
+};
+
+
+/** The latency of one (de)compressed packet */
+struct perf_sample
+{
+	uint64_t ns;                /**< The elapsed time (in nanoseconds) */
+	int profile_id;             /**< The ROHC profile used for the packet */
+	rohc_packet_t packet_type;  /**< The type of the ROHC packet */
+};
+
+
+/** The latency statistics of a group of packets */
+struct perf_group
+{
+	int profile_id;             /**< The ROHC profile, -1 for all profiles */
+	int packet_type;            /**< The ROHC packet type, -1 for all types */
+	size_t nr;                  /**< The number of packets in the group */
+	uint64_t pcts[PERF_PCTS_NR];  /**< The percentiles (in nanoseconds) */
+	uint64_t max;               /**< The maximum latency (in nanoseconds) */
+};
+
 
 /** Whether the application runs in verbose mode or not */
 static enum
@@ -121,6 +183,28 @@ static enum
 
 static void usage(void);
 
+static int open_capture(const char *const filename,
+                        pcap_t **const handle,
+                        size_t *const link_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static int skip_link_layer(const unsigned long num_packet,
+                           const struct pcap_pkthdr header,
+                           const size_t link_len,
+                           struct rohc_buf *const packet)
+	__attribute__((warn_unused_result, nonnull(4)));
+static int remove_ether_padding(const unsigned long num_packet,
+                                const struct pcap_pkthdr header,
+                                const size_t link_len,
+                                struct rohc_buf *const ip_packet)
+	__attribute__((warn_unused_result, nonnull(4)));
+static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts)
+	__attribute__((warn_unused_result));
+static struct rohc_decomp * create_decompressor(const rohc_cid_type_t cid_type,
+                                                const size_t max_contexts)
+	__attribute__((warn_unused_result));
+
 static int test_compression_perfs(char *filename,
                                   const rohc_cid_type_t cid_type,
                                   const size_t wlsb_width,
@@ -143,6 +227,53 @@ static int time_decompress_packet(struct rohc_decomp *decomp,
                                   size_t link_len,
                                   const struct rohc_ts arrival_time);
 
+static int test_latency_perfs(const bool is_comp,
+                              const char *const filename,
+                              const rohc_cid_type_t cid_type,
+                              const size_t wlsb_width,
+                              const size_t max_contexts,
+                              const unsigned long warmup,
+                              const char *const json_filename,
+                              unsigned long *const packet_count)
+	__attribute__((warn_unused_result, nonnull(2, 8)));
+static int load_capture(const bool is_comp,
+                        const char *const filename,
+                        struct perf_packet **const packets,
+                        size_t *const packets_nr)
+	__attribute__((warn_unused_result, nonnull(2, 3, 4)));
+static void free_capture(struct perf_packet *const packets,
+                         const size_t packets_nr);
+static uint64_t perf_now_ns(void)
+	__attribute__((warn_unused_result));
+static size_t compute_latency_groups(struct perf_sample *const samples,
+                                     const size_t samples_nr,
+                                     uint64_t *const latencies,
+                                     struct perf_group *const groups)
+	__attribute__((warn_unused_result, nonnull(1, 3, 4)));
+static void compute_latency_stats(const struct perf_sample *const samples,
+                                  const size_t samples_nr,
+                                  uint64_t *const latencies,
+                                  struct perf_group *const group)
+	__attribute__((nonnull(1, 3, 4)));
+static void print_latency_report(const bool is_comp,
+                                 const struct perf_group *const groups,
+                                 const size_t groups_nr)
+	__attribute__((nonnull(2)));
+static int write_latency_json(const char *const json_filename,
+                              const bool is_comp,
+                              const unsigned long warmup,
+                              const struct perf_group *const groups,
+                              const size_t groups_nr)
+	__attribute__((warn_unused_result, nonnull(1, 4)));
+static const char * perf_group_profile_descr(const struct perf_group *const group)
+	__attribute__((warn_unused_result, nonnull(1)));
+static const char * perf_group_packet_descr(const struct perf_group *const group)
+	__attribute__((warn_unused_result, nonnull(1)));
+static int cmp_samples(const void *const sample1, const void *const sample2)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static int cmp_latencies(const void *const latency1, const void *const latency2)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
 static void print_rohc_traces(void *const priv_ctxt,
                               const rohc_trace_level_t level,
                               const rohc_trace_entity_t entity,
@@ -179,6 +310,9 @@ int main(int argc, char *argv[])
 	int wlsb_width = 4;
 	char *test_type = NULL; /* the name of the test to perform */
 	char *filename = NULL; /* the name of the PCAP capture used as input */
+	bool latency_mode = false;
+	long warmup = PERF_WARMUP_DEFAULT;
+	char *json_filename = NULL;
 	rohc_cid_type_t cid_type;
 	unsigned long packet_count = 0;
 	int status = 1;
@@ -244,6 +378,37 @@ int main(int argc, char *argv[])
 			argv++;
 			argc--;
 		}
+		else if(!strcmp(*argv, "--latency"))
+		{
+			/* time every packet and report latency percentiles */
+			latency_mode = true;
+		}
+		else if(!strcmp(*argv, "--warmup"))
+		{
+			/* get the number of packets to (de)compress before timing them */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "missing mandatory --warmup parameter\n");
+				usage();
+				goto error;
+			}
+			warmup = atol(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--json"))
+		{
+			/* get the name of the file to write the latency report to */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "missing mandatory --json parameter\n");
+				usage();
+				goto error;
+			}
+			json_filename = argv[1];
+			argv++;
+			argc--;
+		}
 		else if(test_type == 0)
 		{
 			/* get the name of the test */
@@ -283,6 +448,20 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
+	/* check latency options */
+	if(warmup < 0)
+	{
+		fprintf(stderr, "invalid number of warm-up packets %ld: should be "
+		        "positive or zero\n", warmup);
+		goto error;
+	}
+	if(!latency_mode && json_filename != NULL)
+	{
+		fprintf(stderr, "option --json requires option --latency\n");
+		usage();
+		goto error;
+	}
+
 	/* check CID type */
 	if(!strcmp(cid_type_name, "smallcid"))
 	{
@@ -318,7 +497,15 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
-	if(strcmp(test_type, "comp") == 0)
+	if(latency_mode &&
+	   (strcmp(test_type, "comp") == 0 || strcmp(test_type, "decomp") == 0))
+	{
+		/* time every (de)compressed packet of the capture */
+		ret = test_latency_perfs(strcmp(test_type, "comp") == 0, filename,
+		                         cid_type, wlsb_width, max_contexts, warmup,
+		                         json_filename, &packet_count);
+	}
+	else if(strcmp(test_type, "comp") == 0)
 	{
 		/* test ROHC compression with the packets from the capture */
 		ret = test_compression_perfs(filename, cid_type, wlsb_width, max_contexts,
@@ -386,55 +573,50 @@ static void usage(void)
 		"      --wlsb-width NUM    The width of the WLSB window to use\n"
 		"      --max-contexts NUM  The maximum number of ROHC contexts to\n"
 		"                          simultaneously use during the test\n"
+		"Latency options:\n"
+		"      --latency           Load the whole capture in memory, time\n"
+		"                          every packet, and report the latency\n"
+		"                          percentiles per profile and packet type\n"
+		"      --warmup NUM        The number of packets to (de)compress\n"
+		"                          before timing packets (default: %u)\n"
+		"      --json FILE         Also write the latency report to FILE\n"
+		"                          in the JSON format\n"
 		"\n"
 		"Examples:\n"
 		"  rohc_test_performance comp smallcid voip.pcap     test compression performances with small CIDs on the given VoIP stream\n"
 		"  rohc_test_performance decomp largecid a.pcap      test decompression performances with large CIDs on the given stream\n"
+		"  rohc_test_performance --latency --json lat.json comp smallcid voip.pcap\n"
+		"                                                    report compression latencies on the given VoIP stream\n"
 		"\n"
-		"Report bugs to <" PACKAGE_BUGREPORT ">.\n");
+		"Report bugs to <" PACKAGE_BUGREPORT ">.\n", PERF_WARMUP_DEFAULT);
 }
 
 
 /**
- * @brief Test the compression performance of the ROHC library
- *        with a flow of IP packets
+ * @brief Open the given PCAP capture
  *
- * @param filename      The name of the PCAP file that contains the IP packets
- * @param cid_type      The type of CIDs the compressor shall use
- * @param wlsb_width    The width of the WLSB window to use
- * @param max_contexts  The maximum number of ROHC contexts to use
- * @param packet_count  OUT: the number of compressed packets, undefined if
- *                      compression failed
- * @return              0 in case of success, 1 otherwise
+ * @param filename  The name of the PCAP file to open
+ * @param handle    OUT: The handle on the opened capture
+ * @param link_len  OUT: The length of the link layer header before IP data
+ * @return          0 in case of success, 1 otherwise
  */
-static int test_compression_perfs(char *filename,
-                                  const rohc_cid_type_t cid_type,
-                                  const size_t wlsb_width,
-                                  const size_t max_contexts,
-                                  unsigned long *packet_count)
+static int open_capture(const char *const filename,
+                        pcap_t **const handle,
+                        size_t *const link_len)
 {
-	pcap_t *handle;
 	char errbuf[PCAP_ERRBUF_SIZE];
 	int link_layer_type;
-	size_t link_len;
-	struct pcap_pkthdr header;
-	unsigned char *packet;
-	struct rohc_comp *comp;
-	int is_failure = 1;
-	int ret;
-
-	assert(max_contexts > 0);
 
 	/* open the PCAP file that contains the stream */
-	handle = pcap_open_offline(filename, errbuf);
-	if(handle == NULL)
+	*handle = pcap_open_offline(filename, errbuf);
+	if((*handle) == NULL)
 	{
 		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
-		goto exit;
+		goto error;
 	}
 
 	/* link layer in the capture must be Ethernet */
-	link_layer_type = pcap_datalink(handle);
+	link_layer_type = pcap_datalink(*handle);
 	if(link_layer_type != DLT_EN10MB &&
 	   link_layer_type != DLT_LINUX_SLL &&
 	   link_layer_type != DLT_RAW)
@@ -447,23 +629,136 @@ static int test_compression_perfs(char *filename,
 
 	if(link_layer_type == DLT_EN10MB)
 	{
-		link_len = ETHER_HDR_LEN;
+		*link_len = ETHER_HDR_LEN;
 	}
 	else if(link_layer_type == DLT_LINUX_SLL)
 	{
-		link_len = LINUX_COOKED_HDR_LEN;
+		*link_len = LINUX_COOKED_HDR_LEN;
 	}
 	else /* DLT_RAW */
 	{
-		link_len = 0;
+		*link_len = 0;
+	}
+
+	return 0;
+
+close_input:
+	pcap_close(*handle);
+error:
+	return 1;
+}
+
+
+/**
+ * @brief Skip the link layer header of the given captured packet
+ *
+ * @param num_packet  A number affected to the packet (traces only)
+ * @param header      The PCAP header for the packet
+ * @param link_len    The length of the link layer header before IP data
+ * @param packet      IN: The captured packet (link layer included)
+ *                    OUT: The packet without its link layer
+ * @return            0 in case of success, 1 otherwise
+ */
+static int skip_link_layer(const unsigned long num_packet,
+                           const struct pcap_pkthdr header,
+                           const size_t link_len,
+                           struct rohc_buf *const packet)
+{
+	/* check Ethernet frame length */
+	if(header.len <= link_len || header.len != header.caplen)
+	{
+		fprintf(stderr, "packet %lu: bad PCAP packet (len = %u, caplen = %u)\n",
+		        num_packet, header.len, header.caplen);
+		return 1;
+	}
+
+	/* skip the link layer header */
+	rohc_buf_pull(packet, link_len);
+
+	return 0;
+}
+
+
+/**
+ * @brief Remove the Ethernet padding after the given IP packet if any
+ *
+ * @param num_packet  A number affected to the IP packet (traces only)
+ * @param header      The PCAP header for the packet
+ * @param link_len    The length of the link layer header before IP data
+ * @param ip_packet   IN: The IP packet, maybe followed by Ethernet padding
+ *                    OUT: The IP packet without Ethernet padding
+ * @return            0 in case of success, 1 otherwise
+ */
+static int remove_ether_padding(const unsigned long num_packet,
+                                const struct pcap_pkthdr header,
+                                const size_t link_len,
+                                struct rohc_buf *const ip_packet)
+{
+	uint8_t ip_version;
+	uint16_t tot_len;
+
+	/* only minimal Ethernet frames may contain padding */
+	if(link_len != ETHER_HDR_LEN || header.len != ETHER_FRAME_MIN_LEN)
+	{
+		return 0;
+	}
+
+	/* determine the total length of the IP packet */
+	ip_version = (rohc_buf_byte(*ip_packet) >> 4) & 0x0f;
+	if(ip_version == 4) /* IPv4 */
+	{
+		struct ipv4_hdr *ip;
+
+		ip = (struct ipv4_hdr *) rohc_buf_data(*ip_packet);
+		tot_len = ntohs(ip->tot_len);
+	}
+	else if(ip_version == 6) /* IPv6 */
+	{
+		struct ipv6_hdr *ip;
+
+		ip = (struct ipv6_hdr *) rohc_buf_data(*ip_packet);
+		tot_len = sizeof(struct ipv6_hdr) + ntohs(ip->plen);
+	}
+	else /* unknown IP version */
+	{
+		fprintf(stderr, "packet %lu: bad IP version (0x%x) "
+		        "in packet\n", num_packet, ip_version);
+		return 1;
+	}
+
+	/* update the length of the IP packet if padding is present */
+	if(tot_len < ip_packet->len)
+	{
+		fprintf(stderr, "packet %lu: the Ethernet frame has %zu "
+		        "bytes of padding after the %u-byte IP packet!\n",
+		        num_packet, ip_packet->len - tot_len, tot_len);
+		ip_packet->len = tot_len;
 	}
 
+	return 0;
+}
+
+
+/**
+ * @brief Create the ROHC compressor used for tests
+ *
+ * @param cid_type      The type of CIDs the compressor shall use
+ * @param wlsb_width    The width of the WLSB window to use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @return              The new compressor, NULL in case of error
+ */
+static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts)
+{
+	struct rohc_comp *comp;
+
 	/* create ROHC compressor */
 	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
 	if(comp == NULL)
 	{
 		fprintf(stderr, "cannot create the ROHC compressor\n");
-		goto close_input;
+		goto error;
 	}
 
 	/* enable traces in verbose mode */
@@ -509,6 +804,106 @@ static int test_compression_perfs(char *filename,
 		goto free_compresssor;
 	}
 
+	return comp;
+
+free_compresssor:
+	rohc_comp_free(comp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Create the ROHC decompressor used for tests
+ *
+ * @param cid_type      The type of CIDs the decompressor shall use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @return              The new decompressor, NULL in case of error
+ */
+static struct rohc_decomp * create_decompressor(const rohc_cid_type_t cid_type,
+                                                const size_t max_contexts)
+{
+	struct rohc_decomp *decomp;
+
+	/* create ROHC decompressor */
+	decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC decompressor\n");
+		goto error;
+	}
+
+	/* enable traces in verbose mode */
+	if(verbosity == VERBOSITY_FULL)
+	{
+		/* set the callback for traces on decompressor */
+		if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+		{
+			fprintf(stderr, "cannot set trace callback for decompressor\n");
+			goto free_decompressor;
+		}
+	}
+
+	/* activate all the decompression profiles */
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto free_decompressor;
+	}
+
+	return decomp;
+
+free_decompressor:
+	rohc_decomp_free(decomp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Test the compression performance of the ROHC library
+ *        with a flow of IP packets
+ *
+ * @param filename      The name of the PCAP file that contains the IP packets
+ * @param cid_type      The type of CIDs the compressor shall use
+ * @param wlsb_width    The width of the WLSB window to use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @param packet_count  OUT: the number of compressed packets, undefined if
+ *                      compression failed
+ * @return              0 in case of success, 1 otherwise
+ */
+static int test_compression_perfs(char *filename,
+                                  const rohc_cid_type_t cid_type,
+                                  const size_t wlsb_width,
+                                  const size_t max_contexts,
+                                  unsigned long *packet_count)
+{
+	pcap_t *handle;
+	size_t link_len;
+	struct pcap_pkthdr header;
+	unsigned char *packet;
+	struct rohc_comp *comp;
+	int is_failure = 1;
+	int ret;
+
+	assert(max_contexts > 0);
+
+	/* open the PCAP file that contains the stream */
+	if(open_capture(filename, &handle, &link_len) != 0)
+	{
+		goto exit;
+	}
+
+	/* create ROHC compressor */
+	comp = create_compressor(cid_type, wlsb_width, max_contexts);
+	if(comp == NULL)
+	{
+		goto close_input;
+	}
+
 	/* print some progress info if not in quiet mode */
 	if(verbosity != VERBOSITY_NONE)
 	{
@@ -585,56 +980,13 @@ static int time_compress_packet(struct rohc_comp *comp,
 	int is_failure = 1;
 	rohc_status_t status;
 
-	/* check Ethernet frame length */
-	if(header.len <= link_len || header.len != header.caplen)
+	/* skip the link layer header and the Ethernet padding if any */
+	if(skip_link_layer(num_packet, header, link_len, &ip_packet) != 0 ||
+	   remove_ether_padding(num_packet, header, link_len, &ip_packet) != 0)
 	{
-		fprintf(stderr, "packet %lu: bad PCAP packet (len = %u, caplen = %u)\n",
-		        num_packet, header.len, header.caplen);
 		goto error;
 	}
 
-	/* skip the link layer header */
-	rohc_buf_pull(&ip_packet, link_len);
-
-	/* check for padding after the IP packet in the Ethernet payload */
-	if(link_len == ETHER_HDR_LEN && header.len == ETHER_FRAME_MIN_LEN)
-	{
-		uint8_t ip_version;
-		uint16_t tot_len;
-
-		/* determine the total length of the IP packet */
-		ip_version = (rohc_buf_byte(ip_packet) >> 4) & 0x0f;
-		if(ip_version == 4) /* IPv4 */
-		{
-			struct ipv4_hdr *ip;
-
-			ip = (struct ipv4_hdr *) rohc_buf_data(ip_packet);
-			tot_len = ntohs(ip->tot_len);
-		}
-		else if(ip_version == 6) /* IPv6 */
-		{
-			struct ipv6_hdr *ip;
-
-			ip = (struct ipv6_hdr *) rohc_buf_data(ip_packet);
-			tot_len = sizeof(struct ipv6_hdr) + ntohs(ip->plen);
-		}
-		else /* unknown IP version */
-		{
-			fprintf(stderr, "packet %lu: bad IP version (0x%x) "
-			        "in packet\n", num_packet, ip_version);
-			goto error;
-		}
-
-		/* update the length of the IP packet if padding is present */
-		if(tot_len < ip_packet.len)
-		{
-			fprintf(stderr, "packet %lu: the Ethernet frame has %zu "
-			        "bytes of padding after the %u-byte IP packet!\n",
-			        num_packet, ip_packet.len - tot_len, tot_len);
-			ip_packet.len = tot_len;
-		}
-	}
-
 	/* compress the packet */
 	status = rohc_compress4(comp, ip_packet, &rohc_packet);
 	if(status != ROHC_STATUS_OK)
@@ -669,8 +1021,6 @@ static int test_decompression_perfs(char *filename,
 {
 	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
 	pcap_t *handle;
-	char errbuf[PCAP_ERRBUF_SIZE];
-	int link_layer_type;
 	size_t link_len;
 	struct pcap_pkthdr header;
 	unsigned char *packet;
@@ -681,67 +1031,18 @@ static int test_decompression_perfs(char *filename,
 	assert(max_contexts > 0);
 
 	/* open the PCAP file that contains the stream */
-	handle = pcap_open_offline(filename, errbuf);
-	if(handle == NULL)
+	if(open_capture(filename, &handle, &link_len) != 0)
 	{
-		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
 		goto exit;
 	}
 
-	/* link layer in the capture must be Ethernet */
-	link_layer_type = pcap_datalink(handle);
-	if(link_layer_type != DLT_EN10MB &&
-	   link_layer_type != DLT_LINUX_SLL &&
-	   link_layer_type != DLT_RAW)
-	{
-		fprintf(stderr, "link layer type %d not supported in capture "
-		        "(supported = %d, %d, %d)\n", link_layer_type,
-		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
-		goto close_input;
-	}
-
-	if(link_layer_type == DLT_EN10MB)
-	{
-		link_len = ETHER_HDR_LEN;
-	}
-	else if(link_layer_type == DLT_LINUX_SLL)
-	{
-		link_len = LINUX_COOKED_HDR_LEN;
-	}
-	else /* DLT_RAW */
-	{
-		link_len = 0;
-	}
-
 	/* create ROHC decompressor */
-	decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_U_MODE);
+	decomp = create_decompressor(cid_type, max_contexts);
 	if(decomp == NULL)
 	{
-		fprintf(stderr, "cannot create the ROHC decompressor\n");
 		goto close_input;
 	}
 
-	/* enable traces in verbose mode */
-	if(verbosity == VERBOSITY_FULL)
-	{
-		/* set the callback for traces on decompressor */
-		if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
-		{
-			fprintf(stderr, "cannot set trace callback for decompressor\n");
-			goto free_decompressor;
-		}
-	}
-
-	/* activate all the decompression profiles */
-	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
-	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
-	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
-	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
-	{
-		fprintf(stderr, "failed to enable the decompression profiles\n");
-		goto free_decompressor;
-	}
-
 	/* print some progress info if not in quiet mode */
 	if(verbosity != VERBOSITY_NONE)
 	{
@@ -812,17 +1113,12 @@ static int time_decompress_packet(struct rohc_decomp *decomp,
 	int is_failure = 1;
 	rohc_status_t status;
 
-	/* check Ethernet frame length */
-	if(header.len <= link_len || header.len != header.caplen)
+	/* skip the link layer header */
+	if(skip_link_layer(num_packet, header, link_len, &rohc_packet) != 0)
 	{
-		fprintf(stderr, "packet %lu: bad PCAP packet (len = %u, caplen = %u)\n",
-		        num_packet, header.len, header.caplen);
 		goto error;
 	}
 
-	/* skip the link layer header */
-	rohc_buf_pull(&rohc_packet, link_len);
-
 	/* decompress the packet */
 	status = rohc_decompress3(decomp, rohc_packet, &ip_packet, NULL, NULL);
 	if(status != ROHC_STATUS_OK)
@@ -839,6 +1135,627 @@ error:
 }
 
 
+/**
+ * @brief Test the latency of the ROHC library packet per packet
+ *
+ * The whole capture is loaded in memory first. The first packets are
+ * (de)compressed without being timed to warm up the contexts, then every
+ * call to rohc_compress4() or rohc_decompress3() is timed.
+ *
+ * @param is_comp        Whether to test compression or decompression
+ * @param filename        The name of the PCAP file that contains the packets
+ * @param cid_type        The type of CIDs the (de)compressor shall use
+ * @param wlsb_width      The width of the WLSB window to use
+ * @param max_contexts    The maximum number of ROHC contexts to use
+ * @param warmup          The number of packets to (de)compress before timing
+ * @param json_filename   The name of the file to write the JSON report to,
+ *                        NULL for no JSON report
+ * @param packet_count    OUT: the number of timed packets, undefined if
+ *                        (de)compression failed
+ * @return                0 in case of success, 1 otherwise
+ */
+static int test_latency_perfs(const bool is_comp,
+                              const char *const filename,
+                              const rohc_cid_type_t cid_type,
+                              const size_t wlsb_width,
+                              const size_t max_contexts,
+                              const unsigned long warmup,
+                              const char *const json_filename,
+                              unsigned long *const packet_count)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct perf_packet *packets;
+	size_t packets_nr;
+	struct perf_sample *samples;
+	uint64_t *latencies;
+	struct perf_group *groups;
+	size_t groups_nr;
+	struct rohc_comp *comp = NULL;
+	struct rohc_decomp *decomp = NULL;
+	uint8_t *out_buffer;
+	int is_failure = 1;
+	size_t i;
+
+	assert(max_contexts > 0);
+
+	/* load the whole capture, so that neither the disk nor libpcap are timed */
+	if(load_capture(is_comp, filename, &packets, &packets_nr) != 0)
+	{
+		goto exit;
+	}
+	if(packets_nr <= warmup)
+	{
+		fprintf(stderr, "the capture contains %zu packets, it shall contain more "
+		        "than the %lu warm-up packets\n", packets_nr, warmup);
+		goto free_packets;
+	}
+	*packet_count = packets_nr - warmup;
+
+	/* allocate all memory before timing packets */
+	samples = calloc(*packet_count, sizeof(struct perf_sample));
+	if(samples == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %lu latency samples\n",
+		        *packet_count);
+		goto free_packets;
+	}
+	out_buffer = malloc(MAX_ROHC_SIZE);
+	if(out_buffer == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for the output buffer\n");
+		goto free_samples;
+	}
+
+	/* create the ROHC (de)compressor */
+	if(is_comp)
+	{
+		comp = create_compressor(cid_type, wlsb_width, max_contexts);
+		if(comp == NULL)
+		{
+			goto free_out_buffer;
+		}
+	}
+	else
+	{
+		decomp = create_decompressor(cid_type, max_contexts);
+		if(decomp == NULL)
+		{
+			goto free_out_buffer;
+		}
+	}
+
+	/* (de)compress all packets, time them once contexts are warmed up */
+	for(i = 0; i < packets_nr; i++)
+	{
+		const struct rohc_buf in_packet =
+			rohc_buf_init_full(packets[i].data, packets[i].len, arrival_time);
+		struct rohc_buf out_packet =
+			rohc_buf_init_empty(out_buffer, MAX_ROHC_SIZE);
+		struct perf_sample *sample;
+		rohc_status_t status;
+		uint64_t start;
+		uint64_t end;
+
+		if(is_comp)
+		{
+			start = perf_now_ns();
+			status = rohc_compress4(comp, in_packet, &out_packet);
+			end = perf_now_ns();
+		}
+		else
+		{
+			start = perf_now_ns();
+			status = rohc_decompress3(decomp, in_packet, &out_packet, NULL, NULL);
+			end = perf_now_ns();
+		}
+		if(status != ROHC_STATUS_OK)
+		{
+			fprintf(stderr, "packet %zu: %scompression failed\n", i + 1,
+			        is_comp ? "" : "de");
+			goto free_rohc;
+		}
+
+		/* do not record the warm-up packets */
+		if(i < warmup)
+		{
+			continue;
+		}
+		sample = &samples[i - warmup];
+		sample->ns = end - start;
+
+		/* classify the packet by profile and packet type */
+		if(is_comp)
+		{
+			rohc_comp_last_packet_info2_t info;
+
+			memset(&info, 0, sizeof(rohc_comp_last_packet_info2_t));
+			info.version_major = 0;
+			info.version_minor = 0;
+			if(!rohc_comp_get_last_packet_info2(comp, &info))
+			{
+				fprintf(stderr, "packet %zu: failed to get compression info\n", i + 1);
+				goto free_rohc;
+			}
+			sample->profile_id = info.profile_id;
+			sample->packet_type = info.packet_type;
+		}
+		else
+		{
+			rohc_decomp_last_packet_info_t info;
+
+			memset(&info, 0, sizeof(rohc_decomp_last_packet_info_t));
+			info.version_major = 0;
+			info.version_minor = 1;
+			if(!rohc_decomp_get_last_packet_info(decomp, &info))
+			{
+				fprintf(stderr, "packet %zu: failed to get decompression info\n", i + 1);
+				goto free_rohc;
+			}
+			sample->profile_id = info.profile_id;
+			sample->packet_type = info.packet_type;
+		}
+	}
+
+	/* compute the latency statistics: all packets, per profile, and per
+	 * profile and packet type */
+	latencies = malloc((*packet_count) * sizeof(uint64_t));
+	if(latencies == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for latency statistics\n");
+		goto free_rohc;
+	}
+	groups = calloc(2 * (*packet_count) + 1, sizeof(struct perf_group));
+	if(groups == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for latency statistics\n");
+		goto free_latencies;
+	}
+	groups_nr = compute_latency_groups(samples, *packet_count, latencies, groups);
+
+	/* report the latency statistics */
+	if(verbosity != VERBOSITY_NONE)
+	{
+		print_latency_report(is_comp, groups, groups_nr);
+	}
+	if(json_filename != NULL &&
+	   write_latency_json(json_filename, is_comp, warmup, groups, groups_nr) != 0)
+	{
+		goto free_groups;
+	}
+
+	/* everything went fine */
+	is_failure = 0;
+
+free_groups:
+	free(groups);
+free_latencies:
+	free(latencies);
+free_rohc:
+	if(is_comp)
+	{
+		rohc_comp_free(comp);
+	}
+	else
+	{
+		rohc_decomp_free(decomp);
+	}
+free_out_buffer:
+	free(out_buffer);
+free_samples:
+	free(samples);
+free_packets:
+	free_capture(packets, packets_nr);
+exit:
+	return is_failure;
+}
+
+
+/**
+ * @brief Load the whole PCAP capture in memory
+ *
+ * The link layer of every packet is removed. The Ethernet padding is also
+ * removed after IP packets.
+ *
+ * @param is_comp     Whether the capture contains IP packets to compress
+ *                    or ROHC packets to decompress
+ * @param filename    The name of the PCAP file to load
+ * @param packets     OUT: The packets of the capture, to free with
+ *                    \ref free_capture
+ * @param packets_nr  OUT: The number of packets in the capture
+ * @return            0 in case of success, 1 otherwise
+ */
+static int load_capture(const bool is_comp,
+                        const char *const filename,
+                        struct perf_packet **const packets,
+                        size_t *const packets_nr)
+{
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	size_t packets_max = 0;
+	pcap_t *handle;
+	size_t link_len;
+	struct pcap_pkthdr header;
+	unsigned char *packet;
+
+	*packets = NULL;
+	*packets_nr = 0;
+
+	/* open the PCAP file that contains the stream */
+	if(open_capture(filename, &handle, &link_len) != 0)
+	{
+		goto error;
+	}
+
+	/* copy every packet of the capture, without its link layer */
+	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	{
+		struct rohc_buf buf = rohc_buf_init_full(packet, header.caplen, arrival_time);
+		const unsigned long num_packet = (*packets_nr) + 1;
+
+		if(skip_link_layer(num_packet, header, link_len, &buf) != 0 ||
+		   (is_comp && remove_ether_padding(num_packet, header, link_len, &buf) != 0))
+		{
+			goto free_packets;
+		}
+
+		/* enlarge the table of packets if needed */
+		if((*packets_nr) == packets_max)
+		{
+			struct perf_packet *new_packets;
+
+			packets_max = (packets_max == 0 ? 1024 : packets_max * 2);
+			new_packets = realloc(*packets, packets_max * sizeof(struct perf_packet));
+			if(new_packets == NULL)
+			{
+				fprintf(stderr, "failed to allocate memory for %zu packets\n",
+				        packets_max);
+				goto free_packets;
+			}
+			*packets = new_packets;
+		}
+
+		(*packets)[*packets_nr].data = malloc(buf.len);
+		if((*packets)[*packets_nr].data == NULL)
+		{
+			fprintf(stderr, "packet %lu: failed to allocate memory\n", num_packet);
+			goto free_packets;
+		}
+		memcpy((*packets)[*packets_nr].data, rohc_buf_data(buf), buf.len);
+		(*packets)[*packets_nr].len = buf.len;
+		(*packets_nr)++;
+	}
+
+	pcap_close(handle);
+	return 0;
+
+free_packets:
+	free_capture(*packets, *packets_nr);
+	*packets = NULL;
+	*packets_nr = 0;
+	pcap_close(handle);
+error:
+	return 1;
+}
+
+
+/**
+ * @brief Free the packets loaded in memory by \ref load_capture
+ *
+ * @param packets     The packets to free
+ * @param packets_nr  The number of packets to free
+ */
+static void free_capture(struct perf_packet *const packets,
+                         const size_t packets_nr)
+{
+	size_t i;
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		free(packets[i].data);
+	}
+	free(packets);
+}
+
+
+/**
+ * @brief Get the current time of the monotonic clock
+ *
+ * @return  The current time (in nanoseconds)
+ */
+static uint64_t perf_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t) now.tv_sec) * 1000000000U + now.tv_nsec;
+}
+
+
+/**
+ * @brief Compute the latency statistics of all the timed packets
+ *
+ * The first group contains all packets, then every profile is followed by
+ * the groups of its packet types.
+ *
+ * @param samples     The latency samples, sorted by the function
+ * @param samples_nr  The number of latency samples
+ * @param latencies   A work buffer for samples_nr latencies
+ * @param groups      OUT: The latency statistics, at least 2 * samples_nr + 1
+ * @return            The number of groups of latency statistics
+ */
+static size_t compute_latency_groups(struct perf_sample *const samples,
+                                     const size_t samples_nr,
+                                     uint64_t *const latencies,
+                                     struct perf_group *const groups)
+{
+	size_t groups_nr = 0;
+	size_t profile_first;
+
+	/* all packets */
+	groups[groups_nr].profile_id = -1;
+	groups[groups_nr].packet_type = -1;
+	compute_latency_stats(samples, samples_nr, latencies, &groups[groups_nr]);
+	groups_nr++;
+
+	/* per profile, then per packet type within every profile */
+	qsort(samples, samples_nr, sizeof(struct perf_sample), cmp_samples);
+	profile_first = 0;
+	while(profile_first < samples_nr)
+	{
+		const int profile_id = samples[profile_first].profile_id;
+		size_t type_first = profile_first;
+		size_t profile_end = profile_first;
+
+		while(profile_end < samples_nr &&
+		      samples[profile_end].profile_id == profile_id)
+		{
+			profile_end++;
+		}
+		groups[groups_nr].profile_id = profile_id;
+		groups[groups_nr].packet_type = -1;
+		compute_latency_stats(samples + profile_first, profile_end - profile_first,
+		                      latencies, &groups[groups_nr]);
+		groups_nr++;
+
+		while(type_first < profile_end)
+		{
+			const rohc_packet_t packet_type = samples[type_first].packet_type;
+			size_t type_end = type_first;
+
+			while(type_end < profile_end &&
+			      samples[type_end].packet_type == packet_type)
+			{
+				type_end++;
+			}
+			groups[groups_nr].profile_id = profile_id;
+			groups[groups_nr].packet_type = packet_type;
+			compute_latency_stats(samples + type_first, type_end - type_first,
+			                      latencies, &groups[groups_nr]);
+			groups_nr++;
+
+			type_first = type_end;
+		}
+
+		profile_first = profile_end;
+	}
+
+	return groups_nr;
+}
+
+
+/**
+ * @brief Compute the latency percentiles of one group of packets
+ *
+ * The percentiles are computed with the nearest-rank method.
+ *
+ * @param samples     The latency samples of the group
+ * @param samples_nr  The number of latency samples in the group
+ * @param latencies   A work buffer for at least samples_nr latencies
+ * @param group       IN: the group of packets
+ *                    OUT: the latency statistics of the group
+ */
+static void compute_latency_stats(const struct perf_sample *const samples,
+                                  const size_t samples_nr,
+                                  uint64_t *const latencies,
+                                  struct perf_group *const group)
+{
+	size_t i;
+
+	assert(samples_nr > 0);
+
+	for(i = 0; i < samples_nr; i++)
+	{
+		latencies[i] = samples[i].ns;
+	}
+	qsort(latencies, samples_nr, sizeof(uint64_t), cmp_latencies);
+
+	group->nr = samples_nr;
+	for(i = 0; i < PERF_PCTS_NR; i++)
+	{
+		size_t rank = (samples_nr * perf_pcts[i].permille + 999) / 1000;
+		if(rank < 1)
+		{
+			rank = 1;
+		}
+		group->pcts[i] = latencies[rank - 1];
+	}
+	group->max = latencies[samples_nr - 1];
+}
+
+
+/**
+ * @brief Print the latency report on the standard output
+ *
+ * @param is_comp    Whether compression or decompression was tested
+ * @param groups     The latency statistics
+ * @param groups_nr  The number of groups of latency statistics
+ */
+static void print_latency_report(const bool is_comp,
+                                 const struct perf_group *const groups,
+                                 const size_t groups_nr)
+{
+	size_t i;
+	size_t j;
+
+	printf("%scompression latencies (in nanoseconds):\n", is_comp ? "" : "de");
+	printf("%-28s %-16s %10s", "profile", "packet type", "packets");
+	for(j = 0; j < PERF_PCTS_NR; j++)
+	{
+		printf(" %10s", perf_pcts[j].name);
+	}
+	printf(" %10s\n", "max");
+
+	for(i = 0; i < groups_nr; i++)
+	{
+		printf("%-28s %-16s %10zu", perf_group_profile_descr(&groups[i]),
+		       perf_group_packet_descr(&groups[i]), groups[i].nr);
+		for(j = 0; j < PERF_PCTS_NR; j++)
+		{
+			printf(" %10" PRIu64, groups[i].pcts[j]);
+		}
+		printf(" %10" PRIu64 "\n", groups[i].max);
+	}
+}
+
+
+/**
+ * @brief Write the latency report in the JSON format
+ *
+ * @param json_filename  The name of the file to write the report to
+ * @param is_comp        Whether compression or decompression was tested
+ * @param warmup         The number of warm-up packets
+ * @param groups         The latency statistics
+ * @param groups_nr      The number of groups of latency statistics
+ * @return               0 in case of success, 1 otherwise
+ */
+static int write_latency_json(const char *const json_filename,
+                              const bool is_comp,
+                              const unsigned long warmup,
+                              const struct perf_group *const groups,
+                              const size_t groups_nr)
+{
+	FILE *json;
+	size_t i;
+	size_t j;
+
+	json = fopen(json_filename, "w");
+	if(json == NULL)
+	{
+		fprintf(stderr, "failed to open JSON file '%s': %s (%d)\n",
+		        json_filename, strerror(errno), errno);
+		goto error;
+	}
+
+	fprintf(json, "{\n");
+	fprintf(json, "  \"test\": \"%s\",\n", is_comp ? "comp" : "decomp");
+	fprintf(json, "  \"unit\": \"ns\",\n");
+	fprintf(json, "  \"warmup\": %lu,\n", warmup);
+	fprintf(json, "  \"groups\": [\n");
+	for(i = 0; i < groups_nr; i++)
+	{
+		fprintf(json, "    { \"profile\": \"%s\", \"profile_id\": %d, "
+		        "\"packet_type\": \"%s\", \"packets\": %zu",
+		        perf_group_profile_descr(&groups[i]), groups[i].profile_id,
+		        perf_group_packet_descr(&groups[i]), groups[i].nr);
+		for(j = 0; j < PERF_PCTS_NR; j++)
+		{
+			fprintf(json, ", \"%s\": %" PRIu64, perf_pcts[j].name,
+			        groups[i].pcts[j]);
+		}
+		fprintf(json, ", \"max\": %" PRIu64 " }%s\n", groups[i].max,
+		        (i + 1) < groups_nr ? "," : "");
+	}
+	fprintf(json, "  ]\n");
+	fprintf(json, "}\n");
+
+	if(fclose(json) != 0)
+	{
+		fprintf(stderr, "failed to write JSON file '%s': %s (%d)\n",
+		        json_filename, strerror(errno), errno);
+		goto error;
+	}
+
+	return 0;
+
+error:
+	return 1;
+}
+
+
+/**
+ * @brief Get the description of the profile of the given group of packets
+ *
+ * @param group  The group of packets
+ * @return       The description of the profile of the group
+ */
+static const char * perf_group_profile_descr(const struct perf_group *const group)
+{
+	if(group->profile_id < 0)
+	{
+		return "all";
+	}
+	return rohc_get_profile_descr(group->profile_id);
+}
+
+
+/**
+ * @brief Get the description of the packet type of the given group of packets
+ *
+ * @param group  The group of packets
+ * @return       The description of the packet type of the group
+ */
+static const char * perf_group_packet_descr(const struct perf_group *const group)
+{
+	if(group->packet_type < 0)
+	{
+		return "all";
+	}
+	return rohc_get_packet_descr(group->packet_type);
+}
+
+
+/**
+ * @brief Compare two latency samples by profile, then by packet type
+ *
+ * @param sample1  The first latency sample
+ * @param sample2  The second latency sample
+ * @return         <0, 0 or >0 if the first sample is ordered before, with
+ *                 or after the second sample
+ */
+static int cmp_samples(const void *const sample1, const void *const sample2)
+{
+	const struct perf_sample *const s1 = sample1;
+	const struct perf_sample *const s2 = sample2;
+
+	if(s1->profile_id != s2->profile_id)
+	{
+		return (s1->profile_id < s2->profile_id ? -1 : 1);
+	}
+	if(s1->packet_type != s2->packet_type)
+	{
+		return (s1->packet_type < s2->packet_type ? -1 : 1);
+	}
+	return 0;
+}
+
+
+/**
+ * @brief Compare two latencies
+ *
+ * @param latency1  The first latency
+ * @param latency2  The second latency
+ * @return          <0, 0 or >0 if the first latency is lower, equal or
+ *                  greater than the second latency
+ */
+static int cmp_latencies(const void *const latency1, const void *const latency2)
+{
+	const uint64_t l1 = *((const uint64_t *) latency1);
+	const uint64_t l2 = *((const uint64_t *) latency2);
+
+	return (l1 < l2 ? -1 : (l1 > l2 ? 1 : 0));
+}
+
+
 /**
  * @brief Print traces emitted by the ROHC library in verbose mode
  *
@@ -0,0 +1,1361 @@
+/*
+ * Copyright 2017 Didier Barvaux
+ * Copyright 2017 Viveris Technologies
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_scaling.c
+ * @brief   ROHC multi-core scaling program
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * Introduction
+ * ------------
+ *
+ * The program takes a flow of IP packets as input (in the PCAP format) and
+ * tests how the throughput of the ROHC library scales with the number of
+ * CPU cores. The library has no global state besides its constant tables,
+ * so one compressor/decompressor pair per core should scale linearly. The
+ * program detects the regressions that break this property, such as hidden
+ * static variables or false sharing.
+ *
+ * Details
+ * -------
+ *
+ * The program loads the whole capture in memory, then runs one test for
+ * every number of threads from 1 to N. For every test, the flows of the
+ * capture are sharded among the threads with a hash of their IP addresses,
+ * IP protocol and ports, so that all the packets of one flow are handled by
+ * the same thread. Every thread is pinned on its own CPU core, among the
+ * cores the program is allowed to run on, and owns one compressor and one
+ * decompressor. It compresses every packet of its shard,
+ * decompresses the ROHC packet and checks that the original IP packet is
+ * retrieved. See the figure below.
+ *
+ *                     +------------+        +--------------+
+ *   shard #1  ------> | compressor | -----> | decompressor | ---->  check
+ *                     +------------+        +--------------+
+ *     ...                                 ...
+ *                     +------------+        +--------------+
+ *   shard #n  ------> | compressor | -----> | decompressor | ---->  check
+ *                     +------------+        +--------------+
+ *
+ * All threads are created and their (de)compressors are allocated before
+ * they are released together. The elapsed time is measured from the first
+ * thread that starts to the last thread that ends.
+ *
+ * Output
+ * ------
+ *
+ * For every number of threads, the program outputs the aggregate throughput
+ * in millions of packets per second (Mpps), the throughput per thread, the
+ * scaling efficiency, that is the aggregate throughput divided by n times
+ * the throughput of one thread, and the balance of the shards, that is the
+ * efficiency that the sharding alone allows. An efficiency far below the
+ * balance denotes contention between the threads.
+ */
+
+#ifndef _GNU_SOURCE
+#  define _GNU_SOURCE /* for pthread_setaffinity_np() and sched_getaffinity() */
+#endif
+
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#include <unistd.h>
+#if HAVE_WINSOCK2_H == 1
+#  include <winsock2.h> /* for ntohs() on Windows */
+#endif
+#if HAVE_ARPA_INET_H == 1
+#  include <arpa/inet.h> /* for ntohs() on Linux */
+#endif
+#include <pthread.h>
+#ifdef __linux__
+#  include <sched.h> /* for CPU_SET() and sched_getaffinity() */
+#endif
+#include <time.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* include for the PCAP library */
+#if HAVE_PCAP_PCAP_H == 1
+#  include <pcap/pcap.h>
+#elif HAVE_PCAP_H == 1
+#  include <pcap.h>
+#else
+#  error "pcap.h header not found, did you specified --enable-rohc-tests \
+for ./configure ? If yes, check configure output and config.log"
+#endif
+
+/* includes for network headers */
+#include <protocols/ip_numbers.h>
+#include <protocols/ipv4.h>
+#include <protocols/ipv6.h>
+
+/* ROHC includes */
+#include <rohc/rohc.h>
+#include <rohc/rohc_comp.h>
+#include <rohc/rohc_decomp.h>
+
+
+/** The maximal size for the ROHC packets */
+#define MAX_ROHC_SIZE  0xffffU
+
+/** The length of the Linux Cooked Sockets header */
+#define LINUX_COOKED_HDR_LEN  16U
+
+/** The length (in bytes) of the Ethernet header */
+#define ETHER_HDR_LEN  14U
+
+/** The minimum Ethernet length (in bytes) */
+#define ETHER_FRAME_MIN_LEN  60U
+
+/** The default number of times every thread (de)compresses its shard */
+#define SCALING_REPEAT_DEFAULT  10U
+
+
+/** One IP packet of the capture preloaded in memory */
+struct scaling_packet
+{
+	uint8_t *data;  /**< The packet data, link layer excluded */
+	size_t len;     /**< The length (in bytes) of the packet data */
+	uint32_t hash;  /**< The hash of the flow the packet belongs to */
+};
+
+
+/** The gate that releases all the threads of one test together */
+struct scaling_gate
+{
+	pthread_mutex_t mutex;  /**< The mutex that protects the gate */
+	pthread_cond_t cond;    /**< The condition signaled when gate opens */
+	size_t ready_nr;        /**< The number of threads ready to start */
+	bool is_open;           /**< Whether the threads may start or not */
+};
+
+
+/** The outcome of one thread of a scaling test */
+enum scaling_status
+{
+	SCALING_OK             = 0, /**< All packets were round-tripped */
+	SCALING_PIN_FAILED     = 1, /**< The thread failed to pin itself */
+	SCALING_SETUP_FAILED   = 2, /**< The thread failed to set up its resources */
+	SCALING_PACKETS_FAILED = 3  /**< Some packets failed to round-trip */
+};
+
+
+/** One thread of a scaling test */
+struct scaling_worker
+{
+	pthread_t thread;              /**< The thread */
+	size_t id;                     /**< The index of the thread */
+	long cpu;                      /**< The CPU to pin the thread on, -1 if none */
+	struct scaling_gate *gate;     /**< The gate shared by all threads */
+
+	rohc_cid_type_t cid_type;      /**< The type of CIDs to use */
+	size_t wlsb_width;             /**< The width of the WLSB window to use */
+	size_t max_contexts;           /**< The maximum number of ROHC contexts */
+	unsigned long repeat;          /**< The number of passes over the shard */
+
+	const struct scaling_packet **packets;  /**< The packets of the shard */
+	size_t packets_nr;             /**< The number of packets in the shard */
+
+	/* results, written once by the thread when it ends, so that the workers
+	 * do not share any cache line while they are timed */
+	uint64_t start_ns;             /**< The time the thread started (in ns) */
+	uint64_t end_ns;               /**< The time the thread ended (in ns) */
+	unsigned long done_nr;         /**< The number of round-tripped packets */
+	unsigned long errors_nr;       /**< The number of failed packets */
+	enum scaling_status status;    /**< The outcome of the thread */
+};
+
+
+/** Whether the application runs in verbose mode or not */
+static enum
+{
+	VERBOSITY_NONE,
+	VERBOSITY_NORMAL,
+	VERBOSITY_FULL
+} verbosity = VERBOSITY_NORMAL;
+
+
+static void usage(void);
+
+static int load_capture(const char *const filename,
+                        struct scaling_packet **const packets,
+                        size_t *const packets_nr)
+	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
+static void free_capture(struct scaling_packet *const packets,
+                         const size_t packets_nr);
+static int get_usable_cpus(long **const cpus, size_t *const cpus_nr)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+static uint32_t compute_flow_hash(const uint8_t *const data,
+                                  const size_t len)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static int test_scaling(const struct scaling_packet *const packets,
+                        const size_t packets_nr,
+                        const rohc_cid_type_t cid_type,
+                        const size_t wlsb_width,
+                        const size_t max_contexts,
+                        const size_t threads_nr,
+                        const unsigned long repeat,
+                        const long *const cpus,
+                        const size_t cpus_nr,
+                        double *const mpps_1)
+	__attribute__((warn_unused_result, nonnull(1, 10)));
+static void * scaling_worker_run(void *const arg)
+	__attribute__((nonnull(1)));
+static int pin_thread(const long cpu)
+	__attribute__((warn_unused_result));
+
+static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts)
+	__attribute__((warn_unused_result));
+static struct rohc_decomp * create_decompressor(const rohc_cid_type_t cid_type,
+                                                const size_t max_contexts)
+	__attribute__((warn_unused_result));
+
+static uint64_t scaling_now_ns(void)
+	__attribute__((warn_unused_result));
+
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+	__attribute__((nonnull(1), warn_unused_result));
+
+static bool rohc_comp_rtp_cb(const unsigned char *const ip,
+                             const unsigned char *const udp,
+                             const unsigned char *const payload,
+                             const unsigned int payload_size,
+                             void *const rtp_private)
+	__attribute__((warn_unused_result));
+
+
+/**
+ * @brief Main function for the ROHC scaling test program
+ *
+ * @param argc The number of program arguments
+ * @param argv The program arguments
+ * @return     The unix return code: 0 in case of success, 1 in case of error
+ */
+int main(int argc, char *argv[])
+{
+	int max_contexts = ROHC_SMALL_CID_MAX + 1;
+	char *cid_type_name = NULL;
+	int wlsb_width = 4;
+	char *filename = NULL; /* the name of the PCAP capture used as input */
+	long threads_max = 0;
+	bool is_threads_max_set = false;
+	long repeat = SCALING_REPEAT_DEFAULT;
+	bool pin_threads = true;
+	struct scaling_packet *packets;
+	size_t packets_nr;
+	long *cpus = NULL;
+	size_t cpus_nr = 0;
+	rohc_cid_type_t cid_type;
+	double mpps_1 = 0.0;
+	int status = 1;
+	long threads_nr;
+
+	/* set to normal mode by default */
+	verbosity = VERBOSITY_NORMAL;
+
+	/* parse program arguments, print the help message in case of failure */
+	if(argc <= 1)
+	{
+		usage();
+		goto error;
+	}
+
+	for(argc--, argv++; argc > 0; argc--, argv++)
+	{
+		if(!strcmp(*argv, "-v") || !strcmp(*argv, "--version"))
+		{
+			/* print version */
+			printf("rohc_test_scaling version %s\n", rohc_version());
+			goto error;
+		}
+		else if(!strcmp(*argv, "-h") || !strcmp(*argv, "--help"))
+		{
+			/* print help */
+			usage();
+			goto error;
+		}
+		else if(!strcmp(*argv, "--verbose"))
+		{
+			/* enable verbose mode */
+			verbosity = VERBOSITY_FULL;
+		}
+		else if(!strcmp(*argv, "--quiet"))
+		{
+			/* enable quiet mode */
+			verbosity = VERBOSITY_NONE;
+		}
+		else if(!strcmp(*argv, "--max-contexts"))
+		{
+			/* get the maximum number of contexts the test should use */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "missing mandatory --max-contexts parameter\n");
+				usage();
+				goto error;
+			}
+			max_contexts = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--wlsb-width"))
+		{
+			/* get the width of the WLSB window the test should use */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "missing mandatory --wlsb-width parameter\n");
+				usage();
+				goto error;
+			}
+			wlsb_width = atoi(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--threads"))
+		{
+			/* get the maximum number of threads the test should use */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "missing mandatory --threads parameter\n");
+				usage();
+				goto error;
+			}
+			threads_max = atol(argv[1]);
+			is_threads_max_set = true;
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--repeat"))
+		{
+			/* get the number of passes every thread does over its shard */
+			if(argc <= 1)
+			{
+				fprintf(stderr, "missing mandatory --repeat parameter\n");
+				usage();
+				goto error;
+			}
+			repeat = atol(argv[1]);
+			argv++;
+			argc--;
+		}
+		else if(!strcmp(*argv, "--no-pin"))
+		{
+			/* let the system schedule threads on any CPU */
+			pin_threads = false;
+		}
+		else if(cid_type_name == NULL)
+		{
+			/* get the type of CID to use within the ROHC library */
+			cid_type_name = argv[0];
+		}
+		else if(filename == NULL)
+		{
+			/* get the name of the file that contains the IP packets
+			   to compress */
+			filename = argv[0];
+		}
+		else
+		{
+			/* do not accept more than one filename without option name */
+			usage();
+			goto error;
+		}
+	}
+
+	/* the CID type and source filename are mandatory */
+	if(cid_type_name == NULL || filename == NULL)
+	{
+		usage();
+		goto error;
+	}
+
+	/* check WLSB width */
+	if(wlsb_width <= 0 || (wlsb_width & (wlsb_width - 1)) != 0)
+	{
+		fprintf(stderr, "invalid WLSB width %d: should be a positive power of "
+		        "two\n", wlsb_width);
+		goto error;
+	}
+
+	/* the CPUs the threads may run on are the ones the program is allowed to
+	 * run on, not all the online CPUs of the system */
+	if(get_usable_cpus(&cpus, &cpus_nr) != 0)
+	{
+		goto error;
+	}
+
+	/* check scaling options */
+	if(!is_threads_max_set)
+	{
+		threads_max = cpus_nr;
+	}
+	if(threads_max <= 0)
+	{
+		fprintf(stderr, "invalid number of threads %ld: should be strictly "
+		        "positive\n", threads_max);
+		goto error;
+	}
+	if(repeat <= 0)
+	{
+		fprintf(stderr, "invalid number of passes %ld: should be strictly "
+		        "positive\n", repeat);
+		goto error;
+	}
+	if((size_t) threads_max > cpus_nr)
+	{
+		fprintf(stderr, "warning: up to %ld threads requested, but only %zu CPUs "
+		        "are usable: some threads will share a CPU and the scaling "
+		        "efficiency will drop\n", threads_max, cpus_nr);
+	}
+
+	/* check CID type */
+	if(!strcmp(cid_type_name, "smallcid"))
+	{
+		cid_type = ROHC_SMALL_CID;
+
+		/* the maximum number of ROHC contexts should be valid */
+		if(max_contexts < 1 || (size_t) max_contexts > (ROHC_SMALL_CID_MAX + 1))
+		{
+			fprintf(stderr, "the maximum number of ROHC contexts should be "
+			        "between 1 and %u\n\n", ROHC_SMALL_CID_MAX + 1);
+			usage();
+			goto error;
+		}
+	}
+	else if(!strcmp(cid_type_name, "largecid"))
+	{
+		cid_type = ROHC_LARGE_CID;
+
+		/* the maximum number of ROHC contexts should be valid */
+		if(max_contexts < 1 || (size_t) max_contexts > (ROHC_LARGE_CID_MAX + 1))
+		{
+			fprintf(stderr, "the maximum number of ROHC contexts should be "
+			        "between 1 and %u\n\n", ROHC_LARGE_CID_MAX + 1);
+			usage();
+			goto error;
+		}
+	}
+	else
+	{
+		fprintf(stderr, "invalid CID type '%s', only 'smallcid' and 'largecid' "
+		        "expected\n", cid_type_name);
+		usage();
+		goto error;
+	}
+
+	/* load the whole capture, so that neither the disk nor libpcap are timed */
+	if(load_capture(filename, &packets, &packets_nr) != 0)
+	{
+		goto error;
+	}
+	if(packets_nr == 0)
+	{
+		fprintf(stderr, "the capture contains no packet\n");
+		goto free_packets;
+	}
+
+	if(verbosity != VERBOSITY_NONE)
+	{
+		printf("%7s %10s %10s %9s %12s %10s %8s\n", "threads", "packets",
+		       "time (ms)", "Mpps", "Mpps/thread", "efficiency", "balance");
+	}
+
+	/* run one test for every number of threads from 1 to N */
+	for(threads_nr = 1; threads_nr <= threads_max; threads_nr++)
+	{
+		if(test_scaling(packets, packets_nr, cid_type, wlsb_width, max_contexts,
+		                threads_nr, repeat, (pin_threads ? cpus : NULL), cpus_nr,
+		                &mpps_1) != 0)
+		{
+			fprintf(stderr, "scaling test with %ld threads failed, see above "
+			        "error(s)\n", threads_nr);
+			goto free_packets;
+		}
+	}
+
+	/* everything went fine */
+	status = 0;
+
+free_packets:
+	free_capture(packets, packets_nr);
+error:
+	free(cpus);
+	return status;
+}
+
+
+/**
+ * @brief Print usage of the scaling test application
+ */
+static void usage(void)
+{
+	printf(
+		"Test how the ROHC library scales with the number of CPU cores.\n"
+		"\n"
+		"Usage: rohc_test_scaling [General options]\n"
+		"   or: rohc_test_scaling [ROHC options] [Scaling options] CID_TYPE FLOW\n"
+		"\n"
+		"Options:\n"
+		"Mandatory parameters:\n"
+		"  CID_TYPE          Run a small CID test with 'smallcid' or a\n"
+		"                    large CID test with 'largecid'\n"
+		"  FLOW              A flow of Ethernet frames to compress and\n"
+		"                    decompress (in PCAP format)\n"
+		"General options:\n"
+		"  -h, --help              Print application usage and exit\n"
+		"  -v, --version           Print version information and exit\n"
+		"ROHC options:\n"
+		"      --verbose           Tell the application to be more verbose\n"
+		"      --quiet             Tell the application to be even less verbose\n"
+		"      --wlsb-width NUM    The width of the WLSB window to use\n"
+		"      --max-contexts NUM  The maximum number of ROHC contexts every\n"
+		"                          thread should simultaneously use\n"
+		"Scaling options:\n"
+		"      --threads NUM       Run the tests from 1 to NUM threads\n"
+		"                          (default: the number of CPUs the program\n"
+		"                          is allowed to run on)\n"
+		"      --repeat NUM        The number of times every thread handles\n"
+		"                          its share of the flow (default: %u)\n"
+		"      --no-pin            Do not pin every thread on its own CPU\n"
+		"\n"
+		"Examples:\n"
+		"  rohc_test_scaling smallcid voip.pcap             test scaling from 1 to all CPUs with small CIDs\n"
+		"  rohc_test_scaling --threads 4 largecid a.pcap    test scaling from 1 to 4 threads with large CIDs\n"
+		"\n"
+		"Report bugs to <" PACKAGE_BUGREPORT ">.\n", SCALING_REPEAT_DEFAULT);
+}
+
+
+/**
+ * @brief Load the IP packets of the whole PCAP capture in memory
+ *
+ * The link layer and the Ethernet padding of every packet are removed. The
+ * flow hash of every packet is computed.
+ *
+ * @param filename    The name of the PCAP file to load
+ * @param packets     OUT: The packets of the capture, to free with
+ *                    \ref free_capture
+ * @param packets_nr  OUT: The number of packets in the capture
+ * @return            0 in case of success, 1 otherwise
+ */
+static int load_capture(const char *const filename,
+                        struct scaling_packet **const packets,
+                        size_t *const packets_nr)
+{
+	char errbuf[PCAP_ERRBUF_SIZE];
+	size_t packets_max = 0;
+	pcap_t *handle;
+	int link_layer_type;
+	size_t link_len;
+	struct pcap_pkthdr header;
+	unsigned char *packet;
+
+	*packets = NULL;
+	*packets_nr = 0;
+
+	/* open the PCAP file that contains the stream */
+	handle = pcap_open_offline(filename, errbuf);
+	if(handle == NULL)
+	{
+		fprintf(stderr, "failed to open the pcap file: %s\n", errbuf);
+		goto error;
+	}
+
+	/* link layer in the capture must be Ethernet */
+	link_layer_type = pcap_datalink(handle);
+	if(link_layer_type == DLT_EN10MB)
+	{
+		link_len = ETHER_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_LINUX_SLL)
+	{
+		link_len = LINUX_COOKED_HDR_LEN;
+	}
+	else if(link_layer_type == DLT_RAW)
+	{
+		link_len = 0;
+	}
+	else
+	{
+		fprintf(stderr, "link layer type %d not supported in capture "
+		        "(supported = %d, %d, %d)\n", link_layer_type,
+		        DLT_EN10MB, DLT_LINUX_SLL, DLT_RAW);
+		goto close_input;
+	}
+
+	/* copy every IP packet of the capture */
+	while((packet = (unsigned char *) pcap_next(handle, &header)) != NULL)
+	{
+		const unsigned long num_packet = (*packets_nr) + 1;
+		const uint8_t *ip_data;
+		size_t ip_len;
+
+		/* check Ethernet frame length */
+		if(header.len <= link_len || header.len != header.caplen)
+		{
+			fprintf(stderr, "packet %lu: bad PCAP packet (len = %u, caplen = %u)\n",
+			        num_packet, header.len, header.caplen);
+			goto free_packets;
+		}
+		ip_data = packet + link_len;
+		ip_len = header.len - link_len;
+
+		/* remove Ethernet padding if any */
+		if(link_len == ETHER_HDR_LEN && header.len == ETHER_FRAME_MIN_LEN)
+		{
+			const uint8_t ip_version = (ip_data[0] >> 4) & 0x0f;
+			size_t tot_len = ip_len;
+
+			if(ip_version == 4 && ip_len >= sizeof(struct ipv4_hdr))
+			{
+				const struct ipv4_hdr *const ip = (struct ipv4_hdr *) ip_data;
+				tot_len = ntohs(ip->tot_len);
+			}
+			else if(ip_version == 6 && ip_len >= sizeof(struct ipv6_hdr))
+			{
+				const struct ipv6_hdr *const ip = (struct ipv6_hdr *) ip_data;
+				tot_len = sizeof(struct ipv6_hdr) + ntohs(ip->plen);
+			}
+			if(tot_len < ip_len)
+			{
+				ip_len = tot_len;
+			}
+		}
+
+		/* enlarge the table of packets if needed */
+		if((*packets_nr) == packets_max)
+		{
+			struct scaling_packet *new_packets;
+
+			packets_max = (packets_max == 0 ? 1024 : packets_max * 2);
+			new_packets = realloc(*packets, packets_max * sizeof(struct scaling_packet));
+			if(new_packets == NULL)
+			{
+				fprintf(stderr, "failed to allocate memory for %zu packets\n",
+				        packets_max);
+				goto free_packets;
+			}
+			*packets = new_packets;
+		}
+
+		(*packets)[*packets_nr].data = malloc(ip_len);
+		if((*packets)[*packets_nr].data == NULL)
+		{
+			fprintf(stderr, "packet %lu: failed to allocate memory\n", num_packet);
+			goto free_packets;
+		}
+		memcpy((*packets)[*packets_nr].data, ip_data, ip_len);
+		(*packets)[*packets_nr].len = ip_len;
+		(*packets)[*packets_nr].hash = compute_flow_hash(ip_data, ip_len);
+		(*packets_nr)++;
+	}
+
+	pcap_close(handle);
+	return 0;
+
+free_packets:
+	free_capture(*packets, *packets_nr);
+	*packets = NULL;
+	*packets_nr = 0;
+close_input:
+	pcap_close(handle);
+error:
+	return 1;
+}
+
+
+/**
+ * @brief Free the packets loaded in memory by \ref load_capture
+ *
+ * @param packets     The packets to free
+ * @param packets_nr  The number of packets to free
+ */
+static void free_capture(struct scaling_packet *const packets,
+                         const size_t packets_nr)
+{
+	size_t i;
+
+	for(i = 0; i < packets_nr; i++)
+	{
+		free(packets[i].data);
+	}
+	free(packets);
+}
+
+
+/**
+ * @brief Compute the hash of the flow the given IP packet belongs to
+ *
+ * The hash covers the IP addresses, the IP protocol and the UDP, UDP-Lite
+ * or TCP ports of the outer IP header, so that all the packets that share
+ * one ROHC context share the same hash. The FNV-1a function is used.
+ *
+ * @param data  The IP packet
+ * @param len   The length (in bytes) of the IP packet
+ * @return      The hash of the flow, 0 if the packet is not IP
+ */
+static uint32_t compute_flow_hash(const uint8_t *const data,
+                                  const size_t len)
+{
+	const uint8_t *addrs;
+	size_t addrs_len;
+	uint8_t proto;
+	size_t l4_offset;
+	bool has_ports;
+	uint32_t hash = 2166136261U;
+	size_t i;
+
+	if(len < 1)
+	{
+		return 0;
+	}
+
+	if(((data[0] >> 4) & 0x0f) == 4 && len >= sizeof(struct ipv4_hdr))
+	{
+		const struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) data;
+
+		addrs = data + 12;
+		addrs_len = 8;
+		proto = ipv4->protocol;
+		l4_offset = ipv4->ihl * 4;
+		/* only the first fragment contains the transport header */
+		has_ports = ((ntohs(ipv4->frag_off) & 0x1fff) == 0);
+	}
+	else if(((data[0] >> 4) & 0x0f) == 6 && len >= sizeof(struct ipv6_hdr))
+	{
+		const struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) data;
+
+		addrs = data + 8;
+		addrs_len = 32;
+		proto = ipv6->nh;
+		l4_offset = sizeof(struct ipv6_hdr);
+		has_ports = true;
+	}
+	else
+	{
+		return 0;
+	}
+
+	for(i = 0; i < addrs_len; i++)
+	{
+		hash = (hash ^ addrs[i]) * 16777619U;
+	}
+	hash = (hash ^ proto) * 16777619U;
+
+	if(has_ports &&
+	   (proto == ROHC_IPPROTO_UDP || proto == ROHC_IPPROTO_UDPLITE ||
+	    proto == ROHC_IPPROTO_TCP) &&
+	   len >= (l4_offset + 4))
+	{
+		for(i = 0; i < 4; i++)
+		{
+			hash = (hash ^ data[l4_offset + i]) * 16777619U;
+		}
+	}
+
+	return hash;
+}
+
+
+/**
+ * @brief Get the list of the CPUs the program is allowed to run on
+ *
+ * The affinity mask of the program may exclude some online CPUs (taskset,
+ * cgroups, containers...), and the usable CPUs may not be numbered from 0.
+ * The list is the full range of online CPUs on platforms without affinity
+ * support, since the threads are not pinned there.
+ *
+ * @param cpus     OUT: The usable CPUs, to free with free()
+ * @param cpus_nr  OUT: The number of usable CPUs
+ * @return         0 in case of success, 1 otherwise
+ */
+static int get_usable_cpus(long **const cpus, size_t *const cpus_nr)
+{
+#ifdef __linux__
+	cpu_set_t cpu_set;
+	size_t cpus_max;
+	long cpu;
+
+	CPU_ZERO(&cpu_set);
+	if(sched_getaffinity(0, sizeof(cpu_set_t), &cpu_set) != 0)
+	{
+		fprintf(stderr, "failed to get the CPU affinity of the program\n");
+		goto error;
+	}
+	cpus_max = CPU_COUNT(&cpu_set);
+#else
+	const long online_nr = sysconf(_SC_NPROCESSORS_ONLN);
+	const size_t cpus_max = (online_nr > 0 ? online_nr : 1);
+	long cpu;
+#endif
+	if(cpus_max == 0)
+	{
+		fprintf(stderr, "no usable CPU found\n");
+		goto error;
+	}
+
+	*cpus = malloc(cpus_max * sizeof(long));
+	if((*cpus) == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %zu CPUs\n", cpus_max);
+		goto error;
+	}
+	*cpus_nr = 0;
+	for(cpu = 0; (*cpus_nr) < cpus_max; cpu++)
+	{
+#ifdef __linux__
+		if(!CPU_ISSET(cpu, &cpu_set))
+		{
+			continue;
+		}
+#endif
+		(*cpus)[*cpus_nr] = cpu;
+		(*cpus_nr)++;
+	}
+
+	return 0;
+
+error:
+	return 1;
+}
+
+
+/**
+ * @brief Run one scaling test with the given number of threads
+ *
+ * @param packets       The IP packets of the capture
+ * @param packets_nr    The number of IP packets in the capture
+ * @param cid_type      The type of CIDs the (de)compressors shall use
+ * @param wlsb_width    The width of the WLSB window to use
+ * @param max_contexts  The maximum number of ROHC contexts per thread
+ * @param threads_nr    The number of threads to run
+ * @param repeat        The number of passes every thread does over its shard
+ * @param cpus          The CPUs to pin the threads on, NULL not to pin them
+ * @param cpus_nr       The number of CPUs in \e cpus
+ * @param mpps_1        IN: The throughput with one thread, if threads_nr > 1
+ *                      OUT: The throughput with one thread, if threads_nr = 1
+ * @return              0 in case of success, 1 otherwise
+ */
+static int test_scaling(const struct scaling_packet *const packets,
+                        const size_t packets_nr,
+                        const rohc_cid_type_t cid_type,
+                        const size_t wlsb_width,
+                        const size_t max_contexts,
+                        const size_t threads_nr,
+                        const unsigned long repeat,
+                        const long *const cpus,
+                        const size_t cpus_nr,
+                        double *const mpps_1)
+{
+	struct scaling_gate gate;
+	struct scaling_worker *workers;
+	size_t workers_nr;
+	uint64_t start_ns = UINT64_MAX;
+	uint64_t end_ns = 0;
+	unsigned long done_nr = 0;
+	size_t shard_max = 0;
+	double mpps;
+	int is_failure = 1;
+	size_t i;
+
+	assert(threads_nr > 0);
+
+	workers = calloc(threads_nr, sizeof(struct scaling_worker));
+	if(workers == NULL)
+	{
+		fprintf(stderr, "failed to allocate memory for %zu threads\n", threads_nr);
+		goto error;
+	}
+
+	/* shard the flows among the threads */
+	for(i = 0; i < packets_nr; i++)
+	{
+		workers[packets[i].hash % threads_nr].packets_nr++;
+	}
+	for(i = 0; i < threads_nr; i++)
+	{
+		workers[i].packets =
+			malloc((workers[i].packets_nr + 1) * sizeof(struct scaling_packet *));
+		if(workers[i].packets == NULL)
+		{
+			fprintf(stderr, "failed to allocate memory for the shard of thread "
+			        "#%zu\n", i + 1);
+			goto free_shards;
+		}
+		if(workers[i].packets_nr > shard_max)
+		{
+			shard_max = workers[i].packets_nr;
+		}
+		workers[i].packets_nr = 0;
+	}
+	for(i = 0; i < packets_nr; i++)
+	{
+		struct scaling_worker *const worker = &workers[packets[i].hash % threads_nr];
+		worker->packets[worker->packets_nr] = &packets[i];
+		worker->packets_nr++;
+	}
+
+	/* start all threads, they wait for the gate to open */
+	if(pthread_mutex_init(&gate.mutex, NULL) != 0)
+	{
+		fprintf(stderr, "failed to initialize the start mutex\n");
+		goto free_shards;
+	}
+	if(pthread_cond_init(&gate.cond, NULL) != 0)
+	{
+		fprintf(stderr, "failed to initialize the start condition\n");
+		goto destroy_mutex;
+	}
+	gate.ready_nr = 0;
+	gate.is_open = false;
+	for(workers_nr = 0; workers_nr < threads_nr; workers_nr++)
+	{
+		struct scaling_worker *const worker = &workers[workers_nr];
+
+		worker->id = workers_nr;
+		worker->cpu = (cpus != NULL ? cpus[workers_nr % cpus_nr] : -1);
+		worker->gate = &gate;
+		worker->cid_type = cid_type;
+		worker->wlsb_width = wlsb_width;
+		worker->max_contexts = max_contexts;
+		worker->repeat = repeat;
+		worker->status = SCALING_SETUP_FAILED;
+		if(pthread_create(&worker->thread, NULL, scaling_worker_run, worker) != 0)
+		{
+			fprintf(stderr, "failed to create thread #%zu\n", workers_nr + 1);
+			break;
+		}
+	}
+
+	/* release the threads together once they are all ready */
+	pthread_mutex_lock(&gate.mutex);
+	while(gate.ready_nr < workers_nr)
+	{
+		pthread_cond_wait(&gate.cond, &gate.mutex);
+	}
+	gate.is_open = true;
+	pthread_cond_broadcast(&gate.cond);
+	pthread_mutex_unlock(&gate.mutex);
+
+	/* wait for all threads to end */
+	for(i = 0; i < workers_nr; i++)
+	{
+		pthread_join(workers[i].thread, NULL);
+	}
+	if(workers_nr < threads_nr)
+	{
+		goto destroy_cond;
+	}
+
+	/* collect the results of all threads */
+	for(i = 0; i < threads_nr; i++)
+	{
+		switch(workers[i].status)
+		{
+			case SCALING_OK:
+				break;
+			case SCALING_PIN_FAILED:
+				fprintf(stderr, "thread #%zu failed to pin itself on CPU %ld\n",
+				        i + 1, workers[i].cpu);
+				goto destroy_cond;
+			case SCALING_SETUP_FAILED:
+				fprintf(stderr, "thread #%zu failed to create its compressor, "
+				        "decompressor or buffers\n", i + 1);
+				goto destroy_cond;
+			case SCALING_PACKETS_FAILED:
+			default:
+				fprintf(stderr, "thread #%zu failed to round-trip %lu packets\n",
+				        i + 1, workers[i].errors_nr);
+				goto destroy_cond;
+		}
+		if(workers[i].start_ns < start_ns)
+		{
+			start_ns = workers[i].start_ns;
+		}
+		if(workers[i].end_ns > end_ns)
+		{
+			end_ns = workers[i].end_ns;
+		}
+		done_nr += workers[i].done_nr;
+	}
+	if(end_ns <= start_ns)
+	{
+		end_ns = start_ns + 1;
+	}
+
+	/* report throughput and scaling efficiency */
+	mpps = ((double) done_nr) * 1000.0 / ((double) (end_ns - start_ns));
+	if(threads_nr == 1)
+	{
+		*mpps_1 = mpps;
+	}
+	if(verbosity != VERBOSITY_NONE)
+	{
+		printf("%7zu %10lu %10.3f %9.3f %12.3f %9.1f%% %7.1f%%\n", threads_nr,
+		       done_nr, ((double) (end_ns - start_ns)) / 1e6, mpps,
+		       mpps / threads_nr, mpps * 100.0 / (threads_nr * (*mpps_1)),
+		       ((double) packets_nr) * 100.0 / (threads_nr * shard_max));
+	}
+	if(verbosity == VERBOSITY_FULL)
+	{
+		for(i = 0; i < threads_nr; i++)
+		{
+			const uint64_t elapsed = workers[i].end_ns - workers[i].start_ns;
+
+			printf("%7s thread #%zu on CPU %ld: %lu packets in %.3f ms, "
+			       "%.3f Mpps\n", "", i + 1, workers[i].cpu, workers[i].done_nr,
+			       ((double) elapsed) / 1e6,
+			       ((double) workers[i].done_nr) * 1000.0 /
+			       ((double) (elapsed > 0 ? elapsed : 1)));
+		}
+	}
+
+	/* everything went fine */
+	is_failure = 0;
+
+destroy_cond:
+	pthread_cond_destroy(&gate.cond);
+destroy_mutex:
+	pthread_mutex_destroy(&gate.mutex);
+free_shards:
+	for(i = 0; i < threads_nr; i++)
+	{
+		free(workers[i].packets);
+	}
+	free(workers);
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Round-trip the packets of one shard through one thread
+ *
+ * The thread creates its own compressor and decompressor, waits for all the
+ * threads of the test to be ready, then compresses and decompresses every
+ * packet of its shard, and checks the decompressed packet.
+ *
+ * @param arg  The thread, a pointer to \ref scaling_worker
+ * @return     Always NULL, the results are written in the thread structure
+ */
+static void * scaling_worker_run(void *const arg)
+{
+	struct scaling_worker *const worker = (struct scaling_worker *) arg;
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_comp *comp = NULL;
+	struct rohc_decomp *decomp = NULL;
+	uint8_t *rohc_buffer = NULL;
+	uint8_t *ip_buffer = NULL;
+	unsigned long done_nr = 0;
+	unsigned long errors_nr = 0;
+	uint64_t start_ns;
+	uint64_t end_ns;
+	unsigned long pass;
+	size_t i;
+
+	/* pin the thread, then allocate all memory from the pinned CPU */
+	if(worker->cpu >= 0 && pin_thread(worker->cpu) != 0)
+	{
+		worker->status = SCALING_PIN_FAILED;
+		goto ready;
+	}
+	rohc_buffer = malloc(MAX_ROHC_SIZE);
+	ip_buffer = malloc(MAX_ROHC_SIZE);
+	if(rohc_buffer == NULL || ip_buffer == NULL)
+	{
+		fprintf(stderr, "thread #%zu: failed to allocate memory for buffers\n",
+		        worker->id + 1);
+		goto ready;
+	}
+	comp = create_compressor(worker->cid_type, worker->wlsb_width,
+	                         worker->max_contexts);
+	if(comp == NULL)
+	{
+		goto ready;
+	}
+	decomp = create_decompressor(worker->cid_type, worker->max_contexts);
+	if(decomp == NULL)
+	{
+		goto ready;
+	}
+
+ready:
+	/* tell the main thread that the thread is ready, wait for the others */
+	pthread_mutex_lock(&worker->gate->mutex);
+	worker->gate->ready_nr++;
+	pthread_cond_broadcast(&worker->gate->cond);
+	while(!worker->gate->is_open)
+	{
+		pthread_cond_wait(&worker->gate->cond, &worker->gate->mutex);
+	}
+	pthread_mutex_unlock(&worker->gate->mutex);
+	if(decomp == NULL)
+	{
+		/* the reason of the failure was recorded in the thread status */
+		goto error;
+	}
+
+	/* round-trip every packet of the shard */
+	start_ns = scaling_now_ns();
+	for(pass = 0; pass < worker->repeat; pass++)
+	{
+		for(i = 0; i < worker->packets_nr; i++)
+		{
+			const struct scaling_packet *const packet = worker->packets[i];
+			const struct rohc_buf ip_packet =
+				rohc_buf_init_full(packet->data, packet->len, arrival_time);
+			struct rohc_buf rohc_packet =
+				rohc_buf_init_empty(rohc_buffer, MAX_ROHC_SIZE);
+			struct rohc_buf decomp_packet =
+				rohc_buf_init_empty(ip_buffer, MAX_ROHC_SIZE);
+
+			if(rohc_compress4(comp, ip_packet, &rohc_packet) != ROHC_STATUS_OK ||
+			   rohc_decompress3(decomp, rohc_packet, &decomp_packet,
+			                    NULL, NULL) != ROHC_STATUS_OK ||
+			   decomp_packet.len != packet->len ||
+			   memcmp(rohc_buf_data(decomp_packet), packet->data, packet->len) != 0)
+			{
+				errors_nr++;
+				continue;
+			}
+			done_nr++;
+		}
+	}
+	end_ns = scaling_now_ns();
+
+	/* publish the results */
+	worker->start_ns = start_ns;
+	worker->end_ns = end_ns;
+	worker->done_nr = done_nr;
+	worker->errors_nr = errors_nr;
+	worker->status = (errors_nr == 0 ? SCALING_OK : SCALING_PACKETS_FAILED);
+
+error:
+	rohc_decomp_free(decomp);
+	rohc_comp_free(comp);
+	free(ip_buffer);
+	free(rohc_buffer);
+	return NULL;
+}
+
+
+/**
+ * @brief Pin the calling thread on the given CPU
+ *
+ * Pinning is only supported on Linux, the thread is left to the system
+ * scheduler on other platforms.
+ *
+ * @param cpu  The CPU to pin the thread on
+ * @return     0 in case of success, 1 otherwise
+ */
+static int pin_thread(const long cpu)
+{
+#ifdef __linux__
+	cpu_set_t cpu_set;
+
+	CPU_ZERO(&cpu_set);
+	CPU_SET(cpu, &cpu_set);
+	if(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set) != 0)
+	{
+		return 1;
+	}
+#else
+	(void) cpu;
+#endif
+
+	return 0;
+}
+
+
+/**
+ * @brief Create the ROHC compressor of one thread
+ *
+ * @param cid_type      The type of CIDs the compressor shall use
+ * @param wlsb_width    The width of the WLSB window to use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @return              The new compressor, NULL in case of error
+ */
+static struct rohc_comp * create_compressor(const rohc_cid_type_t cid_type,
+                                            const size_t wlsb_width,
+                                            const size_t max_contexts)
+{
+	struct rohc_comp *comp;
+
+	/* create ROHC compressor */
+	comp = rohc_comp_new2(cid_type, max_contexts - 1, gen_false_random_num, NULL);
+	if(comp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC compressor\n");
+		goto error;
+	}
+
+	/* activate all the compression profiles */
+	if(!rohc_comp_enable_profiles(comp, ROHC_PROFILE_UNCOMPRESSED,
+	                              ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                              ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                              ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the compression profiles\n");
+		goto free_compresssor;
+	}
+
+	/* set the WLSB window width on compressor */
+	if(!rohc_comp_set_wlsb_window_width(comp, wlsb_width))
+	{
+		fprintf(stderr, "failed to set the WLSB window width on compressor\n");
+		goto free_compresssor;
+	}
+
+	/* set UDP ports dedicated to RTP traffic */
+	if(!rohc_comp_set_rtp_detection_cb(comp, rohc_comp_rtp_cb, NULL))
+	{
+		fprintf(stderr, "failed to set the RTP detection callback on compressor\n");
+		goto free_compresssor;
+	}
+
+	return comp;
+
+free_compresssor:
+	rohc_comp_free(comp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Create the ROHC decompressor of one thread
+ *
+ * @param cid_type      The type of CIDs the decompressor shall use
+ * @param max_contexts  The maximum number of ROHC contexts to use
+ * @return              The new decompressor, NULL in case of error
+ */
+static struct rohc_decomp * create_decompressor(const rohc_cid_type_t cid_type,
+                                                const size_t max_contexts)
+{
+	struct rohc_decomp *decomp;
+
+	/* create ROHC decompressor */
+	decomp = rohc_decomp_new2(cid_type, max_contexts - 1, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "cannot create the ROHC decompressor\n");
+		goto error;
+	}
+
+	/* activate all the decompression profiles */
+	if(!rohc_decomp_enable_profiles(decomp, ROHC_PROFILE_UNCOMPRESSED,
+	                                ROHC_PROFILE_RTP, ROHC_PROFILE_UDP,
+	                                ROHC_PROFILE_IP, ROHC_PROFILE_UDPLITE,
+	                                ROHC_PROFILE_ESP, ROHC_PROFILE_TCP, -1))
+	{
+		fprintf(stderr, "failed to enable the decompression profiles\n");
+		goto free_decompressor;
+	}
+
+	return decomp;
+
+free_decompressor:
+	rohc_decomp_free(decomp);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Get the current time of the monotonic clock
+ *
+ * @return  The current time (in nanoseconds)
+ */
+static uint64_t scaling_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t) now.tv_sec) * 1000000000U + now.tv_nsec;
+}
+
+
+/**
+ * @brief Generate a false random number for testing the ROHC library
+ *
+ * We want to test the performances of the ROHC library, not the performances
+ * of a random generator, so disable it.
+ *
+ * @param comp          The ROHC compressor
+ * @param user_context  Should always be NULL
+ * @return              Always 0
+ */
+static int gen_false_random_num(const struct rohc_comp *const comp,
+                                void *const user_context)
+{
+	assert(comp != NULL);
+	assert(user_context == NULL);
+	return 0;
+}
+
+
+/**
+ * @brief The RTP detection callback
+ *
+ * @param ip           The innermost IP packet
+ * @param udp          The UDP header of the packet
+ * @param payload      The UDP payload of the packet
+ * @param payload_size The size of the UDP payload (in bytes)
+ * @return             true if the packet is an RTP packet, false otherwise
+ */
+static bool rohc_comp_rtp_cb(const unsigned char *const ip __attribute__((unused)),
+                             const unsigned char *const udp,
+                             const unsigned char *const payload __attribute__((unused)),
+                             const unsigned int payload_size __attribute__((unused)),
+                             void *const rtp_private __attribute__((unused)))
+{
+	const size_t default_rtp_ports_nr = 5;
+	unsigned int default_rtp_ports[] = { 1234, 36780, 33238, 5020, 5002 };
+	uint16_t udp_dport;
+	bool is_rtp = false;
+	size_t i;
+
+	if(udp == NULL)
+	{
+		return false;
+	}
+
+	/* get the UDP destination port */
+	memcpy(&udp_dport, udp + 2, sizeof(uint16_t));
+
+	/* is the UDP destination port in the list of ports reserved for RTP
+	 * traffic by default (for compatibility reasons) */
+	for(i = 0; i < default_rtp_ports_nr; i++)
+	{
+		if(ntohs(udp_dport) == default_rtp_ports[i])
+		{
+			is_rtp = true;
+			break;
+		}
+	}
+
+	return is_rtp;
+}
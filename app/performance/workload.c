@@ -0,0 +1,1086 @@
+/*
+ * Copyright 2017 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   workload.c
+ * @brief  Generate synthetic traffic with many concurrent flows
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "workload.h"
+
+#include "config.h" /* for HAVE_*_H */
+
+/* system includes */
+#if HAVE_WINSOCK2_H == 1
+#  include <winsock2.h> /* for htons() on Windows */
+#endif
+#if HAVE_ARPA_INET_H == 1
+#  include <arpa/inet.h> /* for htons() on Linux */
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+/* includes for network headers */
+#include <ip.h> /* for IPv4 checksum */
+#include <protocols/ip_numbers.h>
+#include <protocols/ipv4.h>
+#include <protocols/ipv6.h>
+#include <protocols/udp.h>
+#include <protocols/rtp.h>
+#include <protocols/tcp.h>
+#include <protocols/esp.h>
+
+
+/** The UDP port of RTP flows, the one the ROHC tools detect as RTP */
+#define WORKLOAD_RTP_PORT  1234U
+
+/** The length (in bytes) of one IPv6 extension header with padding only */
+#define WORKLOAD_IPV6_EXT_LEN  8U
+
+/** The length (in bytes) of the TCP options of SYN segments */
+#define WORKLOAD_TCP_SYN_OPTS_LEN  20U
+
+/** The length (in bytes) of the TCP Timestamp option with its padding */
+#define WORKLOAD_TCP_TS_OPTS_LEN  12U
+
+/** The length (in bytes) of one TCP SACK option with its padding */
+#define WORKLOAD_TCP_SACK_OPTS_LEN  12U
+
+
+/** One flow of the workload */
+struct workload_flow
+{
+	workload_proto_t proto;  /**< The protocol of the flow */
+	bool is_ipv6;            /**< Whether the flow uses IPv6 or IPv4 */
+	bool has_ipv6_exts;      /**< Whether the IPv6 flow has extension headers */
+	uint8_t saddr[16];       /**< The source address (4 bytes for IPv4) */
+	uint8_t daddr[16];       /**< The destination address (4 bytes for IPv4) */
+	uint16_t ip_id;          /**< The next IPv4 Identification */
+	uint16_t sport;          /**< The UDP/TCP source port */
+	uint16_t dport;          /**< The UDP/TCP destination port */
+	uint32_t spi;            /**< The ESP SPI or the RTP SSRC */
+	uint32_t sn;             /**< The ESP/RTP/TCP sequence number */
+	uint32_t ack;            /**< The TCP acknowledgment number */
+	uint32_t ts;             /**< The RTP timestamp or TCP timestamp echo */
+	uint16_t window;         /**< The TCP window, constant most of the time */
+	size_t payload_len;      /**< The RTP payload length, constant per flow */
+	unsigned long packets_nr;  /**< The number of packets sent in the flow */
+};
+
+
+/** A packet held by the workload to be delivered late */
+struct workload_held
+{
+	size_t delay;                   /**< The packets still to deliver before */
+	struct workload_packet packet;  /**< The late packet */
+};
+
+
+/** The workload engine */
+struct workload
+{
+	struct workload_config config;  /**< The configuration of the workload */
+	uint64_t rng;                   /**< The state of the random generator */
+	uint64_t now_ns;                /**< The arrival time of the last packet */
+	struct workload_flow *flows;    /**< The pool of concurrent flows */
+	double *popularity;             /**< The Zipf CDF, NULL if uniform */
+	unsigned int mix_total;         /**< The sum of the protocol weights */
+	struct workload_held held[WORKLOAD_REORDER_DEPTH_MAX];  /**< Late packets */
+	size_t held_nr;                 /**< The number of late packets */
+	struct workload_stats stats;    /**< The statistics of the workload */
+};
+
+
+static uint64_t workload_rand(struct workload *const workload)
+	__attribute__((nonnull(1)));
+static double workload_rand_unit(struct workload *const workload)
+	__attribute__((nonnull(1)));
+static bool workload_rand_pct(struct workload *const workload, const double pct)
+	__attribute__((nonnull(1)));
+static void workload_rand_bytes(struct workload *const workload,
+                                uint8_t *const data,
+                                const size_t len)
+	__attribute__((nonnull(1, 2)));
+
+static size_t workload_pick_flow(struct workload *const workload)
+	__attribute__((nonnull(1)));
+static void workload_start_flow(struct workload *const workload,
+                                struct workload_flow *const flow)
+	__attribute__((nonnull(1, 2)));
+static bool workload_build_packet(struct workload *const workload,
+                                  struct workload_flow *const flow,
+                                  const bool is_last,
+                                  struct workload_packet *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+static size_t workload_build_tcp(struct workload *const workload,
+                                 struct workload_flow *const flow,
+                                 const bool is_last,
+                                 uint8_t *const data,
+                                 const size_t max_len)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4)));
+static void workload_put32(uint8_t *const data, const uint32_t value)
+	__attribute__((nonnull(1)));
+static uint16_t workload_l4_csum(const struct workload_flow *const flow,
+                                 const uint8_t protocol,
+                                 const uint8_t *const data,
+                                 const size_t len)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+static uint32_t workload_csum_add(uint32_t sum,
+                                  const uint8_t *const data,
+                                  const size_t len)
+	__attribute__((warn_unused_result, nonnull(2)));
+
+
+/**
+ * @brief Initialize a workload configuration with default values
+ *
+ * @param config  The configuration to initialize
+ */
+void workload_config_init(struct workload_config *const config)
+{
+	memset(config, 0, sizeof(struct workload_config));
+	config->flows_nr = 1000;
+	config->zipf_exponent = 1.0;
+	config->lifetime = 100;
+	config->rate = 100000.0;
+	config->mix[WORKLOAD_PROTO_UDP] = 20;
+	config->mix[WORKLOAD_PROTO_RTP] = 20;
+	config->mix[WORKLOAD_PROTO_TCP] = 50;
+	config->mix[WORKLOAD_PROTO_ESP] = 10;
+	config->ipv6_pct = 20.0;
+	config->ipv6_ext_pct = 50.0;
+	config->loss_pct = 0.0;
+	config->reorder_pct = 0.0;
+	config->reorder_depth = 3;
+	config->tcp_window_change_pct = 1.0;
+	config->seed = 1;
+}
+
+
+/**
+ * @brief Create a new workload
+ *
+ * @param config  The configuration of the workload
+ * @return        The new workload, NULL in case of error
+ */
+struct workload * workload_new(const struct workload_config *const config)
+{
+	struct workload *workload;
+	size_t i;
+
+	/* check the configuration */
+	if(config->flows_nr == 0 ||
+	   config->zipf_exponent < 0.0 ||
+	   config->rate <= 0.0 ||
+	   config->ipv6_pct < 0.0 || config->ipv6_pct > 100.0 ||
+	   config->ipv6_ext_pct < 0.0 || config->ipv6_ext_pct > 100.0 ||
+	   config->loss_pct < 0.0 || config->loss_pct >= 100.0 ||
+	   config->reorder_pct < 0.0 || config->reorder_pct > 100.0 ||
+	   config->reorder_depth == 0 ||
+	   config->reorder_depth > WORKLOAD_REORDER_DEPTH_MAX ||
+	   config->tcp_window_change_pct < 0.0 ||
+	   config->tcp_window_change_pct > 100.0)
+	{
+		goto error;
+	}
+
+	workload = calloc(1, sizeof(struct workload));
+	if(workload == NULL)
+	{
+		goto error;
+	}
+	memcpy(&workload->config, config, sizeof(struct workload_config));
+	workload->rng = config->seed;
+
+	/* at least one protocol is required */
+	for(i = 0; i < WORKLOAD_PROTO_MAX; i++)
+	{
+		workload->mix_total += config->mix[i];
+	}
+	if(workload->mix_total == 0)
+	{
+		goto free_workload;
+	}
+
+	/* the popularity of the flows follows a Zipf law: the flow of rank k is
+	 * picked with a probability proportional to 1 / k^s */
+	if(config->zipf_exponent > 0.0)
+	{
+		double sum = 0.0;
+
+		workload->popularity = malloc(config->flows_nr * sizeof(double));
+		if(workload->popularity == NULL)
+		{
+			goto free_workload;
+		}
+		for(i = 0; i < config->flows_nr; i++)
+		{
+			sum += 1.0 / pow((double) (i + 1), config->zipf_exponent);
+			workload->popularity[i] = sum;
+		}
+		for(i = 0; i < config->flows_nr; i++)
+		{
+			workload->popularity[i] /= sum;
+		}
+	}
+
+	/* start all the concurrent flows */
+	workload->flows = calloc(config->flows_nr, sizeof(struct workload_flow));
+	if(workload->flows == NULL)
+	{
+		goto free_popularity;
+	}
+	for(i = 0; i < config->flows_nr; i++)
+	{
+		workload_start_flow(workload, &workload->flows[i]);
+	}
+
+	return workload;
+
+free_popularity:
+	free(workload->popularity);
+free_workload:
+	free(workload);
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given workload
+ *
+ * @param workload  The workload to destroy, may be NULL
+ */
+void workload_free(struct workload *const workload)
+{
+	if(workload != NULL)
+	{
+		free(workload->flows);
+		free(workload->popularity);
+		free(workload);
+	}
+}
+
+
+/**
+ * @brief Get the next IP packet of the workload
+ *
+ * Lost packets are built, so that the flows skip them, but they are never
+ * returned. Late packets are held until the configured number of packets
+ * overtook them, then they are returned with the arrival time of the last
+ * packet that overtook them. The late packets still held when the caller
+ * stops generating packets are not lost: get them with \ref workload_flush.
+ *
+ * @param workload  The workload
+ * @param packet    OUT: The next IP packet
+ * @return          true if a packet was generated, false in case of error
+ */
+bool workload_next(struct workload *const workload,
+                   struct workload_packet *const packet)
+{
+	size_t i;
+
+	for(;;)
+	{
+		struct workload_flow *flow;
+		bool is_last;
+
+		/* deliver the first late packet that was overtaken enough */
+		for(i = 0; i < workload->held_nr; i++)
+		{
+			if(workload->held[i].delay == 0)
+			{
+				memcpy(packet, &workload->held[i].packet,
+				       sizeof(struct workload_packet));
+				packet->time.sec = workload->now_ns / 1000000000U;
+				packet->time.nsec = workload->now_ns % 1000000000U;
+				workload->held_nr--;
+				memmove(&workload->held[i], &workload->held[i + 1],
+				        (workload->held_nr - i) * sizeof(struct workload_held));
+				return true;
+			}
+		}
+
+		/* packets arrive with exponential inter-arrival times */
+		workload->now_ns +=
+			(uint64_t) (-log(1.0 - workload_rand_unit(workload)) * 1e9 /
+			            workload->config.rate);
+
+		/* build one packet for the flow picked by the popularity law, the
+		 * last packet of the flow is replaced by a new flow */
+		flow = &workload->flows[workload_pick_flow(workload)];
+		is_last = (workload->config.lifetime > 0 &&
+		           (workload_rand(workload) % workload->config.lifetime) == 0);
+		if(!workload_build_packet(workload, flow, is_last, packet))
+		{
+			return false;
+		}
+		workload->stats.packets_nr++;
+		if(is_last)
+		{
+			workload_start_flow(workload, flow);
+		}
+
+		/* inject losses */
+		if(workload_rand_pct(workload, workload->config.loss_pct))
+		{
+			workload->stats.lost_nr++;
+			continue;
+		}
+
+		/* inject reordering */
+		if(workload->held_nr < workload->config.reorder_depth &&
+		   workload_rand_pct(workload, workload->config.reorder_pct))
+		{
+			struct workload_held *const held = &workload->held[workload->held_nr];
+
+			held->delay = 1 + workload_rand(workload) % workload->config.reorder_depth;
+			memcpy(&held->packet, packet, sizeof(struct workload_packet));
+			workload->held_nr++;
+			workload->stats.reordered_nr++;
+			continue;
+		}
+
+		/* the packet overtakes all the late packets */
+		for(i = 0; i < workload->held_nr; i++)
+		{
+			workload->held[i].delay--;
+		}
+
+		return true;
+	}
+}
+
+
+/**
+ * @brief Get the next late packet still held by the workload
+ *
+ * Call it once the generation stopped, until it returns false, so that the
+ * late packets are delivered instead of being silently dropped. The late
+ * packets are delivered in the order they would have been delivered if
+ * the generation went on, with the arrival time of the last packet.
+ *
+ * @param workload  The workload
+ * @param packet    OUT: The next late IP packet
+ * @return          true if a late packet was returned, false if none is left
+ */
+bool workload_flush(struct workload *const workload,
+                    struct workload_packet *const packet)
+{
+	size_t first = 0;
+	size_t i;
+
+	if(workload->held_nr == 0)
+	{
+		return false;
+	}
+
+	/* the late packet with the shortest delay is due first */
+	for(i = 1; i < workload->held_nr; i++)
+	{
+		if(workload->held[i].delay < workload->held[first].delay)
+		{
+			first = i;
+		}
+	}
+
+	memcpy(packet, &workload->held[first].packet, sizeof(struct workload_packet));
+	packet->time.sec = workload->now_ns / 1000000000U;
+	packet->time.nsec = workload->now_ns % 1000000000U;
+	workload->held_nr--;
+	memmove(&workload->held[first], &workload->held[first + 1],
+	        (workload->held_nr - first) * sizeof(struct workload_held));
+
+	return true;
+}
+
+
+/**
+ * @brief Allocate an in-memory ring of packets
+ *
+ * @param ring  The ring to initialize, to free with \ref workload_ring_free
+ * @param size  The number of packets the ring may contain
+ * @return      true if the ring was allocated, false otherwise
+ */
+bool workload_ring_init(struct workload_ring *const ring, const size_t size)
+{
+	ring->packets = calloc(size, sizeof(struct workload_packet));
+	if(ring->packets == NULL)
+	{
+		return false;
+	}
+	ring->size = size;
+	ring->nr = 0;
+
+	return true;
+}
+
+
+/**
+ * @brief Free the in-memory ring of packets
+ *
+ * @param ring  The ring to free
+ */
+void workload_ring_free(struct workload_ring *const ring)
+{
+	free(ring->packets);
+	ring->packets = NULL;
+	ring->size = 0;
+	ring->nr = 0;
+}
+
+
+/**
+ * @brief Fill the in-memory ring with the next packets of the workload
+ *
+ * The previous content of the ring is overwritten. Benchmarks may replay
+ * the ring as many times as needed. The late packets held at the end of
+ * the batch come with the next batch, or with \ref workload_flush.
+ *
+ * @param workload     The workload
+ * @param ring         The ring to fill
+ * @param max_packets  The maximum number of packets to generate
+ * @return             The number of packets in the ring, less than the ring
+ *                     size and max_packets in case of error
+ */
+size_t workload_fill_ring(struct workload *const workload,
+                          struct workload_ring *const ring,
+                          const size_t max_packets)
+{
+	const size_t packets_nr =
+		(max_packets < ring->size ? max_packets : ring->size);
+
+	for(ring->nr = 0; ring->nr < packets_nr; ring->nr++)
+	{
+		if(!workload_next(workload, &ring->packets[ring->nr]))
+		{
+			break;
+		}
+	}
+
+	return ring->nr;
+}
+
+
+/**
+ * @brief Get the statistics of the workload
+ *
+ * @param workload  The workload
+ * @param stats     OUT: The statistics of the workload
+ */
+void workload_get_stats(const struct workload *const workload,
+                        struct workload_stats *const stats)
+{
+	memcpy(stats, &workload->stats, sizeof(struct workload_stats));
+}
+
+
+/**
+ * @brief Give a description for the given workload protocol
+ *
+ * @param proto  The workload protocol
+ * @return       The description of the protocol
+ */
+const char * workload_get_proto_descr(const workload_proto_t proto)
+{
+	switch(proto)
+	{
+		case WORKLOAD_PROTO_UDP:
+			return "UDP";
+		case WORKLOAD_PROTO_RTP:
+			return "RTP";
+		case WORKLOAD_PROTO_TCP:
+			return "TCP";
+		case WORKLOAD_PROTO_ESP:
+			return "ESP";
+		case WORKLOAD_PROTO_MAX:
+		default:
+			return "unknown";
+	}
+}
+
+
+/**
+ * @brief Get the next pseudo-random number of the workload
+ *
+ * The xorshift64* generator is used, so that the same seed generates the
+ * same workload on all platforms.
+ *
+ * @param workload  The workload
+ * @return          The next pseudo-random number
+ */
+static uint64_t workload_rand(struct workload *const workload)
+{
+	uint64_t x = workload->rng;
+
+	/* the generator is stuck on zero */
+	if(x == 0)
+	{
+		x = 0x9e3779b97f4a7c15ULL;
+	}
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	workload->rng = x;
+
+	return x * 0x2545f4914f6cdd1dULL;
+}
+
+
+/**
+ * @brief Get a pseudo-random number in [0, 1)
+ *
+ * @param workload  The workload
+ * @return          The pseudo-random number
+ */
+static double workload_rand_unit(struct workload *const workload)
+{
+	return (workload_rand(workload) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+/**
+ * @brief Determine whether an event with the given probability happens
+ *
+ * @param workload  The workload
+ * @param pct       The probability of the event (in percents)
+ * @return          true if the event happens, false otherwise
+ */
+static bool workload_rand_pct(struct workload *const workload, const double pct)
+{
+	return (pct > 0.0 && workload_rand_unit(workload) * 100.0 < pct);
+}
+
+
+/**
+ * @brief Fill the given buffer with pseudo-random bytes
+ *
+ * @param workload  The workload
+ * @param data      The buffer to fill
+ * @param len       The length (in bytes) of the buffer
+ */
+static void workload_rand_bytes(struct workload *const workload,
+                                uint8_t *const data,
+                                const size_t len)
+{
+	size_t i;
+
+	for(i = 0; i < len; i += sizeof(uint64_t))
+	{
+		const uint64_t value = workload_rand(workload);
+		const size_t chunk_len =
+			(len - i < sizeof(uint64_t) ? len - i : sizeof(uint64_t));
+
+		memcpy(data + i, &value, chunk_len);
+	}
+}
+
+
+/**
+ * @brief Pick the flow of the next packet according to the popularity law
+ *
+ * @param workload  The workload
+ * @return          The index of the flow in the pool
+ */
+static size_t workload_pick_flow(struct workload *const workload)
+{
+	const double value = workload_rand_unit(workload);
+	size_t low = 0;
+	size_t high;
+
+	if(workload->popularity == NULL)
+	{
+		return workload_rand(workload) % workload->config.flows_nr;
+	}
+
+	/* search for the first flow whose cumulative popularity exceeds the
+	 * random value */
+	high = workload->config.flows_nr - 1;
+	while(low < high)
+	{
+		const size_t mid = low + (high - low) / 2;
+
+		if(workload->popularity[mid] > value)
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+
+	return low;
+}
+
+
+/**
+ * @brief Replace the given flow by a new flow
+ *
+ * @param workload  The workload
+ * @param flow      The flow to start
+ */
+static void workload_start_flow(struct workload *const workload,
+                                struct workload_flow *const flow)
+{
+	/* the UDP destination ports of the flows that are not RTP */
+	static const uint16_t udp_ports[] = { 53, 123, 443, 514, 1194 };
+	static const uint16_t tcp_ports[] = { 22, 80, 443, 993, 8080 };
+	unsigned int weight;
+	size_t i;
+
+	memset(flow, 0, sizeof(struct workload_flow));
+
+	/* pick the protocol according to the protocol mix */
+	weight = workload_rand(workload) % workload->mix_total;
+	for(i = 0; i < (WORKLOAD_PROTO_MAX - 1) && weight >= workload->config.mix[i]; i++)
+	{
+		weight -= workload->config.mix[i];
+	}
+	flow->proto = i;
+	workload->stats.flows_per_proto[flow->proto]++;
+	workload->stats.flows_nr++;
+
+	/* pick the IP version and addresses */
+	flow->is_ipv6 = workload_rand_pct(workload, workload->config.ipv6_pct);
+	if(flow->is_ipv6)
+	{
+		/* 2001:db8::/32 documentation prefix */
+		flow->saddr[0] = 0x20;
+		flow->saddr[1] = 0x01;
+		flow->saddr[2] = 0x0d;
+		flow->saddr[3] = 0xb8;
+		workload_rand_bytes(workload, flow->saddr + 4, 12);
+		memcpy(flow->daddr, flow->saddr, 4);
+		workload_rand_bytes(workload, flow->daddr + 4, 12);
+		flow->has_ipv6_exts =
+			workload_rand_pct(workload, workload->config.ipv6_ext_pct);
+		workload->stats.flows_ipv6_nr++;
+	}
+	else
+	{
+		/* 10.0.0.0/8 clients towards 172.16.0.0/12 servers */
+		workload_rand_bytes(workload, flow->saddr, 4);
+		flow->saddr[0] = 10;
+		workload_rand_bytes(workload, flow->daddr, 4);
+		flow->daddr[0] = 172;
+		flow->daddr[1] = 16 | (flow->daddr[1] & 0x0f);
+		flow->ip_id = workload_rand(workload) & 0xffff;
+	}
+
+	/* pick the ports and sequence numbers */
+	flow->sport = 32768 + workload_rand(workload) % 28232;
+	flow->spi = (uint32_t) workload_rand(workload) | 0x100;
+	flow->sn = (uint32_t) workload_rand(workload);
+	flow->ack = (uint32_t) workload_rand(workload);
+	flow->ts = (uint32_t) workload_rand(workload);
+	switch(flow->proto)
+	{
+		case WORKLOAD_PROTO_UDP:
+			flow->dport =
+				udp_ports[workload_rand(workload) % (sizeof(udp_ports) / sizeof(uint16_t))];
+			break;
+		case WORKLOAD_PROTO_RTP:
+			/* RTP uses even ports and 16-bit sequence numbers, codecs send
+			 * constant-size frames */
+			flow->sport &= 0xfffe;
+			flow->dport = WORKLOAD_RTP_PORT;
+			flow->sn &= 0xffff;
+			flow->payload_len = 20 + (workload_rand(workload) % 8) * 20;
+			break;
+		case WORKLOAD_PROTO_TCP:
+			flow->dport =
+				tcp_ports[workload_rand(workload) % (sizeof(tcp_ports) / sizeof(uint16_t))];
+			/* the window is scaled by 128 (see the SYN), so 256 to 1279 means
+			 * 32 KB to 160 KB */
+			flow->window = 256 + workload_rand(workload) % 1024;
+			break;
+		case WORKLOAD_PROTO_ESP:
+			/* ESP sequence numbers start at 1 */
+			flow->sn = 1;
+			break;
+		case WORKLOAD_PROTO_MAX:
+		default:
+			assert(0);
+			break;
+	}
+}
+
+
+/**
+ * @brief Build the next IP packet of the given flow
+ *
+ * @param workload  The workload
+ * @param flow      The flow the packet belongs to
+ * @param is_last   Whether the packet is the last one of the flow
+ * @param packet    OUT: The IP packet
+ * @return          true if the packet was built, false otherwise
+ */
+static bool workload_build_packet(struct workload *const workload,
+                                  struct workload_flow *const flow,
+                                  const bool is_last,
+                                  struct workload_packet *const packet)
+{
+	uint8_t *nh_proto;
+	uint8_t protocol;
+	size_t ip_hdr_len;
+	size_t l4_len;
+
+	/* build the IP header, its lengths and checksum are set later */
+	if(flow->is_ipv6)
+	{
+		struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) packet->data;
+
+		ipv6->version_tc_flow = htonl(0x60000000U | (flow->spi & IPV6_FLOW_MASK));
+		ipv6->hl = 64;
+		memcpy(&ipv6->saddr, flow->saddr, 16);
+		memcpy(&ipv6->daddr, flow->daddr, 16);
+		nh_proto = &ipv6->nh;
+		ip_hdr_len = sizeof(struct ipv6_hdr);
+
+		/* Hop-by-Hop and Destination options, both with one PadN option */
+		if(flow->has_ipv6_exts)
+		{
+			const uint8_t ext_types[] = { ROHC_IPPROTO_HOPOPTS, ROHC_IPPROTO_DSTOPTS };
+			size_t i;
+
+			for(i = 0; i < 2; i++)
+			{
+				uint8_t *const ext = packet->data + ip_hdr_len;
+
+				*nh_proto = ext_types[i];
+				memset(ext, 0, WORKLOAD_IPV6_EXT_LEN);
+				ext[2] = 0x01; /* PadN */
+				ext[3] = WORKLOAD_IPV6_EXT_LEN - 4;
+				nh_proto = &ext[0];
+				ip_hdr_len += WORKLOAD_IPV6_EXT_LEN;
+			}
+		}
+	}
+	else
+	{
+		struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) packet->data;
+
+		ipv4->version = 4;
+		ipv4->ihl = 5;
+		ipv4->tos = 0;
+		ipv4->id = htons(flow->ip_id);
+		flow->ip_id++;
+		ipv4->frag_off = (flow->proto == WORKLOAD_PROTO_TCP ? htons(IPV4_DF) : 0);
+		ipv4->ttl = 64;
+		memcpy(&ipv4->saddr, flow->saddr, 4);
+		memcpy(&ipv4->daddr, flow->daddr, 4);
+		nh_proto = &ipv4->protocol;
+		ip_hdr_len = sizeof(struct ipv4_hdr);
+	}
+
+	/* build the transport header and payload */
+	switch(flow->proto)
+	{
+		case WORKLOAD_PROTO_UDP:
+		case WORKLOAD_PROTO_RTP:
+		{
+			struct udphdr *const udp = (struct udphdr *) (packet->data + ip_hdr_len);
+			size_t payload_len;
+
+			protocol = ROHC_IPPROTO_UDP;
+			udp->source = htons(flow->sport);
+			udp->dest = htons(flow->dport);
+			l4_len = sizeof(struct udphdr);
+			if(flow->proto == WORKLOAD_PROTO_RTP)
+			{
+				struct rtphdr *const rtp = (struct rtphdr *) (udp + 1);
+
+				memset(rtp, 0, sizeof(struct rtphdr));
+				rtp->version = 2;
+				rtp->m = (flow->packets_nr == 0 ? 1 : 0);
+				rtp->pt = 0x60; /* first dynamic payload type */
+				rtp->sn = htons(flow->sn & 0xffff);
+				rtp->timestamp = htonl(flow->ts);
+				rtp->ssrc = htonl(flow->spi);
+				flow->sn++;
+				flow->ts += 160;
+				l4_len += sizeof(struct rtphdr);
+				payload_len = flow->payload_len;
+			}
+			else
+			{
+				payload_len = 16 + workload_rand(workload) % 1024;
+			}
+			workload_rand_bytes(workload, packet->data + ip_hdr_len + l4_len,
+			                    payload_len);
+			l4_len += payload_len;
+			udp->len = htons(l4_len);
+			udp->check = 0;
+			udp->check = workload_l4_csum(flow, protocol, (uint8_t *) udp, l4_len);
+			if(udp->check == 0)
+			{
+				udp->check = 0xffff;
+			}
+			break;
+		}
+		case WORKLOAD_PROTO_TCP:
+			protocol = ROHC_IPPROTO_TCP;
+			l4_len = workload_build_tcp(workload, flow, is_last,
+			                            packet->data + ip_hdr_len,
+			                            WORKLOAD_PACKET_MAX_LEN - ip_hdr_len);
+			break;
+		case WORKLOAD_PROTO_ESP:
+		{
+			struct esphdr *const esp = (struct esphdr *) (packet->data + ip_hdr_len);
+			const size_t payload_len = 16 + (workload_rand(workload) % 64) * 16;
+
+			protocol = ROHC_IPPROTO_ESP;
+			esp->spi = htonl(flow->spi);
+			esp->sn = htonl(flow->sn);
+			flow->sn++;
+			workload_rand_bytes(workload, (uint8_t *) (esp + 1), payload_len);
+			l4_len = sizeof(struct esphdr) + payload_len;
+			break;
+		}
+		case WORKLOAD_PROTO_MAX:
+		default:
+			return false;
+	}
+	*nh_proto = protocol;
+	assert((ip_hdr_len + l4_len) <= WORKLOAD_PACKET_MAX_LEN);
+
+	/* set the IP lengths and checksum */
+	if(flow->is_ipv6)
+	{
+		struct ipv6_hdr *const ipv6 = (struct ipv6_hdr *) packet->data;
+		ipv6->plen = htons(ip_hdr_len - sizeof(struct ipv6_hdr) + l4_len);
+	}
+	else
+	{
+		struct ipv4_hdr *const ipv4 = (struct ipv4_hdr *) packet->data;
+		ipv4->tot_len = htons(ip_hdr_len + l4_len);
+		ipv4->check = 0;
+		ipv4->check = ip_fast_csum(packet->data, ipv4->ihl);
+	}
+
+	packet->len = ip_hdr_len + l4_len;
+	packet->time.sec = workload->now_ns / 1000000000U;
+	packet->time.nsec = workload->now_ns % 1000000000U;
+	flow->packets_nr++;
+
+	return true;
+}
+
+
+/**
+ * @brief Build the next TCP segment of the given flow
+ *
+ * The first segment is a SYN with the MSS, SACK Permitted, Timestamp and
+ * Window Scale options. The next segments carry data with the Timestamp
+ * option, and sometimes one SACK block. The last segment is a FIN. The
+ * window is constant, unless it changes with the configured probability.
+ *
+ * @param workload  The workload
+ * @param flow      The TCP flow
+ * @param is_last   Whether the segment is the last one of the flow
+ * @param data      The buffer for the TCP segment
+ * @param max_len   The length (in bytes) of the buffer
+ * @return          The length (in bytes) of the TCP segment
+ */
+static size_t workload_build_tcp(struct workload *const workload,
+                                 struct workload_flow *const flow,
+                                 const bool is_last,
+                                 uint8_t *const data,
+                                 const size_t max_len)
+{
+	struct tcphdr *const tcp = (struct tcphdr *) data;
+	const uint32_t ts_val = (uint32_t) (workload->now_ns / 1000000U);
+	const bool is_syn = (flow->packets_nr == 0);
+	uint8_t *opts = tcp->options;
+	size_t opts_len;
+	size_t payload_len = 0;
+
+	memset(tcp, 0, sizeof(struct tcphdr));
+	tcp->src_port = htons(flow->sport);
+	tcp->dst_port = htons(flow->dport);
+	tcp->seq_num = htonl(flow->sn);
+
+	/* the receiver rarely changes its window during a transfer, as real
+	 * stacks do */
+	if(!is_syn && workload_rand_pct(workload, workload->config.tcp_window_change_pct))
+	{
+		flow->window = 256 + workload_rand(workload) % 1024;
+	}
+	tcp->window = htons(is_syn ? 65535 : flow->window);
+
+	if(is_syn)
+	{
+		/* MSS, SACK Permitted, Timestamp, NOP, Window Scale */
+		opts[0] = TCP_OPT_MSS;
+		opts[1] = 4;
+		opts[2] = 0x05;
+		opts[3] = 0xb4; /* 1460 */
+		opts[4] = TCP_OPT_SACK_PERM;
+		opts[5] = 2;
+		opts[6] = TCP_OPT_TS;
+		opts[7] = 10;
+		workload_put32(opts + 8, ts_val);
+		workload_put32(opts + 12, 0);
+		opts[16] = TCP_OPT_NOP;
+		opts[17] = TCP_OPT_WS;
+		opts[18] = 3;
+		opts[19] = 7;
+		opts_len = WORKLOAD_TCP_SYN_OPTS_LEN;
+		tcp->rsf_flags = RSF_SYN_ONLY;
+		flow->sn++;
+	}
+	else
+	{
+		/* NOP, NOP, Timestamp */
+		opts[0] = TCP_OPT_NOP;
+		opts[1] = TCP_OPT_NOP;
+		opts[2] = TCP_OPT_TS;
+		opts[3] = 10;
+		workload_put32(opts + 4, ts_val);
+		workload_put32(opts + 8, flow->ts);
+		opts_len = WORKLOAD_TCP_TS_OPTS_LEN;
+
+		/* NOP, NOP, SACK with one block on some segments */
+		if((workload_rand(workload) % 16) == 0)
+		{
+			const uint32_t block_start = flow->ack + 1460;
+
+			opts[opts_len] = TCP_OPT_NOP;
+			opts[opts_len + 1] = TCP_OPT_NOP;
+			opts[opts_len + 2] = TCP_OPT_SACK;
+			opts[opts_len + 3] = 10;
+			workload_put32(opts + opts_len + 4, block_start);
+			workload_put32(opts + opts_len + 8, block_start + 1460);
+			opts_len += WORKLOAD_TCP_SACK_OPTS_LEN;
+		}
+
+		tcp->ack_flag = 1;
+		tcp->ack_num = htonl(flow->ack);
+		if(is_last)
+		{
+			tcp->rsf_flags = RSF_FIN_ONLY;
+			flow->sn++;
+		}
+		else
+		{
+			/* bulk transfers send full segments, others send small ones */
+			payload_len = ((workload_rand(workload) % 2) == 0 ?
+			               1200 : 1 + workload_rand(workload) % 400);
+			tcp->psh_flag = 1;
+			flow->sn += payload_len;
+		}
+
+		/* the peer acknowledges some data and echoes a timestamp from time
+		 * to time */
+		if((workload_rand(workload) % 4) == 0)
+		{
+			flow->ack += 1 + workload_rand(workload) % 100;
+			flow->ts = ts_val;
+		}
+	}
+	tcp->data_offset = (sizeof(struct tcphdr) + opts_len) / sizeof(uint32_t);
+
+	assert((sizeof(struct tcphdr) + opts_len + payload_len) <= max_len);
+	workload_rand_bytes(workload, opts + opts_len, payload_len);
+
+	tcp->checksum = workload_l4_csum(flow, ROHC_IPPROTO_TCP, data,
+	                                 sizeof(struct tcphdr) + opts_len + payload_len);
+
+	return sizeof(struct tcphdr) + opts_len + payload_len;
+}
+
+
+/**
+ * @brief Write a 32-bit value in network byte order
+ *
+ * @param data   The buffer to write into, maybe unaligned
+ * @param value  The value to write (in host byte order)
+ */
+static void workload_put32(uint8_t *const data, const uint32_t value)
+{
+	data[0] = (value >> 24) & 0xff;
+	data[1] = (value >> 16) & 0xff;
+	data[2] = (value >> 8) & 0xff;
+	data[3] = value & 0xff;
+}
+
+
+/**
+ * @brief Compute the UDP or TCP checksum with the IP pseudo-header
+ *
+ * @param flow      The flow the segment belongs to
+ * @param protocol  The transport protocol
+ * @param data      The transport header and payload, checksum set to zero
+ * @param len       The length (in bytes) of the transport header and payload
+ * @return          The checksum (in network byte order)
+ */
+static uint16_t workload_l4_csum(const struct workload_flow *const flow,
+                                 const uint8_t protocol,
+                                 const uint8_t *const data,
+                                 const size_t len)
+{
+	const size_t addr_len = (flow->is_ipv6 ? 16 : 4);
+	const uint8_t pseudo[4] = { len >> 8, len & 0xff, 0, protocol };
+	uint32_t sum = 0;
+
+	sum = workload_csum_add(sum, flow->saddr, addr_len);
+	sum = workload_csum_add(sum, flow->daddr, addr_len);
+	sum = workload_csum_add(sum, pseudo, 4);
+	sum = workload_csum_add(sum, data, len);
+	while(sum >> 16)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return htons(~sum & 0xffff);
+}
+
+
+/**
+ * @brief Add the given data to a one's complement sum
+ *
+ * @param sum   The current sum
+ * @param data  The data to add, an odd length is padded with one zero byte
+ * @param len   The length (in bytes) of the data
+ * @return      The new sum, not folded
+ */
+static uint32_t workload_csum_add(uint32_t sum,
+                                  const uint8_t *const data,
+                                  const size_t len)
+{
+	size_t i;
+
+	for(i = 0; (i + 1) < len; i += 2)
+	{
+		sum += (data[i] << 8) | data[i + 1];
+	}
+	if((len % 2) != 0)
+	{
+		sum += data[len - 1] << 8;
+	}
+	while(sum >> 16)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return sum;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2017 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   workload.h
+ * @brief  Generate synthetic traffic with many concurrent flows
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The workload engine simulates a pool of concurrent flows. Every packet
+ * belongs to one flow picked with a Zipf popularity law. Every flow ends
+ * after a random number of packets and is replaced by a new flow with new
+ * addresses and ports. Packets arrive with exponential inter-arrival times
+ * around the configured packet rate. Losses and reordering may be injected
+ * after the packets are built.
+ *
+ * The generated IP packets are read one by one with \ref workload_next or
+ * by batches in an in-memory ring with \ref workload_fill_ring. The late
+ * packets still held when the generation stops are read with
+ * \ref workload_flush.
+ */
+
+#ifndef ROHC_APP_WORKLOAD_H
+#define ROHC_APP_WORKLOAD_H
+
+#include <rohc/rohc_time.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+
+/** The maximum length (in bytes) of one generated IP packet */
+#define WORKLOAD_PACKET_MAX_LEN  1500U
+
+/** The maximum number of packets that may be held for reordering */
+#define WORKLOAD_REORDER_DEPTH_MAX  64U
+
+
+/** The protocols the flows of a workload may use */
+typedef enum
+{
+	WORKLOAD_PROTO_UDP = 0,  /**< Plain UDP flows */
+	WORKLOAD_PROTO_RTP = 1,  /**< RTP flows over UDP */
+	WORKLOAD_PROTO_TCP = 2,  /**< TCP flows with options */
+	WORKLOAD_PROTO_ESP = 3,  /**< ESP flows */
+	WORKLOAD_PROTO_MAX = 4,  /**< The number of protocols */
+} workload_proto_t;
+
+
+/** The configuration of a workload */
+struct workload_config
+{
+	/** The number of concurrent flows */
+	unsigned long flows_nr;
+	/** The exponent of the Zipf popularity of flows, 0 for uniform */
+	double zipf_exponent;
+	/** The mean number of packets per flow, 0 for flows that never end */
+	unsigned long lifetime;
+	/** The mean arrival rate of packets (in packets per second) */
+	double rate;
+	/** The relative weight of every protocol in the new flows */
+	unsigned int mix[WORKLOAD_PROTO_MAX];
+	/** The percentage of new flows that use IPv6 instead of IPv4 */
+	double ipv6_pct;
+	/** The percentage of IPv6 flows with Hop-by-Hop and Destination options */
+	double ipv6_ext_pct;
+	/** The percentage of packets that are lost */
+	double loss_pct;
+	/** The percentage of packets that are delivered late */
+	double reorder_pct;
+	/** The maximum number of packets a late packet is overtaken by */
+	size_t reorder_depth;
+	/** The percentage of TCP segments that change the advertised window */
+	double tcp_window_change_pct;
+	/** The seed of the pseudo-random generator */
+	uint64_t seed;
+};
+
+
+/** One generated IP packet */
+struct workload_packet
+{
+	struct rohc_ts time;                     /**< The arrival time */
+	size_t len;                              /**< The length (in bytes) */
+	uint8_t data[WORKLOAD_PACKET_MAX_LEN];   /**< The IP packet */
+};
+
+
+/** An in-memory ring of generated IP packets */
+struct workload_ring
+{
+	struct workload_packet *packets;  /**< The packets of the ring */
+	size_t size;                      /**< The number of slots in the ring */
+	size_t nr;                        /**< The number of filled slots */
+};
+
+
+/** The statistics of a workload */
+struct workload_stats
+{
+	unsigned long flows_nr;                      /**< The number of flows started */
+	unsigned long flows_per_proto[WORKLOAD_PROTO_MAX];  /**< Flows per protocol */
+	unsigned long flows_ipv6_nr;                 /**< The number of IPv6 flows */
+	unsigned long packets_nr;                    /**< The number of built packets */
+	unsigned long lost_nr;                       /**< The number of lost packets */
+	unsigned long reordered_nr;                  /**< The number of late packets */
+};
+
+
+struct workload;
+
+
+void workload_config_init(struct workload_config *const config)
+	__attribute__((nonnull(1)));
+
+struct workload * workload_new(const struct workload_config *const config)
+	__attribute__((warn_unused_result, nonnull(1)));
+void workload_free(struct workload *const workload);
+
+bool workload_next(struct workload *const workload,
+                   struct workload_packet *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+bool workload_flush(struct workload *const workload,
+                    struct workload_packet *const packet)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+bool workload_ring_init(struct workload_ring *const ring, const size_t size)
+	__attribute__((warn_unused_result, nonnull(1)));
+void workload_ring_free(struct workload_ring *const ring)
+	__attribute__((nonnull(1)));
+size_t workload_fill_ring(struct workload *const workload,
+                          struct workload_ring *const ring,
+                          const size_t max_packets)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+void workload_get_stats(const struct workload *const workload,
+                        struct workload_stats *const stats)
+	__attribute__((nonnull(1, 2)));
+
+const char * workload_get_proto_descr(const workload_proto_t proto)
+	__attribute__((warn_unused_result, const));
+
+#endif
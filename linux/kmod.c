@@ -77,11 +77,15 @@ EXPORT_SYMBOL_GPL(rohc_buf_reset);
 EXPORT_SYMBOL_GPL(rohc_comp_new2);
 EXPORT_SYMBOL_GPL(rohc_comp_free);
 EXPORT_SYMBOL_GPL(rohc_compress4);
+EXPORT_SYMBOL_GPL(rohc_compress_inplace);
+EXPORT_SYMBOL_GPL(rohc_compress_sg);
+EXPORT_SYMBOL_GPL(rohc_compress_burst);
 EXPORT_SYMBOL_GPL(rohc_comp_pad);
 EXPORT_SYMBOL_GPL(rohc_comp_force_contexts_reinit);
 
 /* segment */
 EXPORT_SYMBOL_GPL(rohc_comp_get_segment2);
+EXPORT_SYMBOL_GPL(rohc_comp_get_segment_sg);
 
 /* feedback */
 EXPORT_SYMBOL_GPL(rohc_comp_deliver_feedback2);
@@ -90,6 +94,9 @@ EXPORT_SYMBOL_GPL(rohc_comp_deliver_feedback2);
 EXPORT_SYMBOL_GPL(rohc_comp_get_state_descr);
 EXPORT_SYMBOL_GPL(rohc_comp_get_general_info);
 EXPORT_SYMBOL_GPL(rohc_comp_get_last_packet_info2);
+EXPORT_SYMBOL_GPL(rohc_comp_get_perf_counters);
+EXPORT_SYMBOL_GPL(rohc_comp_get_stats);
+EXPORT_SYMBOL_GPL(rohc_comp_get_ctxt_stats);
 
 /* configuration */
 EXPORT_SYMBOL_GPL(rohc_comp_profile_enabled);
@@ -105,6 +112,8 @@ EXPORT_SYMBOL_GPL(rohc_comp_set_wlsb_window_width);
 EXPORT_SYMBOL_GPL(rohc_comp_set_periodic_refreshes);
 EXPORT_SYMBOL_GPL(rohc_comp_set_periodic_refreshes_time);
 EXPORT_SYMBOL_GPL(rohc_comp_set_traces_cb2);
+EXPORT_SYMBOL_GPL(rohc_comp_set_traces_level);
+EXPORT_SYMBOL_GPL(rohc_comp_set_allocator);
 EXPORT_SYMBOL_GPL(rohc_comp_set_features);
 
 /* RTP-specific configuration */
@@ -119,10 +128,15 @@ EXPORT_SYMBOL_GPL(rohc_comp_set_rtp_detection_cb);
 EXPORT_SYMBOL_GPL(rohc_decomp_new2);
 EXPORT_SYMBOL_GPL(rohc_decomp_free);
 EXPORT_SYMBOL_GPL(rohc_decompress3);
+EXPORT_SYMBOL_GPL(rohc_decompress_inplace);
+EXPORT_SYMBOL_GPL(rohc_decompress_burst);
 
 /* statistics */
 EXPORT_SYMBOL_GPL(rohc_decomp_get_state_descr);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_general_info);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_perf_counters);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_stats);
+EXPORT_SYMBOL_GPL(rohc_decomp_get_ctxt_stats);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_context_info);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_last_packet_info);
 
@@ -141,5 +155,7 @@ EXPORT_SYMBOL_GPL(rohc_decomp_get_rate_limits);
 EXPORT_SYMBOL_GPL(rohc_decomp_set_prtt);
 EXPORT_SYMBOL_GPL(rohc_decomp_get_prtt);
 EXPORT_SYMBOL_GPL(rohc_decomp_set_traces_cb2);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_traces_level);
+EXPORT_SYMBOL_GPL(rohc_decomp_set_allocator);
 EXPORT_SYMBOL_GPL(rohc_decomp_set_features);
 
@@ -47,6 +47,11 @@
 /// The CRC-8 initial value
 #define CRC_INIT_8 0xff
 
+/** The number of bytes the CRC tables handle at once (slicing-by-8) */
+#define CRC_SLICES_NR  8U
+/** The length (in bytes) of the tables for CRC-3, CRC-7 and CRC-8 */
+#define CRC_TABLE_LEN  (CRC_SLICES_NR * 256U)
+
 /** The FCS-32 initial value */
 #define CRC_INIT_FCS32 0xffffffff
 /** The length (in bytes) of the FCS-32 CRC */
@@ -63,12 +68,17 @@ typedef enum
 
 
 /*
- * Function prototypes.
+ * Pre-computed tables shared by all compressors and decompressors.
  */
 
-void rohc_crc_init_table(uint8_t *const table,
-                         const rohc_crc_type_t crc_type)
-	__attribute__((nonnull(1)));
+extern const uint8_t rohc_crc_table_3[CRC_TABLE_LEN];
+extern const uint8_t rohc_crc_table_7[CRC_TABLE_LEN];
+extern const uint8_t rohc_crc_table_8[CRC_TABLE_LEN];
+
+
+/*
+ * Function prototypes.
+ */
 
 uint8_t crc_calculate(const rohc_crc_type_t crc_type,
                       const uint8_t *const data,
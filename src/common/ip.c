@@ -92,8 +92,8 @@ void ip_create(struct ip_packet *const ip,
 			goto malformed;
 		}
 
-		/* copy the IPv4 header */
-		memcpy(&ip->header.v4, packet, sizeof(struct ipv4_hdr));
+		/* point to the IPv4 header, do not copy it */
+		ip->header.v4 = (const struct ipv4_hdr *) packet;
 
 		if(ipv4_get_hdrlen(ip) < sizeof(struct ipv4_hdr) ||
 		   ipv4_get_hdrlen(ip) > size)
@@ -120,8 +120,8 @@ void ip_create(struct ip_packet *const ip,
 			goto malformed;
 		}
 
-		/* copy the IPv6 header */
-		memcpy(&ip->header.v6, packet, sizeof(struct ipv6_hdr));
+		/* point to the IPv6 header, do not copy it */
+		ip->header.v6 = (const struct ipv6_hdr *) packet;
 
 		if(ip_get_totlen(ip) != size)
 		{
@@ -352,19 +352,17 @@ unsigned short ip_get_extension_size(const uint8_t *const ext)
  */
 unsigned short ip_get_total_extension_size(const struct ip_packet *const ip)
 {
-	uint8_t *ext;
-	uint8_t next_hdr_type;
-	unsigned short total_ext_size = 0;
+	/* function does not handle non-IPv4/IPv6 packets */
+	assert(ip->version != IP_UNKNOWN);
 
-	/* TODO: not very performant */
-	ext = ip_get_next_ext_from_ip(ip, &next_hdr_type);
-	while(ext != NULL)
+	if(ip->version != IPV6)
 	{
-		total_ext_size += ip_get_extension_size(ext);
-		ext = ip_get_next_ext_from_ext(ext, &next_hdr_type);
+		return 0;
 	}
 
-	return total_ext_size;
+	/* the extension headers were already walked by ip_create(): they span from
+	 * the next header to the next layer */
+	return (ip->nl.data - ip->nh.data);
 }
 
 
@@ -386,7 +384,7 @@ bool ip_is_fragment(const struct ip_packet *const ip)
 
 	if(ip->version == IPV4)
 	{
-		is_fragment = ipv4_is_fragment(&ip->header.v4);
+		is_fragment = ipv4_is_fragment(ip->header.v4);
 	}
 	else if(ip->version == IPV6)
 	{
@@ -420,11 +418,11 @@ unsigned int ip_get_totlen(const struct ip_packet *const ip)
 
 	if(ip->version == IPV4)
 	{
-		len = rohc_ntoh16(ip->header.v4.tot_len);
+		len = rohc_ntoh16(ip->header.v4->tot_len);
 	}
 	else if(ip->version == IPV6)
 	{
-		len = sizeof(struct ipv6_hdr) + rohc_ntoh16(ip->header.v6.plen);
+		len = sizeof(struct ipv6_hdr) + rohc_ntoh16(ip->header.v6->plen);
 	}
 	else /* IP_UNKNOWN */
 	{
@@ -469,17 +467,6 @@ unsigned int ip_get_hdrlen(const struct ip_packet *const ip)
 }
 
 
-/**
- * @brief Set the IP version of an IP packet
- *
- * @param ip     The IP packet to modify
- * @param value  The version value
- */
-void ip_set_version(struct ip_packet *const ip, const ip_version value)
-{
-	ip->version = value;
-}
-
 
 /**
  * @brief Get the protocol transported by an IP packet
@@ -500,34 +487,6 @@ uint8_t ip_get_protocol(const struct ip_packet *const ip)
 }
 
 
-/**
- * @brief Set the protocol transported by an IP packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is \ref IP_UNKNOWN.
- *
- * @param ip     The IP packet to modify
- * @param value  The protocol value
- */
-void ip_set_protocol(struct ip_packet *const ip, const uint8_t value)
-{
-	if(ip->version == IPV4)
-	{
-		ip->header.v4.protocol = value & 0xff;
-		ip->nl.proto = value & 0xff;
-	}
-	else if(ip->version == IPV6)
-	{
-		ip->header.v6.nh = value & 0xff;
-		ip->nl.proto = value & 0xff;
-	}
-	else
-	{
-		/* function does not handle non-IPv4/IPv6 packets */
-		assert(0);
-	}
-}
-
 
 /**
  * @brief Get the IPv4 Type Of Service (TOS) or IPv6 Traffic Class (TC)
@@ -545,11 +504,11 @@ unsigned int ip_get_tos(const struct ip_packet *const ip)
 
 	if(ip->version == IPV4)
 	{
-		tos = ip->header.v4.tos;
+		tos = ip->header.v4->tos;
 	}
 	else if(ip->version == IPV6)
 	{
-		tos = ipv6_get_tc(&ip->header.v6);
+		tos = ipv6_get_tc(ip->header.v6);
 	}
 	else
 	{
@@ -564,33 +523,6 @@ unsigned int ip_get_tos(const struct ip_packet *const ip)
 }
 
 
-/**
- * @brief Set the IPv4 Type Of Service (TOS) or IPv6 Traffic Class (TC)
- *        of an IP packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is \ref IP_UNKNOWN.
- *
- * @param ip     The IP packet to modify
- * @param value  The TOS/TC value
- */
-void ip_set_tos(struct ip_packet *const ip, const uint8_t value)
-{
-	if(ip->version == IPV4)
-	{
-		ip->header.v4.tos = value & 0xff;
-	}
-	else if(ip->version == IPV6)
-	{
-		ipv6_set_tc(&ip->header.v6, value);
-	}
-	else
-	{
-		/* function does not handle non-IPv4/IPv6 packets */
-		assert(0);
-	}
-}
-
 
 /**
  * @brief Get the IPv4 Time To Live (TTL) or IPv6 Hop Limit (HL)
@@ -608,11 +540,11 @@ unsigned int ip_get_ttl(const struct ip_packet *const ip)
 
 	if(ip->version == IPV4)
 	{
-		ttl = ip->header.v4.ttl;
+		ttl = ip->header.v4->ttl;
 	}
 	else if(ip->version == IPV6)
 	{
-		ttl = ip->header.v6.hl;
+		ttl = ip->header.v6->hl;
 	}
 	else
 	{
@@ -627,87 +559,8 @@ unsigned int ip_get_ttl(const struct ip_packet *const ip)
 }
 
 
-/**
- * @brief Set the IPv4 Time To Live (TTL) or IPv6 Hop Limit (HL)
- *        of an IP packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is \ref IP_UNKNOWN.
- *
- * @param ip     The IP packet to modify
- * @param value  The TTL/HL value
- */
-void ip_set_ttl(struct ip_packet *const ip, const uint8_t value)
-{
-	if(ip->version == IPV4)
-	{
-		ip->header.v4.ttl = value & 0xff;
-	}
-	else if(ip->version == IPV6)
-	{
-		ip->header.v6.hl = value & 0xff;
-	}
-	else
-	{
-		/* function does not handle non-IPv4/IPv6 packets */
-		assert(0);
-	}
-}
 
 
-/**
- * @brief Set the Source Address of an IP packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is \ref IP_UNKNOWN.
- *
- * @param ip     The IP packet to modify
- * @param value  The IP address value
- */
-void ip_set_saddr(struct ip_packet *const ip, const uint8_t *value)
-{
-	if(ip->version == IPV4)
-	{
-		memcpy(&ip->header.v4.saddr, value, sizeof(uint32_t));
-	}
-	else if(ip->version == IPV6)
-	{
-		memcpy(&ip->header.v6.saddr, value, sizeof(struct ipv6_addr));
-	}
-	else
-	{
-		/* function does not handle non-IPv4/IPv6 packets */
-		assert(0);
-	}
-}
-
-
-/**
- * @brief Set the Destination Address of an IP packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is \ref IP_UNKNOWN.
- *
- * @param ip     The IP packet to modify
- * @param value  The IP address value
- */
-void ip_set_daddr(struct ip_packet *const ip, const uint8_t *value)
-{
-	if(ip->version == IPV4)
-	{
-		memcpy(&ip->header.v4.daddr, value, sizeof(uint32_t));
-	}
-	else if(ip->version == IPV6)
-	{
-		memcpy(&ip->header.v6.daddr, value, sizeof(struct ipv6_addr));
-	}
-	else
-	{
-		/* function does not handle non-IPv4/IPv6 packets */
-		assert(0);
-	}
-}
-
 
 /*
  * IPv4 specific functions:
@@ -726,7 +579,7 @@ void ip_set_daddr(struct ip_packet *const ip, const uint8_t *value)
 const struct ipv4_hdr * ipv4_get_header(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV4);
-	return &(ip->header.v4);
+	return ip->header.v4;
 }
 
 
@@ -766,7 +619,7 @@ uint16_t ipv4_get_id_nbo(const struct ip_packet *const ip,
 
 	assert(ip->version == IPV4);
 
-	id = ip->header.v4.id;
+	id = ip->header.v4->id;
 	if(!nbo)
 	{
 		/* If IP-ID is not transmitted in Network Byte Order,
@@ -778,24 +631,6 @@ uint16_t ipv4_get_id_nbo(const struct ip_packet *const ip,
 }
 
 
-/**
- * @brief Set the IP-ID of an IPv4 packet
- *
- * The IP-ID value is set as-is (ie. not automatically converted to
- * the host byte order).
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is not \ref IPV4.
- *
- * @param ip     The IP packet to modify
- * @param value  The IP-ID value
- */
-void ipv4_set_id(struct ip_packet *const ip, const int value)
-{
-	assert(ip->version == IPV4);
-	ip->header.v4.id = value & 0xffff;
-}
-
 
 /**
  * @brief Get the Don't Fragment (DF) bit of an IPv4 packet
@@ -809,25 +644,10 @@ void ipv4_set_id(struct ip_packet *const ip, const int value)
 int ipv4_get_df(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV4);
-	return ip->header.v4.df;
+	return ip->header.v4->df;
 }
 
 
-/**
- * @brief Set the Don't Fragment (DF) bit of an IPv4 packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is not \ref IPV4.
- *
- * @param ip     The IP packet to modify
- * @param value  The value of the DF bit
- */
-void ipv4_set_df(struct ip_packet *const ip, const int value)
-{
-	assert(ip->version == IPV4);
-	ip->header.v4.df = value;
-}
-
 
 /**
  * @brief Get the source address of an IPv4 packet
@@ -841,7 +661,7 @@ void ipv4_set_df(struct ip_packet *const ip, const int value)
 uint32_t ipv4_get_saddr(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV4);
-	return ip->header.v4.saddr;
+	return ip->header.v4->saddr;
 }
 
 
@@ -857,7 +677,7 @@ uint32_t ipv4_get_saddr(const struct ip_packet *const ip)
 uint32_t ipv4_get_daddr(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV4);
-	return ip->header.v4.daddr;
+	return ip->header.v4->daddr;
 }
 
 
@@ -878,7 +698,7 @@ uint32_t ipv4_get_daddr(const struct ip_packet *const ip)
 const struct ipv6_hdr * ipv6_get_header(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV6);
-	return &(ip->header.v6);
+	return ip->header.v6;
 }
 
 
@@ -894,25 +714,10 @@ const struct ipv6_hdr * ipv6_get_header(const struct ip_packet *const ip)
 uint32_t ip_get_flow_label(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV6);
-	return ipv6_get_flow_label(&ip->header.v6);
+	return ipv6_get_flow_label(ip->header.v6);
 }
 
 
-/**
- * @brief Set the flow label of an IPv6 packet
- *
- * The function does not handle \ref ip_packet whose \ref ip_packet::version
- * is not \ref IPV6.
- *
- * @param ip     The IPv6 packet to modify
- * @param value  The flow label value
- */
-void ip_set_flow_label(struct ip_packet *const ip, const uint32_t value)
-{
-	assert(ip->version == IPV6);
-	ipv6_set_flow_label(&ip->header.v6, value);
-}
-
 
 /**
  * @brief Get the source address of an IPv6 packet
@@ -926,7 +731,7 @@ void ip_set_flow_label(struct ip_packet *const ip, const uint32_t value)
 const struct ipv6_addr * ipv6_get_saddr(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV6);
-	return &(ip->header.v6.saddr);
+	return &(ip->header.v6->saddr);
 }
 
 
@@ -942,7 +747,7 @@ const struct ipv6_addr * ipv6_get_saddr(const struct ip_packet *const ip)
 const struct ipv6_addr * ipv6_get_daddr(const struct ip_packet *const ip)
 {
 	assert(ip->version == IPV6);
-	return &(ip->header.v6.daddr);
+	return &(ip->header.v6->daddr);
 }
 
 
@@ -969,7 +774,7 @@ static bool ip_find_next_layer(const struct ip_packet *const ip,
 		size_t ip_hdr_len;
 
 		/* find next header after IPv4 header */
-		nh->proto = ip->header.v4.protocol;
+		nh->proto = ip->header.v4->protocol;
 
 		if(ip->size < sizeof(struct ipv4_hdr))
 		{
@@ -988,7 +793,7 @@ static bool ip_find_next_layer(const struct ip_packet *const ip,
 	else if(ip->version == IPV6)
 	{
 		/* find next header after IPv6 header */
-		nh->proto = ip->header.v6.nh;
+		nh->proto = ip->header.v6->nh;
 
 		if(ip->size < sizeof(struct ipv6_hdr))
 		{
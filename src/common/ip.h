@@ -30,6 +30,9 @@
 #include "protocols/ipv4.h"
 #include "protocols/ipv6.h"
 
+#ifndef __KERNEL__
+#  include <string.h>
+#endif
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -73,19 +76,23 @@ struct net_hdr
 /**
  * @brief Defines an IP-agnostic packet that can handle
  *        an IPv4 or IPv6 packet
+ *
+ * The IP packet is parsed once by \ref ip_create: the IP header, the next
+ * header and the next layer point into the packet data, nothing is copied.
+ * The packet data shall thus outlive the IP packet.
  */
 struct ip_packet
 {
 	/// The version of the IP packet
 	ip_version version;
 
-	/// The IP header
+	/// The IP header in the packet data (IPv4 or IPv6 only)
 	union
 	{
 		/// The IPv4 header
-		struct ipv4_hdr v4;
+		const struct ipv4_hdr *v4;
 		/// The IPv6 header
-		struct ipv6_hdr v6;
+		const struct ipv6_hdr *v6;
 	} header;
 
 	/// The whole IP data (header + payload) if not NULL
@@ -120,6 +127,60 @@ static inline uint16_t swab16(const uint16_t value)
 }
 
 
+static inline uint16_t from32to16(const uint32_t x)
+	__attribute__((warn_unused_result, const));
+
+static inline uint16_t from32to16(const uint32_t x)
+{
+	uint32_t y;
+	/* add up 16-bit and 16-bit for 16+c bit */
+	y = (x & 0xffff) + (x >> 16);
+	/* add up carry.. */
+	y = (y & 0xffff) + (y >> 16);
+	return y;
+}
+
+static inline uint16_t ip_fast_csum_generic(const uint8_t *const iph,
+                                            const size_t ihl)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+
+/**
+ * @brief Compute the checksum of an IPv4 header in portable C
+ *
+ * It is the ip_fast_csum() of the platforms without an assembly version. It
+ * is built on all platforms, so that it may be tested everywhere.
+ *
+ * The 32-bit words are accumulated in a 64-bit sum, so no carry has to be
+ * propagated within the loop, and they are loaded with memcpy() so that the
+ * header does not need to be aligned. The one's complement sum does not
+ * depend on the byte order (RFC 1071), so the checksum is returned in the
+ * byte order of the header.
+ *
+ * @param iph The IPv4 header
+ * @param ihl The length of the IPv4 header (in 32-bit words)
+ * @return    The IPv4 checksum
+ */
+static inline uint16_t ip_fast_csum_generic(const uint8_t *const iph,
+                                            const size_t ihl)
+{
+	uint64_t sum = 0;
+	size_t i;
+
+	for(i = 0; i < ihl; i++)
+	{
+		uint32_t word;
+		memcpy(&word, iph + i * sizeof(uint32_t), sizeof(uint32_t));
+		sum += word;
+	}
+
+	/* fold the 64-bit sum into 32 bits, then into 16 bits */
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+
+	return ~from32to16(sum);
+}
+
+
 #if defined(__i386__) || defined(__x86_64__)
 
 static inline uint16_t ip_fast_csum(const uint8_t *iph,
@@ -176,99 +237,22 @@ static inline uint16_t ip_fast_csum(const uint8_t *iph,
 
 #else
 
-static inline uint16_t from32to16(const uint32_t x)
-	__attribute__((warn_unused_result, const));
-
-static inline uint16_t from32to16(const uint32_t x)
-{
-	uint32_t y;
-	/* add up 16-bit and 16-bit for 16+c bit */
-	y = (x & 0xffff) + (x >> 16);
-	/* add up carry.. */
-	y = (y & 0xffff) + (y >> 16);
-	return y;
-}
-
 static inline uint16_t ip_fast_csum(const uint8_t *const iph,
                                     const size_t ihl)
 	__attribute__((nonnull(1), warn_unused_result, pure));
 
 /**
- *  This is a version of ip_compute_csum() optimized for IP headers,
- *  which always checksum on 4 octet boundaries.
+ * @brief This is a version of ip_compute_csum() optimized for IP headers,
+ *        which always checksum on 4 octet boundaries.
+ *
+ * @param iph The IPv4 header
+ * @param ihl The length of the IPv4 header (in 32-bit words)
+ * @return    The IPv4 checksum
  */
 static inline uint16_t ip_fast_csum(const uint8_t *const iph,
                                     const size_t ihl)
 {
-	const uint8_t *buff = iph;
-	size_t len = ihl * 4;
-	bool odd;
-	size_t count;
-	uint32_t result = 0;
-
-	if(len == 0)
-	{
-		goto out;
-	}
-	odd = 1 & (uintptr_t) buff;
-	if(odd)
-	{
-#ifdef __LITTLE_ENDIAN
-		result = *buff;
-#else
-		result += (*buff << 8);
-#endif
-		len--;
-		buff++;
-	}
-	count = len >> 1; /* nr of 16-bit words.. */
-	if(count)
-	{
-		if(2 & (uintptr_t) buff)
-		{
-			result += *(uint16_t *) buff;
-			count--;
-			len -= 2;
-			buff += 2;
-		}
-		count >>= 1; /* nr of 32-bit words.. */
-		if(count)
-		{
-			uint32_t carry = 0;
-			do
-			{
-				uint32_t word = *(uint32_t *) buff;
-				count--;
-				buff += sizeof(uint32_t);
-				result += carry;
-				result += word;
-				carry = (word > result);
-			}
-			while(count);
-			result += carry;
-			result = (result & 0xffff) + (result >> 16);
-		}
-		if(len & 2)
-		{
-			result += *(uint16_t *) buff;
-			buff += 2;
-		}
-	}
-	if(len & 1)
-	{
-#ifdef __LITTLE_ENDIAN
-		result += *buff;
-#else
-		result += (*buff << 8);
-#endif
-	}
-	result = from32to16(result);
-	if(odd)
-	{
-		result = ((result >> 8) & 0xff) | ((result & 0xff) << 8);
-	}
-out:
-	return ~result;
+	return ip_fast_csum_generic(iph, ihl);
 }
 
 
@@ -324,19 +308,6 @@ unsigned int ip_get_tos(const struct ip_packet *const ip)
 unsigned int ip_get_ttl(const struct ip_packet *const ip)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 
-void ip_set_version(struct ip_packet *const ip, const ip_version value)
-	__attribute__((nonnull(1)));
-void ip_set_protocol(struct ip_packet *const ip, const uint8_t value)
-	__attribute__((nonnull(1)));
-void ip_set_tos(struct ip_packet *const ip, const uint8_t value)
-	__attribute__((nonnull(1)));
-void ip_set_ttl(struct ip_packet *const ip, const uint8_t value)
-	__attribute__((nonnull(1)));
-void ip_set_saddr(struct ip_packet *const ip, const uint8_t *value)
-	__attribute__((nonnull(1, 2)));
-void ip_set_daddr(struct ip_packet *const ip, const uint8_t *value)
-	__attribute__((nonnull(1, 2)));
-
 /* IPv4 specific functions */
 
 static inline
@@ -355,11 +326,6 @@ uint32_t ipv4_get_saddr(const struct ip_packet *const ip)
 uint32_t ipv4_get_daddr(const struct ip_packet *const ip)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 
-void ipv4_set_id(struct ip_packet *const ip, const int value)
-	__attribute__((nonnull(1)));
-void ipv4_set_df(struct ip_packet *const ip, const int value)
-	__attribute__((nonnull(1)));
-
 /* IPv6 specific functions */
 
 static inline
@@ -373,8 +339,6 @@ const struct ipv6_addr * ipv6_get_saddr(const struct ip_packet *const ip)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 const struct ipv6_addr * ipv6_get_daddr(const struct ip_packet *const ip)
 	__attribute__((warn_unused_result, nonnull(1), pure));
-void ip_set_flow_label(struct ip_packet *const ip, const uint32_t value)
-	__attribute__((nonnull(1)));
 unsigned short ip_get_extension_size(const uint8_t *const ext)
 	__attribute__((warn_unused_result, nonnull(1), pure));
 unsigned short ip_get_total_extension_size(const struct ip_packet *const ip)
@@ -400,7 +364,7 @@ ip_version ip_get_version(const struct ip_packet *const ip)
 static inline
 size_t ipv4_get_hdrlen(const struct ip_packet *const ip)
 {
-	return (ip->header.v4.ihl * 4);
+	return (ip->header.v4->ihl * 4);
 }
 
 
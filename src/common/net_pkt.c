@@ -29,19 +29,39 @@
 #include "rohc_traces_internal.h"
 
 
+static bool net_pkt_check_ip_csum(const struct ip_packet *const ip,
+                                  const bool check_csum)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+static rohc_ctxt_key_t net_pkt_compute_key(const struct net_pkt *const packet)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
+static rohc_ctxt_key_t net_pkt_key_add_ip(const rohc_ctxt_key_t key,
+                                          const struct ip_packet *const ip)
+	__attribute__((warn_unused_result, nonnull(2), pure));
+
+static inline rohc_ctxt_key_t net_pkt_key_add(const rohc_ctxt_key_t key,
+                                              const uint32_t value)
+	__attribute__((warn_unused_result, const));
+
+
 /**
  * @brief Parse a network packet
  *
  * @param[out] packet    The parsed packet
  * @param data           The data to parse
+ * @param check_csums    Whether to verify the checksums of IPv4 headers
  * @param trace_cb       The function to call for printing traces
  * @param trace_cb_priv  An optional private context, may be NULL
+ * @param trace_level    The lowest level of the traces to print
  * @param trace_entity   The entity that emits the traces
  */
 void net_pkt_parse(struct net_pkt *const packet,
                    const struct rohc_buf data,
+                   const bool check_csums,
                    rohc_trace_callback2_t trace_cb,
                    void *const trace_cb_priv,
+                   const rohc_trace_level_t trace_level,
                    rohc_trace_entity_t trace_entity)
 {
 	packet->time = data.time;
@@ -52,10 +72,13 @@ void net_pkt_parse(struct net_pkt *const packet,
 	/* traces */
 	packet->trace_callback = trace_cb;
 	packet->trace_callback_priv = trace_cb_priv;
+	packet->trace_level = trace_level;
 
 	/* create the outer IP packet from raw data */
 	ip_create(&packet->outer_ip, rohc_buf_data(data), data.len);
 	packet->ip_hdr_nr++;
+	packet->ip_csum_ok[0] = net_pkt_check_ip_csum(&packet->outer_ip, check_csums);
+	packet->ip_csum_ok[1] = true;
 	rohc_debug(packet, trace_entity, ROHC_PROFILE_GENERAL,
 	           "outer IP header: %u bytes", ip_get_totlen(&packet->outer_ip));
 	rohc_debug(packet, trace_entity, ROHC_PROFILE_GENERAL,
@@ -82,6 +105,7 @@ void net_pkt_parse(struct net_pkt *const packet,
 		/* create the second IP header */
 		ip_get_inner_packet(&packet->outer_ip, &packet->inner_ip);
 		packet->ip_hdr_nr++;
+		packet->ip_csum_ok[1] = net_pkt_check_ip_csum(&packet->inner_ip, check_csums);
 		rohc_debug(packet, trace_entity, ROHC_PROFILE_GENERAL,
 		           "inner IP header: %u bytes", ip_get_totlen(&packet->inner_ip));
 		rohc_debug(packet, trace_entity, ROHC_PROFILE_GENERAL,
@@ -102,6 +126,12 @@ void net_pkt_parse(struct net_pkt *const packet,
 		/* get the transport protocol */
 		packet->transport = &packet->inner_ip.nl;
 	}
+
+	/* compute the key of the flow once for all, it is used to find out the
+	 * compression context of the packet */
+	packet->key = net_pkt_compute_key(packet);
+	rohc_debug(packet, trace_entity, ROHC_PROFILE_GENERAL,
+	           "flow key = 0x%08x", packet->key);
 }
 
 
@@ -133,3 +163,123 @@ size_t net_pkt_get_payload_offset(const struct net_pkt *const packet)
 	return payload_offset;
 }
 
+
+
+/**
+ * @brief Verify the checksum of the given IP header
+ *
+ * Only IPv4 headers with at least the minimal header length are verified.
+ *
+ * @param ip          The IP header to verify
+ * @param check_csum  Whether the checksum shall be verified or not
+ * @return            false if the IPv4 checksum is wrong, true otherwise
+ */
+static bool net_pkt_check_ip_csum(const struct ip_packet *const ip,
+                                  const bool check_csum)
+{
+	if(!check_csum ||
+	   (ip->version != IPV4 && ip->version != IPV4_MALFORMED) ||
+	   ip->size < sizeof(struct ipv4_hdr))
+	{
+		return true;
+	}
+
+	return (ip_fast_csum(ip->data, sizeof(struct ipv4_hdr) / sizeof(uint32_t)) == 0);
+}
+
+
+/**
+ * @brief Compute the key of the flow the given packet belongs to
+ *
+ * The key is computed from the fields that identify a flow: the IP versions,
+ * the IP addresses, the IPv6 Flow Labels, the transport protocol and the
+ * transport ports (UDP, UDP-Lite, TCP) or the SPI (ESP).
+ *
+ * The key is not guaranteed unique: two different flows may share the same
+ * key. However, two packets of the same flow always get the same key.
+ *
+ * @param packet  The packet to compute the flow key for
+ * @return        The flow key
+ */
+static rohc_ctxt_key_t net_pkt_compute_key(const struct net_pkt *const packet)
+{
+	const struct net_hdr *const transport = packet->transport;
+	rohc_ctxt_key_t key = 0;
+
+	/* the outer IP header, and the inner IP header if any */
+	key = net_pkt_key_add_ip(key, &packet->outer_ip);
+	if(packet->ip_hdr_nr > 1)
+	{
+		key = net_pkt_key_add_ip(key, &packet->inner_ip);
+	}
+
+	/* the transport protocol and its flow identifiers if any */
+	key = net_pkt_key_add(key, transport->proto);
+	if(transport->data != NULL && transport->len >= sizeof(uint32_t))
+	{
+		const uint8_t *const data = transport->data;
+
+		switch(transport->proto)
+		{
+			case ROHC_IPPROTO_UDP:
+			case ROHC_IPPROTO_UDPLITE:
+			case ROHC_IPPROTO_TCP: /* source and destination ports */
+			case ROHC_IPPROTO_ESP: /* SPI */
+				key = net_pkt_key_add(key, (data[0] << 24) | (data[1] << 16) |
+				                           (data[2] << 8) | data[3]);
+				break;
+			default:
+				break;
+		}
+	}
+
+	return key;
+}
+
+
+/**
+ * @brief Add the flow identifiers of the given IP header to a flow key
+ *
+ * @param key  The flow key computed so far
+ * @param ip   The IP header to add to the flow key
+ * @return     The updated flow key
+ */
+static rohc_ctxt_key_t net_pkt_key_add_ip(const rohc_ctxt_key_t key,
+                                          const struct ip_packet *const ip)
+{
+	rohc_ctxt_key_t new_key = net_pkt_key_add(key, ip->version);
+
+	if(ip->version == IPV4)
+	{
+		new_key = net_pkt_key_add(new_key, ip->header.v4->saddr);
+		new_key = net_pkt_key_add(new_key, ip->header.v4->daddr);
+	}
+	else if(ip->version == IPV6)
+	{
+		size_t i;
+
+		for(i = 0; i < 4; i++)
+		{
+			new_key = net_pkt_key_add(new_key, ip->header.v6->saddr.u32[i]);
+			new_key = net_pkt_key_add(new_key, ip->header.v6->daddr.u32[i]);
+		}
+		new_key = net_pkt_key_add(new_key, ipv6_get_flow_label(ip->header.v6));
+	}
+
+	return new_key;
+}
+
+
+/**
+ * @brief Mix one 32-bit value into a flow key
+ *
+ * @param key    The flow key computed so far
+ * @param value  The 32-bit value to mix into the flow key
+ * @return       The updated flow key
+ */
+static inline rohc_ctxt_key_t net_pkt_key_add(const rohc_ctxt_key_t key,
+                                              const uint32_t value)
+{
+	const uint32_t mixed = (key ^ value) * 0x9e3779b1U;
+	return ((mixed << 15) | (mixed >> 17));
+}
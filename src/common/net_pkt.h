@@ -49,17 +49,28 @@ struct net_pkt
 
 	struct net_hdr *transport;   /**< The transport layer of the packet if any */
 
+	/** Whether the checksums of the outer and inner IPv4 headers are correct:
+	 *  verified once at parsing, always true for IPv6 headers or when the
+	 *  checksums are not verified */
+	bool ip_csum_ok[2];
+
+	rohc_ctxt_key_t key;         /**< The key of the flow the packet belongs to */
+
 	/** The callback function used to manage traces */
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The lowest level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
 };
 
 
 void net_pkt_parse(struct net_pkt *const packet,
                    const struct rohc_buf data,
+                   const bool check_csums,
                    rohc_trace_callback2_t trace_cb,
                    void *const trace_cb_priv,
+                   const rohc_trace_level_t trace_level,
                    rohc_trace_entity_t trace_entity)
 	__attribute__((nonnull(1)));
 
@@ -34,6 +34,7 @@ extern "C"
 
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
 
 
 /** Macro that handles deprecated declarations gracefully */
@@ -234,6 +235,119 @@ typedef enum
 } rohc_profile_t;
 
 
+/**
+ * @brief The prototype of the memory allocation callback
+ *
+ * User-defined function that is called by the ROHC library every time it
+ * needs memory for the compression or decompression contexts. The library
+ * requests large blocks and splits them itself in cache-line-aligned
+ * objects, so the callback is seldom called once the flows are set up.
+ *
+ * The user-defined function is set by calling the function
+ * \ref rohc_comp_set_allocator or \ref rohc_decomp_set_allocator
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param size       The number of bytes to allocate
+ * @return           The allocated memory, NULL in case of failure
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_set_allocator
+ * @see rohc_decomp_set_allocator
+ */
+typedef void * (*rohc_malloc_cb_t)(void *const priv_ctxt, const size_t size)
+	__attribute__((warn_unused_result));
+
+
+/**
+ * @brief The prototype of the memory release callback
+ *
+ * User-defined function that is called by the ROHC library to give back the
+ * memory obtained with the \ref rohc_malloc_cb_t callback.
+ *
+ * @param priv_ctxt  An optional private context, may be NULL
+ * @param ptr        The memory to release
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_set_allocator
+ * @see rohc_decomp_set_allocator
+ */
+typedef void (*rohc_free_cb_t)(void *const priv_ctxt, void *const ptr);
+
+
+/**
+ * @brief The timing counter of one stage of the compression or decompression
+ *
+ * The counters are filled only if the library was built with the option
+ * --enable-rohc-perf-counters of the configure script. The time is measured
+ * in CPU cycles (Time Stamp Counter) on x86 and in nanoseconds on the other
+ * architectures.
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_get_perf_counters
+ * @see rohc_decomp_get_perf_counters
+ */
+typedef struct
+{
+	/** The time spent in the stage since the creation of the (de)compressor */
+	uint64_t cycles;
+	/** The number of times the stage was run */
+	uint64_t calls;
+} __attribute__((packed)) rohc_perf_counter_t;
+
+
+/**
+ * @brief The statistics of one compressor, decompressor or context
+ *
+ * The structure is used by the \ref rohc_comp_get_stats,
+ * \ref rohc_comp_get_ctxt_stats, \ref rohc_decomp_get_stats and
+ * \ref rohc_decomp_get_ctxt_stats functions to store a consistent snapshot
+ * of the statistics. Unlike the other information functions, they may be
+ * called from another thread than the one that compresses or decompresses.
+ *
+ * Versioning works as follow:
+ *  - The \e version_major field defines the compatibility level. If the major
+ *    number given by user does not match the one expected by the library,
+ *    an error is returned.
+ *  - The \e version_minor field defines the extension level. If the minor
+ *    number given by user does not match the one expected by the library,
+ *    only the fields supported in that minor version will be filled.
+ *
+ * Supported versions:
+ *  - major 0 and minor = 0 contains: version_major, version_minor,
+ *    packets_nr, failures_nr, uncomp_bytes_nr, comp_bytes_nr,
+ *    uncomp_hdr_bytes_nr and comp_hdr_bytes_nr.
+ *
+ * @ingroup rohc
+ *
+ * @see rohc_comp_get_stats
+ * @see rohc_comp_get_ctxt_stats
+ * @see rohc_decomp_get_stats
+ * @see rohc_decomp_get_ctxt_stats
+ */
+typedef struct
+{
+	/** The major version of this structure */
+	unsigned short version_major;
+	/** The minor version of this structure */
+	unsigned short version_minor;
+	/** The number of packets successfully compressed or decompressed */
+	uint64_t packets_nr;
+	/** The number of packets that failed to be compressed or decompressed */
+	uint64_t failures_nr;
+	/** The number of bytes of the uncompressed packets */
+	uint64_t uncomp_bytes_nr;
+	/** The number of bytes of the compressed packets */
+	uint64_t comp_bytes_nr;
+	/** The number of bytes of the uncompressed headers */
+	uint64_t uncomp_hdr_bytes_nr;
+	/** The number of bytes of the compressed headers */
+	uint64_t comp_hdr_bytes_nr;
+} __attribute__((packed)) rohc_stats_t;
+
+
 
 /*
  * Prototypes of public functions
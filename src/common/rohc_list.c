@@ -24,6 +24,7 @@
  */
 
 #include "rohc_list.h"
+#include "rohc_debug.h" /* for zfree() */
 
 #include <stdlib.h>
 #include <string.h>
@@ -113,9 +114,28 @@ bool rohc_list_supersede(const struct rohc_list *const large,
 }
 
 
+/**
+ * @brief Initialize the given list item
+ *
+ * No memory is allocated for the item data until the item is updated.
+ *
+ * @param list_item  The item to initialize
+ */
+void rohc_list_item_init(struct rohc_list_item *const list_item)
+{
+	assert(list_item != NULL);
+
+	list_item->data_max_len = 0;
+	list_item->data = NULL;
+	rohc_list_item_reset(list_item);
+}
+
+
 /**
  * @brief Reset the given list item
  *
+ * The memory allocated for the item data is kept for the next update.
+ *
  * @param list_item  The item to reset
  */
 void rohc_list_item_reset(struct rohc_list_item *const list_item)
@@ -131,6 +151,21 @@ void rohc_list_item_reset(struct rohc_list_item *const list_item)
 }
 
 
+/**
+ * @brief Free the memory allocated for the given list item
+ *
+ * @param list_item  The item to free
+ */
+void rohc_list_item_free(struct rohc_list_item *const list_item)
+{
+	assert(list_item != NULL);
+
+	zfree(list_item->data);
+	list_item->data_max_len = 0;
+	rohc_list_item_reset(list_item);
+}
+
+
 /**
  * @brief Update the content of the given compressed item if it changed
  *
@@ -196,6 +231,18 @@ static bool rohc_list_item_update(struct rohc_list_item *const list_item,
 	{
 		return false;
 	}
+	if(item_len > list_item->data_max_len)
+	{
+		/* the item data grows, allocate a larger buffer */
+		uint8_t *const data = malloc(item_len);
+		if(data == NULL)
+		{
+			return false;
+		}
+		free(list_item->data);
+		list_item->data = data;
+		list_item->data_max_len = item_len;
+	}
 	memcpy(list_item->data, item_data, item_len);
 	list_item->length = item_len;
 	list_item->type = item_type;
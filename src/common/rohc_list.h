@@ -97,8 +97,11 @@ struct rohc_list_item
 
 	/** The length of the item data (in bytes) */
 	size_t length;
-	/** The item data */
-	uint8_t data[ROHC_LIST_ITEM_DATA_MAX];
+	/** The number of bytes allocated for the item data */
+	size_t data_max_len;
+	/** The item data, allocated when the item is updated for the first time
+	 *  and grown as needed up to \ref ROHC_LIST_ITEM_DATA_MAX bytes */
+	uint8_t *data;
 };
 
 
@@ -126,9 +129,15 @@ bool rohc_list_supersede(const struct rohc_list *const large,
                          const struct rohc_list *const small)
 	__attribute__((warn_unused_result, nonnull(1, 2), pure));
 
+void rohc_list_item_init(struct rohc_list_item *const list_item)
+	__attribute__((nonnull(1)));
+
 void rohc_list_item_reset(struct rohc_list_item *const list_item)
 	__attribute__((nonnull(1)));
 
+void rohc_list_item_free(struct rohc_list_item *const list_item)
+	__attribute__((nonnull(1)));
+
 int rohc_list_item_update_if_changed(rohc_list_item_cmp cmp_item,
                                      struct rohc_list_item *const list_item,
                                      const uint8_t item_type,
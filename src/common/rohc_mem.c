@@ -0,0 +1,456 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_mem.c
+ * @brief  Pools of fixed-size objects for the compression/decompression contexts
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_mem.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+
+/**
+ * The header word that precedes every object is either the address of the
+ * pool of the object, or the address of the description of an object that
+ * was allocated alone with the lowest bit set.
+ */
+typedef uintptr_t rohc_mem_hdr_t;
+
+/** The bit of the header word set for the objects allocated alone */
+#define ROHC_MEM_HDR_ALONE  ((rohc_mem_hdr_t) 1U)
+
+
+/** One free object of a pool, the link is stored in the object itself */
+struct rohc_mem_obj
+{
+	struct rohc_mem_obj *next_free;  /**< The next free object of the pool */
+};
+
+
+/** The description of one object allocated alone, in the cache line that
+ *  precedes the object */
+struct rohc_mem_alone
+{
+	struct rohc_mem *mem;  /**< The memory the object was allocated from */
+	void *block;           /**< The block returned by the allocator */
+};
+
+#if ((defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L) || \
+     (defined(__GNUC__) && defined(__GNUC_MINOR__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6))))
+_Static_assert(sizeof(struct rohc_mem_slab) + sizeof(rohc_mem_hdr_t) <=
+               ROHC_MEM_CACHE_LINE,
+               "slab header and header word of first object should share "
+               "one cache line");
+_Static_assert(sizeof(struct rohc_mem_alone) + sizeof(rohc_mem_hdr_t) <=
+               ROHC_MEM_CACHE_LINE,
+               "description and header word of object allocated alone should "
+               "share one cache line");
+#endif
+
+
+/*
+ * Prototypes of private functions
+ */
+
+static void * rohc_mem_get_block(struct rohc_mem *const mem, const size_t size)
+	__attribute__((warn_unused_result, nonnull(1)));
+static void rohc_mem_put_block(struct rohc_mem *const mem, void *const block)
+	__attribute__((nonnull(1, 2)));
+
+static struct rohc_mem_pool * rohc_mem_find_pool(struct rohc_mem *const mem,
+                                                 const size_t obj_size)
+	__attribute__((warn_unused_result, nonnull(1)));
+static bool rohc_mem_grow_pool(struct rohc_mem *const mem,
+                               struct rohc_mem_pool *const pool)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static inline void * rohc_mem_align(void *const ptr)
+	__attribute__((warn_unused_result, const));
+static inline rohc_mem_hdr_t * rohc_mem_hdr(void *const obj)
+	__attribute__((warn_unused_result, const));
+
+
+/*
+ * Definitions of public functions
+ */
+
+
+/**
+ * @brief Initialize the memory of one compressor or decompressor
+ *
+ * No memory is allocated until the first object is requested. The default
+ * allocator is used until another one is set.
+ *
+ * @param mem  The memory to initialize
+ */
+void rohc_mem_init(struct rohc_mem *const mem)
+{
+	memset(mem, 0, sizeof(struct rohc_mem));
+}
+
+
+/**
+ * @brief Release all the slabs of the pools
+ *
+ * All the objects shall have been released before.
+ *
+ * @param mem  The memory to release
+ */
+void rohc_mem_release(struct rohc_mem *const mem)
+{
+	size_t i;
+
+	for(i = 0; i < mem->pools_nr; i++)
+	{
+		struct rohc_mem_slab *slab = mem->pools[i].slabs;
+
+		while(slab != NULL)
+		{
+			struct rohc_mem_slab *const next_slab = slab->next;
+			rohc_mem_put_block(mem, slab->block);
+			slab = next_slab;
+		}
+		mem->pools[i].slabs = NULL;
+		mem->pools[i].free_objs = NULL;
+	}
+	mem->pools_nr = 0;
+}
+
+
+/**
+ * @brief Set the allocator that provides the memory for the pools
+ *
+ * The allocator cannot be changed once some memory was obtained from the
+ * current one.
+ *
+ * @param mem        The memory to configure
+ * @param malloc_cb  The allocation callback, NULL for the default allocator
+ * @param free_cb    The release callback, NULL for the default allocator
+ * @param priv_ctxt  The private context given to the callbacks
+ * @return           true if the allocator was set,
+ *                   false if the callbacks are not consistent or if some
+ *                   memory is already in use
+ */
+bool rohc_mem_set_allocator(struct rohc_mem *const mem,
+                            rohc_malloc_cb_t malloc_cb,
+                            rohc_free_cb_t free_cb,
+                            void *const priv_ctxt)
+{
+	/* both callbacks or none of them */
+	if((malloc_cb == NULL) != (free_cb == NULL))
+	{
+		goto error;
+	}
+
+	/* blocks shall be given back to the allocator they come from */
+	if(mem->blocks_nr > 0)
+	{
+		goto error;
+	}
+
+	mem->malloc_cb = malloc_cb;
+	mem->free_cb = free_cb;
+	mem->priv_ctxt = priv_ctxt;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Allocate one object aligned on a cache line
+ *
+ * The object is taken from the pool of the objects of the same size if
+ * possible. The pool is created or grown if needed.
+ *
+ * @param mem   The memory to allocate the object from
+ * @param size  The size of the object
+ * @return      The uninitialized object, NULL if no memory is available
+ */
+void * rohc_mem_alloc(struct rohc_mem *const mem, const size_t size)
+{
+	const size_t obj_size =
+		(size + sizeof(rohc_mem_hdr_t) + ROHC_MEM_CACHE_LINE - 1) &
+		~((size_t) ROHC_MEM_CACHE_LINE - 1);
+	struct rohc_mem_pool *const pool = rohc_mem_find_pool(mem, obj_size);
+	void *obj;
+
+	if(pool != NULL)
+	{
+		/* take the first free object of the pool, its header word was set
+		 * once for all when the slab was created */
+		if(pool->free_objs == NULL && !rohc_mem_grow_pool(mem, pool))
+		{
+			goto error;
+		}
+		obj = pool->free_objs;
+		pool->free_objs = pool->free_objs->next_free;
+	}
+	else
+	{
+		/* too many different sizes, allocate the object alone: its description
+		 * takes the first cache line */
+		struct rohc_mem_alone *alone;
+		void *const block =
+			rohc_mem_get_block(mem, ROHC_MEM_CACHE_LINE + obj_size +
+			                   ROHC_MEM_CACHE_LINE - 1);
+		if(block == NULL)
+		{
+			goto error;
+		}
+		alone = rohc_mem_align(block);
+		alone->mem = mem;
+		alone->block = block;
+		obj = ((uint8_t *) alone) + ROHC_MEM_CACHE_LINE;
+		*rohc_mem_hdr(obj) = ((rohc_mem_hdr_t) alone) | ROHC_MEM_HDR_ALONE;
+	}
+
+	return obj;
+
+error:
+	return NULL;
+}
+
+
+/**
+ * @brief Allocate one object aligned on a cache line and zero it
+ *
+ * @param mem   The memory to allocate the object from
+ * @param size  The size of the object
+ * @return      The zeroed object, NULL if no memory is available
+ */
+void * rohc_mem_zalloc(struct rohc_mem *const mem, const size_t size)
+{
+	void *const ptr = rohc_mem_alloc(mem, size);
+
+	if(ptr != NULL)
+	{
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
+}
+
+
+/**
+ * @brief Release one object allocated with \ref rohc_mem_alloc
+ *
+ * The object goes back to its pool, or to the allocator if it was allocated
+ * alone. Nothing is done if the given pointer is NULL.
+ *
+ * @param ptr  The object to release, may be NULL
+ */
+void rohc_mem_free(void *const ptr)
+{
+	rohc_mem_hdr_t hdr;
+
+	if(ptr == NULL)
+	{
+		return;
+	}
+	hdr = *rohc_mem_hdr(ptr);
+
+	if((hdr & ROHC_MEM_HDR_ALONE) == 0)
+	{
+		struct rohc_mem_pool *const pool = (struct rohc_mem_pool *) hdr;
+		struct rohc_mem_obj *const obj = ptr;
+
+		obj->next_free = pool->free_objs;
+		pool->free_objs = obj;
+	}
+	else
+	{
+		const struct rohc_mem_alone *const alone =
+			(struct rohc_mem_alone *) (hdr & ~ROHC_MEM_HDR_ALONE);
+
+		rohc_mem_put_block(alone->mem, alone->block);
+	}
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Get one block of memory from the allocator
+ *
+ * @param mem   The memory to get the block for
+ * @param size  The size of the block
+ * @return      The block, NULL if no memory is available
+ */
+static void * rohc_mem_get_block(struct rohc_mem *const mem, const size_t size)
+{
+	void *block;
+
+	if(mem->malloc_cb != NULL)
+	{
+		block = mem->malloc_cb(mem->priv_ctxt, size);
+	}
+	else
+	{
+		block = malloc(size);
+	}
+	if(block != NULL)
+	{
+		mem->blocks_nr++;
+	}
+
+	return block;
+}
+
+
+/**
+ * @brief Give one block of memory back to the allocator
+ *
+ * @param mem    The memory the block was got for
+ * @param block  The block to release
+ */
+static void rohc_mem_put_block(struct rohc_mem *const mem, void *const block)
+{
+	assert(mem->blocks_nr > 0);
+	mem->blocks_nr--;
+
+	if(mem->free_cb != NULL)
+	{
+		mem->free_cb(mem->priv_ctxt, block);
+	}
+	else
+	{
+		free(block);
+	}
+}
+
+
+/**
+ * @brief Find the pool for the given size of objects, create it if needed
+ *
+ * @param mem       The memory to search for the pool
+ * @param obj_size  The space taken by one object (header word included)
+ * @return          The pool, NULL if all pools are used by other sizes
+ */
+static struct rohc_mem_pool * rohc_mem_find_pool(struct rohc_mem *const mem,
+                                                 const size_t obj_size)
+{
+	struct rohc_mem_pool *pool;
+	size_t i;
+
+	for(i = 0; i < mem->pools_nr; i++)
+	{
+		if(mem->pools[i].obj_size == obj_size)
+		{
+			return &(mem->pools[i]);
+		}
+	}
+
+	if(mem->pools_nr >= ROHC_MEM_POOLS_MAX)
+	{
+		return NULL;
+	}
+
+	pool = &(mem->pools[mem->pools_nr]);
+	pool->obj_size = obj_size;
+	pool->objs_per_slab = ROHC_MEM_SLAB_LEN / obj_size;
+	if(pool->objs_per_slab == 0)
+	{
+		pool->objs_per_slab = 1;
+	}
+	pool->free_objs = NULL;
+	pool->slabs = NULL;
+	mem->pools_nr++;
+
+	return pool;
+}
+
+
+/**
+ * @brief Add one slab of free objects to the given pool
+ *
+ * @param mem   The memory the pool belongs to
+ * @param pool  The pool to grow
+ * @return      true if the pool was grown, false if no memory is available
+ */
+static bool rohc_mem_grow_pool(struct rohc_mem *const mem,
+                               struct rohc_mem_pool *const pool)
+{
+	const size_t slab_len = ROHC_MEM_CACHE_LINE + pool->objs_per_slab * pool->obj_size;
+	struct rohc_mem_slab *slab;
+	uint8_t *objs;
+	void *block;
+	size_t i;
+
+	block = rohc_mem_get_block(mem, slab_len + ROHC_MEM_CACHE_LINE - 1);
+	if(block == NULL)
+	{
+		return false;
+	}
+	slab = rohc_mem_align(block);
+	slab->block = block;
+	slab->next = pool->slabs;
+	pool->slabs = slab;
+
+	/* chain the objects in address order, the slab header takes the first
+	 * cache line, the header word of every object is stored at the end of
+	 * the cache line that precedes it */
+	objs = ((uint8_t *) slab) + ROHC_MEM_CACHE_LINE;
+	for(i = pool->objs_per_slab; i > 0; i--)
+	{
+		struct rohc_mem_obj *const obj =
+			(struct rohc_mem_obj *) (objs + (i - 1) * pool->obj_size);
+		*rohc_mem_hdr(obj) = (rohc_mem_hdr_t) pool;
+		obj->next_free = pool->free_objs;
+		pool->free_objs = obj;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Align the given pointer on the next cache line
+ *
+ * @param ptr  The pointer to align
+ * @return     The aligned pointer
+ */
+static inline void * rohc_mem_align(void *const ptr)
+{
+	return (void *) (((uintptr_t) ptr + ROHC_MEM_CACHE_LINE - 1) &
+	                 ~((uintptr_t) ROHC_MEM_CACHE_LINE - 1));
+}
+
+
+/**
+ * @brief Get the header word of the given object
+ *
+ * @param obj  The object
+ * @return     The header word, located just before the object
+ */
+static inline rohc_mem_hdr_t * rohc_mem_hdr(void *const obj)
+{
+	return ((rohc_mem_hdr_t *) obj) - 1;
+}
+
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_mem.h
+ * @brief  Pools of fixed-size objects for the compression/decompression contexts
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The contexts of the compressor and of the decompressor are made of a few
+ * objects whose sizes only depend on the profile. The objects of one size
+ * are carved from large slabs and recycled through a free list, so that the
+ * creation of new contexts does not hit the general-purpose heap once the
+ * pools are warm.
+ *
+ * Every object is aligned on a cache line and is preceded by one word that
+ * records where it comes from, so that it may be released without any
+ * knowledge of its size or of its pool, just like with free(3). The word is
+ * stored in the padding at the end of the previous cache line, so an object
+ * costs its size rounded up to the next cache line, once the word is added.
+ */
+
+#ifndef ROHC_MEM_H
+#define ROHC_MEM_H
+
+#include "rohc.h"
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+
+/** The size of the cache lines the objects are aligned on */
+#define ROHC_MEM_CACHE_LINE  64U
+
+/** The maximum number of object sizes handled by the pools of one
+ *  compressor or decompressor, bigger objects are allocated one by one */
+#define ROHC_MEM_POOLS_MAX  16U
+
+/** The minimal amount of object memory to request at once for one pool */
+#define ROHC_MEM_SLAB_LEN  (16U * 1024U)
+
+
+struct rohc_mem;
+
+
+/** One slab of objects, located at the beginning of the allocated block */
+struct rohc_mem_slab
+{
+	struct rohc_mem_slab *next;  /**< The next slab of the same pool */
+	void *block;                 /**< The block returned by the allocator */
+};
+
+
+/** One pool of objects of the same size */
+struct rohc_mem_pool
+{
+	size_t obj_size;                 /**< The space taken by one object in a
+	                                      slab (header word included) */
+	size_t objs_per_slab;            /**< The number of objects per slab */
+	struct rohc_mem_obj *free_objs;  /**< The objects ready for use */
+	struct rohc_mem_slab *slabs;     /**< The slabs of the pool */
+};
+
+
+/** The memory of one compressor or decompressor */
+struct rohc_mem
+{
+	rohc_malloc_cb_t malloc_cb;  /**< The allocation callback, NULL for
+	                                  the default allocator */
+	rohc_free_cb_t free_cb;      /**< The release callback, NULL for the
+	                                  default allocator */
+	void *priv_ctxt;             /**< The private context of the callbacks */
+
+	size_t blocks_nr;            /**< The number of blocks obtained from the
+	                                  allocator and not released yet */
+
+	size_t pools_nr;                                /**< The number of pools */
+	struct rohc_mem_pool pools[ROHC_MEM_POOLS_MAX]; /**< The pools */
+};
+
+
+void rohc_mem_init(struct rohc_mem *const mem)
+	__attribute__((nonnull(1)));
+
+void rohc_mem_release(struct rohc_mem *const mem)
+	__attribute__((nonnull(1)));
+
+bool rohc_mem_set_allocator(struct rohc_mem *const mem,
+                            rohc_malloc_cb_t malloc_cb,
+                            rohc_free_cb_t free_cb,
+                            void *const priv_ctxt)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void * rohc_mem_alloc(struct rohc_mem *const mem, const size_t size)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void * rohc_mem_zalloc(struct rohc_mem *const mem, const size_t size)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+void rohc_mem_free(void *const ptr);
+
+
+/** Release an object plus set the pointer to NULL to avoid hidden bugs */
+#define rohc_mem_zfree(pointer) \
+	do { \
+		rohc_mem_free(pointer); \
+		pointer = NULL; \
+	} while(0)
+
+#endif
+
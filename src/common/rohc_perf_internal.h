@@ -0,0 +1,98 @@
+/*
+ * Copyright 2017 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    rohc_perf_internal.h
+ * @brief   ROHC internal timing counters for the stages of the hot path
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The counters are built only if the option --enable-rohc-perf-counters of
+ * the configure script is given. Otherwise, the macros below expand to
+ * nothing: the counters cost nothing at all, not even one test.
+ */
+
+#ifndef ROHC_PERF_INTERNAL_H
+#define ROHC_PERF_INTERNAL_H
+
+#include "rohc.h" /* for public definition of rohc_perf_counter_t */
+
+#ifndef __KERNEL__
+#  include "config.h" /* for ROHC_PERF_COUNTERS */
+#endif
+
+#include <stdint.h>
+
+#ifdef ROHC_PERF_COUNTERS
+
+#if defined(__KERNEL__)
+#  include <linux/timex.h>
+#elif !defined(__i386__) && !defined(__x86_64__)
+#  include <time.h>
+#endif
+
+
+static inline uint64_t rohc_perf_now(void)
+	__attribute__((warn_unused_result));
+
+
+/**
+ * @brief Get the current value of the clock used by the timing counters
+ *
+ * The Time Stamp Counter is read on x86, so the unit is the CPU cycle.
+ * The monotonic clock is read on other architectures, so the unit is the
+ * nanosecond. The kernel module relies on get_cycles().
+ *
+ * @return  The current value of the clock
+ */
+static inline uint64_t rohc_perf_now(void)
+{
+#if defined(__KERNEL__)
+	return get_cycles();
+#elif defined(__i386__) || defined(__x86_64__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((uint64_t) now.tv_sec) * 1000000000UL + now.tv_nsec;
+#endif
+}
+
+
+/** Start measuring one stage, the start time is stored in \e start */
+#define rohc_perf_start(start) \
+	const uint64_t start = rohc_perf_now()
+
+/** Stop measuring one stage, account its duration and call in \e counters */
+#define rohc_perf_stop(counters, stage, start) \
+	do { \
+		(counters)[(stage)].cycles += rohc_perf_now() - (start); \
+		(counters)[(stage)].calls++; \
+	} while(0)
+
+#else /* !ROHC_PERF_COUNTERS */
+
+#define rohc_perf_start(start) \
+	do { } while(0)
+
+#define rohc_perf_stop(counters, stage, start) \
+	do { } while(0)
+
+#endif /* ROHC_PERF_COUNTERS */
+
+#endif /* ROHC_PERF_INTERNAL_H */
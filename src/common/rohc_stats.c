@@ -0,0 +1,110 @@
+/*
+ * Copyright 2017 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_stats.c
+ * @brief  Statistics blocks that other threads may read without locking
+ * @author Didier Barvaux <didier@barvaux.org>
+ */
+
+#include "rohc_stats.h"
+
+#include <stdlib.h>
+
+
+/**
+ * @brief Allocate an array of zeroed statistics blocks
+ *
+ * The blocks are aligned on cache lines. The returned array shall not be
+ * freed: the memory block given back in \e mem shall be freed instead.
+ *
+ * @param blocks_nr  The number of statistics blocks to allocate
+ * @param[out] mem   The allocated memory block, to be freed with free(3)
+ * @return           The array of statistics blocks, NULL in case of failure
+ */
+struct rohc_stats * rohc_stats_new(const size_t blocks_nr, void **const mem)
+{
+	const size_t align = ROHC_MEM_CACHE_LINE;
+
+	/* one more alignment unit to align the start of the memory block */
+	*mem = calloc(1, blocks_nr * sizeof(struct rohc_stats) + align - 1);
+	if((*mem) == NULL)
+	{
+		return NULL;
+	}
+
+	return (struct rohc_stats *) (((uintptr_t) (*mem) + align - 1) &
+	                              ~((uintptr_t) align - 1));
+}
+
+
+/**
+ * @brief Reset all the counters of the given statistics block
+ *
+ * @param stats  The statistics block to reset
+ */
+void rohc_stats_reset(struct rohc_stats *const stats)
+{
+	rohc_stats_write_begin(stats);
+	stats->packets_nr = 0;
+	stats->failures_nr = 0;
+	stats->uncomp_bytes_nr = 0;
+	stats->comp_bytes_nr = 0;
+	stats->uncomp_hdr_bytes_nr = 0;
+	stats->comp_hdr_bytes_nr = 0;
+	rohc_stats_write_end(stats);
+}
+
+
+/**
+ * @brief Copy a consistent snapshot of the given statistics block
+ *
+ * The function may be called from any thread, even while the block is
+ * updated. It never blocks the writer: the copy is started again if the
+ * block was updated meanwhile.
+ *
+ * @param stats          The statistics block to read
+ * @param[out] snapshot  The snapshot of the statistics, the version fields
+ *                       are left untouched
+ */
+void rohc_stats_read(const struct rohc_stats *const stats,
+                     rohc_stats_t *const snapshot)
+{
+	uint32_t seq;
+
+	do
+	{
+		/* wait for the end of the ongoing update if any */
+		seq = __atomic_load_n(&stats->seq, __ATOMIC_ACQUIRE);
+		while((seq & 1) != 0)
+		{
+			seq = __atomic_load_n(&stats->seq, __ATOMIC_ACQUIRE);
+		}
+
+		snapshot->packets_nr = stats->packets_nr;
+		snapshot->failures_nr = stats->failures_nr;
+		snapshot->uncomp_bytes_nr = stats->uncomp_bytes_nr;
+		snapshot->comp_bytes_nr = stats->comp_bytes_nr;
+		snapshot->uncomp_hdr_bytes_nr = stats->uncomp_hdr_bytes_nr;
+		snapshot->comp_hdr_bytes_nr = stats->comp_hdr_bytes_nr;
+
+		/* the counters shall be read before the sequence is checked again */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	}
+	while(__atomic_load_n(&stats->seq, __ATOMIC_RELAXED) != seq);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2017 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file   rohc_stats.h
+ * @brief  Statistics blocks that other threads may read without locking
+ * @author Didier Barvaux <didier@barvaux.org>
+ *
+ * The statistics of one compressor or decompressor and of its contexts are
+ * stored apart from them, in blocks of one cache line each. A monitoring
+ * thread that reads them thus never shares a cache line with the fields
+ * used by the compression or decompression of packets.
+ *
+ * Every block is protected by a sequence lock. The thread that compresses
+ * or decompresses is the only writer: it makes the sequence odd before it
+ * updates the counters and even again once done, it never waits. The
+ * readers copy the counters and start again if the sequence was odd or
+ * changed during the copy.
+ */
+
+#ifndef ROHC_STATS_H
+#define ROHC_STATS_H
+
+#include "rohc.h"
+#include "rohc_mem.h" /* for ROHC_MEM_CACHE_LINE */
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/** The statistics of one compressor, decompressor or context */
+struct rohc_stats
+{
+	uint32_t seq;                 /**< The sequence, odd during updates */
+	uint64_t packets_nr;          /**< The number of successful packets */
+	uint64_t failures_nr;         /**< The number of failed packets */
+	uint64_t uncomp_bytes_nr;     /**< The bytes of uncompressed packets */
+	uint64_t comp_bytes_nr;       /**< The bytes of compressed packets */
+	uint64_t uncomp_hdr_bytes_nr; /**< The bytes of uncompressed headers */
+	uint64_t comp_hdr_bytes_nr;   /**< The bytes of compressed headers */
+} __attribute__((aligned(ROHC_MEM_CACHE_LINE)));
+
+
+struct rohc_stats * rohc_stats_new(const size_t blocks_nr, void **const mem)
+	__attribute__((warn_unused_result, nonnull(2)));
+
+void rohc_stats_reset(struct rohc_stats *const stats)
+	__attribute__((nonnull(1)));
+
+void rohc_stats_read(const struct rohc_stats *const stats,
+                     rohc_stats_t *const snapshot)
+	__attribute__((nonnull(1, 2)));
+
+
+static inline void rohc_stats_write_begin(struct rohc_stats *const stats)
+	__attribute__((nonnull(1)));
+static inline void rohc_stats_write_end(struct rohc_stats *const stats)
+	__attribute__((nonnull(1)));
+
+
+/**
+ * @brief Start updating the given statistics block
+ *
+ * The sequence becomes odd, so that readers wait for the end of the update.
+ * The sequence is stored before any of the counters.
+ *
+ * @param stats  The statistics block to update
+ */
+static inline void rohc_stats_write_begin(struct rohc_stats *const stats)
+{
+	__atomic_store_n(&stats->seq, stats->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Stop updating the given statistics block
+ *
+ * The sequence becomes even again, once all the counters were stored.
+ *
+ * @param stats  The statistics block that was updated
+ */
+static inline void rohc_stats_write_end(struct rohc_stats *const stats)
+{
+	__atomic_store_n(&stats->seq, stats->seq + 1, __ATOMIC_RELEASE);
+}
+
+#endif
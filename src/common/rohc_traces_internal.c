@@ -90,8 +90,8 @@ void rohc_dump_buf(const rohc_trace_callback2_t trace_cb,
 
 	if(length == 0)
 	{
-		__rohc_print(trace_cb, trace_cb_priv, ROHC_TRACE_DEBUG, trace_entity,
-		             ROHC_PROFILE_GENERAL, "%s (0 byte)", descr);
+		__rohc_print(trace_cb, trace_cb_priv, ROHC_TRACE_DEBUG, ROHC_TRACE_DEBUG,
+		             trace_entity, ROHC_PROFILE_GENERAL, "%s (0 byte)", descr);
 	}
 	else
 	{
@@ -103,8 +103,9 @@ void rohc_dump_buf(const rohc_trace_callback2_t trace_cb,
 		size_t line_index;
 		size_t i;
 
-		__rohc_print(trace_cb, trace_cb_priv, trace_level, trace_entity,
-		             ROHC_PROFILE_GENERAL, "%s (%zd bytes):", descr, length);
+		__rohc_print(trace_cb, trace_cb_priv, ROHC_TRACE_DEBUG, trace_level,
+		             trace_entity, ROHC_PROFILE_GENERAL, "%s (%zd bytes):",
+		             descr, length);
 		line_index = 0;
 		for(i = 0; i < length; i++)
 		{
@@ -112,8 +113,8 @@ void rohc_dump_buf(const rohc_trace_callback2_t trace_cb,
 			{
 				assert(line_index <= line_max);
 				line[line_index] = '\0';
-				__rohc_print(trace_cb, trace_cb_priv, trace_level, trace_entity,
-				             ROHC_PROFILE_GENERAL, "%s", line);
+				__rohc_print(trace_cb, trace_cb_priv, ROHC_TRACE_DEBUG, trace_level,
+				             trace_entity, ROHC_PROFILE_GENERAL, "%s", line);
 				line_index = 0;
 			}
 			else if(i > 0 && (i % 8) == 0)
@@ -132,8 +133,8 @@ void rohc_dump_buf(const rohc_trace_callback2_t trace_cb,
 		{
 			assert(line_index <= line_max);
 			line[line_index] = '\0';
-			__rohc_print(trace_cb, trace_cb_priv, trace_level, trace_entity,
-			             ROHC_PROFILE_GENERAL, "%s", line);
+			__rohc_print(trace_cb, trace_cb_priv, ROHC_TRACE_DEBUG, trace_level,
+			             trace_entity, ROHC_PROFILE_GENERAL, "%s", line);
 		}
 	}
 }
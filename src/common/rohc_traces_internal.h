@@ -33,15 +33,39 @@
 #include "rohc_traces.h"
 #include <rohc/rohc_buf.h>
 
+#ifndef __KERNEL__
+#  include "config.h" /* for ROHC_TRACES_MIN_LEVEL */
+#endif
+
 #include <stdlib.h>
 #include <assert.h>
 
 
-/** Print information depending on the debug level (internal usage) */
-#define __rohc_print(trace_cb, trace_cb_priv, \
+/**
+ * @brief The lowest level of traces built in the library
+ *
+ * The traces with a lower level are removed at build time: they cost
+ * nothing, not even the evaluation of their arguments. The option
+ * --disable-rohc-traces of the configure script removes the debug and info
+ * traces.
+ */
+#ifndef ROHC_TRACES_MIN_LEVEL
+#  define ROHC_TRACES_MIN_LEVEL ROHC_TRACE_DEBUG
+#endif
+
+/**
+ * @brief Print information depending on the debug level (internal usage)
+ *
+ * The levels are compared before the trace arguments are evaluated, so that
+ * filtered traces cost only one test, or nothing at all if their level is
+ * lower than \ref ROHC_TRACES_MIN_LEVEL.
+ */
+#define __rohc_print(trace_cb, trace_cb_priv, trace_min_level, \
                      level, entity, profile, format, ...) \
 	do { \
-		if(trace_cb != NULL) { \
+		if(((int) (level)) >= ((int) ROHC_TRACES_MIN_LEVEL) && \
+		   ((int) (level)) >= ((int) (trace_min_level)) && \
+		   trace_cb != NULL) { \
 			trace_cb(trace_cb_priv, level, entity, profile, \
 			         "[%s:%d %s()] " format "\n", \
 			         __FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__); \
@@ -53,6 +77,7 @@
 	do { \
 		__rohc_print((entity_struct)->trace_callback, \
 		             (entity_struct)->trace_callback_priv, \
+		             (entity_struct)->trace_level, \
 		             level, entity, profile, \
 		             format, ##__VA_ARGS__); \
 	} while(0)
@@ -0,0 +1,475 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_crc.c
+ * @brief   Test the CRC-3, CRC-7, CRC-8 and FCS-32 algorithms
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The CRCs computed by the library are compared with the ones computed
+ * byte per byte with 256-entry tables built from the polynoms, for all
+ * lengths and alignments.
+ * The \e bench mode measures the throughput of both algorithms for several
+ * packet sizes.
+ */
+
+#include "crc.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+
+/** The maximum length of data to compute CRCs on */
+#define TEST_CRC_MAX_LEN  2048U
+
+/** The number of bytes to compute CRCs on for every benchmark */
+#define BENCH_CRC_BYTES_NR  (64U * 1024U * 1024U)
+
+
+/** Print trace on stdout only in verbose mode */
+#define trace(is_verbose, format, ...) \
+	do { \
+		if(is_verbose) { \
+			printf(format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+
+/** The table for the FCS-32 reference algorithm */
+static uint32_t crc_ref_table_fcs32[256];
+
+
+static bool test_crc_8bits(const bool verbose,
+                           const rohc_crc_type_t crc_type,
+                           const uint8_t init_val,
+                           const uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(4)));
+static bool test_crc_fcs32(const bool verbose, const uint8_t *const data)
+	__attribute__((warn_unused_result, nonnull(2)));
+static void bench_crc(const uint8_t *const data)
+	__attribute__((nonnull(1)));
+
+static const uint8_t * crc_lib_table(const rohc_crc_type_t crc_type)
+	__attribute__((warn_unused_result));
+static void crc_ref_8bits_init(const rohc_crc_type_t crc_type,
+                               uint8_t *const crc_table)
+	__attribute__((nonnull(2)));
+static uint8_t crc_ref_8bits(const rohc_crc_type_t crc_type,
+                             const uint8_t *const data,
+                             const size_t length,
+                             const uint8_t init_val,
+                             const uint8_t *const crc_table)
+	__attribute__((warn_unused_result, nonnull(2, 5)));
+static void crc_ref_fcs32_init(void);
+static uint32_t crc_ref_fcs32(const uint8_t *const data,
+                              const size_t length,
+                              const uint32_t init_val)
+	__attribute__((warn_unused_result, nonnull(1)));
+static double bench_elapsed_ns(const struct timespec *const start,
+                               const struct timespec *const end)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+
+/**
+ * @brief Test the CRC algorithms
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if test succeeds, non-zero if test fails
+ */
+int main(int argc, char *argv[])
+{
+	static uint8_t data[TEST_CRC_MAX_LEN + 16];
+	bool verbose = false;
+	bool bench = false;
+	uint32_t seed = 0x12345678;
+	int is_failure = 1; /* test fails by default */
+	size_t i;
+
+	/* do we run in verbose or benchmark mode ? */
+	if(argc == 2 && strcmp(argv[1], "verbose") == 0)
+	{
+		verbose = true;
+	}
+	else if(argc == 2 && strcmp(argv[1], "bench") == 0)
+	{
+		bench = true;
+	}
+	else if(argc != 1)
+	{
+		/* invalid usage */
+		printf("test the CRC-3, CRC-7, CRC-8 and FCS-32 algorithms\n");
+		printf("usage: %s [verbose|bench]\n", argv[0]);
+		goto error;
+	}
+
+	crc_ref_fcs32_init();
+
+	/* fill data with pseudo-random bytes */
+	for(i = 0; i < sizeof(data); i++)
+	{
+		seed = seed * 1103515245U + 12345U;
+		data[i] = (seed >> 16) & 0xff;
+	}
+
+	if(bench)
+	{
+		bench_crc(data);
+	}
+	else
+	{
+		if(!test_crc_8bits(verbose, ROHC_CRC_TYPE_3, CRC_INIT_3, data) ||
+		   !test_crc_8bits(verbose, ROHC_CRC_TYPE_7, CRC_INIT_7, data) ||
+		   !test_crc_8bits(verbose, ROHC_CRC_TYPE_8, CRC_INIT_8, data) ||
+		   !test_crc_fcs32(verbose, data))
+		{
+			goto error;
+		}
+		trace(verbose, "all tests are successful\n");
+	}
+
+	/* test succeeds */
+	is_failure = 0;
+
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Compare one 8-bit CRC with the reference for all lengths/alignments
+ *
+ * @param verbose   Whether to print traces or not
+ * @param crc_type  The type of CRC to test
+ * @param init_val  The initial CRC value
+ * @param data      The data to compute CRCs on
+ * @return          true if the test succeeds, false otherwise
+ */
+static bool test_crc_8bits(const bool verbose,
+                           const rohc_crc_type_t crc_type,
+                           const uint8_t init_val,
+                           const uint8_t *const data)
+{
+	const uint8_t *const crc_table = crc_lib_table(crc_type);
+	uint8_t crc_ref_table[256];
+	size_t offset;
+	size_t len;
+
+	trace(verbose, "test CRC-%d\n", crc_type);
+	crc_ref_8bits_init(crc_type, crc_ref_table);
+
+	for(offset = 0; offset < 16; offset++)
+	{
+		for(len = 0; len <= TEST_CRC_MAX_LEN; len++)
+		{
+			const uint8_t crc_ref =
+				crc_ref_8bits(crc_type, data + offset, len, init_val, crc_ref_table);
+			const uint8_t crc =
+				crc_calculate(crc_type, data + offset, len, init_val, crc_table);
+
+			if(crc != crc_ref)
+			{
+				printf("CRC-%d mismatch for %zu bytes at offset %zu: 0x%02x "
+				       "computed while 0x%02x expected\n", crc_type, len, offset,
+				       crc, crc_ref);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Compare the FCS-32 with the reference for all lengths/alignments
+ *
+ * @param verbose   Whether to print traces or not
+ * @param data      The data to compute CRCs on
+ * @return          true if the test succeeds, false otherwise
+ */
+static bool test_crc_fcs32(const bool verbose, const uint8_t *const data)
+{
+	size_t offset;
+	size_t len;
+
+	trace(verbose, "test FCS-32\n");
+
+	for(offset = 0; offset < 16; offset++)
+	{
+		for(len = 0; len <= TEST_CRC_MAX_LEN; len++)
+		{
+			const uint32_t crc_ref =
+				crc_ref_fcs32(data + offset, len, CRC_INIT_FCS32);
+			const uint32_t crc =
+				crc_calc_fcs32(data + offset, len, CRC_INIT_FCS32);
+
+			if(crc != crc_ref)
+			{
+				printf("FCS-32 mismatch for %zu bytes at offset %zu: 0x%08x "
+				       "computed while 0x%08x expected\n", len, offset, crc,
+				       crc_ref);
+				return false;
+			}
+		}
+	}
+
+	/* the well-known check value of the CRC-32 used by FCS-32 */
+	if((crc_calc_fcs32((const uint8_t *) "123456789", 9, CRC_INIT_FCS32) ^
+	    0xffffffff) != 0xcbf43926)
+	{
+		printf("FCS-32 check value mismatch\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * @brief Measure the throughput of the CRC algorithms for several sizes
+ *
+ * @param data  The data to compute CRCs on
+ */
+static void bench_crc(const uint8_t *const data)
+{
+	const size_t sizes[] = { 4, 8, 20, 40, 60, 100, 256, 576, 1500 };
+	const size_t sizes_nr = sizeof(sizes) / sizeof(sizes[0]);
+	const rohc_crc_type_t crc_types[] =
+		{ ROHC_CRC_TYPE_3, ROHC_CRC_TYPE_7, ROHC_CRC_TYPE_8, ROHC_CRC_TYPE_NONE };
+	const size_t crc_types_nr = sizeof(crc_types) / sizeof(crc_types[0]);
+	uint8_t crc_ref_table[256];
+	size_t type_idx;
+
+	printf("%-8s %6s %14s %14s %8s\n", "CRC", "size", "ref (ns/pkt)",
+	       "lib (ns/pkt)", "speedup");
+
+	for(type_idx = 0; type_idx < crc_types_nr; type_idx++)
+	{
+		const rohc_crc_type_t crc_type = crc_types[type_idx];
+		size_t size_idx;
+
+		if(crc_type != ROHC_CRC_TYPE_NONE)
+		{
+			crc_ref_8bits_init(crc_type, crc_ref_table);
+		}
+
+		for(size_idx = 0; size_idx < sizes_nr; size_idx++)
+		{
+			const size_t size = sizes[size_idx];
+			const size_t iters_nr = BENCH_CRC_BYTES_NR / size;
+			struct timespec start;
+			struct timespec end;
+			volatile uint32_t sink = 0;
+			double ref_ns;
+			double lib_ns;
+			size_t i;
+
+			/* reference: one byte per table lookup */
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for(i = 0; i < iters_nr; i++)
+			{
+				if(crc_type == ROHC_CRC_TYPE_NONE)
+				{
+					sink += crc_ref_fcs32(data + (i & 15), size, CRC_INIT_FCS32);
+				}
+				else
+				{
+					sink += crc_ref_8bits(crc_type, data + (i & 15), size, 0,
+					                      crc_ref_table);
+				}
+			}
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			ref_ns = bench_elapsed_ns(&start, &end) / iters_nr;
+
+			/* library */
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for(i = 0; i < iters_nr; i++)
+			{
+				if(crc_type == ROHC_CRC_TYPE_NONE)
+				{
+					sink += crc_calc_fcs32(data + (i & 15), size, CRC_INIT_FCS32);
+				}
+				else
+				{
+					sink += crc_calculate(crc_type, data + (i & 15), size, 0,
+					                      crc_lib_table(crc_type));
+				}
+			}
+			clock_gettime(CLOCK_MONOTONIC, &end);
+			lib_ns = bench_elapsed_ns(&start, &end) / iters_nr;
+
+			if(crc_type == ROHC_CRC_TYPE_NONE)
+			{
+				printf("%-8s", "FCS-32");
+			}
+			else
+			{
+				printf("CRC-%-4d", crc_type);
+			}
+			printf(" %6zu %14.1f %14.1f %7.2fx\n", size, ref_ns, lib_ns,
+			       ref_ns / lib_ns);
+		}
+	}
+}
+
+
+/**
+ * @brief Get the pre-computed tables of the library for the given CRC type
+ *
+ * @param crc_type  The CRC type
+ * @return          The tables of the library
+ */
+static const uint8_t * crc_lib_table(const rohc_crc_type_t crc_type)
+{
+	switch(crc_type)
+	{
+		case ROHC_CRC_TYPE_3:
+			return rohc_crc_table_3;
+		case ROHC_CRC_TYPE_7:
+			return rohc_crc_table_7;
+		case ROHC_CRC_TYPE_8:
+		default:
+			assert(crc_type == ROHC_CRC_TYPE_8);
+			return rohc_crc_table_8;
+	}
+}
+
+
+/**
+ * @brief Compute the 256-entry table for the CRC-3, CRC-7 or CRC-8 reference
+ *        algorithm
+ *
+ * The reflected polynoms of RFC 3095, section 5.9.2 are used.
+ *
+ * @param crc_type        The CRC type
+ * @param[out] crc_table  The 256-entry table
+ */
+static void crc_ref_8bits_init(const rohc_crc_type_t crc_type,
+                               uint8_t *const crc_table)
+{
+	const uint8_t polynom =
+		(crc_type == ROHC_CRC_TYPE_3 ? 0x6 :
+		 (crc_type == ROHC_CRC_TYPE_7 ? 0x79 : 0xe0));
+	unsigned int i;
+
+	for(i = 0; i < 256; i++)
+	{
+		uint8_t crc = i;
+		int j;
+
+		for(j = 0; j < 8; j++)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ polynom) : (crc >> 1);
+		}
+		crc_table[i] = crc;
+	}
+}
+
+
+/**
+ * @brief Compute a CRC-3, CRC-7 or CRC-8 one byte per table lookup
+ *
+ * @param crc_type   The CRC type
+ * @param data       The data to compute the CRC on
+ * @param length     The length of the data
+ * @param init_val   The initial CRC value
+ * @param crc_table  The 256-entry reference table
+ * @return           The CRC
+ */
+static uint8_t crc_ref_8bits(const rohc_crc_type_t crc_type,
+                             const uint8_t *const data,
+                             const size_t length,
+                             const uint8_t init_val,
+                             const uint8_t *const crc_table)
+{
+	const uint8_t crc_mask = (1U << crc_type) - 1;
+	uint8_t crc = init_val;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		crc = crc_table[data[i] ^ (crc & crc_mask)];
+	}
+
+	return crc;
+}
+
+
+/**
+ * @brief Compute the 256-entry table for the FCS-32 reference algorithm
+ */
+static void crc_ref_fcs32_init(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+		int j;
+
+		for(j = 0; j < 8; j++)
+		{
+			crc = (crc >> 1) ^ (0xedb88320 & (-(crc & 1)));
+		}
+		crc_ref_table_fcs32[i] = crc;
+	}
+}
+
+
+/**
+ * @brief Compute a FCS-32 one byte per table lookup
+ *
+ * @param data      The data to compute the CRC on
+ * @param length    The length of the data
+ * @param init_val  The initial CRC value
+ * @return          The CRC
+ */
+static uint32_t crc_ref_fcs32(const uint8_t *const data,
+                              const size_t length,
+                              const uint32_t init_val)
+{
+	uint32_t crc = init_val;
+	size_t i;
+
+	for(i = 0; i < length; i++)
+	{
+		crc = (crc >> 8) ^ crc_ref_table_fcs32[(crc ^ data[i]) & 0xff];
+	}
+
+	return crc;
+}
+
+
+/**
+ * @brief Compute the time elapsed between two instants
+ *
+ * @param start  The first instant
+ * @param end    The second instant
+ * @return       The elapsed time in nanoseconds
+ */
+static double bench_elapsed_ns(const struct timespec *const start,
+                               const struct timespec *const end)
+{
+	return ((double) (end->tv_sec - start->tv_sec)) * 1e9 +
+	       ((double) (end->tv_nsec - start->tv_nsec));
+}
+
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2016 Didier Barvaux
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * @file    test_ip_csum.c
+ * @brief   Test the computation of IPv4 header checksums
+ * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The checksums computed by ip_fast_csum() and by its portable C version
+ * ip_fast_csum_generic() are compared with the ones computed 16 bits per
+ * 16 bits as described by RFC 1071, for all header lengths and alignments.
+ * The portable version is tested even on the platforms where ip_fast_csum()
+ * is written in assembly.
+ */
+
+#include "ip.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+/** The number of random headers to test for every length and alignment */
+#define TEST_IP_CSUM_ROUNDS  1000U
+
+
+/** Print trace on stdout only in verbose mode */
+#define trace(is_verbose, format, ...) \
+	do { \
+		if(is_verbose) { \
+			printf(format, ##__VA_ARGS__); \
+		} \
+	} while(0)
+
+
+static bool test_ip_csum(const bool verbose,
+                         uint8_t *const hdr,
+                         const size_t ihl)
+	__attribute__((warn_unused_result, nonnull(2)));
+static uint16_t ip_csum_ref(const uint8_t *const data, const size_t length)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+
+/**
+ * @brief Test the IPv4 header checksums
+ *
+ * @param argc  The number of command line arguments
+ * @param argv  The command line arguments
+ * @return      0 if test succeeds, non-zero if test fails
+ */
+int main(int argc, char *argv[])
+{
+	static uint8_t data[15 * sizeof(uint32_t) + 4];
+	bool verbose = false;
+	uint32_t seed = 0x12345678;
+	int is_failure = 1; /* test fails by default */
+	size_t round;
+
+	/* do we run in verbose mode ? */
+	if(argc == 2 && strcmp(argv[1], "verbose") == 0)
+	{
+		verbose = true;
+	}
+	else if(argc != 1)
+	{
+		/* invalid usage */
+		printf("test the computation of IPv4 header checksums\n");
+		printf("usage: %s [verbose]\n", argv[0]);
+		goto error;
+	}
+
+	for(round = 0; round < TEST_IP_CSUM_ROUNDS; round++)
+	{
+		size_t align;
+
+		for(align = 0; align < 4; align++)
+		{
+			size_t ihl;
+
+			for(ihl = 5; ihl <= 15; ihl++)
+			{
+				uint8_t *const hdr = data + align;
+				size_t i;
+
+				/* fill header with pseudo-random bytes, or with only 0xff bytes
+				 * from time to time to exercise the carries */
+				for(i = 0; i < (ihl * sizeof(uint32_t)); i++)
+				{
+					seed = seed * 1103515245U + 12345U;
+					hdr[i] = ((round % 16) == 0 ? 0xff : ((seed >> 16) & 0xff));
+				}
+
+				if(!test_ip_csum(verbose, hdr, ihl))
+				{
+					goto error;
+				}
+			}
+		}
+	}
+	trace(verbose, "all tests are successful\n");
+
+	/* test succeeds */
+	is_failure = 0;
+
+error:
+	return is_failure;
+}
+
+
+/**
+ * @brief Test the checksum of one IPv4 header
+ *
+ * @param verbose  Whether to print traces or not
+ * @param hdr      The IPv4 header, its checksum field is overwritten
+ * @param ihl      The length of the IPv4 header (in 32-bit words)
+ * @return         true if the test succeeds, false otherwise
+ */
+static bool test_ip_csum(const bool verbose,
+                         uint8_t *const hdr,
+                         const size_t ihl)
+{
+	const size_t len = ihl * sizeof(uint32_t);
+	uint16_t check_generic;
+	uint16_t check;
+	uint16_t ref;
+
+	/* compute checksum and compare with reference algorithm */
+	hdr[10] = 0;
+	hdr[11] = 0;
+	check = ip_fast_csum(hdr, ihl);
+	check_generic = ip_fast_csum_generic(hdr, ihl);
+	ref = ip_csum_ref(hdr, len);
+	if(check_generic != check)
+	{
+		trace(verbose, "generic checksum 0x%04x on %zu bytes at %p does not "
+		      "match optimized checksum 0x%04x\n", check_generic, len, hdr,
+		      check);
+		goto error;
+	}
+	memcpy(hdr + 10, &check, sizeof(uint16_t));
+	if(((hdr[10] << 8) | hdr[11]) != ref)
+	{
+		trace(verbose, "checksum 0x%02x%02x on %zu bytes at %p does not match "
+		      "reference 0x%04x\n", hdr[10], hdr[11], len, hdr, ref);
+		goto error;
+	}
+
+	/* header with checksum shall be valid */
+	if(ip_fast_csum(hdr, ihl) != 0 || ip_fast_csum_generic(hdr, ihl) != 0)
+	{
+		trace(verbose, "header with checksum on %zu bytes is not valid\n", len);
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Compute the Internet checksum 16 bits per 16 bits (RFC 1071)
+ *
+ * @param data    The data to compute the checksum on
+ * @param length  The length of the data (in bytes, even)
+ * @return        The checksum in host byte order
+ */
+static uint16_t ip_csum_ref(const uint8_t *const data, const size_t length)
+{
+	uint32_t sum = 0;
+	size_t i;
+
+	for(i = 0; i < length; i += 2)
+	{
+		sum += (data[i] << 8) | data[i + 1];
+	}
+	while((sum >> 16) != 0)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return ~sum;
+}
+
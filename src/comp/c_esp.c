@@ -143,7 +143,8 @@ static bool c_esp_create(struct rohc_comp_ctxt *const context,
 	                "packet = %u", rfc3095_ctxt->sn);
 
 	/* create the ESP part of the profile context */
-	esp_context = malloc(sizeof(struct sc_esp_context));
+	esp_context = rohc_mem_alloc(&context->compressor->mem,
+	                             sizeof(struct sc_esp_context));
 	if(esp_context == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
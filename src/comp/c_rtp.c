@@ -147,7 +147,8 @@ static bool c_rtp_create(struct rohc_comp_ctxt *const context,
 	                "packet = %u", rfc3095_ctxt->sn);
 
 	/* create the RTP part of the profile context */
-	rtp_context = malloc(sizeof(struct sc_rtp_context));
+	rtp_context = rohc_mem_alloc(&context->compressor->mem,
+	                             sizeof(struct sc_rtp_context));
 	if(rtp_context == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
@@ -167,7 +168,8 @@ static bool c_rtp_create(struct rohc_comp_ctxt *const context,
 	c_init_sc(&rtp_context->ts_sc,
 	          context->compressor->wlsb_window_width,
 	          context->compressor->trace_callback,
-	          context->compressor->trace_callback_priv);
+	          context->compressor->trace_callback_priv,
+	          context->compressor->trace_level);
 
 	/* init the RTP-specific temporary variables */
 	rtp_context->tmp.send_rtp_dynamic = -1;
@@ -433,7 +433,8 @@ static bool c_tcp_create_from_ctxt(struct rohc_comp_ctxt *const ctxt,
 	struct sc_tcp_context *tcp_ctxt;
 
 	/* create the TCP part of the profile context */
-	tcp_ctxt = malloc(sizeof(struct sc_tcp_context));
+	tcp_ctxt = rohc_mem_alloc(&ctxt->compressor->mem,
+	                          sizeof(struct sc_tcp_context));
 	if(tcp_ctxt == NULL)
 	{
 		rohc_error(ctxt->compressor, ROHC_TRACE_COMP, ctxt->profile->id,
@@ -505,7 +506,8 @@ static bool c_tcp_create_from_pkt(struct rohc_comp_ctxt *const context,
 	size_t i;
 
 	/* create the TCP part of the profile context */
-	tcp_context = calloc(1, sizeof(struct sc_tcp_context));
+	tcp_context = rohc_mem_zalloc(&context->compressor->mem,
+	                              sizeof(struct sc_tcp_context));
 	if(tcp_context == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
@@ -661,7 +663,7 @@ static bool c_tcp_create_from_pkt(struct rohc_comp_ctxt *const context,
 	return true;
 
 free_context:
-	free(tcp_context);
+	rohc_mem_free(tcp_context);
 error:
 	return false;
 }
@@ -676,7 +678,7 @@ static void c_tcp_destroy(struct rohc_comp_ctxt *const context)
 {
 	struct sc_tcp_context *const tcp_context = context->specific;
 
-	free(tcp_context);
+	rohc_mem_free(tcp_context);
 }
 
 
@@ -776,9 +778,12 @@ static bool c_tcp_check_profile(const struct rohc_comp *const comp,
 				goto bad_profile;
 			}
 
-			/* check if the checksum of the IPv4 header is correct */
-			if((comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
-			   ip_fast_csum(remain_data, ipv4_min_words_nr) != 0)
+			/* check if the checksum of the IPv4 header is correct: the outer
+			 * and inner IP headers were verified while parsing the packet */
+			if(ip_hdrs_nr < packet->ip_hdr_nr ?
+			   !packet->ip_csum_ok[ip_hdrs_nr] :
+			   ((comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
+			    ip_fast_csum(remain_data, ipv4_min_words_nr) != 0))
 			{
 				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 				           "IP packet #%zu is not correct (bad checksum)",
@@ -1677,9 +1682,11 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	}
 
 	/* IR(-CR|-DYN) header was successfully built, compute the CRC */
+	rohc_perf_start(crc_start);
 	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt,
 	                                       rohc_hdr_len, CRC_INIT_8,
-	                                       context->compressor->crc_table_8);
+	                                       rohc_crc_table_8);
+	rohc_perf_stop(context->compressor->perf, ROHC_COMP_PERF_CRC, crc_start);
 	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
 	                rohc_hdr_len, rohc_pkt[crc_position]);
 
@@ -1860,22 +1867,24 @@ static int code_CO_packet(struct rohc_comp_ctxt *const context,
 
 	/* we have just identified the IP and TCP headers (options included), so
 	 * let's compute the CRC on uncompressed headers */
+	rohc_perf_start(crc_start);
 	if(packet_type == ROHC_PACKET_TCP_SEQ_8 ||
 	   packet_type == ROHC_PACKET_TCP_RND_8 ||
 	   packet_type == ROHC_PACKET_TCP_CO_COMMON)
 	{
 		crc_computed = crc_calculate(ROHC_CRC_TYPE_7, ip->data, *payload_offset,
-		                             CRC_INIT_7, context->compressor->crc_table_7);
+		                             CRC_INIT_7, rohc_crc_table_7);
 		rohc_comp_debug(context, "CRC-7 on %zu-byte uncompressed header = 0x%x",
 		                *payload_offset, crc_computed);
 	}
 	else
 	{
 		crc_computed = crc_calculate(ROHC_CRC_TYPE_3, ip->data, *payload_offset,
-		                             CRC_INIT_3, context->compressor->crc_table_3);
+		                             CRC_INIT_3, rohc_crc_table_3);
 		rohc_comp_debug(context, "CRC-3 on %zu-byte uncompressed header = 0x%x",
 		                *payload_offset, crc_computed);
 	}
+	rohc_perf_stop(context->compressor->perf, ROHC_COMP_PERF_CRC, crc_start);
 
 	/* write Add-CID or large CID bytes: 'pos_1st_byte' indicates the location
 	 * where first header byte shall be written, 'pos_2nd_byte' indicates the
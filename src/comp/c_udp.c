@@ -144,7 +144,8 @@ static bool c_udp_create(struct rohc_comp_ctxt *const context,
 	udp = (struct udphdr *) packet->transport->data;
 
 	/* create the UDP part of the profile context */
-	udp_context = malloc(sizeof(struct sc_udp_context));
+	udp_context = rohc_mem_alloc(&context->compressor->mem,
+	                             sizeof(struct sc_udp_context));
 	if(udp_context == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
@@ -193,7 +193,8 @@ static bool c_udp_lite_create(struct rohc_comp_ctxt *const context,
 	udp_lite = (struct udphdr *) packet->transport->data;
 
 	/* create the UDP-Lite part of the profile context */
-	udp_lite_context = malloc(sizeof(struct sc_udp_lite_context));
+	udp_lite_context = rohc_mem_alloc(&context->compressor->mem,
+	                                  sizeof(struct sc_udp_lite_context));
 	if(udp_lite_context == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
@@ -512,9 +512,11 @@ static int uncompressed_code_IR_packet(const struct rohc_comp_ctxt *context,
 
 	/* part 5 */
 	rohc_pkt[counter] = 0;
+	rohc_perf_start(crc_start);
 	rohc_pkt[counter] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt, counter,
 	                                  CRC_INIT_8,
-	                                  context->compressor->crc_table_8);
+	                                  rohc_crc_table_8);
+	rohc_perf_stop(context->compressor->perf, ROHC_COMP_PERF_CRC, crc_start);
 	rohc_comp_debug(context, "CRC on %zu bytes = 0x%02x", counter,
 	                rohc_pkt[counter]);
 	counter++;
@@ -93,6 +93,53 @@ static const struct rohc_comp_profile *const rohc_comp_profiles[C_NUM_PROFILES]
 };
 
 
+/*
+ * Prototypes of private functions related to ROHC compression
+ */
+
+static rohc_status_t c_compress_pkt(struct rohc_comp *const comp,
+                                    const struct rohc_buf uncomp_packet,
+                                    struct rohc_buf *const rohc_packet)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+static int c_encode_hdr(struct rohc_comp *const comp,
+                        const struct rohc_buf uncomp_packet,
+                        uint8_t *const rohc_hdr,
+                        const size_t rohc_hdr_max_len,
+                        struct rohc_comp_ctxt **const context,
+                        rohc_packet_t *const packet_type,
+                        size_t *const payload_offset)
+	__attribute__((warn_unused_result, nonnull(1, 3, 5, 6, 7)));
+
+static void c_update_stats(struct rohc_comp *const comp,
+                           struct rohc_comp_ctxt *const context,
+                           const rohc_packet_t packet_type,
+                           const size_t uncomp_len,
+                           const size_t rohc_len,
+                           const size_t uncomp_hdr_len,
+                           const size_t rohc_hdr_len)
+	__attribute__((nonnull(1, 2)));
+static void c_update_stats_failure(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+
+static bool c_store_rru(struct rohc_comp *const comp,
+                        const rohc_packet_t packet_type,
+                        const uint8_t *const rohc_hdr,
+                        const size_t rohc_hdr_len,
+                        const struct rohc_buf payload,
+                        const bool keep_payload)
+	__attribute__((warn_unused_result, nonnull(1, 3)));
+
+static void c_pull_rru(struct rohc_comp *const comp,
+                       const size_t chunk_len,
+                       const uint8_t **const head,
+                       size_t *const head_len,
+                       struct rohc_buf *const payload,
+                       const uint8_t **const tail,
+                       size_t *const tail_len)
+	__attribute__((nonnull(1, 3, 4, 5, 6, 7)));
+
+
 /*
  * Prototypes of private functions related to ROHC compression profiles
  */
@@ -107,6 +154,9 @@ static const struct rohc_comp_profile *
 	                          const struct net_pkt *const packet)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 
+static void c_update_profiles_dispatch(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+
 
 /*
  * Prototypes of private functions related to ROHC compression contexts
@@ -134,6 +184,55 @@ static struct rohc_comp_ctxt *
 static struct rohc_comp_ctxt *
 	c_get_context(struct rohc_comp *const comp, const rohc_cid_t cid)
 	__attribute__((nonnull(1), warn_unused_result));
+static void c_destroy_context(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_release_context(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_touch_context(struct rohc_comp *const comp,
+                            struct rohc_comp_ctxt *const context,
+                            const struct rohc_ts arrival_time)
+	__attribute__((nonnull(1, 2)));
+static bool c_check_context(const struct rohc_comp *const comp,
+                            const struct rohc_comp_ctxt *const context,
+                            const struct net_pkt *const packet,
+                            size_t *const cr_score)
+	__attribute__((nonnull(1, 2, 3, 4), warn_unused_result));
+
+static void c_free_cids_init(struct rohc_comp *const comp)
+	__attribute__((nonnull(1)));
+static void c_free_cids_add(struct rohc_comp *const comp, const rohc_cid_t cid)
+	__attribute__((nonnull(1)));
+static rohc_cid_t c_free_cids_take(struct rohc_comp *const comp)
+	__attribute__((nonnull(1), warn_unused_result));
+static void c_lru_append_context(struct rohc_comp *const comp,
+                                 struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_lru_remove_context(struct rohc_comp *const comp,
+                                 const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+
+static inline bool c_profile_is_hashed(const struct rohc_comp_profile *const profile)
+	__attribute__((nonnull(1), warn_unused_result, pure));
+static void c_hash_add_context(struct rohc_comp *const comp,
+                               struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+static void c_hash_remove_context(struct rohc_comp *const comp,
+                                  const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
+
+static struct rohc_comp_ctxt *
+	c_find_recent_context(struct rohc_comp *const comp,
+	                      const struct net_pkt *const packet)
+	__attribute__((nonnull(1, 2), warn_unused_result));
+static bool c_is_profile_for_packet(const struct rohc_comp *const comp,
+                                    const struct rohc_comp_profile *const profile,
+                                    const struct net_pkt *const packet)
+	__attribute__((nonnull(1, 2, 3), warn_unused_result));
+static void c_recent_add_context(struct rohc_comp *const comp,
+                                 const struct rohc_comp_ctxt *const context)
+	__attribute__((nonnull(1, 2)));
 
 
 /*
@@ -273,20 +372,32 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 	comp->medium.cid_type = cid_type;
 	comp->medium.max_cid = max_cid;
 	comp->mrru = 0; /* no segmentation by default */
+	comp->rru = NULL;
 	comp->random_cb = rand_cb;
 	comp->random_cb_ctxt = rand_priv;
+	rohc_mem_init(&comp->mem);
 
 	/* all compression profiles are disabled by default */
 	for(i = 0; i < C_NUM_PROFILES; i++)
 	{
 		comp->enabled_profiles[i] = false;
 	}
+	c_update_profiles_dispatch(comp);
 
-	/* reset statistics */
-	comp->num_packets = 0;
-	comp->total_compressed_size = 0;
-	comp->total_uncompressed_size = 0;
+	/* reset statistics: one block for the compressor, then one per CID */
+	comp->stats = rohc_stats_new(max_cid + 2, &comp->stats_mem);
+	if(comp->stats == NULL)
+	{
+		goto destroy_comp;
+	}
+	comp->ctxt_stats = comp->stats + 1;
 	comp->last_context = NULL;
+	for(i = 0; i < ROHC_COMP_RECENT_CTXTS_NR; i++)
+	{
+		comp->recent_cids[i] = ROHC_COMP_CID_NONE;
+	}
+	comp->num_recent_ctxt_hits = 0;
+	comp->num_recent_ctxt_misses = 0;
 
 	/* set the default W-LSB window width */
 	is_fine = rohc_comp_set_wlsb_window_width(comp, wlsb_width);
@@ -319,11 +430,6 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 		goto destroy_comp;
 	}
 
-	/* init the tables for fast CRC computation */
-	rohc_crc_init_table(comp->crc_table_3, ROHC_CRC_TYPE_3);
-	rohc_crc_init_table(comp->crc_table_7, ROHC_CRC_TYPE_7);
-	rohc_crc_init_table(comp->crc_table_8, ROHC_CRC_TYPE_8);
-
 	/* create the MAX_CID + 1 contexts */
 	if(!c_create_contexts(comp))
 	{
@@ -333,6 +439,7 @@ struct rohc_comp * rohc_comp_new2(const rohc_cid_type_t cid_type,
 	return comp;
 
 destroy_comp:
+	zfree(comp->stats_mem);
 	zfree(comp);
 error:
 	return NULL;
@@ -371,6 +478,13 @@ void rohc_comp_free(struct rohc_comp *const comp)
 
 		/* free memory used by contexts */
 		c_destroy_contexts(comp);
+		rohc_mem_release(&comp->mem);
+
+		/* free the RRU buffer used for segmentation */
+		zfree(comp->rru);
+
+		/* free the statistics blocks */
+		zfree(comp->stats_mem);
 
 		/* free the compressor */
 		free(comp);
@@ -433,7 +547,7 @@ bool rohc_comp_set_traces_cb2(struct rohc_comp *const comp,
 	}
 
 	/* refuse to set a new trace callback if compressor is in use */
-	if(comp->num_packets > 0)
+	if(comp->stats->packets_nr > 0)
 	{
 		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
 		           "modify the trace callback after initialization");
@@ -451,6 +565,120 @@ error:
 }
 
 
+/**
+ * @brief Set the lowest level of the traces printed by the compressor
+ *
+ * The traces with a lower level are not given to the trace callback. They
+ * are filtered before their arguments are evaluated and before they are
+ * formatted, so filtering them in the library is cheaper than filtering them
+ * in the trace callback. All traces are printed by default.
+ *
+ * The debug and info traces may also be removed from the library at build
+ * time with the --disable-rohc-traces option of the configure script.
+ *
+ * @warning The level can not be modified after library initialization
+ *
+ * @param comp   The ROHC compressor
+ * @param level  The lowest level of the traces to print
+ * @return       true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_set_traces_cb2
+ */
+bool rohc_comp_set_traces_level(struct rohc_comp *const comp,
+                                const rohc_trace_level_t level)
+{
+	/* check compressor validity */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	/* check the trace level */
+	if(level >= ROHC_TRACE_LEVEL_MAX)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "unknown trace level %d", level);
+		goto error;
+	}
+
+	/* refuse to set a new trace level if compressor is in use */
+	if(comp->stats->packets_nr > 0)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the trace level after initialization");
+		goto error;
+	}
+
+	comp->trace_level = level;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Set the allocator used for the compression contexts
+ *
+ * The compression contexts are carved from pools of cache-line-aligned
+ * objects, one pool per size of objects. The pools get their memory from the
+ * given allocator in large blocks, so that the creation of many new contexts
+ * seldom calls it. By default, the standard malloc(3) and free(3) functions
+ * are used.
+ *
+ * The allocator must be set before the first packet is compressed, and it
+ * cannot be changed once some memory was obtained from it.
+ *
+ * @param comp       The ROHC compressor
+ * @param malloc_cb  The callback used to allocate memory,
+ *                   NULL to restore the default allocator
+ * @param free_cb    The callback used to release memory,
+ *                   NULL to restore the default allocator
+ * @param priv_ctxt  An optional private context given to the callbacks,
+ *                   may be NULL
+ * @return           true on success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_malloc_cb_t
+ * @see rohc_free_cb_t
+ */
+bool rohc_comp_set_allocator(struct rohc_comp *const comp,
+                             rohc_malloc_cb_t malloc_cb,
+                             rohc_free_cb_t free_cb,
+                             void *const priv_ctxt)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+
+	/* refuse to change the allocator if compressor is in use */
+	if(comp->stats->packets_nr > 0)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the allocator after initialization");
+		goto error;
+	}
+
+	if(!rohc_mem_set_allocator(&comp->mem, malloc_cb, free_cb, priv_ctxt))
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "failed to set "
+		           "the allocator: both callbacks shall be set or unset, and "
+		           "no context shall be in use");
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
 /**
  * @brief Compress the given uncompressed packet into a ROHC packet
  *
@@ -521,268 +749,349 @@ rohc_status_t rohc_compress4(struct rohc_comp *const comp,
                              const struct rohc_buf uncomp_packet,
                              struct rohc_buf *const rohc_packet)
 {
-	struct net_pkt ip_pkt;
+	/* check inputs validity */
+	if(comp == NULL)
+	{
+		return ROHC_STATUS_ERROR;
+	}
+	if(rohc_packet == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is NULL");
+		return ROHC_STATUS_ERROR;
+	}
+
+	return c_compress_pkt(comp, uncomp_packet, rohc_packet);
+}
+
+
+/**
+ * @brief Compress the given uncompressed packet in place
+ *
+ * Compress the given uncompressed packet into a ROHC packet that is stored
+ * in the same buffer: the ROHC header is written just before the payload of
+ * the uncompressed packet, and the payload is never copied. On success, the
+ * buffer becomes a view on the ROHC packet: its offset and length are updated,
+ * the uncompressed headers are lost.
+ *
+ * The ROHC header is built in the headroom of the buffer (the \e offset bytes
+ * before the uncompressed packet) before it is moved in front of the payload,
+ * so the headroom shall be large enough for the ROHC header. IR packets are
+ * the largest ones, they are a few bytes longer than the uncompressed headers.
+ * Like with \ref rohc_compress4, the Uncompressed profile is used if the
+ * header does not fit.
+ *
+ * ROHC segmentation is never required since the ROHC packet always fits in
+ * the space of the uncompressed packet and of its headroom.
+ *
+ * @param comp         The ROHC compressor
+ * @param[in,out] pkt  IN:  The uncompressed packet to compress, with some
+ *                          headroom
+ *                     OUT: The resulting compressed ROHC packet, unchanged
+ *                          in case of error
+ * @return             Possible return values:
+ *                      \li \ref ROHC_STATUS_OK if the ROHC packet is
+ *                          returned
+ *                      \li \ref ROHC_STATUS_ERROR if an error occurred
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress4
+ */
+rohc_status_t rohc_compress_inplace(struct rohc_comp *const comp,
+                                    struct rohc_buf *const pkt)
+{
 	struct rohc_comp_ctxt *c;
 	rohc_packet_t packet_type;
 	int rohc_hdr_size;
-	size_t payload_size;
 	size_t payload_offset;
-
-	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
+	size_t rohc_offset;
 
 	/* check inputs validity */
 	if(comp == NULL)
 	{
 		goto error;
 	}
-	if(rohc_buf_is_malformed(uncomp_packet))
+	if(pkt == NULL)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is malformed");
+		             "given packet is NULL");
 		goto error;
 	}
-	if(rohc_buf_is_empty(uncomp_packet))
+
+	/* create the ROHC header in the headroom */
+	rohc_hdr_size = c_encode_hdr(comp, *pkt, pkt->data, pkt->offset, &c,
+	                             &packet_type, &payload_offset);
+	if(rohc_hdr_size < 0)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is empty");
 		goto error;
 	}
-	if(rohc_packet == NULL)
+
+	/* move the ROHC header just before the payload */
+	assert(((size_t) rohc_hdr_size) <= pkt->offset);
+	rohc_offset = pkt->offset + payload_offset - rohc_hdr_size;
+	rohc_perf_start(payload_start);
+	memmove(pkt->data + rohc_offset, pkt->data, rohc_hdr_size);
+	rohc_perf_stop(comp->perf, ROHC_COMP_PERF_PAYLOAD, payload_start);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "ROHC size = %zu bytes (header = %d, payload = %zu), payload "
+	           "kept in place", rohc_hdr_size + pkt->len - payload_offset,
+	           rohc_hdr_size, pkt->len - payload_offset);
+
+	c_update_stats(comp, c, packet_type, pkt->len,
+	               rohc_hdr_size + pkt->len - payload_offset,
+	               payload_offset, rohc_hdr_size);
+
+	/* the buffer is now a view on the ROHC packet */
+	pkt->len = rohc_hdr_size + pkt->len - payload_offset;
+	pkt->offset = rohc_offset;
+
+	return ROHC_STATUS_OK;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Compress the given uncompressed packet into a header and a payload
+ *
+ * Compress the given uncompressed packet like \ref rohc_compress4 does, but
+ * only the ROHC header is written in the output buffer: the payload is
+ * returned as a view on the uncompressed packet, ie. the offset and the
+ * length of the payload within the uncompressed packet. The ROHC packet is
+ * the ROHC header followed by that payload, it may be sent with one
+ * scatter-gather I/O (see writev(2) or sendmsg(2)) without any copy of the
+ * payload.
+ *
+ * The ROHC packet is segmented if it is longer than \e max_rohc_len bytes:
+ * \ref ROHC_STATUS_SEGMENT is returned and the segments shall be retrieved
+ * with \ref rohc_comp_get_segment_sg (or \ref rohc_comp_get_segment2).
+ * The payload of the segments is read from the uncompressed packet, that
+ * shall remain unchanged until the final segment is retrieved.
+ *
+ * @param comp            The ROHC compressor
+ * @param uncomp_packet   The uncompressed packet to compress
+ * @param max_rohc_len    The maximum length of the ROHC packet (header and
+ *                        payload), longer packets are segmented
+ * @param[out] rohc_hdr   The resulting ROHC header, the buffer shall be empty
+ * @param[out] payload    The resulting payload, ie. a view on the part of
+ *                        \e uncomp_packet that follows the ROHC header
+ * @return                Possible return values:
+ *                         \li \ref ROHC_STATUS_OK if the ROHC header and the
+ *                             payload are returned
+ *                         \li \ref ROHC_STATUS_SEGMENT if the ROHC packet
+ *                             needs to be segmented, the ROHC header and the
+ *                             payload are then empty
+ *                         \li \ref ROHC_STATUS_ERROR if an error occurred
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress4
+ * @see rohc_comp_get_segment_sg
+ */
+rohc_status_t rohc_compress_sg(struct rohc_comp *const comp,
+                               const struct rohc_buf uncomp_packet,
+                               const size_t max_rohc_len,
+                               struct rohc_buf *const rohc_hdr,
+                               struct rohc_buf *const payload)
+{
+	struct rohc_comp_ctxt *c;
+	rohc_packet_t packet_type;
+	int rohc_hdr_size;
+	size_t payload_offset;
+	rohc_status_t status;
+
+	/* check inputs validity */
+	if(comp == NULL)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is NULL");
 		goto error;
 	}
-	if(rohc_buf_is_malformed(*rohc_packet))
+	if(rohc_hdr == NULL)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is malformed");
+		             "given rohc_hdr is NULL");
 		goto error;
 	}
-	if(!rohc_buf_is_empty(*rohc_packet))
+	if(payload == NULL)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is not empty");
+		             "given payload is NULL");
 		goto error;
 	}
-
-	/* print uncompressed bytes */
-	if((comp->features & ROHC_COMP_FEATURE_DUMP_PACKETS) != 0)
+	if(rohc_buf_is_malformed(*rohc_hdr))
 	{
-		rohc_dump_packet(comp->trace_callback, comp->trace_callback_priv,
-		                 ROHC_TRACE_COMP, ROHC_TRACE_DEBUG,
-		                 "uncompressed data, max 100 bytes", uncomp_packet);
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_hdr is malformed");
+		goto error;
 	}
-
-	/* parse the uncompressed packet */
-	net_pkt_parse(&ip_pkt, uncomp_packet, comp->trace_callback,
-	              comp->trace_callback_priv, ROHC_TRACE_COMP);
-
-	/* find the best context for the packet */
-	c = rohc_comp_find_ctxt(comp, &ip_pkt, -1, uncomp_packet.time);
-	if(c == NULL)
+	if(!rohc_buf_is_empty(*rohc_hdr))
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "failed to find a matching context or to create a new "
-		             "context");
+		             "given rohc_hdr is not empty");
 		goto error;
 	}
 
-	/* create the ROHC packet: */
-	rohc_packet->len = 0;
-
-	/* use profile to compress packet */
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "compress the packet #%d", comp->num_packets + 1);
-	rohc_hdr_size =
-		c->profile->encode(c, &ip_pkt, rohc_buf_data(*rohc_packet),
-		                   rohc_buf_avail_len(*rohc_packet),
-		                   &packet_type, &payload_offset);
+	/* create the ROHC header in the output buffer */
+	rohc_hdr_size = c_encode_hdr(comp, uncomp_packet, rohc_buf_data(*rohc_hdr),
+	                             rohc_buf_avail_len(*rohc_hdr), &c,
+	                             &packet_type, &payload_offset);
 	if(rohc_hdr_size < 0)
 	{
-		/* error while compressing, use the Uncompressed profile
-		 * (except if we were already using the Uncompressed profile) */
-		if(c->profile->id == ROHC_PROFILE_UNCOMPRESSED)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "error while compressing with uncompressed profile, "
-			             "giving up");
-			goto error_free_new_context;
-		}
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "error while compressing with the profile, using "
-		             "uncompressed profile");
-
-		/* free context if it was just created */
-		if(c->num_sent_packets <= 1)
-		{
-			c->profile->destroy(c);
-			c->used = 0;
-			assert(comp->num_contexts_used > 0);
-			comp->num_contexts_used--;
-		}
-
-		/* find the best context for the Uncompressed profile */
-		c = rohc_comp_find_ctxt(comp, &ip_pkt, ROHC_PROFILE_UNCOMPRESSED,
-		                        uncomp_packet.time);
-		if(c == NULL)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to find a matching Uncompressed context or to "
-			             "create a new Uncompressed context");
-			goto error;
-		}
-
-		/* use the Uncompressed profile to compress the packet */
-		rohc_hdr_size =
-			c->profile->encode(c, &ip_pkt, rohc_buf_data(*rohc_packet),
-			                   rohc_buf_avail_len(*rohc_packet),
-			                   &packet_type, &payload_offset);
-		if(rohc_hdr_size < 0)
-		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "error while compressing with uncompressed profile, "
-			             "giving up");
-			goto error_free_new_context;
-		}
+		goto error;
 	}
-	rohc_packet->len += rohc_hdr_size;
 
-	/* the payload starts after the header, skip it */
-	rohc_buf_pull(rohc_packet, rohc_hdr_size);
-	payload_size = ip_pkt.len - payload_offset;
+	/* the payload is the end of the uncompressed packet */
+	*payload = uncomp_packet;
+	rohc_buf_pull(payload, payload_offset);
 
-	/* is packet too large for output buffer? */
-	if(payload_size > rohc_buf_avail_len(*rohc_packet))
+	if((rohc_hdr_size + payload->len) > max_rohc_len)
 	{
-		const size_t max_rohc_buf_len =
-			rohc_buf_avail_len(*rohc_packet) + rohc_hdr_size;
-		uint32_t rru_crc;
-
-		/* resulting ROHC packet too large, segmentation may be a solution */
 		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		          "%s ROHC packet is too large for the given output buffer, "
-		          "try to segment it (input size = %zd, maximum output "
-		          "size = %zd, required output size = %d + %zd = %zd, "
-		          "MRRU = %zd)", rohc_get_packet_descr(packet_type),
-		          uncomp_packet.len, max_rohc_buf_len, rohc_hdr_size,
-		          payload_size, rohc_hdr_size + payload_size, comp->mrru);
-
-		/* in order to be segmented, a ROHC packet shall be <= MRRU
-		 * (remember that MRRU includes the CRC length) */
-		if((payload_size + CRC_FCS32_LEN) > comp->mrru)
+		          "%s ROHC packet is too large, try to segment it (%d + %zu "
+		          "bytes, %zu bytes max, MRRU = %zu)",
+		          rohc_get_packet_descr(packet_type), rohc_hdr_size,
+		          payload->len, max_rohc_len, comp->mrru);
+
+		/* keep the payload in the uncompressed packet until the segments
+		 * are retrieved */
+		if(!c_store_rru(comp, packet_type, rohc_buf_data(*rohc_hdr),
+		                rohc_hdr_size, *payload, true))
 		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "%s ROHC packet cannot be segmented: too large (%d + "
-			             "%zu + %u = %zu bytes) for MRRU (%zu bytes)",
-			             rohc_get_packet_descr(packet_type), rohc_hdr_size,
-			             payload_size, CRC_FCS32_LEN, rohc_hdr_size +
-			             payload_size + CRC_FCS32_LEN, comp->mrru);
 			goto error_free_new_context;
 		}
-		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		          "%s ROHC packet can be segmented (MRRU = %zd)",
-		          rohc_get_packet_descr(packet_type), comp->mrru);
-
-		/* store the whole ROHC packet in compressor (headers and payload only,
-		 * not feedbacks, feedbacks will be transmitted with the first segment
-		 * when rohc_comp_get_segment2() is called) */
-		if(comp->rru_len != 0)
-		{
-			/* warn users about previous, not yet retrieved RRU */
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "erase the existing %zd-byte RRU that was not "
-			             "retrieved yet (call rohc_comp_get_segment2() to add "
-			             "support for ROHC segments in your application)",
-			             comp->rru_len);
-		}
-		comp->rru_len = 0;
-		comp->rru_off = 0;
-		/* ROHC header */
-		rohc_buf_push(rohc_packet, rohc_hdr_size);
-		memcpy(comp->rru + comp->rru_off, rohc_buf_data(*rohc_packet),
-		       rohc_hdr_size);
-		comp->rru_len += rohc_hdr_size;
-		/* ROHC payload */
-		memcpy(comp->rru + comp->rru_off + comp->rru_len,
-		       rohc_buf_data_at(uncomp_packet, payload_offset), payload_size);
-		comp->rru_len += payload_size;
-		/* compute FCS-32 CRC over header and payload (optional feedbacks and
-		   the CRC field itself are excluded) */
-		rru_crc = crc_calc_fcs32(comp->rru + comp->rru_off, comp->rru_len,
-		                         CRC_INIT_FCS32);
-		memcpy(comp->rru + comp->rru_off + comp->rru_len, &rru_crc,
-		       CRC_FCS32_LEN);
-		comp->rru_len += CRC_FCS32_LEN;
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "RRU 32-bit FCS CRC = 0x%08x", rohc_ntoh32(rru_crc));
-		/* computed RRU must be <= MRRU */
-		assert(comp->rru_len <= comp->mrru);
-
-		/* reset the length of the ROHC packet: it shall be 0 for users */
-		rohc_packet->len = 0;
-
-		/* report to users that segmentation is possible */
+		payload->len = 0;
 		status = ROHC_STATUS_SEGMENT;
 	}
 	else
 	{
-		/* copy full payload after ROHC header */
+		rohc_hdr->len = rohc_hdr_size;
 		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "copy full %zd-byte payload", payload_size);
-		rohc_buf_append(rohc_packet,
-		                rohc_buf_data_at(uncomp_packet, payload_offset),
-		                payload_size);
-
-		/* unhide the ROHC header */
-		rohc_buf_push(rohc_packet, rohc_hdr_size);
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "ROHC size = %zd bytes (header = %d, payload = %zu), output "
-		           "buffer size = %zu", rohc_packet->len, rohc_hdr_size,
-		           payload_size, rohc_buf_avail_len(*rohc_packet));
-
-		/* report to user that compression was successful */
+		           "ROHC size = %zu bytes (header = %d, payload = %zu), "
+		           "payload left in the uncompressed packet",
+		           rohc_hdr->len + payload->len, rohc_hdr_size, payload->len);
 		status = ROHC_STATUS_OK;
 	}
 
-	/* update some statistics:
-	 *  - compressor statistics
-	 *  - context statistics (global + last packet + last 16 packets) */
-	comp->num_packets++;
-	comp->total_uncompressed_size += uncomp_packet.len;
-	comp->total_compressed_size += rohc_packet->len;
-	comp->last_context = c;
+	c_update_stats(comp, c, packet_type, uncomp_packet.len,
+	               rohc_hdr->len + payload->len, payload_offset, rohc_hdr_size);
 
-	c->packet_type = packet_type;
-
-	c->total_uncompressed_size += uncomp_packet.len;
-	c->total_compressed_size += rohc_packet->len;
-	c->header_uncompressed_size += payload_offset;
-	c->header_compressed_size += rohc_hdr_size;
-	c->num_sent_packets++;
-
-	c->total_last_uncompressed_size = uncomp_packet.len;
-	c->total_last_compressed_size = rohc_packet->len;
-	c->header_last_uncompressed_size = payload_offset;
-	c->header_last_compressed_size = rohc_hdr_size;
-
-	/* compression is successful */
 	return status;
 
 error_free_new_context:
 	/* free context if it was just created */
 	if(c->num_sent_packets <= 1)
 	{
-		c->profile->destroy(c);
-		c->used = 0;
-		assert(comp->num_contexts_used > 0);
-		comp->num_contexts_used--;
+		c_destroy_context(comp, c);
 	}
+	c_update_stats_failure(comp);
 error:
 	return ROHC_STATUS_ERROR;
 }
 
 
+/**
+ * @brief Compress a burst of uncompressed packets into ROHC packets
+ *
+ * Compress the given uncompressed packets one after the other, in the order
+ * of the array. The result is the same as calling \ref rohc_compress4 for
+ * every packet of the burst: packet \e i is compressed from
+ * \e uncomp_packets[i] into \e rohc_packets[i], and the status returned by
+ * \ref rohc_compress4 for that packet is stored in \e statuses[i].
+ *
+ * The compressor and the arrays are checked once for the whole burst. The
+ * next uncompressed packet is prefetched while the current one is
+ * compressed. Packets are never reordered, since the order of the packets
+ * of one flow drives the SN and the state of their context. Consecutive
+ * packets of the same flow reuse the context that compressed the previous
+ * packet without any context lookup.
+ *
+ * The failure of one packet does not stop the burst: its status is
+ * \ref ROHC_STATUS_ERROR or \ref ROHC_STATUS_OUTPUT_TOO_SMALL, and the
+ * following packets are compressed. However, the burst stops after the
+ * first packet that requires ROHC segmentation (status
+ * \ref ROHC_STATUS_SEGMENT), otherwise the next packet that requires
+ * segmentation would erase the RRU before the segments were retrieved. Call
+ * \ref rohc_comp_get_segment2 to retrieve the segments, then call
+ * \ref rohc_compress_burst again for the remaining packets.
+ *
+ * @param comp                The ROHC compressor
+ * @param uncomp_packets      The uncompressed packets to compress
+ * @param[out] rohc_packets   The resulting compressed ROHC packets, every
+ *                            buffer shall be empty
+ * @param[out] statuses       The compression status of every packet, see
+ *                            \ref rohc_compress4 for the possible values
+ * @param pkts_nr             The number of packets in the burst
+ * @return                    The number of packets processed from the start
+ *                            of the burst (with or without success), that is
+ *                            \e pkts_nr unless a packet required segmentation,
+ *                            0 if the parameters are invalid
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress4
+ * @see rohc_comp_get_segment2
+ */
+size_t rohc_compress_burst(struct rohc_comp *const comp,
+                           const struct rohc_buf *const uncomp_packets,
+                           struct rohc_buf *const rohc_packets,
+                           rohc_status_t *const statuses,
+                           const size_t pkts_nr)
+{
+	size_t i;
+
+	/* check inputs validity */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(uncomp_packets == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packets is NULL");
+		goto error;
+	}
+	if(rohc_packets == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packets is NULL");
+		goto error;
+	}
+	if(statuses == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given statuses is NULL");
+		goto error;
+	}
+
+	for(i = 0; i < pkts_nr; i++)
+	{
+		/* fetch the headers of the next packet while the current one is
+		 * compressed, they are parsed just after */
+		if((i + 1) < pkts_nr && !rohc_buf_is_empty(uncomp_packets[i + 1]))
+		{
+			__builtin_prefetch(rohc_buf_data(uncomp_packets[i + 1]), 0, 3);
+		}
+
+		statuses[i] = c_compress_pkt(comp, uncomp_packets[i], &(rohc_packets[i]));
+		if(statuses[i] == ROHC_STATUS_SEGMENT)
+		{
+			/* let the caller retrieve the segments before the RRU is erased */
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "stop burst after packet %zu/%zu: ROHC segments shall "
+			           "be retrieved first", i + 1, pkts_nr);
+			i++;
+			break;
+		}
+	}
+
+	return i;
+
+error:
+	return 0;
+}
+
+
 /**
  * @brief Pad the given ROHC compressed packet
  *
@@ -884,6 +1193,10 @@ error:
  * To get all the segments of one ROHC packet, call this function until
  * \ref ROHC_STATUS_OK or \ref ROHC_STATUS_ERROR is returned.
  *
+ * If the ROHC packet was compressed by \ref rohc_compress_sg, its payload is
+ * copied from the uncompressed packet, that shall remain unchanged until the
+ * final segment is retrieved.
+ *
  * @param comp          The ROHC compressor
  * @param[out] segment  The buffer where to store the ROHC segment
  * @return              Possible return values:
@@ -931,6 +1244,11 @@ rohc_status_t rohc_comp_get_segment2(struct rohc_comp *const comp,
 {
 	const size_t segment_type_len = 1; /* segment type byte */
 	size_t max_data_len;
+	const uint8_t *head;
+	size_t head_len;
+	struct rohc_buf payload;
+	const uint8_t *tail;
+	size_t tail_len;
 	rohc_status_t status;
 
 	/* check input parameters */
@@ -991,10 +1309,13 @@ rohc_status_t rohc_comp_get_segment2(struct rohc_comp *const comp,
 	rohc_buf_pull(segment, 1);
 
 	/* copy remaining ROHC data (CRC included) */
-	rohc_buf_append(segment, comp->rru + comp->rru_off, max_data_len);
-	rohc_buf_pull(segment, max_data_len);
-	comp->rru_off += max_data_len;
-	comp->rru_len -= max_data_len;
+	c_pull_rru(comp, max_data_len, &head, &head_len, &payload, &tail, &tail_len);
+	rohc_buf_append(segment, head, head_len);
+	rohc_buf_pull(segment, head_len);
+	rohc_buf_append(segment, rohc_buf_data(payload), payload.len);
+	rohc_buf_pull(segment, payload.len);
+	rohc_buf_append(segment, tail, tail_len);
+	rohc_buf_pull(segment, tail_len);
 
 	/* set status wrt to (non-)final segment */
 	if(comp->rru_len == 0)
@@ -1020,6 +1341,155 @@ error:
 }
 
 
+/**
+ * @brief Get the next ROHC segment if any, as a header, payload and trailer
+ *
+ * Get the next ROHC segment like \ref rohc_comp_get_segment2 does, but
+ * without copying the payload of the ROHC packet compressed by
+ * \ref rohc_compress_sg. The segment is made of three parts, to be sent
+ * one after the other with one scatter-gather I/O:
+ *  \li \e segment: the segment type byte and the part of the ROHC header
+ *      carried by the segment, written in the given buffer,
+ *  \li \e payload: the part of the payload carried by the segment, as a
+ *      view on the uncompressed packet given to \ref rohc_compress_sg,
+ *  \li \e trailer: the part of the CRC of the RRU carried by the segment,
+ *      as a view on the memory of the compressor that remains valid until
+ *      the next ROHC packet is segmented.
+ * The payload and the trailer may be empty.
+ *
+ * If the ROHC packet was compressed by \ref rohc_compress4, the whole
+ * segment is written in the \e segment buffer.
+ *
+ * To get all the segments of one ROHC packet, call this function until
+ * \ref ROHC_STATUS_OK or \ref ROHC_STATUS_ERROR is returned.
+ *
+ * @param comp              The ROHC compressor
+ * @param max_segment_len   The maximum length of the segment (type byte,
+ *                          header, payload and trailer)
+ * @param[out] segment      The buffer where to store the head of the
+ *                          segment, the buffer shall be empty
+ * @param[out] payload      The payload of the segment
+ * @param[out] trailer      The trailer of the segment
+ * @return                  Possible return values:
+ *                           \li \ref ROHC_STATUS_SEGMENT if a ROHC segment
+ *                               is returned and more segments are available,
+ *                           \li \ref ROHC_STATUS_OK if a ROHC segment is
+ *                               returned and no more ROHC segment is
+ *                               available
+ *                           \li \ref ROHC_STATUS_ERROR if an error occurred
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_compress_sg
+ * @see rohc_comp_get_segment2
+ */
+rohc_status_t rohc_comp_get_segment_sg(struct rohc_comp *const comp,
+                                       const size_t max_segment_len,
+                                       struct rohc_buf *const segment,
+                                       struct rohc_buf *const payload,
+                                       struct rohc_buf *const trailer)
+{
+	const size_t segment_type_len = 1; /* segment type byte */
+	size_t max_data_len;
+	size_t max_head_len;
+	const uint8_t *head;
+	size_t head_len;
+	const uint8_t *tail;
+	size_t tail_len;
+	rohc_status_t status;
+
+	/* check input parameters */
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(segment == NULL || payload == NULL || trailer == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segment, payload and trailer cannot be NULL");
+		goto error;
+	}
+	if(rohc_buf_is_malformed(*segment))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segment is malformed");
+		goto error;
+	}
+	if(!rohc_buf_is_empty(*segment))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given segment is not empty");
+		goto error;
+	}
+
+	/* abort if no RRU is available in the compressor */
+	if(comp->rru_len == 0)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no RRU available in given compressor");
+		goto error;
+	}
+
+	/* abort is the segment or the given output buffer is too small */
+	if(max_segment_len <= segment_type_len ||
+	   rohc_buf_avail_len(*segment) <= segment_type_len)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "segment or output buffer is too small for RRU, more "
+		             "than %zd bytes are required", segment_type_len);
+		goto error;
+	}
+
+	/* how many bytes of ROHC packet can we put in that new segment? the head
+	 * bytes shall fit in the output buffer */
+	max_data_len = rohc_min(max_segment_len - segment_type_len, comp->rru_len);
+	max_head_len = rohc_buf_avail_len(*segment) - segment_type_len;
+	if(comp->rru_off < comp->rru_payload_off &&
+	   rohc_min(max_data_len, comp->rru_payload_off - comp->rru_off) > max_head_len)
+	{
+		max_data_len = max_head_len;
+	}
+	assert(max_data_len > 0);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "put %zd bytes of the remaining %zd bytes of ROHC packet and "
+	           "CRC in the segment", max_data_len, comp->rru_len);
+
+	/* set segment type with F bit set only for last segment */
+	rohc_buf_byte_at(*segment, 0) = 0xfe | (max_data_len == comp->rru_len);
+	segment->len++;
+	rohc_buf_pull(segment, 1);
+
+	/* copy the head bytes, return the payload and the tail bytes as views */
+	c_pull_rru(comp, max_data_len, &head, &head_len, payload, &tail, &tail_len);
+	rohc_buf_append(segment, head, head_len);
+	rohc_buf_push(segment, segment_type_len);
+	trailer->time = payload->time;
+	trailer->data = comp->rru;
+	trailer->max_len = comp->mrru;
+	trailer->offset = tail - comp->rru;
+	trailer->len = tail_len;
+
+	/* set status wrt to (non-)final segment */
+	if(comp->rru_len == 0)
+	{
+		/* final segment, no more segment available */
+		status = ROHC_STATUS_OK;
+		/* reset context for next RRU */
+		comp->rru_off = 0;
+	}
+	else
+	{
+		/* non-final segment, more segments to available */
+		status = ROHC_STATUS_SEGMENT;
+	}
+
+	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
 /**
  * @brief Force the compressor to re-initialize all its contexts
  *
@@ -1118,7 +1588,7 @@ bool rohc_comp_set_wlsb_window_width(struct rohc_comp *const comp,
 	}
 
 	/* refuse to set a value if compressor is in use */
-	if(comp->num_packets > 0)
+	if(comp->stats->packets_nr > 0)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL, "unable to "
 		             "modify the W-LSB window width after initialization");
@@ -1174,7 +1644,7 @@ bool rohc_comp_set_periodic_refreshes(struct rohc_comp *const comp,
 	}
 
 	/* refuse to set values if compressor is in use */
-	if(comp->num_packets > 0)
+	if(comp->stats->packets_nr > 0)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 		             "unable to modify the timeouts for periodic refreshes "
@@ -1235,7 +1705,7 @@ bool rohc_comp_set_periodic_refreshes_time(struct rohc_comp *const comp,
 	}
 
 	/* refuse to set values if compressor is in use */
-	if(comp->num_packets > 0)
+	if(comp->stats->packets_nr > 0)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 		             "unable to modify the timeouts for periodic refreshes "
@@ -1292,7 +1762,7 @@ bool rohc_comp_set_list_trans_nr(struct rohc_comp *const comp,
 	}
 
 	/* refuse to set values if compressor is in use */
-	if(comp->num_packets > 0)
+	if(comp->stats->packets_nr > 0)
 	{
 		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 		             "unable to modify the value for uncompressed transmissions"
@@ -1491,6 +1961,7 @@ bool rohc_comp_enable_profile(struct rohc_comp *const comp,
 
 	/* mark the profile as enabled */
 	comp->enabled_profiles[i] = true;
+	c_update_profiles_dispatch(comp);
 	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 	          "ROHC compression profile (ID = %d) enabled", profile);
 
@@ -1553,6 +2024,7 @@ bool rohc_comp_disable_profile(struct rohc_comp *const comp,
 
 	/* mark the profile as disabled */
 	comp->enabled_profiles[i] = false;
+	c_update_profiles_dispatch(comp);
 	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 	          "ROHC compression profile (ID = %d) disabled", profile);
 
@@ -1708,6 +2180,10 @@ error:
  * If segmentation is enabled and used by the compressor, the function
  * \ref rohc_comp_get_segment2 can be used to retrieve ROHC segments.
  *
+ * The compressor allocates a MRRU-byte buffer to store the ROHC packets
+ * being segmented, there is no such buffer while segmentation is disabled.
+ * Changing the MRRU drops the segments that were not retrieved yet.
+ *
  * @param comp  The ROHC compressor
  * @param mrru  The new MRRU value (in bytes)
  * @return      true if the MRRU was successfully set, false otherwise
@@ -1748,6 +2224,34 @@ bool rohc_comp_set_mrru(struct rohc_comp *const comp,
 		goto error;
 	}
 
+	/* resize the RRU buffer to the new MRRU */
+	if(mrru != comp->mrru)
+	{
+		uint8_t *rru = NULL;
+
+		if(mrru > 0)
+		{
+			rru = malloc(mrru);
+			if(rru == NULL)
+			{
+				rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+				             "failed to allocate memory for the %zu-byte RRU", mrru);
+				goto error;
+			}
+		}
+		if(comp->rru_len != 0)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "drop the existing %zu-byte RRU that was not retrieved "
+			             "yet", comp->rru_len);
+		}
+		free(comp->rru);
+		comp->rru = rru;
+		comp->rru_off = 0;
+		comp->rru_len = 0;
+		comp->rru_payload.len = 0;
+	}
+
 	/* set new MRRU */
 	comp->mrru = mrru;
 	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
@@ -2240,12 +2744,17 @@ bool rohc_comp_get_general_info(const struct rohc_comp *const comp,
 	{
 		/* base fields for major version 0 */
 		info->contexts_nr = comp->num_contexts_used;
-		info->packets_nr = comp->num_packets;
-		info->uncomp_bytes_nr = comp->total_uncompressed_size;
-		info->comp_bytes_nr = comp->total_compressed_size;
+		info->packets_nr = comp->stats->packets_nr;
+		info->uncomp_bytes_nr = comp->stats->uncomp_bytes_nr;
+		info->comp_bytes_nr = comp->stats->comp_bytes_nr;
 
 		/* new fields added by minor versions */
-		if(info->version_minor > 0)
+		if(info->version_minor >= 1)
+		{
+			info->recent_ctxt_hits_nr = comp->num_recent_ctxt_hits;
+			info->recent_ctxt_misses_nr = comp->num_recent_ctxt_misses;
+		}
+		if(info->version_minor > 1)
 		{
 			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 			           "unsupported minor version (%u) of the structure for "
@@ -2269,497 +2778,1630 @@ error:
 
 
 /**
- * @brief Give a description for the given ROHC compression context state
+ * @brief Get the timing counters of the compressor stages
  *
- * Give a description for the given ROHC compression context state.
+ * Get the time spent in every stage of the compression and the number of
+ * times every stage was run since the compressor was created. See
+ * \ref rohc_comp_perf_stage_t for the list of stages.
  *
- * The descriptions are not part of the API. They may change between
- * releases without any warning. Do NOT use them for other means that
- * providing to users a textual description of compression context states
- * used by the library. If unsure, ask on the mailing list.
+ * The counters are available only if the library was built with the option
+ * --enable-rohc-perf-counters of the configure script, so that they cost
+ * nothing otherwise. The function fails if they are not available.
  *
- * @param state  The compression context state to get a description for
- * @return       A string that describes the given compression context state
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_comp_perf_counters_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *
+ * @param comp              The ROHC compressor to get counters from
+ * @param[in,out] counters  The structure where counters will be stored
+ * @return                  true in case of success, false if the counters
+ *                          are not available or in case of error
  *
  * @ingroup rohc_comp
+ *
+ * @see rohc_comp_perf_counters_t
  */
-const char * rohc_comp_get_state_descr(const rohc_comp_state_t state)
+bool rohc_comp_get_perf_counters(const struct rohc_comp *const comp,
+                                 rohc_comp_perf_counters_t *const counters)
 {
-	switch(state)
+	if(comp == NULL)
 	{
-		case ROHC_COMP_STATE_IR:
-			return "IR";
-		case ROHC_COMP_STATE_FO:
-			return "FO";
-		case ROHC_COMP_STATE_SO:
-			return "SO";
-		case ROHC_COMP_STATE_CR:
-			return "CR";
-		case ROHC_COMP_STATE_UNKNOWN:
-		default:
-			return "no description";
+		goto error;
 	}
-}
-
-
-/*
- * Definitions of private functions
- */
-
 
-/**
- * @brief Find out a ROHC profile given a profile ID
- *
- * @param comp       The ROHC compressor
- * @param profile_id The ID of the ROHC profile to find out
- * @return           The ROHC profile if found, NULL otherwise
- */
-static const struct rohc_comp_profile *
-	rohc_get_profile_from_id(const struct rohc_comp *comp,
-	                         const rohc_profile_t profile_id)
-{
-	size_t i;
+	if(counters == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "structure for timing counters is not valid");
+		goto error;
+	}
 
-	/* test all compression profiles */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	/* check compatibility version */
+	if(counters->version_major == 0)
 	{
-		/* if the profile IDs match and the profile is enabled */
-		if(rohc_comp_profiles[i]->id == profile_id && comp->enabled_profiles[i])
+		if(counters->version_minor > 0)
 		{
-			return rohc_comp_profiles[i];
+			rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "unsupported minor version (%u) of the structure for "
+			           "timing counters", counters->version_minor);
+			goto error;
 		}
 	}
+	else
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for "
+		           "timing counters", counters->version_major);
+		goto error;
+	}
 
-	return NULL;
+#ifdef ROHC_PERF_COUNTERS
+	memcpy(counters->stages, comp->perf, sizeof(counters->stages));
+	return true;
+#else
+	rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	             "timing counters are not available, rebuild the library "
+	             "with --enable-rohc-perf-counters");
+#endif
+
+error:
+	return false;
 }
 
 
 /**
- * @brief Find out a ROHC profile given an IP protocol ID
+ * @brief Get a snapshot of the statistics of the compressor
  *
- * @param comp    The ROHC compressor
- * @param packet  The packet to find a compression profile for
- * @return        The ROHC profile if found, NULL otherwise
+ * Get a consistent snapshot of the statistics of the compressor. Unlike the
+ * other information functions, this one may be called from any thread, even
+ * while packets are being compressed: it never blocks the compression, and
+ * it never emits traces. The compressor shall not be destroyed meanwhile.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_stats_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *
+ * @param comp           The ROHC compressor to get statistics from
+ * @param[in,out] stats  The structure where statistics will be stored
+ * @return               true in case of success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_stats_t
+ * @see rohc_comp_get_ctxt_stats
  */
-static const struct rohc_comp_profile *
-	c_get_profile_from_packet(const struct rohc_comp *const comp,
-	                          const struct net_pkt *const packet)
+bool rohc_comp_get_stats(const struct rohc_comp *const comp,
+                         rohc_stats_t *const stats)
 {
-	size_t i;
-
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "try to find the best profile for packet with transport "
-	           "protocol %u", packet->transport->proto);
-
-	/* test all compression profiles */
-	for(i = 0; i < C_NUM_PROFILES; i++)
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(stats == NULL)
+	{
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(stats->version_major != 0 || stats->version_minor != 0)
+	{
+		goto error;
+	}
+
+	rohc_stats_read(comp->stats, stats);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get a snapshot of the statistics of one compression context
+ *
+ * Get a consistent snapshot of the statistics of the context identified by
+ * the given CID. The statistics are reset when a new context is created for
+ * the CID, they are kept when the context is destroyed: they are the ones of
+ * the context that uses the CID, or of the last context that used it. The
+ * \e failures_nr field is always 0 for contexts.
+ *
+ * The function may be called from any thread like \ref rohc_comp_get_stats.
+ *
+ * @param comp           The ROHC compressor to get statistics from
+ * @param cid            The CID of the context to get statistics for
+ * @param[in,out] stats  The structure where statistics will be stored
+ * @return               true in case of success, false otherwise
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_stats_t
+ * @see rohc_comp_get_stats
+ */
+bool rohc_comp_get_ctxt_stats(const struct rohc_comp *const comp,
+                              const rohc_cid_t cid,
+                              rohc_stats_t *const stats)
+{
+	if(comp == NULL)
+	{
+		goto error;
+	}
+	if(cid > comp->medium.max_cid)
+	{
+		goto error;
+	}
+	if(stats == NULL)
+	{
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(stats->version_major != 0 || stats->version_minor != 0)
+	{
+		goto error;
+	}
+
+	rohc_stats_read(&comp->ctxt_stats[cid], stats);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Give a description for the given ROHC compression context state
+ *
+ * Give a description for the given ROHC compression context state.
+ *
+ * The descriptions are not part of the API. They may change between
+ * releases without any warning. Do NOT use them for other means that
+ * providing to users a textual description of compression context states
+ * used by the library. If unsure, ask on the mailing list.
+ *
+ * @param state  The compression context state to get a description for
+ * @return       A string that describes the given compression context state
+ *
+ * @ingroup rohc_comp
+ */
+const char * rohc_comp_get_state_descr(const rohc_comp_state_t state)
+{
+	switch(state)
+	{
+		case ROHC_COMP_STATE_IR:
+			return "IR";
+		case ROHC_COMP_STATE_FO:
+			return "FO";
+		case ROHC_COMP_STATE_SO:
+			return "SO";
+		case ROHC_COMP_STATE_CR:
+			return "CR";
+		case ROHC_COMP_STATE_UNKNOWN:
+		default:
+			return "no description";
+	}
+}
+
+
+/*
+ * Definitions of private functions
+ */
+
+
+/**
+ * @brief Compress one uncompressed packet into a ROHC packet
+ *
+ * See \ref rohc_compress4 for details. The compressor and the output buffer
+ * pointer are checked by the callers.
+ *
+ * @param comp              The ROHC compressor
+ * @param uncomp_packet     The uncompressed packet to compress
+ * @param[out] rohc_packet  The resulting compressed ROHC packet
+ * @return                  The same values as \ref rohc_compress4
+ */
+static rohc_status_t c_compress_pkt(struct rohc_comp *const comp,
+                                    const struct rohc_buf uncomp_packet,
+                                    struct rohc_buf *const rohc_packet)
+{
+	struct rohc_comp_ctxt *c;
+	rohc_packet_t packet_type;
+	int rohc_hdr_size;
+	size_t payload_size;
+	size_t payload_offset;
+
+	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
+
+	/* check inputs validity */
+	if(rohc_buf_is_malformed(*rohc_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is malformed");
+		goto error;
+	}
+	if(!rohc_buf_is_empty(*rohc_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is not empty");
+		goto error;
+	}
+
+	/* create the ROHC header at the beginning of the output buffer */
+	rohc_packet->len = 0;
+	rohc_hdr_size = c_encode_hdr(comp, uncomp_packet, rohc_buf_data(*rohc_packet),
+	                             rohc_buf_avail_len(*rohc_packet), &c,
+	                             &packet_type, &payload_offset);
+	if(rohc_hdr_size < 0)
+	{
+		goto error;
+	}
+	rohc_packet->len += rohc_hdr_size;
+
+	/* the payload starts after the header, skip it */
+	rohc_buf_pull(rohc_packet, rohc_hdr_size);
+	payload_size = uncomp_packet.len - payload_offset;
+
+	/* is packet too large for output buffer? */
+	if(payload_size > rohc_buf_avail_len(*rohc_packet))
+	{
+		const size_t max_rohc_buf_len =
+			rohc_buf_avail_len(*rohc_packet) + rohc_hdr_size;
+
+		struct rohc_buf payload = uncomp_packet;
+
+		/* resulting ROHC packet too large, segmentation may be a solution */
+		rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		          "%s ROHC packet is too large for the given output buffer, "
+		          "try to segment it (input size = %zd, maximum output "
+		          "size = %zd, required output size = %d + %zd = %zd, "
+		          "MRRU = %zd)", rohc_get_packet_descr(packet_type),
+		          uncomp_packet.len, max_rohc_buf_len, rohc_hdr_size,
+		          payload_size, rohc_hdr_size + payload_size, comp->mrru);
+
+		/* store the whole ROHC packet in compressor (headers and payload only,
+		 * not feedbacks, feedbacks will be transmitted with the first segment
+		 * when rohc_comp_get_segment2() is called) */
+		rohc_buf_push(rohc_packet, rohc_hdr_size);
+		rohc_buf_pull(&payload, payload_offset);
+		if(!c_store_rru(comp, packet_type, rohc_buf_data(*rohc_packet),
+		                rohc_hdr_size, payload, false))
+		{
+			goto error_free_new_context;
+		}
+
+		/* reset the length of the ROHC packet: it shall be 0 for users */
+		rohc_packet->len = 0;
+
+		/* report to users that segmentation is possible */
+		status = ROHC_STATUS_SEGMENT;
+	}
+	else
+	{
+		/* copy full payload after ROHC header */
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "copy full %zd-byte payload", payload_size);
+		rohc_perf_start(payload_start);
+		rohc_buf_append(rohc_packet,
+		                rohc_buf_data_at(uncomp_packet, payload_offset),
+		                payload_size);
+		rohc_perf_stop(comp->perf, ROHC_COMP_PERF_PAYLOAD, payload_start);
+
+		/* unhide the ROHC header */
+		rohc_buf_push(rohc_packet, rohc_hdr_size);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "ROHC size = %zd bytes (header = %d, payload = %zu), output "
+		           "buffer size = %zu", rohc_packet->len, rohc_hdr_size,
+		           payload_size, rohc_buf_avail_len(*rohc_packet));
+
+		/* report to user that compression was successful */
+		status = ROHC_STATUS_OK;
+	}
+
+	c_update_stats(comp, c, packet_type, uncomp_packet.len, rohc_packet->len,
+	               payload_offset, rohc_hdr_size);
+
+	/* compression is successful */
+	return status;
+
+error_free_new_context:
+	/* free context if it was just created */
+	if(c->num_sent_packets <= 1)
+	{
+		c_destroy_context(comp, c);
+	}
+	c_update_stats_failure(comp);
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Create the ROHC header for one uncompressed packet
+ *
+ * Parse the uncompressed packet, find the best context for it (create one if
+ * needed), and let the profile of the context create the ROHC header. Fall
+ * back on the Uncompressed profile if the profile fails.
+ *
+ * The ROHC header is written in the given buffer. The uncompressed packet is
+ * read during the whole encoding, so the buffer shall not overlap it.
+ *
+ * @param comp                 The ROHC compressor
+ * @param uncomp_packet        The uncompressed packet to compress
+ * @param[out] rohc_hdr        The buffer for the ROHC header
+ * @param rohc_hdr_max_len     The maximum length of the ROHC header
+ * @param[out] context         The context used to compress the packet
+ * @param[out] packet_type     The type of the created ROHC packet
+ * @param[out] payload_offset  The offset of the payload in the uncompressed
+ *                             packet
+ * @return                     The length of the ROHC header,
+ *                             -1 in case of error
+ */
+static int c_encode_hdr(struct rohc_comp *const comp,
+                        const struct rohc_buf uncomp_packet,
+                        uint8_t *const rohc_hdr,
+                        const size_t rohc_hdr_max_len,
+                        struct rohc_comp_ctxt **const context,
+                        rohc_packet_t *const packet_type,
+                        size_t *const payload_offset)
+{
+	struct net_pkt ip_pkt;
+	struct rohc_comp_ctxt *c;
+	int rohc_hdr_size;
+
+	/* check inputs validity */
+	if(rohc_buf_is_malformed(uncomp_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is malformed");
+		goto error;
+	}
+	if(rohc_buf_is_empty(uncomp_packet))
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is empty");
+		goto error;
+	}
+
+	/* print uncompressed bytes */
+	if((comp->features & ROHC_COMP_FEATURE_DUMP_PACKETS) != 0)
+	{
+		rohc_dump_packet(comp->trace_callback, comp->trace_callback_priv,
+		                 ROHC_TRACE_COMP, ROHC_TRACE_DEBUG,
+		                 "uncompressed data, max 100 bytes", uncomp_packet);
+	}
+
+	/* parse the uncompressed packet */
+	rohc_perf_start(parse_start);
+	net_pkt_parse(&ip_pkt, uncomp_packet,
+	              (comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0,
+	              comp->trace_callback, comp->trace_callback_priv,
+	              comp->trace_level, ROHC_TRACE_COMP);
+	rohc_perf_stop(comp->perf, ROHC_COMP_PERF_PARSE, parse_start);
+
+	/* find the best context for the packet */
+	rohc_perf_start(find_start);
+	c = rohc_comp_find_ctxt(comp, &ip_pkt, -1, uncomp_packet.time);
+	rohc_perf_stop(comp->perf, ROHC_COMP_PERF_FIND_CTXT, find_start);
+	if(c == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "failed to find a matching context or to create a new "
+		             "context");
+		goto error;
+	}
+
+	/* use profile to compress packet */
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "compress the packet #%" PRIu64, comp->stats->packets_nr + 1);
+	rohc_perf_start(encode_start);
+	rohc_hdr_size = c->profile->encode(c, &ip_pkt, rohc_hdr, rohc_hdr_max_len,
+	                                   packet_type, payload_offset);
+	rohc_perf_stop(comp->perf, ROHC_COMP_PERF_ENCODE, encode_start);
+	if(rohc_hdr_size < 0)
+	{
+		/* error while compressing, use the Uncompressed profile
+		 * (except if we were already using the Uncompressed profile) */
+		if(c->profile->id == ROHC_PROFILE_UNCOMPRESSED)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "error while compressing with uncompressed profile, "
+			             "giving up");
+			goto error_free_new_context;
+		}
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "error while compressing with the profile, using "
+		             "uncompressed profile");
+
+		/* free context if it was just created */
+		if(c->num_sent_packets <= 1)
+		{
+			c_destroy_context(comp, c);
+		}
+
+		/* find the best context for the Uncompressed profile */
+		rohc_perf_start(uncomp_find_start);
+		c = rohc_comp_find_ctxt(comp, &ip_pkt, ROHC_PROFILE_UNCOMPRESSED,
+		                        uncomp_packet.time);
+		rohc_perf_stop(comp->perf, ROHC_COMP_PERF_FIND_CTXT, uncomp_find_start);
+		if(c == NULL)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to find a matching Uncompressed context or to "
+			             "create a new Uncompressed context");
+			goto error;
+		}
+
+		/* use the Uncompressed profile to compress the packet */
+		rohc_perf_start(uncomp_encode_start);
+		rohc_hdr_size = c->profile->encode(c, &ip_pkt, rohc_hdr, rohc_hdr_max_len,
+		                                   packet_type, payload_offset);
+		rohc_perf_stop(comp->perf, ROHC_COMP_PERF_ENCODE, uncomp_encode_start);
+		if(rohc_hdr_size < 0)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "error while compressing with uncompressed profile, "
+			             "giving up");
+			goto error_free_new_context;
+		}
+	}
+
+	*context = c;
+	return rohc_hdr_size;
+
+error_free_new_context:
+	/* free context if it was just created */
+	if(c->num_sent_packets <= 1)
+	{
+		c_destroy_context(comp, c);
+	}
+error:
+	c_update_stats_failure(comp);
+	return -1;
+}
+
+
+/**
+ * @brief Update the statistics once one packet was compressed
+ *
+ * Update the compressor statistics and the context statistics (global + last
+ * packet).
+ *
+ * @param comp            The ROHC compressor
+ * @param context         The context used to compress the packet
+ * @param packet_type     The type of the created ROHC packet
+ * @param uncomp_len      The length of the uncompressed packet
+ * @param rohc_len        The length of the ROHC packet (0 if segmented)
+ * @param uncomp_hdr_len  The length of the uncompressed headers
+ * @param rohc_hdr_len    The length of the ROHC header
+ */
+static void c_update_stats(struct rohc_comp *const comp,
+                           struct rohc_comp_ctxt *const context,
+                           const rohc_packet_t packet_type,
+                           const size_t uncomp_len,
+                           const size_t rohc_len,
+                           const size_t uncomp_hdr_len,
+                           const size_t rohc_hdr_len)
+{
+	struct rohc_stats *const ctxt_stats = &comp->ctxt_stats[context->cid];
+
+	rohc_stats_write_begin(comp->stats);
+	comp->stats->packets_nr++;
+	comp->stats->uncomp_bytes_nr += uncomp_len;
+	comp->stats->comp_bytes_nr += rohc_len;
+	comp->stats->uncomp_hdr_bytes_nr += uncomp_hdr_len;
+	comp->stats->comp_hdr_bytes_nr += rohc_hdr_len;
+	rohc_stats_write_end(comp->stats);
+	comp->last_context = context;
+
+	context->packet_type = packet_type;
+
+	rohc_stats_write_begin(ctxt_stats);
+	ctxt_stats->packets_nr++;
+	ctxt_stats->uncomp_bytes_nr += uncomp_len;
+	ctxt_stats->comp_bytes_nr += rohc_len;
+	ctxt_stats->uncomp_hdr_bytes_nr += uncomp_hdr_len;
+	ctxt_stats->comp_hdr_bytes_nr += rohc_hdr_len;
+	rohc_stats_write_end(ctxt_stats);
+	context->num_sent_packets++;
+
+	context->total_last_uncompressed_size = uncomp_len;
+	context->total_last_compressed_size = rohc_len;
+	context->header_last_uncompressed_size = uncomp_hdr_len;
+	context->header_last_compressed_size = rohc_hdr_len;
+}
+
+
+/**
+ * @brief Update the statistics once one packet failed to be compressed
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_update_stats_failure(struct rohc_comp *const comp)
+{
+	rohc_stats_write_begin(comp->stats);
+	comp->stats->failures_nr++;
+	rohc_stats_write_end(comp->stats);
+}
+
+
+/**
+ * @brief Store one ROHC packet in the RRU for segmentation
+ *
+ * The ROHC header is copied in the RRU buffer, followed by the FCS-32 CRC of
+ * the whole ROHC packet. The payload is either copied between them, or kept
+ * in the uncompressed packet if \e keep_payload is set: it is then read
+ * again when the segments are retrieved.
+ *
+ * @param comp          The ROHC compressor
+ * @param packet_type   The type of the ROHC packet
+ * @param rohc_hdr      The ROHC header
+ * @param rohc_hdr_len  The length of the ROHC header
+ * @param payload       The payload of the ROHC packet
+ * @param keep_payload  Whether the payload shall be kept in the uncompressed
+ *                      packet instead of being copied in the RRU buffer
+ * @return              true if the ROHC packet was stored in the RRU,
+ *                      false if it is too large for the MRRU
+ */
+static bool c_store_rru(struct rohc_comp *const comp,
+                        const rohc_packet_t packet_type,
+                        const uint8_t *const rohc_hdr,
+                        const size_t rohc_hdr_len,
+                        const struct rohc_buf payload,
+                        const bool keep_payload)
+{
+	uint32_t rru_crc;
+
+	/* in order to be segmented, a ROHC packet shall be <= MRRU
+	 * (remember that MRRU includes the CRC length) */
+	if((rohc_hdr_len + payload.len + CRC_FCS32_LEN) > comp->mrru)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "%s ROHC packet cannot be segmented: too large (%zu + "
+		             "%zu + %u = %zu bytes) for MRRU (%zu bytes)",
+		             rohc_get_packet_descr(packet_type), rohc_hdr_len,
+		             payload.len, CRC_FCS32_LEN, rohc_hdr_len +
+		             payload.len + CRC_FCS32_LEN, comp->mrru);
+		goto error;
+	}
+	rohc_info(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	          "%s ROHC packet can be segmented (MRRU = %zd)",
+	          rohc_get_packet_descr(packet_type), comp->mrru);
+
+	if(comp->rru_len != 0)
+	{
+		/* warn users about previous, not yet retrieved RRU */
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "erase the existing %zd-byte RRU that was not "
+		             "retrieved yet (call rohc_comp_get_segment2() to add "
+		             "support for ROHC segments in your application)",
+		             comp->rru_len);
+	}
+	comp->rru_off = 0;
+
+	/* ROHC header */
+	memcpy(comp->rru, rohc_hdr, rohc_hdr_len);
+	comp->rru_len = rohc_hdr_len;
+	rohc_perf_start(crc_start);
+	rru_crc = crc_calc_fcs32(rohc_buf_data(payload), payload.len,
+	                         crc_calc_fcs32(rohc_hdr, rohc_hdr_len,
+	                                        CRC_INIT_FCS32));
+	rohc_perf_stop(comp->perf, ROHC_COMP_PERF_CRC, crc_start);
+
+	/* ROHC payload */
+	comp->rru_payload = payload;
+	if(keep_payload)
+	{
+		comp->rru_payload_off = comp->rru_len;
+	}
+	else
+	{
+		memcpy(comp->rru + comp->rru_len, rohc_buf_data(payload), payload.len);
+		comp->rru_len += payload.len;
+		comp->rru_payload.len = 0;
+		comp->rru_payload_off = comp->rru_len + CRC_FCS32_LEN;
+	}
+
+	/* FCS-32 CRC over header and payload (optional feedbacks and the CRC
+	 * field itself are excluded) */
+	memcpy(comp->rru + comp->rru_len, &rru_crc, CRC_FCS32_LEN);
+	comp->rru_len += CRC_FCS32_LEN;
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "RRU 32-bit FCS CRC = 0x%08x", rohc_ntoh32(rru_crc));
+
+	/* the payload kept in the uncompressed packet belongs to the RRU too */
+	comp->rru_len += comp->rru_payload.len;
+	assert(comp->rru_len <= comp->mrru);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Take the next bytes of the RRU for one segment
+ *
+ * The bytes are made of up to three parts: the bytes of the RRU buffer
+ * located before the payload kept in the uncompressed packet, the bytes of
+ * that payload, and the bytes of the RRU buffer located after it. The head
+ * and the tail are contiguous if no payload was kept in the uncompressed
+ * packet.
+ *
+ * @param comp           The ROHC compressor
+ * @param chunk_len      The number of bytes to take, at most the remaining
+ *                       length of the RRU
+ * @param[out] head      The head bytes in the RRU buffer
+ * @param[out] head_len  The number of head bytes
+ * @param[out] payload   The bytes of the payload kept in the uncompressed
+ *                       packet, empty if none
+ * @param[out] tail      The tail bytes in the RRU buffer
+ * @param[out] tail_len  The number of tail bytes
+ */
+static void c_pull_rru(struct rohc_comp *const comp,
+                       const size_t chunk_len,
+                       const uint8_t **const head,
+                       size_t *const head_len,
+                       struct rohc_buf *const payload,
+                       const uint8_t **const tail,
+                       size_t *const tail_len)
+{
+	assert(chunk_len <= comp->rru_len);
+
+	*head = comp->rru + comp->rru_off;
+	if(comp->rru_off < comp->rru_payload_off)
+	{
+		*head_len = rohc_min(chunk_len, comp->rru_payload_off - comp->rru_off);
+	}
+	else
+	{
+		*head_len = 0;
+	}
+
+	*payload = comp->rru_payload;
+	payload->len = rohc_min(chunk_len - (*head_len), comp->rru_payload.len);
+	rohc_buf_pull(&comp->rru_payload, payload->len);
+
+	*tail = (*head) + (*head_len);
+	*tail_len = chunk_len - (*head_len) - payload->len;
+
+	comp->rru_off += (*head_len) + (*tail_len);
+	comp->rru_len -= chunk_len;
+}
+
+
+/**
+ * @brief Find out a ROHC profile given a profile ID
+ *
+ * @param comp       The ROHC compressor
+ * @param profile_id The ID of the ROHC profile to find out
+ * @return           The ROHC profile if found, NULL otherwise
+ */
+static const struct rohc_comp_profile *
+	rohc_get_profile_from_id(const struct rohc_comp *comp,
+	                         const rohc_profile_t profile_id)
+{
+	size_t i;
+
+	/* test all compression profiles */
+	for(i = 0; i < C_NUM_PROFILES; i++)
+	{
+		/* if the profile IDs match and the profile is enabled */
+		if(rohc_comp_profiles[i]->id == profile_id && comp->enabled_profiles[i])
+		{
+			return rohc_comp_profiles[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Find out a ROHC profile given an IP protocol ID
+ *
+ * Only the enabled profiles that may accept the transport protocol of the
+ * packet are tested, in priority order (see \ref c_update_profiles_dispatch).
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to find a compression profile for
+ * @return        The ROHC profile if found, NULL otherwise
+ */
+static const struct rohc_comp_profile *
+	c_get_profile_from_packet(const struct rohc_comp *const comp,
+	                          const struct net_pkt *const packet)
+{
+	const uint8_t proto = packet->transport->proto;
+	size_t i;
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "try to find the best profile for packet with transport "
+	           "protocol %u", proto);
+
+	/* test the compression profiles for the transport protocol */
+	for(i = 0; i < comp->profiles_by_proto_nr[proto]; i++)
+	{
+		const struct rohc_comp_profile *const profile =
+			rohc_comp_profiles[comp->profiles_by_proto[proto][i]];
+
+		/* does the profile accept the packet? */
+		if(!profile->check_profile(comp, packet))
+		{
+			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			           "skip profile '%s' (0x%04x) because it does not match "
+			           "packet", rohc_get_profile_descr(profile->id), profile->id);
+			continue;
+		}
+
+		/* the packet is compatible with the profile, let's go with it! */
+		return profile;
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Build the table of the profiles to test for every transport protocol
+ *
+ * For every IP protocol, the table lists the enabled profiles that may
+ * accept a packet with that transport protocol, in the priority order of
+ * the compression profiles. A profile bound to another transport protocol
+ * is never listed, except for tunneling protocols because the profiles may
+ * handle more IP headers than the packet parser does.
+ *
+ * The table shall be updated every time a profile is enabled or disabled.
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_update_profiles_dispatch(struct rohc_comp *const comp)
+{
+	size_t proto;
+
+	for(proto = 0; proto <= UINT8_MAX; proto++)
+	{
+		const bool is_tunnel = rohc_is_tunneling(proto);
+		uint8_t nr = 0;
+		size_t i;
+
+		for(i = 0; i < C_NUM_PROFILES; i++)
+		{
+			if(comp->enabled_profiles[i] &&
+			   (is_tunnel || rohc_comp_profiles[i]->protocol == 0 ||
+			    rohc_comp_profiles[i]->protocol == proto))
+			{
+				comp->profiles_by_proto[proto][nr] = i;
+				nr++;
+			}
+		}
+		comp->profiles_by_proto_nr[proto] = nr;
+	}
+}
+
+
+/**
+ * @brief Create a compression context
+ *
+ * @param comp          The ROHC compressor
+ * @param profile       The profile to associate the context with
+ * @param packet        The packet to create a compression context for
+ * @param arrival_time  The time at which packet was received (0 if unknown,
+ *                      or to disable time-related features in ROHC protocol)
+ * @param do_ctxt_replication  Are we able to replicate an existing context?
+ * @param cid_for_replication  The context to replicate if any
+ * @return              The compression context if successful, NULL otherwise
+ */
+static struct rohc_comp_ctxt *
+	c_create_context(struct rohc_comp *const comp,
+	                 const struct rohc_comp_profile *const profile,
+	                 const struct net_pkt *const packet,
+	                 const struct rohc_ts arrival_time,
+	                 const bool do_ctxt_replication,
+	                 const rohc_cid_t cid_for_replication)
+{
+	struct rohc_comp_ctxt *c;
+	rohc_cid_t cid_to_use;
+
+	assert(comp != NULL);
+	assert(profile != NULL);
+	assert(packet != NULL);
+
+	/* if all the contexts in the array are used:
+	 *   => recycle the least recently used context to make room
+	 * then pick the first unused context (the one with the smallest CID)
+	 */
+	if(comp->num_contexts_used > comp->medium.max_cid)
+	{
+		/* all the contexts in the array were used, recycle the oldest context
+		 * to make some room: it is the first one of the LRU list */
+		assert(comp->lru_cid_first != ROHC_COMP_CID_NONE);
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "recycle oldest context (CID = %zu)", comp->lru_cid_first);
+		c_destroy_context(comp, &comp->contexts[comp->lru_cid_first]);
+	}
+
+	/* take the unused context with the smallest CID */
+	cid_to_use = c_free_cids_take(comp);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "take the first unused context (CID = %zu)", cid_to_use);
+
+	/* initialize the previously found context */
+	c = &comp->contexts[cid_to_use];
+
+	/* context replication? */
+	if(do_ctxt_replication && cid_to_use != cid_for_replication)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "create context with CID = %zu as a replication of context "
+		           "with CID %zu", cid_to_use, cid_for_replication);
+
+		/* copy the base context, then reset some parts of it */
+		memcpy(c, &(comp->contexts[cid_for_replication]), sizeof(struct rohc_comp_ctxt));
+		c->do_ctxt_replication = true;
+		c->cr_base_cid = cid_for_replication;
+		c->cr_count = 0;
+	}
+	else
+	{
+		c->do_ctxt_replication = false;
+	}
+
+	c->ir_count = 0;
+	c->fo_count = 0;
+	c->so_count = 0;
+	c->go_back_fo_count = 0;
+	c->go_back_fo_time = arrival_time;
+	c->go_back_ir_count = 0;
+	c->go_back_ir_time = arrival_time;
+
+	rohc_stats_reset(&comp->ctxt_stats[cid_to_use]);
+
+	c->total_last_uncompressed_size = 0;
+	c->total_last_compressed_size = 0;
+	c->header_last_uncompressed_size = 0;
+	c->header_last_compressed_size = 0;
+
+	c->num_sent_packets = 0;
+
+	c->cid = cid_to_use;
+	c->key = packet->key;
+	c->hash_next = ROHC_COMP_CID_NONE;
+	c->profile = profile;
+
+	c->mode = ROHC_U_MODE;
+
+	/* use Context Replication (CR) compressor state instead of IR */
+	if(c->do_ctxt_replication)
+	{
+		c->state = ROHC_COMP_STATE_CR;
+	}
+	else
+	{
+		c->state = ROHC_COMP_STATE_IR;
+	}
+
+	c->compressor = comp;
+
+	/* create profile-specific context */
+	if(c->do_ctxt_replication)
+	{
+		if(!profile->clone(c, &(comp->contexts[cid_for_replication])))
+		{
+			goto release_cid;
+		}
+	}
+	else
+	{
+		if(!profile->create(c, packet))
+		{
+			goto release_cid;
+		}
+	}
+
+	/* if creation is successful, mark the context as used */
+	c->used = 1;
+	c->first_used = arrival_time.sec;
+	c->latest_used = arrival_time.sec;
+	assert(comp->num_contexts_used <= comp->medium.max_cid);
+	comp->num_contexts_used++;
+
+	/* the new context is the most recently used one */
+	c_lru_append_context(comp, c);
+
+	/* index the context by its flow key if the profile allows it */
+	if(c_profile_is_hashed(profile))
+	{
+		c_hash_add_context(comp, c);
+	}
+
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "context (CID = %zu) created at %" PRIu64 " seconds (num_used = %zu)",
+	           c->cid, c->latest_used, comp->num_contexts_used);
+	return c;
+
+release_cid:
+	/* the CID is not used, give it back */
+	c->used = 0;
+	c_free_cids_add(comp, c->cid);
+	return NULL;
+}
+
+
+/**
+ * @brief Find a compression context given an IP packet
+ *
+ * @param comp             The ROHC compressor
+ * @param packet           The packet to find a compression context for
+ * @param profile_id_hint  If positive, indicate the profile to use
+ * @param arrival_time     The time at which packet was received
+ *                         (0 if unknown, or to disable time-related features
+ *                          in the ROHC protocol)
+ * @return                 The context if found or successfully created,
+ *                         NULL if not found
+ */
+static struct rohc_comp_ctxt *
+	rohc_comp_find_ctxt(struct rohc_comp *const comp,
+	                    const struct net_pkt *const packet,
+	                    const int profile_id_hint,
+	                    const struct rohc_ts arrival_time)
+{
+	const struct rohc_comp_profile *profile;
+	struct rohc_comp_ctxt *context = NULL;
+	bool is_profile_hashed;
+	size_t num_used_ctxt_seen = 0;
+	rohc_cid_t i;
+
+	size_t best_cr_score = 0;
+	bool do_ctxt_replication = false;
+	rohc_cid_t best_ctxt_for_replication = ROHC_COMP_CID_NONE;
+
+	/* use the suggested profile if any, otherwise try the recently used
+	 * contexts first, then find the best profile for the packet */
+	if(profile_id_hint < 0)
+	{
+		context = c_find_recent_context(comp, packet);
+		if(context != NULL)
+		{
+			comp->num_recent_ctxt_hits++;
+			c_touch_context(comp, context, arrival_time);
+			c_recent_add_context(comp, context);
+			return context;
+		}
+		comp->num_recent_ctxt_misses++;
+
+		profile = c_get_profile_from_packet(comp, packet);
+	}
+	else
 	{
-		bool check_profile;
+		profile = rohc_get_profile_from_id(comp, profile_id_hint);
+	}
+	if(profile == NULL)
+	{
+		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		             "no profile found for packet, giving up");
+		goto not_found;
+	}
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "using profile '%s' (0x%04x)",
+	           rohc_get_profile_descr(profile->id), profile->id);
 
-		/* skip profile if the profile is not enabled */
-		if(!comp->enabled_profiles[i])
+	/* if the contexts of the profile are indexed by flow key, look only at
+	 * the contexts that share the hash bucket of the packet: they are sorted
+	 * by CID, so the context with the smallest CID is still preferred */
+	is_profile_hashed = c_profile_is_hashed(profile);
+	if(is_profile_hashed)
+	{
+		for(i = comp->contexts_hash[packet->key & comp->contexts_hash_mask];
+		    i != ROHC_COMP_CID_NONE && context == NULL;
+		    i = comp->contexts[i].hash_next)
 		{
+			size_t cr_score = 0;
+
+			/* don't look at contexts with the wrong flow key or profile */
+			if(comp->contexts[i].key != packet->key ||
+			   comp->contexts[i].profile->id != profile->id)
+			{
+				continue;
+			}
+
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "skip disabled profile '%s' (0x%04x)",
-			           rohc_get_profile_descr(rohc_comp_profiles[i]->id),
-			           rohc_comp_profiles[i]->id);
-			continue;
+			           "check context CID = %zu with same flow key and profile", i);
+
+			/* ask the profile whether the packet matches the context */
+			if(c_check_context(comp, &comp->contexts[i], packet, &cr_score))
+			{
+				context = &comp->contexts[i];
+			}
 		}
+	}
 
-		/* does the profile accept the packet? */
-		check_profile = rohc_comp_profiles[i]->check_profile(comp, packet);
-		if(!check_profile)
+	/* if the profile is not indexed by flow key, all the contexts with the
+	 * same profile shall be checked ; if the profile is indexed by flow key
+	 * but no context was found, the established contexts with the same profile
+	 * shall be checked for Context Replication if the profile supports it */
+	if(context == NULL && (!is_profile_hashed || profile->clone != NULL))
+	{
+		for(i = 0; i <= comp->medium.max_cid; i++)
 		{
+			bool is_feedback_channel_available;
+			bool is_static_part_transmitted;
+			bool is_ctxt_established;
+			size_t cr_score = 0;
+
+			/* don't even look at unused contexts */
+			if(!comp->contexts[i].used)
+			{
+				continue;
+			}
+			num_used_ctxt_seen++;
+
+			/* if all used contexts were checked, no need go search further */
+			if(num_used_ctxt_seen > comp->num_contexts_used)
+			{
+				break;
+			}
+
+			/* don't look at contexts with the wrong profile */
+			if(comp->contexts[i].profile->id != profile->id)
+			{
+				continue;
+			}
+
+			/* several contexts may be used as basis for context replication:
+			 *  - drop the ones that are not fully established with decompressor
+			 *    (fully established means that the static part of the context
+			 *    was explicitely acknowledged by the decompressor through one
+			 *    ACK protected by a CRC),
+			 *  - keep the one that is the nearest from the new stream (more bytes
+			 *    in common) */
+			is_feedback_channel_available =
+				!!(comp->contexts[i].mode > ROHC_U_MODE);
+			is_static_part_transmitted =
+				!!(comp->contexts[i].state == ROHC_COMP_STATE_FO ||
+				   comp->contexts[i].state == ROHC_COMP_STATE_SO);
+			is_ctxt_established =
+				(is_feedback_channel_available && is_static_part_transmitted);
+
+			/* contexts indexed by flow key were already checked, only the ones
+			 * that may be used for Context Replication are interesting */
+			if(is_profile_hashed && !is_ctxt_established)
+			{
+				continue;
+			}
+
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "skip profile '%s' (0x%04x) because it does not match "
-			           "packet",rohc_get_profile_descr(rohc_comp_profiles[i]->id),
-			           rohc_comp_profiles[i]->id);
-			continue;
+			           "check context CID = %zu with same profile", i);
+
+			/* ask the profile whether the packet matches the context */
+			if(c_check_context(comp, &comp->contexts[i], packet, &cr_score))
+			{
+				context = &comp->contexts[i];
+				break;
+			}
+			rohc_comp_debug(&comp->contexts[i], "context CID %zu scores %zu for "
+			                "Context Replication", i, cr_score);
+
+			if(is_ctxt_established && cr_score > best_cr_score)
+			{
+				do_ctxt_replication = true;
+				best_ctxt_for_replication = i;
+				best_cr_score = cr_score;
+				rohc_comp_debug(&comp->contexts[i], "context CID %zu is best for "
+				                "Context Replication", i);
+			}
 		}
+	}
 
-		/* the packet is compatible with the profile, let's go with it! */
-		return rohc_comp_profiles[i];
+	if(context == NULL)
+	{
+		/* context not found, create a new one */
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "no existing context found for packet, create a new one");
+		context = c_create_context(comp, profile, packet, arrival_time,
+		                           do_ctxt_replication, best_ctxt_for_replication);
+		if(context == NULL)
+		{
+			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+			             "failed to create a new context");
+			goto not_found;
+		}
+	}
+	else
+	{
+		/* matching context found, update use timestamp */
+		c_touch_context(comp, context, arrival_time);
+	}
+
+	/* try the context first for the next packets of the flow */
+	if(c_profile_is_hashed(context->profile))
+	{
+		c_recent_add_context(comp, context);
 	}
 
+	return context;
+
+not_found:
 	return NULL;
 }
 
 
 /**
- * @brief Create a compression context
+ * @brief Record that the given context is used by a new packet
  *
  * @param comp          The ROHC compressor
- * @param profile       The profile to associate the context with
- * @param packet        The packet to create a compression context for
- * @param arrival_time  The time at which packet was received (0 if unknown,
- *                      or to disable time-related features in ROHC protocol)
- * @param do_ctxt_replication  Are we able to replicate an existing context?
- * @param cid_for_replication  The context to replicate if any
- * @return              The compression context if successful, NULL otherwise
+ * @param context       The compression context used by the packet
+ * @param arrival_time  The time at which packet was received
+ */
+static void c_touch_context(struct rohc_comp *const comp,
+                            struct rohc_comp_ctxt *const context,
+                            const struct rohc_ts arrival_time)
+{
+	context->latest_used = arrival_time.sec;
+	c_lru_remove_context(comp, context);
+	c_lru_append_context(comp, context);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "context (CID = %zu) used at %" PRIu64 " seconds",
+	           context->cid, context->latest_used);
+}
+
+
+/**
+ * @brief Check whether the given packet may re-use the given context
+ *
+ * The profile decides whether the packet matches the context. If the context
+ * is a replication of another context that is still in progress, the base
+ * context shall not have changed too much.
+ *
+ * @param comp           The ROHC compressor
+ * @param context        The compression context to check
+ * @param packet         The packet to check
+ * @param[out] cr_score  The score of the context for Context Replication (CR)
+ * @return               true if the packet may re-use the context,
+ *                       false if it shall not
+ */
+static bool c_check_context(const struct rohc_comp *const comp,
+                            const struct rohc_comp_ctxt *const context,
+                            const struct net_pkt *const packet,
+                            size_t *const cr_score)
+{
+	const struct rohc_comp_ctxt *base_ctxt;
+	size_t cr_score_base_ctxt = 0;
+	bool base_ctxt_equals_ctxt;
+
+	/* ask the profile whether the packet matches the context */
+	if(!context->profile->check_context(context, packet, cr_score))
+	{
+		return false;
+	}
+
+	/* hmmm, looks like we could re-use that context ; if Context Replication
+	 * is in action, check that the base context didn't change too much */
+	if(!context->do_ctxt_replication ||
+	   context->state != ROHC_COMP_STATE_CR ||
+	   context->cr_count >= MAX_CR_COUNT)
+	{
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "re-using context CID = %zu", context->cid);
+		return true;
+	}
+
+	/* check whether the base context changed too much to be re-used or not */
+	base_ctxt = &(comp->contexts[context->cr_base_cid]);
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "Context Replication in action (%zu/%u packets sent): check "
+	           "for CID %zu whether base context with CID %zu changed too much",
+	           context->cr_count, MAX_CR_COUNT, context->cid, base_ctxt->cid);
+	base_ctxt_equals_ctxt =
+		context->profile->check_context(base_ctxt, packet, &cr_score_base_ctxt);
+	/* there are two ways the base context may have changed:
+	 *   - the base context now matches exactly the replicated context
+	 *   - the base context does not share enough with the replicated context */
+	if(!base_ctxt_equals_ctxt && cr_score_base_ctxt > 0)
+	{
+		/* no large change, we may continue the Context Replication */
+		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "re-using context CID = %zu as a replication of context "
+		           "CID %zu", context->cid, base_ctxt->cid);
+		return true;
+	}
+
+	/* too much change, we need to interrupt the Context Replication */
+	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+	           "cannot re-use context CID = %zu as replication of context "
+	           "CID %zu, the base context changed too much", context->cid,
+	           base_ctxt->cid);
+	*cr_score = 0;
+	/* TODO: destroy that half-opened context */
+	return false;
+}
+
+
+/**
+ * @brief Find out a context given its CID
+ *
+ * @param comp The ROHC compressor
+ * @param cid  The CID of the context to find
+ * @return     The context with the given CID if found, NULL otherwise
  */
 static struct rohc_comp_ctxt *
-	c_create_context(struct rohc_comp *const comp,
-	                 const struct rohc_comp_profile *const profile,
-	                 const struct net_pkt *const packet,
-	                 const struct rohc_ts arrival_time,
-	                 const bool do_ctxt_replication,
-	                 const rohc_cid_t cid_for_replication)
+	c_get_context(struct rohc_comp *const comp, const rohc_cid_t cid)
 {
-	struct rohc_comp_ctxt *c;
-	rohc_cid_t cid_to_use;
+	/* the CID must not be larger than the context array */
+	if(cid > comp->medium.max_cid)
+	{
+		goto not_found;
+	}
 
-	assert(comp != NULL);
-	assert(profile != NULL);
-	assert(packet != NULL);
+	/* the context with the given CID must be in use */
+	if(comp->contexts[cid].used == 0)
+	{
+		goto not_found;
+	}
+
+	return &(comp->contexts[cid]);
+
+not_found:
+	return NULL;
+}
+
+
+/**
+ * @brief Destroy the given compression context
+ *
+ * The profile-specific context is destroyed, and the context is released
+ * so that its CID may be used again.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to destroy
+ */
+static void c_destroy_context(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+{
+	c_release_context(comp, context);
+	c_free_cids_add(comp, context->cid);
+}
+
+
+/**
+ * @brief Release the given compression context
+ *
+ * The profile-specific context is destroyed, and the context is removed from
+ * the hash table and from the LRU list. Its CID is not marked as unused.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to release
+ */
+static void c_release_context(struct rohc_comp *const comp,
+                              struct rohc_comp_ctxt *const context)
+{
+	assert(context->used);
+
+	if(c_profile_is_hashed(context->profile))
+	{
+		c_hash_remove_context(comp, context);
+	}
+	c_lru_remove_context(comp, context);
+	context->profile->destroy(context);
+	context->used = 0;
+	assert(comp->num_contexts_used > 0);
+	comp->num_contexts_used--;
+}
+
+
+/**
+ * @brief Mark all the CIDs as unused
+ *
+ * @param comp  The ROHC compressor
+ */
+static void c_free_cids_init(struct rohc_comp *const comp)
+{
+	const size_t cids_nr = comp->medium.max_cid + 1;
+	const size_t words_nr =
+		(cids_nr + ROHC_COMP_FREE_CIDS_BITS - 1) / ROHC_COMP_FREE_CIDS_BITS;
+	size_t i;
+
+	memset(comp->free_cids, 0, words_nr * sizeof(uint64_t));
+	memset(comp->free_cids_summary, 0, sizeof(comp->free_cids_summary));
+	for(i = 0; i < cids_nr; i++)
+	{
+		c_free_cids_add(comp, i);
+	}
+}
+
+
+/**
+ * @brief Mark the given CID as unused
+ *
+ * @param comp  The ROHC compressor
+ * @param cid   The CID of the unused compression context
+ */
+static void c_free_cids_add(struct rohc_comp *const comp, const rohc_cid_t cid)
+{
+	const size_t word = cid / ROHC_COMP_FREE_CIDS_BITS;
 
-	cid_to_use = 0;
+	assert(cid <= comp->medium.max_cid);
+	assert(!comp->contexts[cid].used);
 
-	/* if all the contexts in the array are used:
-	 *   => recycle the oldest context to make room
-	 * if at least one context in the array is not used:
-	 *   => pick the first unused context
-	 */
-	if(comp->num_contexts_used > comp->medium.max_cid)
-	{
-		/* all the contexts in the array were used, recycle the oldest context
-		 * to make some room */
+	comp->free_cids[word] |= UINT64_C(1) << (cid % ROHC_COMP_FREE_CIDS_BITS);
+	comp->free_cids_summary[word / ROHC_COMP_FREE_CIDS_BITS] |=
+		UINT64_C(1) << (word % ROHC_COMP_FREE_CIDS_BITS);
+}
 
-		uint64_t oldest;
-		rohc_cid_t i;
 
-		/* find the oldest context */
-		oldest = 0xffffffff;
-		for(i = 0; i <= comp->medium.max_cid; i++)
-		{
-			if(comp->contexts[i].latest_used < oldest)
-			{
-				oldest = comp->contexts[i].latest_used;
-				cid_to_use = i;
-			}
-		}
+/**
+ * @brief Take the smallest unused CID
+ *
+ * The smallest CIDs are the cheapest to transmit, so they are used first.
+ * The summary of the bitmap gives the first word with an unused CID, so the
+ * CID is found with two find-first-set operations whatever the MAX_CID.
+ *
+ * @param comp  The ROHC compressor, with at least one unused CID
+ * @return      The smallest unused CID, now marked as used
+ */
+static rohc_cid_t c_free_cids_take(struct rohc_comp *const comp)
+{
+	size_t summary_word = 0;
+	size_t word;
+	rohc_cid_t cid;
 
-		/* destroy the oldest context before replacing it with a new one */
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "recycle oldest context (CID = %zu)", cid_to_use);
-		comp->contexts[cid_to_use].profile->destroy(&comp->contexts[cid_to_use]);
-		comp->contexts[cid_to_use].used = 0;
-		assert(comp->num_contexts_used > 0);
-		comp->num_contexts_used--;
-	}
-	else
+	while(comp->free_cids_summary[summary_word] == 0)
 	{
-		/* there was at least one unused context in the array, pick the first
-		 * unused context in the context array */
-
-		rohc_cid_t i;
-
-		/* find the first unused context */
-		for(i = 0; i <= comp->medium.max_cid; i++)
-		{
-			if(comp->contexts[i].used == 0)
-			{
-				cid_to_use = i;
-				break;
-			}
-		}
+		summary_word++;
+		assert(summary_word < ROHC_COMP_FREE_CIDS_SUMMARY_LEN);
+	}
+	word = summary_word * ROHC_COMP_FREE_CIDS_BITS +
+	       __builtin_ctzll(comp->free_cids_summary[summary_word]);
+	assert(comp->free_cids[word] != 0);
+	cid = word * ROHC_COMP_FREE_CIDS_BITS + __builtin_ctzll(comp->free_cids[word]);
+	assert(cid <= comp->medium.max_cid);
 
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "take the first unused context (CID = %zu)", cid_to_use);
+	comp->free_cids[word] &= comp->free_cids[word] - 1;
+	if(comp->free_cids[word] == 0)
+	{
+		comp->free_cids_summary[summary_word] &=
+			~(UINT64_C(1) << (word % ROHC_COMP_FREE_CIDS_BITS));
 	}
 
-	/* initialize the previously found context */
-	c = &comp->contexts[cid_to_use];
+	return cid;
+}
 
-	/* context replication? */
-	if(do_ctxt_replication && cid_to_use != cid_for_replication)
-	{
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "create context with CID = %zu as a replication of context "
-		           "with CID %zu", cid_to_use, cid_for_replication);
 
-		/* copy the base context, then reset some parts of it */
-		memcpy(c, &(comp->contexts[cid_for_replication]), sizeof(struct rohc_comp_ctxt));
-		c->do_ctxt_replication = true;
-		c->cr_base_cid = cid_for_replication;
-		c->cr_count = 0;
+/**
+ * @brief Append the given context at the end of the LRU list
+ *
+ * The context becomes the most recently used one.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to append
+ */
+static void c_lru_append_context(struct rohc_comp *const comp,
+                                 struct rohc_comp_ctxt *const context)
+{
+	context->lru_prev = comp->lru_cid_last;
+	context->lru_next = ROHC_COMP_CID_NONE;
+	if(comp->lru_cid_last == ROHC_COMP_CID_NONE)
+	{
+		comp->lru_cid_first = context->cid;
 	}
 	else
 	{
-		c->do_ctxt_replication = false;
+		comp->contexts[comp->lru_cid_last].lru_next = context->cid;
 	}
+	comp->lru_cid_last = context->cid;
+}
 
-	c->ir_count = 0;
-	c->fo_count = 0;
-	c->so_count = 0;
-	c->go_back_fo_count = 0;
-	c->go_back_fo_time = arrival_time;
-	c->go_back_ir_count = 0;
-	c->go_back_ir_time = arrival_time;
-
-	c->total_uncompressed_size = 0;
-	c->total_compressed_size = 0;
-	c->header_uncompressed_size = 0;
-	c->header_compressed_size = 0;
-
-	c->total_last_uncompressed_size = 0;
-	c->total_last_compressed_size = 0;
-	c->header_last_uncompressed_size = 0;
-	c->header_last_compressed_size = 0;
-
-	c->num_sent_packets = 0;
-
-	c->cid = cid_to_use;
-	c->profile = profile;
-
-	c->mode = ROHC_U_MODE;
 
-	/* use Context Replication (CR) compressor state instead of IR */
-	if(c->do_ctxt_replication)
+/**
+ * @brief Remove the given context from the LRU list
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to remove
+ */
+static void c_lru_remove_context(struct rohc_comp *const comp,
+                                 const struct rohc_comp_ctxt *const context)
+{
+	if(context->lru_prev == ROHC_COMP_CID_NONE)
 	{
-		c->state = ROHC_COMP_STATE_CR;
+		comp->lru_cid_first = context->lru_next;
 	}
 	else
 	{
-		c->state = ROHC_COMP_STATE_IR;
+		comp->contexts[context->lru_prev].lru_next = context->lru_next;
 	}
-
-	c->compressor = comp;
-
-	/* create profile-specific context */
-	if(c->do_ctxt_replication)
+	if(context->lru_next == ROHC_COMP_CID_NONE)
 	{
-		if(!profile->clone(c, &(comp->contexts[cid_for_replication])))
-		{
-			return NULL;
-		}
+		comp->lru_cid_last = context->lru_prev;
 	}
 	else
 	{
-		if(!profile->create(c, packet))
-		{
-			return NULL;
-		}
+		comp->contexts[context->lru_next].lru_prev = context->lru_prev;
 	}
+}
 
-	/* if creation is successful, mark the context as used */
-	c->used = 1;
-	c->first_used = arrival_time.sec;
-	c->latest_used = arrival_time.sec;
-	assert(comp->num_contexts_used <= comp->medium.max_cid);
-	comp->num_contexts_used++;
 
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "context (CID = %zu) created at %" PRIu64 " seconds (num_used = %zu)",
-	           c->cid, c->latest_used, comp->num_contexts_used);
-	return c;
+/**
+ * @brief Whether the contexts of the given profile are indexed by flow key
+ *
+ * @param profile  The compression profile
+ * @return         true if the contexts are indexed by flow key,
+ *                 false if they shall be searched for one by one
+ */
+static inline bool c_profile_is_hashed(const struct rohc_comp_profile *const profile)
+{
+	return (profile->protocol != 0);
 }
 
 
 /**
- * @brief Find a compression context given an IP packet
+ * @brief Add the given context to the hash table of contexts
  *
- * @param comp             The ROHC compressor
- * @param packet           The packet to find a compression context for
- * @param profile_id_hint  If positive, indicate the profile to use
- * @param arrival_time     The time at which packet was received
- *                         (0 if unknown, or to disable time-related features
- *                          in the ROHC protocol)
- * @return                 The context if found or successfully created,
- *                         NULL if not found
+ * The contexts of every hash bucket are kept sorted by CID.
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to add
  */
-static struct rohc_comp_ctxt *
-	rohc_comp_find_ctxt(struct rohc_comp *const comp,
-	                    const struct net_pkt *const packet,
-	                    const int profile_id_hint,
-	                    const struct rohc_ts arrival_time)
+static void c_hash_add_context(struct rohc_comp *const comp,
+                               struct rohc_comp_ctxt *const context)
 {
-	const struct rohc_comp_profile *profile;
-	struct rohc_comp_ctxt *context;
-	size_t num_used_ctxt_seen = 0;
-	rohc_cid_t i;
-
-	size_t best_cr_score = 0;
-	bool do_ctxt_replication = false;
-	rohc_cid_t best_ctxt_for_replication = ROHC_LARGE_CID_MAX + 1;
+	rohc_cid_t *next_cid =
+		&(comp->contexts_hash[context->key & comp->contexts_hash_mask]);
 
-	/* use the suggested profile if any, otherwise find the best profile for
-	 * the packet */
-	if(profile_id_hint < 0)
+	while((*next_cid) != ROHC_COMP_CID_NONE && (*next_cid) < context->cid)
 	{
-		profile = c_get_profile_from_packet(comp, packet);
+		next_cid = &(comp->contexts[*next_cid].hash_next);
 	}
-	else
+	context->hash_next = (*next_cid);
+	(*next_cid) = context->cid;
+}
+
+
+/**
+ * @brief Remove the given context from the hash table of contexts
+ *
+ * @param comp     The ROHC compressor
+ * @param context  The compression context to remove
+ */
+static void c_hash_remove_context(struct rohc_comp *const comp,
+                                  const struct rohc_comp_ctxt *const context)
+{
+	rohc_cid_t *next_cid =
+		&(comp->contexts_hash[context->key & comp->contexts_hash_mask]);
+
+	while((*next_cid) != ROHC_COMP_CID_NONE && (*next_cid) != context->cid)
 	{
-		profile = rohc_get_profile_from_id(comp, profile_id_hint);
+		next_cid = &(comp->contexts[*next_cid].hash_next);
 	}
-	if(profile == NULL)
+	if((*next_cid) == context->cid)
 	{
-		rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		             "no profile found for packet, giving up");
-		goto not_found;
+		(*next_cid) = context->hash_next;
 	}
-	rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-	           "using profile '%s' (0x%04x)",
-	           rohc_get_profile_descr(profile->id), profile->id);
+}
 
-	/* get the context using help from the profile we just found */
-	for(i = 0; i <= comp->medium.max_cid; i++)
+
+/**
+ * @brief Find a compression context among the recently used contexts
+ *
+ * Most packets belong to one of the few flows seen recently. The recently
+ * used contexts are thus checked before the whole context table. Only the
+ * contexts indexed by flow key are eligible, and the flow key of the packet
+ * is used as a fingerprint to skip the contexts of other flows cheaply.
+ *
+ * Profile detection is limited to the profile of the candidate context and
+ * to the profiles that are tested before it for the same transport protocol:
+ * the other profiles would reject the packet anyway.
+ *
+ * @param comp    The ROHC compressor
+ * @param packet  The packet to find a compression context for
+ * @return        The context if found among recent ones, NULL otherwise
+ */
+static struct rohc_comp_ctxt *
+	c_find_recent_context(struct rohc_comp *const comp,
+	                      const struct net_pkt *const packet)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_COMP_RECENT_CTXTS_NR; i++)
 	{
-		bool is_feedback_channel_available;
-		bool is_static_part_transmitted;
-		bool is_ctxt_established;
+		const rohc_cid_t cid = comp->recent_cids[i];
+		struct rohc_comp_ctxt *context;
 		size_t cr_score = 0;
 
-		context = &comp->contexts[i];
-
-		/* don't even look at unused contexts */
-		if(!context->used)
+		if(cid == ROHC_COMP_CID_NONE)
 		{
-			continue;
+			break;
 		}
-		num_used_ctxt_seen++;
+		context = &comp->contexts[cid];
 
-		/* don't look at contexts with the wrong profile */
-		if(context->profile->id != profile->id)
+		/* skip the contexts of other flows */
+		if(!context->used || context->key != packet->key ||
+		   !c_profile_is_hashed(context->profile) ||
+		   context->profile->protocol != packet->transport->proto)
 		{
 			continue;
 		}
 
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "check context CID = %zu with same profile", context->cid);
-
-		/* ask the profile whether the packet matches the context */
-		if(context->profile->check_context(context, packet, &cr_score))
+		/* the profile of the context shall be the one selected for the packet,
+		 * and the packet shall match the context */
+		if(c_is_profile_for_packet(comp, context->profile, packet) &&
+		   c_check_context(comp, context, packet, &cr_score))
 		{
-			const struct rohc_comp_ctxt *base_ctxt;
-			size_t cr_score_base_ctxt = 0;
-			bool base_ctxt_equals_ctxt;
-
-			/* hmmm, looks like we could re-use that context ; if Context Replication
-			 * is in action, check that the base context didn't change too much */
-			if(!context->do_ctxt_replication ||
-			   context->state != ROHC_COMP_STATE_CR ||
-			   context->cr_count >= MAX_CR_COUNT)
-			{
-				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-				           "re-using context CID = %zu", context->cid);
-				break;
-			}
-			/* check whether the base context changed too much to be re-used or not */
-			base_ctxt = &(comp->contexts[context->cr_base_cid]);
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "Context Replication in action (%zu/%u packets sent): check "
-			           "for CID %zu whether base context with CID %zu changed too much",
-			           context->cr_count, MAX_CR_COUNT, context->cid, base_ctxt->cid);
-			base_ctxt_equals_ctxt =
-				context->profile->check_context(base_ctxt, packet, &cr_score_base_ctxt);
-			/* there are two ways the base context may have changed:
-			 *   - the base context now matches exactly the replicated context
-			 *   - the base context does not share enough with the replicated context */
-			if(!base_ctxt_equals_ctxt && cr_score_base_ctxt > 0)
-			{
-				/* no large change, we may continue the Context Replication */
-				rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-				           "re-using context CID = %zu as a replication of context "
-				           "CID %zu", context->cid, base_ctxt->cid);
-				break;
-			}
-			/* too much change, we need to interrupt the Context Replication */
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "cannot re-use context CID = %zu as replication of context "
-			           "CID %zu, the base context changed too much", context->cid,
-			           base_ctxt->cid);
-			cr_score = 0;
-			/* TODO: destroy that half-opened context */
-		}
-		rohc_comp_debug(context, "context CID %zu scores %zu for Context Replication",
-		                context->cid, cr_score);
-
-		/* several contexts may be used as basis for context replication:
-		 *  - drop the ones that are not fully established with decompressor (fully
-		 *    established means that the static part of the context was explicitely
-		 *    acknowledged by the decompressor through one ACK protected by a CRC),
-		 *  - keep the one that is the nearest from the new stream (more bytes
-		 *    in common) */
-		is_feedback_channel_available = !!(context->mode > ROHC_U_MODE);
-		is_static_part_transmitted = !!(context->state == ROHC_COMP_STATE_FO ||
-		                                context->state == ROHC_COMP_STATE_SO);
-		is_ctxt_established =
-			(is_feedback_channel_available && is_static_part_transmitted);
-		if(is_ctxt_established && cr_score > best_cr_score)
-		{
-			do_ctxt_replication = true;
-			best_ctxt_for_replication = context->cid;
-			best_cr_score = cr_score;
-			rohc_comp_debug(context, "context CID %zu is best for Context Replication",
-			                context->cid);
+			           "packet matches recently used context CID = %zu", cid);
+			return context;
 		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ * @brief Is the given profile the one that would be selected for the packet?
+ *
+ * The function gives the same result as \ref c_get_profile_from_packet, but
+ * it stops as soon as the given profile is reached.
+ *
+ * @param comp     The ROHC compressor
+ * @param profile  The profile to check
+ * @param packet   The packet to check
+ * @return         true if the profile would be selected for the packet,
+ *                 false otherwise
+ */
+static bool c_is_profile_for_packet(const struct rohc_comp *const comp,
+                                    const struct rohc_comp_profile *const profile,
+                                    const struct net_pkt *const packet)
+{
+	const uint8_t proto = packet->transport->proto;
+	size_t i;
 
-		/* if all used contexts were checked, no need go search further */
-		if(num_used_ctxt_seen >= comp->num_contexts_used)
+	for(i = 0; i < comp->profiles_by_proto_nr[proto]; i++)
+	{
+		const struct rohc_comp_profile *const cur_profile =
+			rohc_comp_profiles[comp->profiles_by_proto[proto][i]];
+
+		if(cur_profile == profile)
 		{
-			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			           "no context was found");
-			context = NULL;
-			break;
+			/* all the profiles tested before rejected the packet */
+			return profile->check_profile(comp, packet);
 		}
-	}
-	if(context == NULL || i > comp->medium.max_cid)
-	{
-		/* context not found, create a new one */
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "no existing context found for packet, create a new one");
-		context = c_create_context(comp, profile, packet, arrival_time,
-		                           do_ctxt_replication, best_ctxt_for_replication);
-		if(context == NULL)
+
+		/* does the profile accept the packet before the given profile? */
+		if(cur_profile->check_profile(comp, packet))
 		{
-			rohc_warning(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-			             "failed to create a new context");
-			goto not_found;
+			return false;
 		}
 	}
-	else
-	{
-		/* matching context found, update use timestamp */
-		context->latest_used = arrival_time.sec;
-		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
-		           "context (CID = %zu) used at %" PRIu64 " seconds",
-		           context->cid, context->latest_used);
-	}
-
-	return context;
 
-not_found:
-	return NULL;
+	/* profile is not enabled or not suitable for the transport protocol */
+	return false;
 }
 
 
 /**
- * @brief Find out a context given its CID
+ * @brief Record the given context as the most recently used one
  *
- * @param comp The ROHC compressor
- * @param cid  The CID of the context to find
- * @return     The context with the given CID if found, NULL otherwise
+ * @param comp     The ROHC compressor
+ * @param context  The compression context that was just used
  */
-static struct rohc_comp_ctxt *
-	c_get_context(struct rohc_comp *const comp, const rohc_cid_t cid)
+static void c_recent_add_context(struct rohc_comp *const comp,
+                                 const struct rohc_comp_ctxt *const context)
 {
-	/* the CID must not be larger than the context array */
-	if(cid > comp->medium.max_cid)
+	size_t i;
+
+	/* find the context in the recent contexts, or drop the oldest one */
+	for(i = 0; i < (ROHC_COMP_RECENT_CTXTS_NR - 1) &&
+	           comp->recent_cids[i] != context->cid; i++)
 	{
-		goto not_found;
 	}
 
-	/* the context with the given CID must be in use */
-	if(comp->contexts[cid].used == 0)
+	/* move the context at the very beginning */
+	for(; i > 0; i--)
 	{
-		goto not_found;
+		comp->recent_cids[i] = comp->recent_cids[i - 1];
 	}
-
-	return &(comp->contexts[cid]);
-
-not_found:
-	return NULL;
+	comp->recent_cids[0] = context->cid;
 }
 
 
@@ -2771,7 +4413,11 @@ not_found:
  */
 static bool c_create_contexts(struct rohc_comp *const comp)
 {
+	size_t hash_size;
+	size_t i;
+
 	assert(comp->contexts == NULL);
+	assert(comp->contexts_hash == NULL);
 
 	comp->num_contexts_used = 0;
 
@@ -2788,8 +4434,48 @@ static bool c_create_contexts(struct rohc_comp *const comp)
 		goto error;
 	}
 
+	/* the hash table has at least one bucket per context, and a power of 2
+	 * number of buckets to get the bucket of a flow key with a simple mask */
+	hash_size = 1;
+	while(hash_size <= comp->medium.max_cid)
+	{
+		hash_size <<= 1;
+	}
+	comp->contexts_hash = malloc(hash_size * sizeof(rohc_cid_t));
+	if(comp->contexts_hash == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "cannot allocate memory for the hash table of contexts");
+		goto free_contexts;
+	}
+	for(i = 0; i < hash_size; i++)
+	{
+		comp->contexts_hash[i] = ROHC_COMP_CID_NONE;
+	}
+	comp->contexts_hash_mask = hash_size - 1;
+
+	/* one bit per CID in the bitmap of unused CIDs */
+	comp->free_cids =
+		malloc((comp->medium.max_cid + ROHC_COMP_FREE_CIDS_BITS) /
+		       ROHC_COMP_FREE_CIDS_BITS * sizeof(uint64_t));
+	if(comp->free_cids == NULL)
+	{
+		rohc_error(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
+		           "cannot allocate memory for the bitmap of unused CIDs");
+		goto free_hash;
+	}
+
+	/* all contexts are unused at the beginning, none is in the LRU list */
+	c_free_cids_init(comp);
+	comp->lru_cid_first = ROHC_COMP_CID_NONE;
+	comp->lru_cid_last = ROHC_COMP_CID_NONE;
+
 	return true;
 
+free_hash:
+	zfree(comp->contexts_hash);
+free_contexts:
+	zfree(comp->contexts);
 error:
 	return false;
 }
@@ -2808,24 +4494,20 @@ static void c_destroy_contexts(struct rohc_comp *const comp)
 
 	assert(comp->contexts != NULL);
 
+	/* the array of contexts is freed, so their CIDs need not be marked as
+	 * unused */
 	for(i = 0; i <= comp->medium.max_cid; i++)
 	{
-		if(comp->contexts[i].used && comp->contexts[i].profile != NULL)
-		{
-			comp->contexts[i].profile->destroy(&comp->contexts[i]);
-		}
-
 		if(comp->contexts[i].used)
 		{
-			comp->contexts[i].used = 0;
-			assert(comp->num_contexts_used > 0);
-			comp->num_contexts_used--;
+			c_release_context(comp, &comp->contexts[i]);
 		}
 	}
 	assert(comp->num_contexts_used == 0);
 
-	free(comp->contexts);
-	comp->contexts = NULL;
+	zfree(comp->free_cids);
+	zfree(comp->contexts_hash);
+	zfree(comp->contexts);
 }
 
 
@@ -3189,12 +4871,12 @@ bool rohc_comp_feedback_parse_opts(const struct rohc_comp_ctxt *const context,
 		/* compute the CRC of the feedback packet (skip CRC byte) */
 		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, packet,
 		                             packet_len - crc_pos_from_end, CRC_INIT_8,
-		                             context->compressor->crc_table_8);
+		                             rohc_crc_table_8);
 		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, &zeroed_crc, zeroed_crc_len,
-		                             crc_computed, context->compressor->crc_table_8);
+		                             crc_computed, rohc_crc_table_8);
 		crc_computed = crc_calculate(ROHC_CRC_TYPE_8, packet + packet_len -
 		                             crc_pos_from_end + 1, crc_pos_from_end - 1,
-		                             crc_computed, context->compressor->crc_table_8);
+		                             crc_computed, rohc_crc_table_8);
 
 		/* ignore feedback in case of bad CRC */
 		if(crc_in_packet != crc_computed)
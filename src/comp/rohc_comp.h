@@ -189,6 +189,8 @@ typedef struct
  * Supported versions:
  *  - major 0 and minor = 0 contains: version_major, version_minor,
  *    contexts_nr, packets_nr, uncomp_bytes_nr, and comp_bytes_nr.
+ *  - major 0 and minor = 1 adds: recent_ctxt_hits_nr and
+ *    recent_ctxt_misses_nr.
  *
  * @ingroup rohc_comp
  *
@@ -208,9 +210,73 @@ typedef struct
 	unsigned long uncomp_bytes_nr;
 	/** The number of compressed bytes produced by the compressor */
 	unsigned long comp_bytes_nr;
+	/** The number of packets that matched one of the recently used contexts
+	 *  (since minor version 1) */
+	unsigned long recent_ctxt_hits_nr;
+	/** The number of packets that did not match any of the recently used
+	 *  contexts (since minor version 1) */
+	unsigned long recent_ctxt_misses_nr;
 } __attribute__((packed)) rohc_comp_general_info_t;
 
 
+/**
+ * @brief The stages of the compression of one packet
+ *
+ * The stages are timed separately if the library was built with the option
+ * --enable-rohc-perf-counters of the configure script. The CRC stage is
+ * nested in the ENCODE stage: the time spent to compute the CRCs is also
+ * accounted in the ENCODE stage.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_get_perf_counters
+ */
+typedef enum
+{
+	/** Parse the uncompressed packet */
+	ROHC_COMP_PERF_PARSE     = 0,
+	/** Find the context for the packet, or create a new one */
+	ROHC_COMP_PERF_FIND_CTXT = 1,
+	/** Encode the ROHC header with the profile of the context */
+	ROHC_COMP_PERF_ENCODE    = 2,
+	/** Compute the CRCs (on uncompressed headers, IR headers and RRUs) */
+	ROHC_COMP_PERF_CRC       = 3,
+	/** Copy the payload after the ROHC header (or move the ROHC header in
+	 *  front of the payload if compressing in place) */
+	ROHC_COMP_PERF_PAYLOAD   = 4,
+	/** The number of stages */
+	ROHC_COMP_PERF_STAGES_NR = 5,
+
+} rohc_comp_perf_stage_t;
+
+
+/**
+ * @brief The timing counters of the compressor
+ *
+ * The structure is used by the \ref rohc_comp_get_perf_counters function
+ * to store the timing counters of the compressor stages.
+ *
+ * Versioning works as for \ref rohc_comp_general_info_t.
+ *
+ * Supported versions:
+ *  - major 0 and minor = 0 contains: version_major, version_minor and
+ *    stages.
+ *
+ * @ingroup rohc_comp
+ *
+ * @see rohc_comp_get_perf_counters
+ */
+typedef struct
+{
+	/** The major version of this structure */
+	unsigned short version_major;
+	/** The minor version of this structure */
+	unsigned short version_minor;
+	/** The timing counters, one per \ref rohc_comp_perf_stage_t stage */
+	rohc_perf_counter_t stages[ROHC_COMP_PERF_STAGES_NR];
+} __attribute__((packed)) rohc_comp_perf_counters_t;
+
+
 /**
  * @brief The different features of the ROHC compressor
  *
@@ -307,11 +373,39 @@ bool ROHC_EXPORT rohc_comp_set_traces_cb2(struct rohc_comp *const comp,
                                           void *const priv_ctxt)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_set_traces_level(struct rohc_comp *const comp,
+                                            const rohc_trace_level_t level)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_set_allocator(struct rohc_comp *const comp,
+                                         rohc_malloc_cb_t malloc_cb,
+                                         rohc_free_cb_t free_cb,
+                                         void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
 rohc_status_t ROHC_EXPORT rohc_compress4(struct rohc_comp *const comp,
                                          const struct rohc_buf uncomp_packet,
                                          struct rohc_buf *const rohc_packet)
 	__attribute__((warn_unused_result));
 
+rohc_status_t ROHC_EXPORT rohc_compress_inplace(struct rohc_comp *const comp,
+                                                struct rohc_buf *const pkt)
+	__attribute__((warn_unused_result));
+
+rohc_status_t ROHC_EXPORT rohc_compress_sg(struct rohc_comp *const comp,
+                                           const struct rohc_buf uncomp_packet,
+                                           const size_t max_rohc_len,
+                                           struct rohc_buf *const rohc_hdr,
+                                           struct rohc_buf *const payload)
+	__attribute__((warn_unused_result));
+
+size_t ROHC_EXPORT rohc_compress_burst(struct rohc_comp *const comp,
+                                      const struct rohc_buf *const uncomp_packets,
+                                      struct rohc_buf *const rohc_packets,
+                                      rohc_status_t *const statuses,
+                                      const size_t pkts_nr)
+	__attribute__((warn_unused_result));
+
 rohc_status_t ROHC_EXPORT rohc_comp_pad(struct rohc_comp *const comp,
                                         struct rohc_buf *const rohc_packet,
                                         const size_t min_pkt_len)
@@ -321,6 +415,13 @@ rohc_status_t ROHC_EXPORT rohc_comp_get_segment2(struct rohc_comp *const comp,
                                                  struct rohc_buf *const segment)
 	__attribute__((warn_unused_result));
 
+rohc_status_t ROHC_EXPORT rohc_comp_get_segment_sg(struct rohc_comp *const comp,
+                                                   const size_t max_segment_len,
+                                                   struct rohc_buf *const segment,
+                                                   struct rohc_buf *const payload,
+                                                   struct rohc_buf *const trailer)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_comp_force_contexts_reinit(struct rohc_comp *const comp)
 	__attribute__((warn_unused_result));
 
@@ -412,6 +513,19 @@ bool ROHC_EXPORT rohc_comp_get_last_packet_info2(const struct rohc_comp *const c
                                                  rohc_comp_last_packet_info2_t *const info)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_comp_get_perf_counters(const struct rohc_comp *const comp,
+                                             rohc_comp_perf_counters_t *const counters)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_get_stats(const struct rohc_comp *const comp,
+                                     rohc_stats_t *const stats)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_comp_get_ctxt_stats(const struct rohc_comp *const comp,
+                                          const rohc_cid_t cid,
+                                          rohc_stats_t *const stats)
+	__attribute__((warn_unused_result));
+
 const char * ROHC_EXPORT rohc_comp_get_state_descr(const rohc_comp_state_t state)
 	__attribute__((warn_unused_result, const));
 
@@ -29,11 +29,15 @@
 
 #include "rohc_internal.h"
 #include "rohc_traces_internal.h"
+#include "rohc_perf_internal.h"
 #include "rohc_packets.h"
 #include "rohc_comp.h"
 #include "schemes/comp_wlsb.h"
 #include "net_pkt.h"
 #include "feedback.h"
+#include "crc.h"
+#include "rohc_mem.h"
+#include "rohc_stats.h"
 
 #include <stdbool.h>
 
@@ -85,6 +89,20 @@
  */
 #define ROHC_LIST_DEFAULT_L  5U
 
+/** The value used to mark the end of a list of contexts linked by their CIDs */
+#define ROHC_COMP_CID_NONE  (ROHC_LARGE_CID_MAX + 1U)
+
+/** The number of recently used contexts that are tried before any other */
+#define ROHC_COMP_RECENT_CTXTS_NR  4U
+
+/** The number of CIDs in one word of the bitmap of unused CIDs */
+#define ROHC_COMP_FREE_CIDS_BITS  64U
+
+/** The number of words of the summary of the bitmap of unused CIDs */
+#define ROHC_COMP_FREE_CIDS_SUMMARY_LEN \
+	((ROHC_LARGE_CID_MAX + 1U) / ROHC_COMP_FREE_CIDS_BITS / \
+	 ROHC_COMP_FREE_CIDS_BITS)
+
 
 /** Print a warning trace for the given compression context */
 #define rohc_comp_warn(context, format, ...) \
@@ -139,18 +157,35 @@ struct rohc_comp
 	/** The number of compression contexts in use in the array */
 	size_t num_contexts_used;
 
+	/** The bitmap of the unused CIDs: bit n % 64 of word n / 64 is set if
+	 *  CID n is unused */
+	uint64_t *free_cids;
+	/** The summary of the bitmap of unused CIDs: bit n % 64 of word n / 64
+	 *  is set if word n of \ref free_cids has at least one unused CID, so
+	 *  that the smallest unused CID is found in constant time */
+	uint64_t free_cids_summary[ROHC_COMP_FREE_CIDS_SUMMARY_LEN];
+	/** The CID of the least recently used context: used contexts are linked
+	 *  by \ref rohc_comp_ctxt::lru_prev and \ref rohc_comp_ctxt::lru_next
+	 *  from the least recently used to the most recently used */
+	rohc_cid_t lru_cid_first;
+	/** The CID of the most recently used context */
+	rohc_cid_t lru_cid_last;
+
+	/** The hash table that indexes the contexts by flow key: each bucket is
+	 *  the CID of the first context of a list sorted by CID and linked by
+	 *  \ref rohc_comp_ctxt::hash_next */
+	rohc_cid_t *contexts_hash;
+	/** The mask to apply on a flow key to get its bucket in the hash table */
+	size_t contexts_hash_mask;
+
 	/** Which profiles are enabled and with one are not? */
 	bool enabled_profiles[C_NUM_PROFILES];
-
-
-	/* CRC-related variables: */
-
-	/** The table to enable fast CRC-3 computation */
-	uint8_t crc_table_3[256];
-	/** The table to enable fast CRC-7 computation */
-	uint8_t crc_table_7[256];
-	/** The table to enable fast CRC-8 computation */
-	uint8_t crc_table_8[256];
+	/** The enabled profiles that may accept a packet, indexed by the protocol
+	 *  of the transport layer of the packet: every list holds indexes in the
+	 *  table of compression profiles, sorted by decreasing priority */
+	uint8_t profiles_by_proto[UINT8_MAX + 1][C_NUM_PROFILES];
+	/** The number of profiles in every list of \ref profiles_by_proto */
+	uint8_t profiles_by_proto_nr[UINT8_MAX + 1];
 
 
 	/* segment-related variables */
@@ -158,12 +193,20 @@ struct rohc_comp
 /** The maximal value for MRRU */
 #define ROHC_MAX_MRRU 65535
 	/** The remaining bytes of the Reconstructed Reception Unit (RRU) waiting
-	 *  to be split into segments */
-	uint8_t rru[ROHC_MAX_MRRU];
+	 *  to be split into segments, MRRU bytes allocated by rohc_comp_set_mrru()
+	 *  (NULL if segmentation is disabled) */
+	uint8_t *rru;
 	/** The offset of the remaining bytes in the RRU buffer */
 	size_t rru_off;
-	/** The number of the remaining bytes in the RRU buffer */
+	/** The number of the remaining bytes of the RRU (CRC and payload kept in
+	 *  the uncompressed packet included) */
 	size_t rru_len;
+	/** The offset in the RRU buffer where the payload kept in the
+	 *  uncompressed packet is inserted */
+	size_t rru_payload_off;
+	/** The remaining bytes of the payload kept in the uncompressed packet,
+	 *  empty if the whole RRU is stored in the RRU buffer */
+	struct rohc_buf rru_payload;
 
 
 	/* variables related to RTP detection */
@@ -174,17 +217,35 @@ struct rohc_comp
 	void *rtp_private;
 
 
+	/* memory-related variables */
+
+	/** The pools the profile-specific parts of the contexts are allocated
+	 *  from */
+	struct rohc_mem mem;
+
+
 	/* some statistics about the compression process: */
 
-	/** The number of sent packets */
-	int num_packets;
-	/** The size of all the received uncompressed IP packets */
-	int total_uncompressed_size;
-	/** The size of all the sent compressed ROHC packets */
-	int total_compressed_size;
+	/** The memory block that holds the statistics blocks */
+	void *stats_mem;
+	/** The statistics of the compressor, may be read by other threads */
+	struct rohc_stats *stats;
+	/** The statistics of the contexts, one block per CID */
+	struct rohc_stats *ctxt_stats;
 
 	/** The last context used by the compressor */
 	struct rohc_comp_ctxt *last_context;
+	/** The CIDs of the recently used contexts, the most recent one first */
+	rohc_cid_t recent_cids[ROHC_COMP_RECENT_CTXTS_NR];
+	/** The number of packets that matched one of the recently used contexts */
+	unsigned long num_recent_ctxt_hits;
+	/** The number of packets that matched none of the recently used contexts */
+	unsigned long num_recent_ctxt_misses;
+
+#ifdef ROHC_PERF_COUNTERS
+	/** The timing counters of the compression stages */
+	rohc_perf_counter_t perf[ROHC_COMP_PERF_STAGES_NR];
+#endif
 
 
 	/* random callback */
@@ -222,6 +283,8 @@ struct rohc_comp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The lowest level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
 };
 
 
@@ -239,6 +302,10 @@ struct rohc_comp_profile
 	/**
 	 * @brief The IP protocol ID used to find out which profile is able to
 	 *        compress an IP packet
+	 *
+	 * The contexts of profiles with a non-zero protocol ID are indexed by
+	 * flow key, so their check_context() handler shall never accept a packet
+	 * whose flow key differs from the one of the context.
 	 */
 	const unsigned short protocol;
 
@@ -338,6 +405,15 @@ struct rohc_comp_ctxt
 	/** The context unique ID (CID) */
 	rohc_cid_t cid;
 
+	/** The key of the flow the context was created for */
+	rohc_ctxt_key_t key;
+	/** The CID of the next context in the same bucket of the hash table */
+	rohc_cid_t hash_next;
+	/** The CID of the previous context in the LRU list (used context only) */
+	rohc_cid_t lru_prev;
+	/** The CID of the next context in the LRU list (used context only) */
+	rohc_cid_t lru_next;
+
 	/** The associated compressor */
 	struct rohc_comp *compressor;
 
@@ -396,14 +472,8 @@ struct rohc_comp_ctxt
 	 */
 	struct rohc_ts go_back_ir_time;
 
-	/** The cumulated size of the uncompressed packets */
-	int total_uncompressed_size;
-	/** The cumulated size of the compressed packets */
-	int total_compressed_size;
-	/** The cumulated size of the uncompressed headers */
-	int header_uncompressed_size;
-	/** The cumulated size of the compressed headers */
-	int header_compressed_size;
+	/* the cumulated statistics of the context are stored in the block
+	 * ctxt_stats[cid] of the compressor */
 
 	/** The total size of the last uncompressed packet */
 	int total_last_uncompressed_size;
@@ -79,6 +79,7 @@ static void ip_header_info_new(struct ip_header_info *const header_info,
                                const size_t wlsb_window_width,
                                rohc_trace_callback2_t trace_cb,
                                void *const trace_cb_priv,
+                               const rohc_trace_level_t trace_level,
                                const int profile_id)
 	__attribute__((nonnull(1, 2)));
 static void ip_header_info_free(struct ip_header_info *const header_info)
@@ -422,6 +423,7 @@ static bool is_field_changed(const unsigned short changed_fields,
  *                           IP-ID (must be > 0)
  * @param trace_cb           The function to call for printing traces
  * @param trace_cb_priv      An optional private context, may be NULL
+ * @param trace_level        The lowest level of the traces to print
  * @param profile_id         The ID of the associated compression profile
  */
 static void ip_header_info_new(struct ip_header_info *const header_info,
@@ -430,6 +432,7 @@ static void ip_header_info_new(struct ip_header_info *const header_info,
                                const size_t wlsb_window_width,
                                rohc_trace_callback2_t trace_cb,
                                void *const trace_cb_priv,
+                               const rohc_trace_level_t trace_level,
                                const int profile_id)
 {
 	assert(header_info != NULL);
@@ -464,7 +467,7 @@ static void ip_header_info_new(struct ip_header_info *const header_info,
 	{
 		/* init the compression context for IPv6 extension header list */
 		rohc_comp_list_ipv6_new(&header_info->info.v6.ext_comp, list_trans_nr,
-		                        trace_cb, trace_cb_priv, profile_id);
+		                        trace_cb, trace_cb_priv, trace_level, profile_id);
 	}
 }
 
@@ -530,7 +533,8 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 	rohc_comp_debug(context, "new generic context required for a new stream");
 
 	/* allocate memory for the generic part of the context */
-	rfc3095_ctxt = calloc(1, sizeof(struct rohc_comp_rfc3095_ctxt));
+	rfc3095_ctxt = rohc_mem_zalloc(&context->compressor->mem,
+	                               sizeof(struct rohc_comp_rfc3095_ctxt));
 	if(rfc3095_ctxt == NULL)
 	{
 		rohc_error(context->compressor, ROHC_TRACE_COMP, context->profile->id,
@@ -562,6 +566,7 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 	                   context->compressor->wlsb_window_width,
 	                   context->compressor->trace_callback,
 	                   context->compressor->trace_callback_priv,
+	                   context->compressor->trace_level,
 	                   context->profile->id);
 	if(packet->ip_hdr_nr > 1)
 	{
@@ -571,6 +576,7 @@ bool rohc_comp_rfc3095_create(struct rohc_comp_ctxt *const context,
 		                   context->compressor->wlsb_window_width,
 		                   context->compressor->trace_callback,
 		                   context->compressor->trace_callback_priv,
+		                   context->compressor->trace_level,
 		                   context->profile->id);
 		rfc3095_ctxt->ip_hdr_nr = 2;
 	}
@@ -628,8 +634,8 @@ void rohc_comp_rfc3095_destroy(struct rohc_comp_ctxt *const context)
 		ip_header_info_free(&rfc3095_ctxt->inner_ip_flags);
 	}
 
-	zfree(rfc3095_ctxt->specific);
-	free(rfc3095_ctxt);
+	rohc_mem_zfree(rfc3095_ctxt->specific);
+	rohc_mem_free(rfc3095_ctxt);
 }
 
 
@@ -694,11 +700,9 @@ bool rohc_comp_rfc3095_check_profile(const struct rohc_comp *const comp,
 		goto bad_profile;
 	}
 
-	/* check if the checksum of the outer IP header is correct */
-	if(packet->outer_ip.version == IPV4 &&
-	   (comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
-	   ip_fast_csum(packet->outer_ip.data,
-	                sizeof(struct ipv4_hdr) / sizeof(uint32_t)) != 0)
+	/* check if the checksum of the outer IP header is correct (verified once
+	 * while parsing the packet) */
+	if(!packet->ip_csum_ok[0])
 	{
 		rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 		           "the outer IP packet is not correct (bad checksum)");
@@ -746,11 +750,9 @@ bool rohc_comp_rfc3095_check_profile(const struct rohc_comp *const comp,
 			goto bad_profile;
 		}
 
-		/* check if the checksum of the inner IP header is correct */
-		if(packet->inner_ip.version == IPV4 &&
-		   (comp->features & ROHC_COMP_FEATURE_NO_IP_CHECKSUMS) == 0 &&
-		   ip_fast_csum(packet->inner_ip.data,
-		                sizeof(struct ipv4_hdr) / sizeof(uint32_t)) != 0)
+		/* check if the checksum of the inner IP header is correct (verified
+		 * once while parsing the packet) */
+		if(!packet->ip_csum_ok[1])
 		{
 			rohc_debug(comp, ROHC_TRACE_COMP, ROHC_PROFILE_GENERAL,
 			           "the inner IP packet is not correct (bad checksum)");
@@ -1302,6 +1304,7 @@ static bool rohc_comp_rfc3095_detect_changes(struct rohc_comp_ctxt *const contex
 			                   context->compressor->wlsb_window_width,
 			                   context->compressor->trace_callback,
 			                   context->compressor->trace_callback_priv,
+			                   context->compressor->trace_level,
 			                   context->profile->id);
 		}
 		else
@@ -1830,9 +1833,11 @@ static int code_IR_packet(struct rohc_comp_ctxt *const context,
 	}
 
 	/* part 5 */
+	rohc_perf_start(crc_start);
 	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt, counter,
 	                                       CRC_INIT_8,
-	                                       context->compressor->crc_table_8);
+	                                       rohc_crc_table_8);
+	rohc_perf_stop(context->compressor->perf, ROHC_COMP_PERF_CRC, crc_start);
 	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
 	                counter, rohc_pkt[crc_position]);
 
@@ -1978,9 +1983,11 @@ static int code_IR_DYN_packet(struct rohc_comp_ctxt *const context,
 	}
 
 	/* part 5 */
+	rohc_perf_start(crc_start);
 	rohc_pkt[crc_position] = crc_calculate(ROHC_CRC_TYPE_8, rohc_pkt, counter,
 	                                       CRC_INIT_8,
-	                                       context->compressor->crc_table_8);
+	                                       rohc_crc_table_8);
+	rohc_perf_stop(context->compressor->perf, ROHC_COMP_PERF_CRC, crc_start);
 	rohc_comp_debug(context, "CRC (header length = %zu, crc = 0x%x)",
 	                counter, rohc_pkt[crc_position]);
 
@@ -2190,13 +2197,13 @@ static int code_ipv6_static_part(const struct rohc_comp_ctxt *const context,
 	const struct ipv6_addr *daddr;
 
 	/* part 1 */
-	dest[counter] = ((6 << 4) & 0xf0) | ip->header.v6.flow1;
+	dest[counter] = ((6 << 4) & 0xf0) | ip->header.v6->flow1;
 	rohc_comp_debug(context, "version + flow label (msb) = 0x%02x",
 	                dest[counter]);
 	counter++;
 
 	/* part 2 */
-	memcpy(dest + counter, &ip->header.v6.flow2, sizeof(uint16_t));
+	memcpy(dest + counter, &ip->header.v6->flow2, sizeof(uint16_t));
 	counter += sizeof(uint16_t);
 	rohc_comp_debug(context, "flow label (lsb) = 0x%02x%02x",
 	                dest[counter - 2], dest[counter - 1]);
@@ -2718,7 +2725,7 @@ static int code_UO0_packet(struct rohc_comp_ctxt *const context,
 	assert(rfc3095_ctxt->tmp.nr_sn_bits_less_equal_than_4 <= 4);
 	f_byte = (rfc3095_ctxt->sn & 0x0f) << 3;
 	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	                     rohc_crc_table_3);
 	f_byte |= crc;
 	rohc_comp_debug(context, "first byte = 0x%02x (CRC = 0x%x)", f_byte, crc);
 	rohc_pkt[first_position] = f_byte;
@@ -2861,7 +2868,7 @@ static int rohc_comp_rfc3095_build_uo1_pkt(struct rohc_comp_ctxt *const context,
 		goto error;
 	}
 	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	                     rohc_crc_table_3);
 	rohc_pkt[counter] = ((rfc3095_ctxt->sn & 0x1f) << 3) | (crc & 0x07);
 	rohc_comp_debug(context, "SN (%d) + CRC (%x) = 0x%02x",
 	                rfc3095_ctxt->sn, crc, rohc_pkt[counter]);
@@ -2998,7 +3005,7 @@ static int rohc_comp_rfc3095_build_uo1rtp_pkt(struct rohc_comp_ctxt *const conte
 	rohc_pkt[counter] = ((!!rtp_context->tmp.is_marker_bit_set) & 0x01) << 7;
 	rohc_pkt[counter] |= (rfc3095_ctxt->sn & 0x0f) << 3;
 	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	                     rohc_crc_table_3);
 	rohc_pkt[counter] |= crc & 0x07;
 	rohc_comp_debug(context, "M (%d) + SN (%d) + CRC (%x) = 0x%02x",
 	                !!rtp_context->tmp.is_marker_bit_set,
@@ -3146,7 +3153,7 @@ static int rohc_comp_rfc3095_build_uo1ts_pkt(struct rohc_comp_ctxt *const contex
 		goto error;
 	}
 	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	                     rohc_crc_table_3);
 	rohc_pkt[counter] = ((!!rtp_context->tmp.is_marker_bit_set) & 0x01) << 7;
 	rohc_pkt[counter] |= (rfc3095_ctxt->sn & 0x0f) << 3;
 	rohc_pkt[counter] |= crc & 0x07;
@@ -3421,7 +3428,7 @@ static int rohc_comp_rfc3095_build_uo1id_pkt(struct rohc_comp_ctxt *const contex
 		goto error;
 	}
 	crc = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_3, CRC_INIT_3,
-	                     context->compressor->crc_table_3);
+	                     rohc_crc_table_3);
 	s_byte = crc & 0x07;
 	switch(extension)
 	{
@@ -3725,7 +3732,7 @@ static int code_UO2_packet(struct rohc_comp_ctxt *const context,
 	 * TODO: The CRC should be computed only on the CRC-DYNAMIC fields
 	 * if the CRC-STATIC fields did not change */
 	t_byte = compute_uo_crc(context, uncomp_pkt, ROHC_CRC_TYPE_7, CRC_INIT_7,
-	                        context->compressor->crc_table_7);
+	                        rohc_crc_table_7);
 	t_byte_position = counter;
 	counter++;
 
@@ -6089,6 +6096,8 @@ static uint8_t compute_uo_crc(struct rohc_comp_ctxt *const context,
 	const uint8_t *next_header;
 	uint8_t crc = crc_init;
 
+	rohc_perf_start(crc_start);
+
 	outer_ip_hdr = ip_get_raw_data(&uncomp_pkt->outer_ip);
 	if(uncomp_pkt->ip_hdr_nr > 1)
 	{
@@ -6137,6 +6146,7 @@ static uint8_t compute_uo_crc(struct rohc_comp_ctxt *const context,
 	crc = rfc3095_ctxt->compute_crc_dynamic(outer_ip_hdr, inner_ip_hdr, next_header,
 	                                        crc_type, crc, crc_table);
 
+	rohc_perf_stop(context->compressor->perf, ROHC_COMP_PERF_CRC, crc_start);
 	return crc;
 }
 
@@ -147,6 +147,29 @@ bool detect_ipv6_ext_changes(struct list_comp *const comp,
 		goto error;
 	}
 
+	/* allocate the lists the first time one IPv6 extension header is found,
+	 * until then the empty list is the only list ever used */
+	if(pkt_list.items_nr > 0 && comp->lists == &comp->empty_list)
+	{
+		struct rohc_list *lists;
+		unsigned int gen_id;
+
+		lists = malloc((ROHC_LIST_GEN_ID_ANON + 1) * sizeof(struct rohc_list));
+		if(lists == NULL)
+		{
+			rohc_comp_list_warn(comp, "failed to allocate memory for the lists of "
+			                    "extension headers");
+			goto error;
+		}
+		for(gen_id = 0; gen_id <= ROHC_LIST_GEN_ID_ANON; gen_id++)
+		{
+			rohc_list_reset(&lists[gen_id]);
+			lists[gen_id].id = gen_id;
+		}
+		memcpy(&lists[0], &comp->empty_list, sizeof(struct rohc_list));
+		comp->lists = lists;
+	}
+
 	/* now that translation table is updated and packet list is generated,
 	 * search for a context list with the same structure or use an anonymous
 	 * list */
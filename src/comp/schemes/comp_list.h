@@ -44,8 +44,13 @@ struct list_comp
 	/** The translation table */
 	struct rohc_list_item trans_table[ROHC_LIST_MAX_ITEM];
 
-	/* All the possible named lists, indexed by gen_id */
-	struct rohc_list lists[ROHC_LIST_GEN_ID_MAX + 2];
+	/** All the possible named lists, indexed by gen_id, plus the anonymous
+	 *  list: ROHC_LIST_GEN_ID_MAX + 2 lists allocated when the first IPv6
+	 *  extension header is found, points to \e empty_list until then */
+	struct rohc_list *lists;
+	/** The empty list with gen_id 0, the only list used while no IPv6
+	 *  extension header was found */
+	struct rohc_list empty_list;
 
 	/** The ID of the reference list */
 	unsigned int ref_id;
@@ -74,6 +79,8 @@ struct list_comp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The lowest level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
 	/** The profile ID the compression list was created for */
 	int profile_id;
 };
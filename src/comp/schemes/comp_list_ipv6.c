@@ -46,12 +46,14 @@ static bool cmp_ipv6_ext(const struct rohc_list_item *const item,
  * @param list_trans_nr   The number of uncompressed transmissions (L)
  * @param trace_cb        The function to call for printing traces
  * @param trace_cb_priv   An optional private context, may be NULL
+ * @param trace_level     The lowest level of the traces to print
  * @param profile_id      The ID of the associated decompression profile
  */
 void rohc_comp_list_ipv6_new(struct list_comp *const comp,
                              const size_t list_trans_nr,
                              rohc_trace_callback2_t trace_cb,
                              void *const trace_cb_priv,
+                             const rohc_trace_level_t trace_level,
                              const int profile_id)
 {
 	size_t i;
@@ -59,15 +61,14 @@ void rohc_comp_list_ipv6_new(struct list_comp *const comp,
 	comp->ref_id = ROHC_LIST_GEN_ID_NONE;
 	comp->cur_id = ROHC_LIST_GEN_ID_NONE;
 
-	for(i = 0; i <= ROHC_LIST_GEN_ID_ANON; i++)
-	{
-		rohc_list_reset(&comp->lists[i]);
-		comp->lists[i].id = i;
-	}
+	/* lists are allocated when the first IPv6 extension header is found */
+	rohc_list_reset(&comp->empty_list);
+	comp->empty_list.id = 0;
+	comp->lists = &comp->empty_list;
 
 	for(i = 0; i < ROHC_LIST_MAX_ITEM; i++)
 	{
-		rohc_list_item_reset(&comp->trans_table[i]);
+		rohc_list_item_init(&comp->trans_table[i]);
 	}
 
 	comp->list_trans_nr = list_trans_nr;
@@ -80,6 +81,7 @@ void rohc_comp_list_ipv6_new(struct list_comp *const comp,
 	/* traces */
 	comp->trace_callback = trace_cb;
 	comp->trace_callback_priv = trace_cb_priv;
+	comp->trace_level = trace_level;
 	comp->profile_id = profile_id;
 }
 
@@ -91,6 +93,17 @@ void rohc_comp_list_ipv6_new(struct list_comp *const comp,
  */
 void rohc_comp_list_ipv6_free(struct list_comp *const comp)
 {
+	size_t i;
+
+	for(i = 0; i < ROHC_LIST_MAX_ITEM; i++)
+	{
+		rohc_list_item_free(&comp->trans_table[i]);
+	}
+	if(comp->lists != &comp->empty_list)
+	{
+		free(comp->lists);
+	}
+
 	memset(comp, 0, sizeof(struct list_comp));
 }
 
@@ -48,11 +48,13 @@
  * @param trace_cb           The trace callback
  * @param trace_cb_priv      An optional private context for the trace
  *                           callback, may be NULL
+ * @param trace_level        The lowest level of the traces to print
  */
 void c_init_sc(struct ts_sc_comp *const ts_sc,
                const size_t wlsb_window_width,
                rohc_trace_callback2_t trace_cb,
-               void *const trace_cb_priv)
+               void *const trace_cb_priv,
+               const rohc_trace_level_t trace_level)
 {
 	assert(wlsb_window_width > 0);
 
@@ -71,6 +73,7 @@ void c_init_sc(struct ts_sc_comp *const ts_sc,
 
 	ts_sc->trace_callback = trace_cb;
 	ts_sc->trace_callback_priv = trace_cb_priv;
+	ts_sc->trace_level = trace_level;
 
 	/* W-LSB context for TS_SCALED */
 	wlsb_init(&ts_sc->ts_scaled_wlsb, 32, wlsb_window_width, ROHC_LSB_SHIFT_RTP_TS);
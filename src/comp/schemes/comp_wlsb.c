@@ -42,6 +42,47 @@ static size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
                                     const rohc_lsb_shift_t p)
 	__attribute__((warn_unused_result, nonnull(1)));
 
+static size_t wlsb_get_minkp(const struct c_wlsb *const wlsb,
+                             const uint32_t value,
+                             const size_t field_bits_nr,
+                             const size_t min_k,
+                             const size_t max_k,
+                             const rohc_lsb_shift_t p,
+                             const bool is_p_k_dependent)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static size_t wlsb_get_minkp_scan(const struct c_wlsb *const wlsb,
+                                  const uint32_t value,
+                                  const uint32_t field_mask,
+                                  const size_t min_k,
+                                  const size_t max_k,
+                                  const rohc_lsb_shift_t p,
+                                  const bool is_p_k_dependent)
+	__attribute__((warn_unused_result, nonnull(1)));
+
+static void wlsb_extremum_push(const struct c_wlsb *const wlsb,
+                               struct c_wlsb_extremum *const extremum,
+                               const size_t entry,
+                               const bool is_min)
+	__attribute__((nonnull(1, 2)));
+static void wlsb_extremum_remove(const struct c_wlsb *const wlsb,
+                                 struct c_wlsb_extremum *const extremum,
+                                 const size_t entry)
+	__attribute__((nonnull(1, 2)));
+static uint32_t wlsb_extremum_get(const struct c_wlsb *const wlsb,
+                                  const struct c_wlsb_extremum *const extremum)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static bool wlsb_is_narrow(const struct c_wlsb *const wlsb)
+	__attribute__((warn_unused_result, nonnull(1)));
+static uint32_t wlsb_range_extend(uint32_t *const min,
+                                  uint32_t *const max,
+                                  const uint32_t value)
+	__attribute__((warn_unused_result, nonnull(1, 2)));
+
+static size_t wlsb_get_bits_nr(const uint32_t value)
+	__attribute__((warn_unused_result, const));
+
 static size_t wlsb_get_next_older(const size_t entry, const size_t max)
 	__attribute__((warn_unused_result, const));
 
@@ -78,6 +119,11 @@ void wlsb_init(struct c_wlsb *const wlsb,
 	wlsb->window_width = window_width;
 	wlsb->bits = bits;
 	wlsb->p = p;
+	wlsb->is_narrow = false;
+	wlsb->min.first = 0;
+	wlsb->min.count = 0;
+	wlsb->max.first = 0;
+	wlsb->max.count = 0;
 
 	for(i = 0; i < wlsb->window_width; i++)
 	{
@@ -97,9 +143,19 @@ void c_add_wlsb(struct c_wlsb *const wlsb,
                 const uint32_t sn,
                 const uint32_t value)
 {
+	/* do the window values stay less than 2^31 apart with the new value? */
+	if(wlsb->count > 0 && wlsb->is_narrow)
+	{
+		uint32_t min = wlsb_extremum_get(wlsb, &wlsb->min);
+		uint32_t max = wlsb_extremum_get(wlsb, &wlsb->max);
+		wlsb->is_narrow = (wlsb_range_extend(&min, &max, value) < (1U << 31));
+	}
+
 	/* if window is full, an entry is overwritten */
 	if(wlsb->count == wlsb->window_width)
 	{
+		wlsb_extremum_remove(wlsb, &wlsb->min, wlsb->oldest);
+		wlsb_extremum_remove(wlsb, &wlsb->max, wlsb->oldest);
 		wlsb->oldest = (wlsb->oldest + 1) % wlsb->window_width;
 	}
 	else
@@ -110,7 +166,20 @@ void c_add_wlsb(struct c_wlsb *const wlsb,
 	wlsb->window[wlsb->next].used = true;
 	wlsb->window[wlsb->next].sn = sn;
 	wlsb->window[wlsb->next].value = value;
+	wlsb_extremum_push(wlsb, &wlsb->min, wlsb->next, true);
+	wlsb_extremum_push(wlsb, &wlsb->max, wlsb->next, false);
 	wlsb->next = (wlsb->next + 1) % wlsb->window_width;
+
+	/* a window with one value is narrow, a wide window might become narrow
+	 * again once the values far from the other ones are overwritten */
+	if(wlsb->count == 1)
+	{
+		wlsb->is_narrow = true;
+	}
+	else if(!wlsb->is_narrow)
+	{
+		wlsb->is_narrow = wlsb_is_narrow(wlsb);
+	}
 }
 
 
@@ -145,71 +214,8 @@ size_t wlsb_get_kp_8bits(const struct c_wlsb *const wlsb,
                          const uint8_t value,
                          const rohc_lsb_shift_t p)
 {
-	size_t bits_nr;
-
-	/* use all bits if the window contains no value */
-	if(wlsb->count == 0)
-	{
-		bits_nr = wlsb->bits;
-	}
-	else
-	{
-		size_t k;
-
-		bits_nr = 0;
-
-		for(k = bits_nr; k < wlsb->bits; k++)
-		{
-			const uint8_t interval_width = (1U << k) - 1; /* interval width = 2^k - 1 */
-			size_t entry;
-			size_t i;
-
-			/* find the minimal number of bits of the value required to be able
-			 * to recreate it thanks to ANY value in the window */
-			for(i = wlsb->count, entry = wlsb->oldest;
-			    i > 0;
-			    i--, entry = (entry + 1) % wlsb->window_width)
-			{
-				const uint8_t v_ref = wlsb->window[entry].value;
-
-				/* compute the minimal and maximal values of the interval:
-				 *   min = v_ref - p
-				 *   max = v_ref + interval_with - p
-				 *
-				 * Straddling the lower and upper wraparound boundaries
-				 * is handled without additional operation */
-				const uint8_t min = v_ref - p;
-				const uint8_t max = min + interval_width;
-
-				if(min <= max)
-				{
-					/* interpretation interval does not straddle field boundaries,
-					 * check if value is in [min, max] */
-					if(value < min || value > max)
-					{
-						break;
-					}
-				}
-				else
-				{
-					/* the interpretation interval does straddle the field boundaries,
-					 * check if value is in [min, 0xffff] or [0, max] */
-					if(value < min && value > max)
-					{
-						break;
-					}
-				}
-			}
-
-			if(i == 0)
-			{
-				break;
-			}
-		}
-		bits_nr = k;
-	}
-
-	return bits_nr;
+	/* the shift parameter is never computed for 8-bit fields */
+	return wlsb_get_minkp(wlsb, value, 8, 0, wlsb->bits, p, false);
 }
 
 
@@ -286,75 +292,7 @@ size_t wlsb_get_minkp_16bits(const struct c_wlsb *const wlsb,
                              const size_t min_k,
                              const rohc_lsb_shift_t p)
 {
-	size_t bits_nr;
-
-	/* use all bits if the window contains no value */
-	if(wlsb->count == 0)
-	{
-		bits_nr = wlsb->bits;
-	}
-	else
-	{
-		size_t k;
-
-		bits_nr = min_k;
-
-		for(k = bits_nr; k < wlsb->bits; k++)
-		{
-			const uint16_t interval_width = (1U << k) - 1; /* interval width = 2^k - 1 */
-			int16_t computed_p;
-			size_t entry;
-			size_t i;
-
-			/* determine the real p value to use */
-			computed_p = rohc_interval_compute_p(k, p);
-
-			/* find the minimal number of bits of the value required to be able
-			 * to recreate it thanks to ANY value in the window */
-			for(i = wlsb->count, entry = wlsb->oldest;
-			    i > 0;
-			    i--, entry = (entry + 1) % wlsb->window_width)
-			{
-				const uint16_t v_ref = wlsb->window[entry].value;
-
-				/* compute the minimal and maximal values of the interval:
-				 *   min = v_ref - p
-				 *   max = v_ref + interval_with - p
-				 *
-				 * Straddling the lower and upper wraparound boundaries
-				 * is handled without additional operation */
-				const uint16_t min = v_ref - computed_p;
-				const uint16_t max = min + interval_width;
-
-				if(min <= max)
-				{
-					/* interpretation interval does not straddle field boundaries,
-					 * check if value is in [min, max] */
-					if(value < min || value > max)
-					{
-						break;
-					}
-				}
-				else
-				{
-					/* the interpretation interval does straddle the field boundaries,
-					 * check if value is in [min, 0xffff] or [0, max] */
-					if(value < min && value > max)
-					{
-						break;
-					}
-				}
-			}
-
-			if(i == 0)
-			{
-				break;
-			}
-		}
-		bits_nr = k;
-	}
-
-	return bits_nr;
+	return wlsb_get_minkp(wlsb, value, 16, min_k, wlsb->bits, p, true);
 }
 
 
@@ -431,76 +369,7 @@ static size_t wlsb_get_minkp_32bits(const struct c_wlsb *const wlsb,
                                     const size_t min_k,
                                     const rohc_lsb_shift_t p)
 {
-	size_t bits_nr;
-
-	/* use all bits if the window contains no value */
-	if(wlsb->count == 0)
-	{
-		bits_nr = wlsb->bits;
-	}
-	else
-	{
-		size_t k;
-
-		bits_nr = min_k;
-
-		for(k = bits_nr; k < 32; k++)
-		{
-			const uint32_t interval_width = (1U << k) - 1; /* interval width = 2^k - 1 */
-			int32_t computed_p;
-			size_t i;
-
-			/* determine the real p value to use */
-			computed_p = rohc_interval_compute_p(k, p);
-
-			/* find the minimal number of bits of the value required to be able
-			 * to recreate it thanks to ANY value in the window */
-			for(i = 0; i < wlsb->window_width; i++)
-			{
-				const struct c_window *const entry = wlsb->window + i;
-
-				if(entry->used)
-				{
-					const uint32_t v_ref = entry->value;
-
-					/* compute the minimal and maximal values of the interval:
-					 *   min = v_ref - p
-					 *   max = v_ref + interval_with - p
-					 *
-					 * Straddling the lower and upper wraparound boundaries
-					 * is handled without additional operation */
-					const uint32_t min = v_ref - computed_p;
-					const uint32_t max = min + interval_width;
-
-					if(min <= max)
-					{
-						/* interpretation interval does not straddle field boundaries,
-						 * check if value is in [min, max] */
-						if(value < min || value > max)
-						{
-							break;
-						}
-					}
-					else
-					{
-						/* the interpretation interval does straddle the field boundaries,
-						 * check if value is in [min, 0xffff] or [0, max] */
-						if(value < min && value > max)
-						{
-							break;
-						}
-					}
-				}
-			}
-			if(i == wlsb->window_width)
-			{
-				break;
-			}
-		}
-		bits_nr = k;
-	}
-
-	return bits_nr;
+	return wlsb_get_minkp(wlsb, value, 32, min_k, 32, p, true);
 }
 
 
@@ -584,6 +453,334 @@ bool wlsb_is_sn_present(struct c_wlsb *const wlsb, const uint32_t sn)
  */
 
 
+/**
+ * @brief Find out the minimal number of bits of the to-be-encoded value
+ *        required to be able to uniquely recreate it given the window
+ *
+ * The value \e value is in the interpretation interval of one window value
+ * \e v_ref for \e k bits if and only if:
+ *   (value - v_ref + p) modulo 2^field_bits_nr < 2^k
+ *
+ * The smallest and largest window values are maintained by c_add_wlsb()
+ * and wlsb_ack(). If they are not more than half the field space apart,
+ * testing them is enough to test the whole window: if the value is in the
+ * interval of the smallest value but not in the interval of the largest
+ * one, it cannot be in the interval of all the window values. The
+ * computation does not depend on the window width then. If the shift
+ * parameter does not depend on k, the minimal k is even given directly by
+ * the number of bits of the distances between the value and those two
+ * window values.
+ *
+ * The window is scanned as a whole if its values are too far apart.
+ *
+ * @param wlsb              The W-LSB object
+ * @param value             The value to encode using the LSB algorithm
+ * @param field_bits_nr     The length (in bits) of the field: 8, 16 or 32
+ * @param min_k             The minimum number of bits to find out
+ * @param max_k             The number of bits to use if no smaller k fits
+ * @param p                 The shift parameter p
+ * @param is_p_k_dependent  Whether p shall be computed for every k
+ * @return                  The number of bits required to uniquely recreate
+ *                          the value
+ */
+static size_t wlsb_get_minkp(const struct c_wlsb *const wlsb,
+                             const uint32_t value,
+                             const size_t field_bits_nr,
+                             const size_t min_k,
+                             const size_t max_k,
+                             const rohc_lsb_shift_t p,
+                             const bool is_p_k_dependent)
+{
+	const uint32_t field_mask =
+		(field_bits_nr >= 32 ? 0xffffffffU : ((1U << field_bits_nr) - 1));
+	const bool is_p_k_dependent_really = is_p_k_dependent &&
+		(p == ROHC_LSB_SHIFT_RTP_TS || p == ROHC_LSB_SHIFT_RTP_SN ||
+		 p == ROHC_LSB_SHIFT_ESP_SN);
+	uint32_t min;
+	uint32_t max;
+	size_t bits_nr;
+
+	if(wlsb->count > 0 && wlsb->is_narrow)
+	{
+		min = wlsb_extremum_get(wlsb, &wlsb->min);
+		max = wlsb_extremum_get(wlsb, &wlsb->max);
+	}
+	else
+	{
+		min = 0;
+		max = 0xffffffffU;
+	}
+
+	/* use all bits if the window contains no value */
+	if(wlsb->count == 0)
+	{
+		bits_nr = wlsb->bits;
+	}
+	else if((max - min) > (1U << (field_bits_nr - 1)))
+	{
+		/* the window values are spread over too many values */
+		bits_nr = wlsb_get_minkp_scan(wlsb, value, field_mask, min_k, max_k,
+		                              p, is_p_k_dependent_really);
+	}
+	else if(!is_p_k_dependent_really)
+	{
+		/* distances of the value to the bounds of the interpretation intervals
+		 * of the smallest and largest window values */
+		const uint32_t dist_min = (value - min + p) & field_mask;
+		const uint32_t dist_max = (value - max + p) & field_mask;
+		const size_t needed_bits_nr = wlsb_get_bits_nr(dist_min | dist_max);
+
+		/* same result as testing all k from min_k to max_k - 1 */
+		if(needed_bits_nr <= min_k)
+		{
+			bits_nr = min_k;
+		}
+		else if(needed_bits_nr >= max_k)
+		{
+			bits_nr = (min_k > max_k ? min_k : max_k);
+		}
+		else
+		{
+			bits_nr = needed_bits_nr;
+		}
+	}
+	else
+	{
+		size_t k;
+
+		/* p depends on k in a non-monotonic way, so test every k, but against
+		 * the smallest and largest window values only */
+		for(k = min_k; k < max_k; k++)
+		{
+			const int32_t computed_p = rohc_interval_compute_p(k, p);
+			const uint32_t dist_min = (value - min + computed_p) & field_mask;
+			const uint32_t dist_max = (value - max + computed_p) & field_mask;
+
+			if((dist_min | dist_max) < (1U << k))
+			{
+				break;
+			}
+		}
+		bits_nr = k;
+	}
+
+	return bits_nr;
+}
+
+
+/**
+ * @brief Find out the minimal number of bits of the to-be-encoded value
+ *        by testing all the values of the window
+ *
+ * @param wlsb              The W-LSB object
+ * @param value             The value to encode using the LSB algorithm
+ * @param field_mask        The mask of the bits of the field
+ * @param min_k             The minimum number of bits to find out
+ * @param max_k             The number of bits to use if no smaller k fits
+ * @param p                 The shift parameter p
+ * @param is_p_k_dependent  Whether p shall be computed for every k
+ * @return                  The number of bits required to uniquely recreate
+ *                          the value
+ */
+static size_t wlsb_get_minkp_scan(const struct c_wlsb *const wlsb,
+                                  const uint32_t value,
+                                  const uint32_t field_mask,
+                                  const size_t min_k,
+                                  const size_t max_k,
+                                  const rohc_lsb_shift_t p,
+                                  const bool is_p_k_dependent)
+{
+	size_t k;
+
+	for(k = min_k; k < max_k; k++)
+	{
+		const int32_t computed_p =
+			(is_p_k_dependent ? rohc_interval_compute_p(k, p) : (int32_t) p);
+		size_t entry;
+		size_t i;
+
+		/* find the minimal number of bits of the value required to be able
+		 * to recreate it thanks to ANY value in the window */
+		for(i = wlsb->count, entry = wlsb->oldest;
+		    i > 0;
+		    i--, entry = (entry + 1) % wlsb->window_width)
+		{
+			const uint32_t v_ref = wlsb->window[entry].value;
+
+			if(((value - v_ref + computed_p) & field_mask) >= (1U << k))
+			{
+				break;
+			}
+		}
+
+		if(i == 0)
+		{
+			break;
+		}
+	}
+
+	return k;
+}
+
+
+/**
+ * @brief Add a new window entry to the candidates for the smallest (or the
+ *        largest) window value
+ *
+ * The older candidates that are larger (or smaller) than the new entry will
+ * never be the extremum again, so they are dropped. Values are compared
+ * with serial number arithmetic: the order is meaningful only when all the
+ * window values are less than 2^31 apart.
+ *
+ * @param wlsb      The W-LSB object
+ * @param extremum  The candidates to update
+ * @param entry     The position of the new entry in the window
+ * @param is_min    Whether the candidates are for the smallest value
+ */
+static void wlsb_extremum_push(const struct c_wlsb *const wlsb,
+                               struct c_wlsb_extremum *const extremum,
+                               const size_t entry,
+                               const bool is_min)
+{
+	const uint32_t value = wlsb->window[entry].value;
+
+	while(extremum->count > 0)
+	{
+		const size_t last =
+			(extremum->first + extremum->count - 1) % wlsb->window_width;
+		const int32_t diff =
+			(int32_t) (wlsb->window[extremum->entries[last]].value - value);
+
+		if((is_min && diff < 0) || (!is_min && diff > 0))
+		{
+			break;
+		}
+		extremum->count--;
+	}
+
+	extremum->entries[(extremum->first + extremum->count) % wlsb->window_width] =
+		entry;
+	extremum->count++;
+}
+
+
+/**
+ * @brief Remove the given window entry from the candidates for the smallest
+ *        (or the largest) window value
+ *
+ * Only the oldest window entry may be removed.
+ *
+ * @param wlsb      The W-LSB object
+ * @param extremum  The candidates to update
+ * @param entry     The position of the removed entry in the window
+ */
+static void wlsb_extremum_remove(const struct c_wlsb *const wlsb,
+                                 struct c_wlsb_extremum *const extremum,
+                                 const size_t entry)
+{
+	if(extremum->count > 0 && extremum->entries[extremum->first] == entry)
+	{
+		extremum->first = (extremum->first + 1) % wlsb->window_width;
+		extremum->count--;
+	}
+}
+
+
+/**
+ * @brief Get the smallest (or the largest) window value
+ *
+ * @param wlsb      The W-LSB object
+ * @param extremum  The candidates for the smallest (or the largest) value
+ * @return          The smallest (or the largest) window value
+ */
+static uint32_t wlsb_extremum_get(const struct c_wlsb *const wlsb,
+                                  const struct c_wlsb_extremum *const extremum)
+{
+	assert(extremum->count > 0);
+	return wlsb->window[extremum->entries[extremum->first]].value;
+}
+
+
+/**
+ * @brief Whether all the window values are less than 2^31 apart
+ *
+ * @param wlsb  The W-LSB object
+ * @return      true if the window values are less than 2^31 apart,
+ *              false if they are or if they might be more spread
+ */
+static bool wlsb_is_narrow(const struct c_wlsb *const wlsb)
+{
+	size_t entry = wlsb->oldest;
+	uint32_t min = wlsb->window[entry].value;
+	uint32_t max = wlsb->window[entry].value;
+	uint32_t width = 0;
+	size_t i;
+
+	for(i = 1; i < wlsb->count && width < (1U << 31); i++)
+	{
+		entry = (entry + 1) % wlsb->window_width;
+		width = wlsb_range_extend(&min, &max, wlsb->window[entry].value);
+	}
+
+	return (width < (1U << 31));
+}
+
+
+/**
+ * @brief Extend the range [min, max] (modulo 2^32) with the given value
+ *
+ * The range is extended on the side that keeps it the smallest.
+ *
+ * @param[in,out] min  The lower bound of the range
+ * @param[in,out] max  The upper bound of the range
+ * @param value        The value to include in the range
+ * @return             The width of the extended range
+ */
+static uint32_t wlsb_range_extend(uint32_t *const min,
+                                  uint32_t *const max,
+                                  const uint32_t value)
+{
+	const uint32_t width = (*max) - (*min);
+	const uint32_t width_if_new_max = value - (*min);
+	uint32_t new_width;
+
+	if(width_if_new_max <= width)
+	{
+		new_width = width;
+	}
+	else
+	{
+		const uint32_t width_if_new_min = (*max) - value;
+
+		if(width_if_new_max <= width_if_new_min)
+		{
+			*max = value;
+			new_width = width_if_new_max;
+		}
+		else
+		{
+			*min = value;
+			new_width = width_if_new_min;
+		}
+	}
+
+	return new_width;
+}
+
+
+/**
+ * @brief Get the number of bits required to represent the given value
+ *
+ * @param value  The value
+ * @return       The position of the most significant bit set plus one,
+ *               0 for value 0
+ */
+static size_t wlsb_get_bits_nr(const uint32_t value)
+{
+	return (value == 0 ? 0 : (32U - __builtin_clz(value)));
+}
+
+
 /**
  * @brief Get the next older entry
  *
@@ -611,6 +808,8 @@ static size_t wlsb_ack_remove(struct c_wlsb *const wlsb, const size_t pos)
 	while(wlsb->oldest != pos)
 	{
 		/* remove the oldest entry */
+		wlsb_extremum_remove(wlsb, &wlsb->min, wlsb->oldest);
+		wlsb_extremum_remove(wlsb, &wlsb->max, wlsb->oldest);
 		wlsb->window[wlsb->oldest].used = false;
 		wlsb->oldest = (wlsb->oldest + 1) % wlsb->window_width;
 		wlsb->count--;
@@ -50,6 +50,22 @@ struct c_window
 };
 
 
+/**
+ * @brief The window entries that may become the smallest (or the largest)
+ *        value of the window once the older entries are removed
+ *
+ * The entries are sorted from the oldest to the newest, and from the
+ * smallest to the largest value (or the contrary), so the first one is the
+ * smallest (or the largest) value of the window.
+ */
+struct c_wlsb_extremum
+{
+	uint8_t entries[ROHC_WLSB_WIDTH_MAX]; /**< The positions in the window */
+	uint8_t first;  /**< The index of the first (oldest) candidate */
+	uint8_t count;  /**< The number of candidates */
+};
+
+
 /**
  * @brief One W-LSB encoding object
  */
@@ -71,6 +87,14 @@ struct c_wlsb
 	/** The shift parameter (see 4.5.2 in the RFC 3095) */
 	rohc_lsb_shift_t p;
 
+	/** Whether all the values of the window are less than 2^31 apart, ie.
+	 *  whether they are ordered and \e min and \e max are meaningful */
+	bool is_narrow;
+	/** The candidates for the smallest value of the window */
+	struct c_wlsb_extremum min;
+	/** The candidates for the largest value of the window */
+	struct c_wlsb_extremum max;
+
 	/** The window in which previous values of the encoded value are stored */
 	struct c_window window[ROHC_WLSB_WIDTH_MAX];
 };
@@ -24,8 +24,12 @@
  */
 
 #include "rohc_comp.h"
+#include "rohc_decomp.h"
+
+#include "config.h" /* for ROHC_PERF_COUNTERS */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
@@ -51,6 +55,9 @@
 static int random_cb(const struct rohc_comp *const comp,
                      void *const user_context)
 	__attribute__((warn_unused_result));
+static void * test_malloc(void *const priv_ctxt, const size_t size)
+	__attribute__((warn_unused_result));
+static void test_free(void *const priv_ctxt, void *const ptr);
 
 
 /**
@@ -63,6 +70,7 @@ static int random_cb(const struct rohc_comp *const comp,
 int main(int argc, char *argv[])
 {
 	struct rohc_comp *comp;
+	size_t blocks_nr = 0;
 	bool verbose; /* whether to run in verbose mode or not */
 	int is_failure = 1; /* test fails by default */
 
@@ -121,6 +129,19 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_set_traces_cb2(comp, fct, comp) == true);
 	}
 
+	/* rohc_comp_set_traces_level() */
+	CHECK(rohc_comp_set_traces_level(NULL, ROHC_TRACE_WARNING) == false);
+	CHECK(rohc_comp_set_traces_level(comp, ROHC_TRACE_LEVEL_MAX) == false);
+	CHECK(rohc_comp_set_traces_level(comp, ROHC_TRACE_WARNING) == true);
+	CHECK(rohc_comp_set_traces_level(comp, ROHC_TRACE_DEBUG) == true);
+
+	/* rohc_comp_set_allocator() */
+	CHECK(rohc_comp_set_allocator(NULL, test_malloc, test_free, &blocks_nr) == false);
+	CHECK(rohc_comp_set_allocator(comp, test_malloc, NULL, &blocks_nr) == false);
+	CHECK(rohc_comp_set_allocator(comp, NULL, test_free, &blocks_nr) == false);
+	CHECK(rohc_comp_set_allocator(comp, NULL, NULL, NULL) == true);
+	CHECK(rohc_comp_set_allocator(comp, test_malloc, test_free, &blocks_nr) == true);
+
 	/* rohc_comp_profile_enabled() */
 	CHECK(rohc_comp_profile_enabled(NULL, ROHC_PROFILE_IP) == false);
 	CHECK(rohc_comp_profile_enabled(comp, ROHC_PROFILE_GENERAL) == false);
@@ -185,6 +206,19 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_get_segment2(comp, &pkt1) == ROHC_STATUS_ERROR);
 	}
 
+	/* rohc_comp_get_segment_sg() */
+	{
+		uint8_t buf1[2];
+		struct rohc_buf pkt1 = rohc_buf_init_empty(buf1, 2);
+		struct rohc_buf payload;
+		struct rohc_buf trailer;
+		CHECK(rohc_comp_get_segment_sg(NULL, 100, &pkt1, &payload, &trailer) == ROHC_STATUS_ERROR);
+		CHECK(rohc_comp_get_segment_sg(comp, 100, NULL, &payload, &trailer) == ROHC_STATUS_ERROR);
+		CHECK(rohc_comp_get_segment_sg(comp, 100, &pkt1, NULL, &trailer) == ROHC_STATUS_ERROR);
+		CHECK(rohc_comp_get_segment_sg(comp, 100, &pkt1, &payload, NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_comp_get_segment_sg(comp, 100, &pkt1, &payload, &trailer) == ROHC_STATUS_ERROR);
+	}
+
 	/* rohc_comp_force_contexts_reinit() */
 	CHECK(rohc_comp_force_contexts_reinit(NULL) == false);
 	CHECK(rohc_comp_force_contexts_reinit(comp) == true);
@@ -312,6 +346,262 @@ int main(int argc, char *argv[])
 		CHECK(rohc_compress4(comp, pkt, &pkt2) == ROHC_STATUS_OK);
 	}
 
+	/* rohc_compress_inplace() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		const uint8_t ip[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const size_t headroom = 100;
+		uint8_t buf[100 + sizeof(ip)];
+		struct rohc_buf pkt = rohc_buf_init_empty(buf, sizeof(buf));
+		pkt.time = ts;
+		memcpy(buf, ip, sizeof(ip));
+		pkt.len = sizeof(ip);
+		CHECK(rohc_compress_inplace(NULL, &pkt) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_inplace(comp, NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_inplace(comp, &pkt) == ROHC_STATUS_ERROR);
+		CHECK(pkt.offset == 0 && pkt.len == sizeof(ip));
+		memcpy(buf + headroom, ip, sizeof(ip));
+		pkt.offset = headroom;
+		CHECK(rohc_compress_inplace(comp, &pkt) == ROHC_STATUS_OK);
+		CHECK(pkt.offset + pkt.len == sizeof(buf));
+		CHECK(memcmp(buf + headroom + 20, ip + 20, sizeof(ip) - 20) == 0);
+	}
+
+	/* rohc_compress_inplace() then rohc_decompress3() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		const uint8_t ip[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const size_t headroom = 100;
+		struct rohc_comp *comp_inplace;
+		struct rohc_decomp *decomp;
+		uint8_t buf[100 + sizeof(ip)];
+		struct rohc_buf pkt = rohc_buf_init_empty(buf, sizeof(buf));
+		uint8_t decomp_buf[100];
+		struct rohc_buf decomp_pkt = rohc_buf_init_empty(decomp_buf, 100);
+
+		comp_inplace = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                              random_cb, NULL);
+		CHECK(comp_inplace != NULL);
+		CHECK(rohc_comp_enable_profile(comp_inplace, ROHC_PROFILE_IP) == true);
+		decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+		CHECK(decomp != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp, ROHC_PROFILE_IP) == true);
+
+		/* the first packet is an IR packet, the next ones are smaller */
+		for(size_t i = 0; i < 5; i++)
+		{
+			pkt.time = ts;
+			pkt.offset = headroom;
+			pkt.len = sizeof(ip);
+			memcpy(buf + headroom, ip, sizeof(ip));
+			CHECK(rohc_compress_inplace(comp_inplace, &pkt) == ROHC_STATUS_OK);
+			rohc_buf_reset(&decomp_pkt);
+			CHECK(rohc_decompress3(decomp, pkt, &decomp_pkt, NULL, NULL) == ROHC_STATUS_OK);
+			CHECK(decomp_pkt.len == sizeof(ip));
+			CHECK(memcmp(rohc_buf_data(decomp_pkt), ip, sizeof(ip)) == 0);
+		}
+
+		rohc_decomp_free(decomp);
+		rohc_comp_free(comp_inplace);
+	}
+
+	/* rohc_compress_sg() and rohc_comp_get_segment_sg() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t ip[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const struct rohc_buf pkt = rohc_buf_init_full(ip, sizeof(ip), ts);
+		uint8_t buf[100];
+		struct rohc_buf hdr = rohc_buf_init_empty(buf, 100);
+		struct rohc_buf payload;
+		struct rohc_buf trailer;
+		size_t seg_len = 0;
+		rohc_status_t status;
+		CHECK(rohc_compress_sg(NULL, pkt, 1500, &hdr, &payload) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_sg(comp, pkt, 1500, NULL, &payload) == ROHC_STATUS_ERROR);
+		CHECK(rohc_compress_sg(comp, pkt, 1500, &hdr, NULL) == ROHC_STATUS_ERROR);
+		hdr.len = 1;
+		CHECK(rohc_compress_sg(comp, pkt, 1500, &hdr, &payload) == ROHC_STATUS_ERROR);
+		hdr.len = 0;
+		CHECK(rohc_compress_sg(comp, pkt, 1500, &hdr, &payload) == ROHC_STATUS_OK);
+		CHECK(hdr.len > 0);
+		CHECK(payload.data == ip);
+		CHECK(payload.offset + payload.len == sizeof(ip));
+
+		/* MRRU disabled, segmentation impossible */
+		rohc_buf_reset(&hdr);
+		CHECK(rohc_compress_sg(comp, pkt, 50, &hdr, &payload) == ROHC_STATUS_ERROR);
+
+		/* segmentation with the payload kept in the uncompressed packet */
+		CHECK(rohc_comp_set_mrru(comp, 500) == true);
+		rohc_buf_reset(&hdr);
+		CHECK(rohc_compress_sg(comp, pkt, 50, &hdr, &payload) == ROHC_STATUS_SEGMENT);
+		CHECK(hdr.len == 0 && payload.len == 0);
+		rohc_buf_reset(&hdr);
+		CHECK(rohc_comp_get_segment_sg(comp, 1, &hdr, &payload, &trailer) == ROHC_STATUS_ERROR);
+		do
+		{
+			rohc_buf_reset(&hdr);
+			status = rohc_comp_get_segment_sg(comp, 50, &hdr, &payload, &trailer);
+			CHECK(status == ROHC_STATUS_OK || status == ROHC_STATUS_SEGMENT);
+			CHECK(hdr.len + payload.len + trailer.len <= 50);
+			CHECK(payload.len == 0 || payload.data == ip);
+			seg_len += hdr.len - 1 + payload.len + trailer.len;
+		}
+		while(status == ROHC_STATUS_SEGMENT);
+		CHECK(trailer.len > 0);
+		CHECK(seg_len > (sizeof(ip) - 20 + 4));
+		rohc_buf_reset(&hdr);
+		CHECK(rohc_comp_get_segment_sg(comp, 50, &hdr, &payload, &trailer) == ROHC_STATUS_ERROR);
+		CHECK(rohc_comp_set_mrru(comp, 0) == true);
+	}
+
+	/* rohc_comp_get_segment_sg() then rohc_decompress3() with the segments */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t ip[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const struct rohc_buf pkt = rohc_buf_init_full(ip, sizeof(ip), ts);
+		struct rohc_comp *comp_sg;
+		struct rohc_decomp *decomp;
+		uint8_t buf[100];
+		struct rohc_buf hdr = rohc_buf_init_empty(buf, 100);
+		struct rohc_buf payload;
+		struct rohc_buf trailer;
+		uint8_t seg_buf[50];
+		struct rohc_buf seg = rohc_buf_init_empty(seg_buf, 50);
+		uint8_t decomp_buf[100];
+		struct rohc_buf decomp_pkt = rohc_buf_init_empty(decomp_buf, 100);
+		rohc_status_t status;
+
+		comp_sg = rohc_comp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX,
+		                         random_cb, NULL);
+		CHECK(comp_sg != NULL);
+		CHECK(rohc_comp_enable_profile(comp_sg, ROHC_PROFILE_IP) == true);
+		CHECK(rohc_comp_set_mrru(comp_sg, 500) == true);
+		decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+		CHECK(decomp != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp, ROHC_PROFILE_IP) == true);
+		CHECK(rohc_decomp_set_mrru(decomp, 500) == true);
+
+		/* gather the header, the payload and the trailer of every segment in
+		 * one buffer, the decompressor rebuilds the packet with the last one */
+		for(size_t i = 0; i < 3; i++)
+		{
+			rohc_buf_reset(&hdr);
+			CHECK(rohc_compress_sg(comp_sg, pkt, 50, &hdr, &payload) == ROHC_STATUS_SEGMENT);
+			do
+			{
+				rohc_buf_reset(&hdr);
+				status = rohc_comp_get_segment_sg(comp_sg, 50, &hdr, &payload, &trailer);
+				CHECK(status == ROHC_STATUS_OK || status == ROHC_STATUS_SEGMENT);
+				rohc_buf_reset(&seg);
+				rohc_buf_append_buf(&seg, hdr);
+				rohc_buf_append_buf(&seg, payload);
+				rohc_buf_append_buf(&seg, trailer);
+				rohc_buf_reset(&decomp_pkt);
+				CHECK(rohc_decompress3(decomp, seg, &decomp_pkt, NULL, NULL) == ROHC_STATUS_OK);
+				CHECK(decomp_pkt.len == (status == ROHC_STATUS_OK ? sizeof(ip) : 0));
+			}
+			while(status == ROHC_STATUS_SEGMENT);
+			CHECK(memcmp(rohc_buf_data(decomp_pkt), ip, sizeof(ip)) == 0);
+		}
+
+		rohc_decomp_free(decomp);
+		rohc_comp_free(comp_sg);
+	}
+
+	/* rohc_compress_burst() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] =
+		{
+			0x45, 0x00, 0x00, 0x54,  0x00, 0x00, 0x40, 0x00,
+			0x40, 0x01, 0x93, 0x52,  0xc0, 0xa8, 0x13, 0x01,
+			0xc0, 0xa8, 0x13, 0x05,  0x08, 0x00, 0xe9, 0xc2,
+			0x9b, 0x42, 0x00, 0x01,  0x66, 0x15, 0xa6, 0x45,
+			0x77, 0x9b, 0x04, 0x00,  0x08, 0x09, 0x0a, 0x0b,
+			0x0c, 0x0d, 0x0e, 0x0f,  0x10, 0x11, 0x12, 0x13,
+			0x14, 0x15, 0x16, 0x17,  0x18, 0x19, 0x1a, 0x1b,
+			0x1c, 0x1d, 0x1e, 0x1f,  0x20, 0x21, 0x22, 0x23,
+			0x24, 0x25, 0x26, 0x27,  0x28, 0x29, 0x2a, 0x2b,
+			0x2c, 0x2d, 0x2e, 0x2f,  0x30, 0x31, 0x32, 0x33,
+			0x34, 0x35, 0x36, 0x37
+		};
+		const struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		struct rohc_buf pkts[3] = { pkt, pkt, pkt };
+		uint8_t buf2[3][100];
+		struct rohc_buf pkts2[3] =
+		{
+			rohc_buf_init_empty(buf2[0], 100),
+			rohc_buf_init_empty(buf2[1], 100),
+			rohc_buf_init_empty(buf2[2], 100),
+		};
+		rohc_status_t statuses[3];
+		CHECK(rohc_compress_burst(NULL, pkts, pkts2, statuses, 3) == 0);
+		CHECK(rohc_compress_burst(comp, NULL, pkts2, statuses, 3) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, NULL, statuses, 3) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, pkts2, NULL, 3) == 0);
+		CHECK(rohc_compress_burst(comp, pkts, pkts2, statuses, 0) == 0);
+		pkts[1].len = 0;
+		pkts2[2].max_len = 1;
+		CHECK(rohc_compress_burst(comp, pkts, pkts2, statuses, 3) == 3);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(statuses[1] == ROHC_STATUS_ERROR);
+		CHECK(statuses[2] == ROHC_STATUS_ERROR);
+		CHECK(pkts2[0].len > 0);
+	}
+
 	/* rohc_comp_get_last_packet_info2() */
 	{
 		rohc_comp_last_packet_info2_t info;
@@ -342,6 +632,65 @@ int main(int argc, char *argv[])
 		CHECK(rohc_comp_get_general_info(comp, &info) == true);
 	}
 
+	/* rohc_comp_get_perf_counters() */
+	{
+		rohc_comp_perf_counters_t counters;
+		memset(&counters, 0, sizeof(rohc_comp_perf_counters_t));
+		CHECK(rohc_comp_get_perf_counters(NULL, &counters) == false);
+		CHECK(rohc_comp_get_perf_counters(comp, NULL) == false);
+		counters.version_major = 0xffff;
+		CHECK(rohc_comp_get_perf_counters(comp, &counters) == false);
+		counters.version_major = 0;
+		counters.version_minor = 0xffff;
+		CHECK(rohc_comp_get_perf_counters(comp, &counters) == false);
+		counters.version_minor = 0;
+#ifdef ROHC_PERF_COUNTERS
+		CHECK(rohc_comp_get_perf_counters(comp, &counters) == true);
+		CHECK(counters.stages[ROHC_COMP_PERF_PARSE].calls > 0);
+		CHECK(counters.stages[ROHC_COMP_PERF_ENCODE].calls > 0);
+		CHECK(counters.stages[ROHC_COMP_PERF_CRC].calls > 0);
+#else
+		CHECK(rohc_comp_get_perf_counters(comp, &counters) == false);
+#endif
+	}
+
+	/* rohc_comp_get_stats() */
+	{
+		rohc_stats_t stats;
+		memset(&stats, 0, sizeof(rohc_stats_t));
+		CHECK(rohc_comp_get_stats(NULL, &stats) == false);
+		CHECK(rohc_comp_get_stats(comp, NULL) == false);
+		stats.version_major = 0xffff;
+		CHECK(rohc_comp_get_stats(comp, &stats) == false);
+		stats.version_major = 0;
+		stats.version_minor = 0xffff;
+		CHECK(rohc_comp_get_stats(comp, &stats) == false);
+		stats.version_minor = 0;
+		CHECK(rohc_comp_get_stats(comp, &stats) == true);
+		CHECK(stats.packets_nr > 0);
+		CHECK(stats.uncomp_bytes_nr > 0);
+		CHECK(stats.comp_bytes_nr > 0);
+	}
+
+	/* rohc_comp_get_ctxt_stats() */
+	{
+		rohc_stats_t stats;
+		memset(&stats, 0, sizeof(rohc_stats_t));
+		CHECK(rohc_comp_get_ctxt_stats(NULL, 0, &stats) == false);
+		CHECK(rohc_comp_get_ctxt_stats(comp, ROHC_SMALL_CID_MAX + 1, &stats) == false);
+		CHECK(rohc_comp_get_ctxt_stats(comp, 0, NULL) == false);
+		stats.version_major = 0xffff;
+		CHECK(rohc_comp_get_ctxt_stats(comp, 0, &stats) == false);
+		stats.version_major = 0;
+		stats.version_minor = 0xffff;
+		CHECK(rohc_comp_get_ctxt_stats(comp, 0, &stats) == false);
+		stats.version_minor = 0;
+		CHECK(rohc_comp_get_ctxt_stats(comp, 0, &stats) == true);
+		CHECK(stats.packets_nr > 0);
+		CHECK(rohc_comp_get_ctxt_stats(comp, ROHC_SMALL_CID_MAX, &stats) == true);
+		CHECK(stats.packets_nr == 0);
+	}
+
 	/* rohc_comp_get_state_descr() */
 	CHECK(strcmp(rohc_comp_get_state_descr(ROHC_COMP_STATE_IR), "IR") == 0);
 	CHECK(strcmp(rohc_comp_get_state_descr(ROHC_COMP_STATE_FO), "FO") == 0);
@@ -378,17 +727,21 @@ int main(int argc, char *argv[])
 	{
 		rohc_trace_callback2_t fct = (rohc_trace_callback2_t) NULL;
 		CHECK(rohc_comp_set_traces_cb2(comp, fct, comp) == false);
+		CHECK(rohc_comp_set_traces_level(comp, ROHC_TRACE_WARNING) == false);
 
 		CHECK(rohc_comp_set_wlsb_window_width(comp, 16) == false);
 
 		CHECK(rohc_comp_set_periodic_refreshes(comp, 10, 5) == false);
 
 		CHECK(rohc_comp_set_list_trans_nr(comp, 5) == false);
+
+		CHECK(rohc_comp_set_allocator(comp, NULL, NULL, NULL) == false);
 	}
 
 	/* rohc_comp_free() */
 	rohc_comp_free(NULL);
 	rohc_comp_free(comp);
+	CHECK(blocks_nr == 0);
 
 	/* test succeeds */
 	trace(verbose, "all tests are successful\n");
@@ -412,3 +765,39 @@ static int random_cb(const struct rohc_comp *const comp __attribute__((unused)),
 	return 0; /* fake */
 }
 
+
+/**
+ * @brief Allocation callback that counts the blocks in use
+ *
+ * @param priv_ctxt  The number of blocks in use
+ * @param size       The number of bytes to allocate
+ * @return           The allocated memory, NULL in case of failure
+ */
+static void * test_malloc(void *const priv_ctxt, const size_t size)
+{
+	size_t *const blocks_nr = priv_ctxt;
+	void *const ptr = malloc(size);
+
+	if(ptr != NULL)
+	{
+		(*blocks_nr)++;
+	}
+
+	return ptr;
+}
+
+
+/**
+ * @brief Release callback that counts the blocks in use
+ *
+ * @param priv_ctxt  The number of blocks in use
+ * @param ptr        The memory to release
+ */
+static void test_free(void *const priv_ctxt, void *const ptr)
+{
+	size_t *const blocks_nr = priv_ctxt;
+
+	assert((*blocks_nr) > 0);
+	(*blocks_nr)--;
+	free(ptr);
+}
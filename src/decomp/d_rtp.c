@@ -72,9 +72,8 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
                          struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void d_rtp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
-                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+static void d_rtp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt)
+	__attribute__((nonnull(1)));
 
 static rohc_packet_t rtp_detect_packet_type(const struct rohc_decomp_ctxt *const context,
                                             const uint8_t *const rohc_packet,
@@ -183,6 +182,7 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 	if(!rohc_decomp_rfc3095_create(context, persist_ctxt, volat_ctxt,
 	                               context->decompressor->trace_callback,
 	                               context->decompressor->trace_callback_priv,
+	                               context->decompressor->trace_level,
 	                               context->profile->id))
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -192,7 +192,8 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 	rfc3095_ctxt = *persist_ctxt;
 
 	/* create the RTP-specific part of the context */
-	rtp_context = calloc(1, sizeof(struct d_rtp_context));
+	rtp_context = rohc_mem_zalloc(&context->decompressor->mem,
+	                              sizeof(struct d_rtp_context));
 	if(rtp_context == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -223,7 +224,8 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 
 	/* create the UDP-specific part of the header changes */
 	rfc3095_ctxt->outer_ip_changes->next_header_len = nh_len;
-	rfc3095_ctxt->outer_ip_changes->next_header = calloc(1, nh_len);
+	rfc3095_ctxt->outer_ip_changes->next_header =
+		rohc_mem_zalloc(&context->decompressor->mem, nh_len);
 	if(rfc3095_ctxt->outer_ip_changes->next_header == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -233,7 +235,8 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 	}
 
 	rfc3095_ctxt->inner_ip_changes->next_header_len = nh_len;
-	rfc3095_ctxt->inner_ip_changes->next_header = calloc(1, nh_len);
+	rfc3095_ctxt->inner_ip_changes->next_header =
+		rohc_mem_zalloc(&context->decompressor->mem, nh_len);
 	if(rfc3095_ctxt->inner_ip_changes->next_header == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -247,16 +250,17 @@ static bool d_rtp_create(const struct rohc_decomp_ctxt *const context,
 
 	/* create the scaled RTP Timestamp decoding context */
 	d_init_sc(&rtp_context->ts_scaled_ctxt, context->decompressor->trace_callback,
-	          context->decompressor->trace_callback_priv);
+	          context->decompressor->trace_callback_priv,
+	          context->decompressor->trace_level);
 
 	return true;
 
 free_outer_ip_changes_next_header:
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
+	rohc_mem_zfree(rfc3095_ctxt->outer_ip_changes->next_header);
 free_rtp_context:
-	zfree(rtp_context);
+	rohc_mem_zfree(rtp_context);
 destroy_context:
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
+	rohc_decomp_rfc3095_destroy(rfc3095_ctxt);
 quit:
 	return false;
 }
@@ -269,19 +273,17 @@ quit:
  * framework to work.
  *
  * @param rfc3095_ctxt  The persistent decompression context for the RFC3095 profiles
- * @param volat_ctxt    The volatile decompression context
  */
-static void d_rtp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
-                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+static void d_rtp_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt)
 {
 	/* clean UDP-specific memory */
 	assert(rfc3095_ctxt->outer_ip_changes != NULL);
-	zfree(rfc3095_ctxt->outer_ip_changes->next_header);
+	rohc_mem_zfree(rfc3095_ctxt->outer_ip_changes->next_header);
 	assert(rfc3095_ctxt->inner_ip_changes != NULL);
-	zfree(rfc3095_ctxt->inner_ip_changes->next_header);
+	rohc_mem_zfree(rfc3095_ctxt->inner_ip_changes->next_header);
 
 	/* destroy the resources of the generic context */
-	rohc_decomp_rfc3095_destroy(rfc3095_ctxt, volat_ctxt);
+	rohc_decomp_rfc3095_destroy(rfc3095_ctxt);
 }
 
 
@@ -1888,7 +1890,7 @@ static void rtp_update_context(struct rohc_decomp_ctxt *const context,
  */
 static inline bool is_outer_ipv4_ctxt(const struct rohc_decomp_rfc3095_ctxt *const ctxt)
 {
-	return (ip_get_version(&ctxt->outer_ip_changes->ip) == IPV4);
+	return (ctxt->outer_ip_changes->ip.version == IPV4);
 }
 
 
@@ -1913,7 +1915,7 @@ static inline bool is_outer_ipv4_rnd_ctxt(const struct rohc_decomp_rfc3095_ctxt
 static inline bool is_inner_ipv4_ctxt(const struct rohc_decomp_rfc3095_ctxt *const ctxt)
 {
 	return (ctxt->multiple_ip &&
-	        ip_get_version(&ctxt->inner_ip_changes->ip) == IPV4);
+	        ctxt->inner_ip_changes->ip.version == IPV4);
 }
 
 
@@ -1937,6 +1939,8 @@ const struct rohc_decomp_profile d_rtp_profile =
 {
 	.id              = ROHC_PROFILE_RTP, /* profile ID (see 8 in RFC3095) */
 	.msn_max_bits    = 16,
+	.extr_bits_len   = sizeof(struct rohc_extr_bits),
+	.decoded_len     = sizeof(struct rohc_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_rtp_create,
 	.free_context    = (rohc_decomp_free_context_t) d_rtp_destroy,
 	.detect_pkt_type = rtp_detect_packet_type,
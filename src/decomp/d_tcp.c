@@ -68,9 +68,8 @@ static void d_tcp_create_from_ctxt(struct rohc_decomp_ctxt *const ctxt,
                                    const struct rohc_tcp_decoded_values *const decoded)
 	__attribute__((nonnull(1, 2)));
 
-static void d_tcp_destroy(struct d_tcp_context *const tcp_context,
-                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+static void d_tcp_destroy(struct d_tcp_context *const tcp_context)
+	__attribute__((nonnull(1)));
 
 static rohc_packet_t tcp_detect_packet_type(const struct rohc_decomp_ctxt *const context,
                                             const uint8_t *const rohc_packet,
@@ -340,8 +339,9 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
                                       const struct rohc_tcp_decoded_values *const decoded,
                                       const size_t payload_len,
                                       struct rohc_buf *const uncomp_hdrs,
-                                      size_t *const uncomp_hdrs_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8)));
+                                      size_t *const uncomp_hdrs_len,
+                                      struct rohc_decomp_csums *const csums)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8, 9)));
 static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp,
                                    const struct rohc_decomp_ctxt *const context,
                                    struct rohc_buf *const uncomp_hdrs,
@@ -447,10 +447,6 @@ static void d_tcp_create_from_ctxt(struct rohc_decomp_ctxt *const ctxt,
 
 	/* init some statistics */
 	ctxt->num_recv_packets = 0;
-	ctxt->total_uncompressed_size = 0;
-	ctxt->total_compressed_size = 0;
-	ctxt->header_uncompressed_size = 0;
-	ctxt->header_compressed_size = 0;
 	ctxt->corrected_crc_failures = 0;
 	ctxt->corrected_sn_wraparounds = 0;
 	ctxt->corrected_wrong_sn_updates = 0;
@@ -478,7 +474,8 @@ static bool d_tcp_create_from_pkt(const struct rohc_decomp_ctxt *const context,
 	struct d_tcp_context *tcp_context;
 
 	/* allocate memory for the context */
-	*persist_ctxt = calloc(1, sizeof(struct d_tcp_context));
+	*persist_ctxt = rohc_mem_zalloc(&context->decompressor->mem,
+	                                sizeof(struct d_tcp_context));
 	if((*persist_ctxt) == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -519,27 +516,9 @@ static bool d_tcp_create_from_pkt(const struct rohc_decomp_ctxt *const context,
 	/* volatile part of the decompression context */
 	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
 	volat_ctxt->crc.bits_nr = 0;
-	volat_ctxt->extr_bits = malloc(sizeof(struct rohc_tcp_extr_bits));
-	if(volat_ctxt->extr_bits == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the TCP decompression context");
-		goto destroy_context;
-	}
-	volat_ctxt->decoded_values = malloc(sizeof(struct rohc_tcp_decoded_values));
-	if(volat_ctxt->decoded_values == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the TCP decompression context");
-		goto free_extr_bits;
-	}
 
 	return true;
 
-free_extr_bits:
-	zfree(volat_ctxt->extr_bits);
-destroy_context:
-	zfree(tcp_context);
 quit:
 	return false;
 }
@@ -552,17 +531,11 @@ quit:
  * framework to work.
  *
  * @param tcp_context  The persistent decompression context for the TCP profile
- * @param volat_ctxt   The volatile decompression context
  */
-static void d_tcp_destroy(struct d_tcp_context *const tcp_context,
-                          const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+static void d_tcp_destroy(struct d_tcp_context *const tcp_context)
 {
 	/* free the TCP decompression context itself */
-	free(tcp_context);
-
-	/* free the volatile part of the decompression context */
-	free(volat_ctxt->decoded_values);
-	free(volat_ctxt->extr_bits);
+	rohc_mem_free(tcp_context);
 }
 
 
@@ -4156,6 +4129,7 @@ error:
  * @param[out] uncomp_hdrs      The uncompressed headers being built
  * @param[out] uncomp_hdrs_len  The length of the uncompressed headers written
  *                              into the buffer
+ * @param[out] csums            The checksums left to the caller
  * @return                      Possible values:
  *                               \li ROHC_STATUS_OK if headers are built
  *                                   successfully,
@@ -4171,15 +4145,23 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
                                       const struct rohc_tcp_decoded_values *const decoded,
                                       const size_t payload_len,
                                       struct rohc_buf *const uncomp_hdrs,
-                                      size_t *const uncomp_hdrs_len)
+                                      size_t *const uncomp_hdrs_len,
+                                      struct rohc_decomp_csums *const csums)
 {
+	/* the CRC covers the IPv4 checksums, so leave them to the caller only if
+	 * the packet carries no CRC on the uncompressed headers */
+	const bool csum_offload =
+		((decomp->features & ROHC_DECOMP_FEATURE_CSUM_OFFLOAD) != 0 &&
+		 extr_crc->type == ROHC_CRC_TYPE_NONE);
 	size_t ip_hdrs_len = 0;
 	size_t tcp_hdr_len = 0;
+	const uint8_t *uncomp_hdrs_data;
 	size_t ip_hdr_nr;
 
 	rohc_decomp_debug(context, "build IP/TCP headers");
 
 	*uncomp_hdrs_len = 0;
+	csums->nr = 0;
 
 	/* build IP headers */
 	if(!d_tcp_build_ip_hdrs(context, decoded, uncomp_hdrs, &ip_hdrs_len))
@@ -4199,6 +4181,7 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
 
 	/* unhide the IP/TCP headers */
 	rohc_buf_push(uncomp_hdrs, *uncomp_hdrs_len);
+	uncomp_hdrs_data = rohc_buf_data(*uncomp_hdrs);
 
 	/* compute payload lengths and checksums for all IP headers */
 	rohc_decomp_debug(context, "compute lengths and checksums for the %zu IP "
@@ -4219,10 +4202,23 @@ static rohc_status_t d_tcp_build_hdrs(const struct rohc_decomp *const decomp,
 			rohc_decomp_debug(context, "    IP total length = 0x%04x (%u)",
 			                  ipv4_tot_len, ipv4_tot_len);
 			ipv4->check = 0;
-			ipv4->check =
-				ip_fast_csum(rohc_buf_data(*uncomp_hdrs), ipv4->ihl);
-			rohc_decomp_debug(context, "    IP checksum = 0x%04x on %zu bytes",
-			                  rohc_ntoh16(ipv4->check), ipv4->ihl * sizeof(uint32_t));
+			if(csum_offload && csums->nr < ROHC_DECOMP_CSUM_MAX)
+			{
+				rohc_decomp_csum_t *const csum = &(csums->csums[csums->nr]);
+				csum->start = rohc_buf_data(*uncomp_hdrs) - uncomp_hdrs_data;
+				csum->offset = offsetof(struct ipv4_hdr, check);
+				csum->len = ipv4->ihl * sizeof(uint32_t);
+				csums->nr++;
+				rohc_decomp_debug(context, "    IP checksum left to the caller");
+			}
+			else
+			{
+				ipv4->check =
+					ip_fast_csum(rohc_buf_data(*uncomp_hdrs), ipv4->ihl);
+				rohc_decomp_debug(context, "    IP checksum = 0x%04x on %zu bytes",
+				                  rohc_ntoh16(ipv4->check),
+				                  ipv4->ihl * sizeof(uint32_t));
+			}
 			rohc_buf_pull(uncomp_hdrs, ipv4->ihl * sizeof(uint32_t));
 		}
 		else
@@ -4286,7 +4282,7 @@ error_output_too_small:
  * @param crc_packet   The CRC extracted from the ROHC header
  * @return             true if the CRC is correct, false otherwise
  */
-static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp,
+static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp __attribute__((unused)),
                                    const struct rohc_decomp_ctxt *const context,
                                    struct rohc_buf *const uncomp_hdrs,
                                    const rohc_crc_type_t crc_type,
@@ -4300,11 +4296,11 @@ static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp,
 	{
 		case ROHC_CRC_TYPE_3:
 			crc_computed = CRC_INIT_3;
-			crc_table = decomp->crc_table_3;
+			crc_table = rohc_crc_table_3;
 			break;
 		case ROHC_CRC_TYPE_7:
 			crc_computed = CRC_INIT_7;
-			crc_table = decomp->crc_table_7;
+			crc_table = rohc_crc_table_7;
 			break;
 		case ROHC_CRC_TYPE_8:
 			rohc_decomp_warn(context, "unexpected CRC type %d", crc_type);
@@ -4318,9 +4314,11 @@ static bool d_tcp_check_uncomp_crc(const struct rohc_decomp *const decomp,
 	}
 
 	/* compute the CRC from built uncompressed headers */
+	rohc_perf_start(crc_start);
 	crc_computed =
 		crc_calculate(crc_type, rohc_buf_data(*uncomp_hdrs), uncomp_hdrs->len,
 		              crc_computed, crc_table);
+	rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_CRC, crc_start);
 	rohc_decomp_debug(context, "CRC-%d on uncompressed header = 0x%x",
 	                  crc_type, crc_computed);
 
@@ -4615,6 +4613,8 @@ const struct rohc_decomp_profile d_tcp_profile =
 {
 	.id              = ROHC_PROFILE_TCP, /* profile ID (see 8 in RFC3095) */
 	.msn_max_bits    = 16,
+	.extr_bits_len   = sizeof(struct rohc_tcp_extr_bits),
+	.decoded_len     = sizeof(struct rohc_tcp_decoded_values),
 	.new_context     = (rohc_decomp_new_context_t) d_tcp_create_from_pkt,
 	.free_context    = (rohc_decomp_free_context_t) d_tcp_destroy,
 	.detect_pkt_type = tcp_detect_packet_type,
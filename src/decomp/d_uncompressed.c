@@ -63,9 +63,7 @@ static bool uncomp_new_context(const struct rohc_decomp_ctxt *const context,
                                struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-static void uncomp_free_context(void *const persist_ctxt,
-                                const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(2)));
+static void uncomp_free_context(void *const persist_ctxt);
 
 static rohc_packet_t uncomp_detect_pkt_type(const struct rohc_decomp_ctxt *const context,
                                             const uint8_t *const rohc_packet,
@@ -111,8 +109,9 @@ static rohc_status_t uncomp_build_hdrs(const struct rohc_decomp *const decomp,
                                        const struct rohc_uncomp_decoded *const decoded,
                                        const size_t payload_len,
                                        struct rohc_buf *const uncomp_hdrs,
-                                       size_t *const uncomp_hdrs_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8)));
+                                       size_t *const uncomp_hdrs_len,
+                                       struct rohc_decomp_csums *const csums)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8, 9)));
 
 static void uncomp_update_ctxt(struct rohc_decomp_ctxt *const context,
                                const struct rohc_uncomp_decoded *const decoded,
@@ -159,27 +158,8 @@ static bool uncomp_new_context(const struct rohc_decomp_ctxt *const context,
 	/* volatile part */
 	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
 	volat_ctxt->crc.bits_nr = 0;
-	volat_ctxt->extr_bits = malloc(sizeof(struct rohc_uncomp_extr_bits));
-	if(volat_ctxt->extr_bits == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of the Uncompressed decompression profile");
-		goto error;
-	}
-	volat_ctxt->decoded_values = malloc(sizeof(struct rohc_uncomp_decoded));
-	if(volat_ctxt->decoded_values == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of the Uncompressed decompression profile");
-		goto free_extr_bits;
-	}
 
 	return true;
-
-free_extr_bits:
-	free(volat_ctxt->extr_bits);
-error:
-	return false;
 }
 
 
@@ -191,14 +171,10 @@ error:
  * framework to work.
  *
  * @param persist_ctxt  The persistent part of the decompression context
- * @param volat_ctxt    The volatile part of the decompression context
  */
-static void uncomp_free_context(void *const persist_ctxt,
-                                const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+static void uncomp_free_context(void *const persist_ctxt __attribute__((unused)))
 {
 	assert(persist_ctxt == NULL);
-	free(volat_ctxt->extr_bits);
-	free(volat_ctxt->decoded_values);
 }
 
 
@@ -440,6 +416,8 @@ static bool uncomp_decode_bits(const struct rohc_decomp_ctxt *const context __at
  * @param[out] uncomp_hdrs      The uncompressed headers being built
  * @param[out] uncomp_hdrs_len  The length of the uncompressed headers written
  *                              into the buffer
+ * @param[out] csums            The checksums left to the caller, always none
+ *                              since the headers are not rebuilt
  * @return                      Possible values:
  *                               \li ROHC_STATUS_OK if headers are built
  *                                   successfully,
@@ -453,9 +431,11 @@ static rohc_status_t uncomp_build_hdrs(const struct rohc_decomp *const decomp __
                                        const struct rohc_uncomp_decoded *const decoded,
                                        const size_t payload_len __attribute__((unused)),
                                        struct rohc_buf *const uncomp_hdrs,
-                                       size_t *const uncomp_hdrs_len)
+                                       size_t *const uncomp_hdrs_len,
+                                       struct rohc_decomp_csums *const csums)
 {
 	(*uncomp_hdrs_len) = 0;
+	csums->nr = 0;
 
 	if(decoded->first_byte_used)
 	{
@@ -552,6 +532,8 @@ const struct rohc_decomp_profile d_uncomp_profile =
 {
 	.id              = ROHC_PROFILE_UNCOMPRESSED, /* profile ID (RFC3095 §8) */
 	.msn_max_bits    = 0, /* no MSN */
+	.extr_bits_len   = sizeof(struct rohc_uncomp_extr_bits),
+	.decoded_len     = sizeof(struct rohc_uncomp_decoded),
 	.new_context     = uncomp_new_context,
 	.free_context    = uncomp_free_context,
 	.detect_pkt_type = uncomp_detect_pkt_type,
@@ -125,6 +125,8 @@ struct rohc_decomp_stream
 static bool rohc_decomp_create_contexts(struct rohc_decomp *const decomp,
                                         const rohc_cid_t max_cid)
 	__attribute__((nonnull(1), warn_unused_result));
+static bool rohc_decomp_create_scratch(struct rohc_decomp *const decomp)
+	__attribute__((nonnull(1), warn_unused_result));
 
 static const struct rohc_decomp_profile *
 	find_profile(const struct rohc_decomp *const decomp,
@@ -141,12 +143,26 @@ static struct rohc_decomp_ctxt * find_context(const struct rohc_decomp *const de
 static void context_free(struct rohc_decomp_ctxt *const context)
 	__attribute__((nonnull(1)));
 
+static bool rohc_decomp_check_feedback_bufs(const struct rohc_decomp *const decomp,
+                                            const struct rohc_buf *const rcvd_feedback,
+                                            const struct rohc_buf *const feedback_send)
+	__attribute__((nonnull(1), warn_unused_result));
+
+static rohc_status_t d_decompress_pkt(struct rohc_decomp *const decomp,
+                                      const struct rohc_buf rohc_packet,
+                                      struct rohc_buf *const uncomp_packet,
+                                      const bool inplace,
+                                      struct rohc_buf *const rcvd_feedback,
+                                      struct rohc_buf *const feedback_send)
+	__attribute__((nonnull(1, 3), warn_unused_result));
+
 static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
                                      const struct rohc_buf rohc_packet,
                                      struct rohc_buf *const uncomp_packet,
+                                     const bool inplace,
                                      struct rohc_buf *const rcvd_feedback,
                                      struct rohc_decomp_stream *const stream)
-	__attribute__((nonnull(1, 3, 5), warn_unused_result));
+	__attribute__((nonnull(1, 3, 6), warn_unused_result));
 
 static bool rohc_decomp_decode_cid(struct rohc_decomp *decomp,
                                    const uint8_t *packet,
@@ -160,6 +176,10 @@ static void rohc_decomp_parse_padding(const struct rohc_decomp *const decomp,
                                       struct rohc_buf *const packet)
 	__attribute__((nonnull(1, 2)));
 
+static void rohc_decomp_prefetch_ctxt(const struct rohc_decomp *const decomp,
+                                      const struct rohc_buf packet)
+	__attribute__((nonnull(1)));
+
 static rohc_status_t rohc_decomp_find_context(struct rohc_decomp *const decomp,
                                               const uint8_t *const packet,
                                               const size_t packet_len,
@@ -177,9 +197,10 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
                                             const size_t add_cid_len,
                                             const size_t large_cid_len,
                                             struct rohc_buf *const uncomp_packet,
+                                            const bool inplace,
                                             rohc_packet_t *const packet_type,
                                             bool *const do_change_mode)
-	__attribute__((warn_unused_result, nonnull(1, 2, 6, 7, 8)));
+	__attribute__((warn_unused_result, nonnull(1, 2, 6, 8, 9)));
 
 static bool rohc_decomp_check_ir_crc(const struct rohc_decomp *const decomp,
                                      const struct rohc_decomp_ctxt *const context,
@@ -194,6 +215,13 @@ static void rohc_decomp_stats_add_success(struct rohc_decomp_ctxt *const context
                                           const size_t comp_hdr_len,
                                           const size_t uncomp_hdr_len)
 	__attribute__((nonnull(1)));
+static void rohc_decomp_stats_add_bytes(struct rohc_stats *const stats,
+                                        const struct rohc_decomp_ctxt *const context,
+                                        const size_t uncomp_len,
+                                        const size_t comp_len)
+	__attribute__((nonnull(1, 2)));
+static void rohc_decomp_stats_add_failure(struct rohc_stats *const stats)
+	__attribute__((nonnull(1)));
 
 static void rohc_decomp_update_context(struct rohc_decomp_ctxt *const context,
                                        const void *const decoded_values,
@@ -266,13 +294,14 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
                                                 const struct rohc_ts arrival_time)
 {
 	struct rohc_decomp_ctxt *context;
+	size_t i;
 
 	assert(decomp != NULL);
 	assert(cid <= ROHC_LARGE_CID_MAX);
 	assert(profile != NULL);
 
 	/* allocate memory for the decompression context */
-	context = (struct rohc_decomp_ctxt *) malloc(sizeof(struct rohc_decomp_ctxt));
+	context = rohc_mem_alloc(&decomp->mem, sizeof(struct rohc_decomp_ctxt));
 	if(context == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, profile->id,
@@ -293,6 +322,9 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	context->mode = ROHC_U_MODE;
 	context->state = ROHC_DECOMP_STATE_NC;
 
+	/* no checksum left to the caller until the first packet is decompressed */
+	context->volat_ctxt.csums.nr = 0;
+
 	/* counters and thresholds for feedbacks and downward state transitions */
 	context->last_pkts_errors = 0;
 	context->last_pkt_feedbacks[ROHC_FEEDBACK_ACK].needed = 0;
@@ -314,10 +346,7 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 
 	/* init some statistics */
 	context->num_recv_packets = 0;
-	context->total_uncompressed_size = 0;
-	context->total_compressed_size = 0;
-	context->header_uncompressed_size = 0;
-	context->header_compressed_size = 0;
+	rohc_stats_reset(&decomp->ctxt_stats[cid]);
 	context->total_last_uncompressed_size = 0;
 	context->total_last_compressed_size = 0;
 	context->header_last_uncompressed_size = 0;
@@ -332,6 +361,15 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	context->first_used = arrival_time.sec;
 	context->latest_used = arrival_time.sec;
 
+	/* the extracted bits and decoded values of the packets of the context are
+	 * stored in the scratch area of the profile */
+	for(i = 0; i < D_NUM_PROFILES && rohc_decomp_profiles[i] != profile; i++)
+	{
+	}
+	assert(i < D_NUM_PROFILES);
+	context->volat_ctxt.extr_bits = decomp->scratch[i].extr_bits;
+	context->volat_ctxt.decoded_values = decomp->scratch[i].decoded_values;
+
 	/* create the profile-specific parts of the decompression context (performed
 	 * at the every end so that everything is initialized in context first) */
 	if(!profile->new_context(context, &context->persist_ctxt, &context->volat_ctxt))
@@ -350,7 +388,7 @@ static struct rohc_decomp_ctxt * context_create(struct rohc_decomp *decomp,
 	return context;
 
 destroy_context:
-	zfree(context);
+	rohc_mem_free(context);
 error:
 	return NULL;
 }
@@ -371,14 +409,14 @@ static void context_free(struct rohc_decomp_ctxt *const context)
 	           "free context with CID %zu", context->cid);
 
 	/* destroy the profile-specific data */
-	context->profile->free_context(context->persist_ctxt, &context->volat_ctxt);
+	context->profile->free_context(context->persist_ctxt);
 
 	/* decompressor got one more context */
 	assert(context->decompressor->num_contexts_used > 0);
 	context->decompressor->num_contexts_used--;
 
 	/* destroy the context itself */
-	free(context);
+	rohc_mem_free(context);
 }
 
 
@@ -491,6 +529,10 @@ struct rohc_decomp * rohc_decomp_new2(const rohc_cid_type_t cid_type,
 	/* no trace callback during decompressor creation */
 	decomp->trace_callback = NULL;
 	decomp->trace_callback_priv = NULL;
+	decomp->trace_level = ROHC_TRACE_DEBUG;
+
+	/* default allocator for contexts */
+	rohc_mem_init(&decomp->mem);
 
 	/* default feature set (empty for the moment) */
 	decomp->features = ROHC_DECOMP_FEATURE_NONE;
@@ -536,21 +578,48 @@ struct rohc_decomp * rohc_decomp_new2(const rohc_cid_type_t cid_type,
 		decomp->last_pkt_feedbacks[ROHC_FEEDBACK_STATIC_NACK].sent = 0;
 	}
 
+	/* reserve the per-packet scratch areas of the profiles */
+	if(!rohc_decomp_create_scratch(decomp))
+	{
+		goto destroy_contexts;
+	}
+
+	/* reserve the statistics of the decompressor and of its contexts */
+	decomp->global_stats = rohc_stats_new(max_cid + 2, &decomp->stats_mem);
+	if(decomp->global_stats == NULL)
+	{
+		goto destroy_scratch;
+	}
+	decomp->ctxt_stats = decomp->global_stats + 1;
+
+#ifdef ROHC_PERF_COUNTERS
+	/* reserve the timing counters of the decompression stages */
+	decomp->perf = calloc(ROHC_DECOMP_PERF_STAGES_NR, sizeof(rohc_perf_counter_t));
+	if(decomp->perf == NULL)
+	{
+		goto destroy_stats;
+	}
+#endif
+
 	/* no Reconstructed Reception Unit (RRU) at the moment */
+	decomp->rru = NULL;
 	decomp->rru_len = 0;
 	/* no segmentation by default */
 	decomp->mrru = 0;
 
-	/* init the tables for fast CRC computation */
-	rohc_crc_init_table(decomp->crc_table_3, ROHC_CRC_TYPE_3);
-	rohc_crc_init_table(decomp->crc_table_7, ROHC_CRC_TYPE_7);
-	rohc_crc_init_table(decomp->crc_table_8, ROHC_CRC_TYPE_8);
-
 	/* reset the decompressor statistics */
 	rohc_decomp_reset_stats(decomp);
 
 	return decomp;
 
+#ifdef ROHC_PERF_COUNTERS
+destroy_stats:
+	zfree(decomp->stats_mem);
+#endif
+destroy_scratch:
+	zfree(decomp->scratch_mem);
+destroy_contexts:
+	zfree(decomp->contexts);
 destroy_decomp:
 	free(decomp);
 error:
@@ -606,6 +675,21 @@ void rohc_decomp_free(struct rohc_decomp *const decomp)
 	}
 	zfree(decomp->contexts);
 	assert(decomp->num_contexts_used == 0);
+	rohc_mem_release(&decomp->mem);
+
+	/* free the RRU buffer used for reassembly */
+	zfree(decomp->rru);
+
+	/* free the per-packet scratch areas */
+	zfree(decomp->scratch_mem);
+
+	/* free the statistics */
+	zfree(decomp->stats_mem);
+
+#ifdef ROHC_PERF_COUNTERS
+	/* free the timing counters */
+	zfree(decomp->perf);
+#endif
 
 	/* destroy the decompressor itself */
 	free(decomp);
@@ -688,44 +772,264 @@ rohc_status_t rohc_decompress3(struct rohc_decomp *const decomp,
                                struct rohc_buf *const rcvd_feedback,
                                struct rohc_buf *const feedback_send)
 {
-	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
-	struct rohc_decomp_stream stream;
-
 	/* check inputs validity */
 	if(decomp == NULL)
 	{
 		goto error;
 	}
-	if(rohc_buf_is_malformed(rohc_packet))
+	if(uncomp_packet == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is malformed");
+		             "given uncomp_packet is NULL");
 		goto error;
 	}
-	if(rohc_buf_is_empty(rohc_packet))
+	if(!rohc_decomp_check_feedback_bufs(decomp, rcvd_feedback, feedback_send))
+	{
+		goto error;
+	}
+
+	return d_decompress_pkt(decomp, rohc_packet, uncomp_packet, false,
+	                        rcvd_feedback, feedback_send);
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Decompress the given ROHC packet in place
+ *
+ * Decompress the given ROHC packet into an uncompressed packet that is stored
+ * in the same buffer: the uncompressed headers are written just before the
+ * payload of the ROHC packet, and the payload is never copied. On success,
+ * the buffer becomes a view on the uncompressed packet: its offset and length
+ * are updated, the ROHC header is lost.
+ *
+ * The uncompressed headers are built in the headroom of the buffer (the
+ * \e offset bytes before the ROHC packet) before they are moved in front of
+ * the payload, so the headroom shall be large enough for the uncompressed
+ * headers. \ref ROHC_STATUS_OUTPUT_TOO_SMALL is returned otherwise, and
+ * \ref ROHC_STATUS_ERROR if the buffer has no headroom at all.
+ *
+ * The uncompressed packet is empty if the ROHC packet contained only
+ * feedback data or if the ROHC packet was not a final segment. The final
+ * segment of a ROHC packet cannot be decompressed in place since the payload
+ * is located in the reassembly buffer of the decompressor: use
+ * \ref rohc_decompress3 on channels where the MRRU is not 0.
+ *
+ * See \ref rohc_decompress3 for the feedback buffers.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param[in,out] pkt         IN:  The compressed packet to decompress, with
+ *                                 some headroom
+ *                            OUT: The resulting uncompressed packet, empty
+ *                                 in case of error
+ * @param[out] rcvd_feedback  The feedback received from the remote peer for
+ *                            the same-side associated ROHC compressor, may
+ *                            be NULL
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, may be NULL
+ * @return                    The same values as \ref rohc_decompress3
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ */
+rohc_status_t rohc_decompress_inplace(struct rohc_decomp *const decomp,
+                                      struct rohc_buf *const pkt,
+                                      struct rohc_buf *const rcvd_feedback,
+                                      struct rohc_buf *const feedback_send)
+{
+	struct rohc_buf uncomp_packet;
+	rohc_status_t status;
+
+	/* check inputs validity */
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(pkt == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given rohc_packet is empty");
+		             "given packet is NULL");
 		goto error;
 	}
-	if(uncomp_packet == NULL)
+	if(!rohc_decomp_check_feedback_bufs(decomp, rcvd_feedback, feedback_send))
+	{
+		goto error;
+	}
+
+	/* build the uncompressed headers in the headroom */
+	uncomp_packet.time = pkt->time;
+	uncomp_packet.data = pkt->data;
+	uncomp_packet.max_len = pkt->offset;
+	uncomp_packet.offset = 0;
+	uncomp_packet.len = 0;
+
+	status = d_decompress_pkt(decomp, *pkt, &uncomp_packet, true,
+	                          rcvd_feedback, feedback_send);
+
+	/* the buffer is now a view on the uncompressed packet */
+	pkt->offset = uncomp_packet.offset;
+	pkt->len = uncomp_packet.len;
+
+	return status;
+
+error:
+	return ROHC_STATUS_ERROR;
+}
+
+
+/**
+ * @brief Decompress a burst of ROHC packets into uncompressed packets
+ *
+ * Decompress the given ROHC packets one after the other, in the order of the
+ * array. Every packet is decompressed as \ref rohc_decompress3 would do it:
+ * packet \e i is decompressed from \e rohc_packets[i] into
+ * \e uncomp_packets[i], and the status returned by \ref rohc_decompress3
+ * for that packet is stored in \e statuses[i]. The failure of one packet
+ * does not stop the burst.
+ *
+ * The feedback is collected for the whole burst instead of per packet:
+ *  \li the feedback received for the same-side associated compressor by all
+ *      the packets of the burst is appended to \e rcvd_feedback,
+ *  \li the feedback generated by the decompression of all the packets of
+ *      the burst is appended to \e feedback_send, so that it may be
+ *      piggybacked at once on the next ROHC packet sent to the remote
+ *      compressor.
+ * Every feedback item is complete: the feedback that does not fit in the
+ * remaining space of the buffer is dropped, as \ref rohc_decompress3 does
+ * with a too small buffer.
+ *
+ * The decompressor, the arrays and the feedback buffers are checked once for
+ * the whole burst. The decompression context of the next packet is
+ * prefetched while the current packet is decompressed.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param rohc_packets        The compressed packets to decompress
+ * @param[out] uncomp_packets The resulting uncompressed packets, every buffer
+ *                            shall be empty
+ * @param[out] statuses       The decompression status of every packet, see
+ *                            \ref rohc_decompress3 for the possible values
+ * @param pkts_nr             The number of packets in the burst
+ * @param[out] rcvd_feedback  The feedback received from the remote peer for
+ *                            the same-side associated ROHC compressor through
+ *                            the feedback channel:
+ *                            \li If NULL, ignore the received feedback data
+ *                            \li If not NULL, store the received feedback of
+ *                                all the packets at the given address
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor through the feedback channel:
+ *                            \li If NULL, the decompression won't generate
+ *                                feedback information for its compressor
+ *                            \li If not NULL, may store the feedback
+ *                                generated for all the packets at the given
+ *                                address
+ * @return                    The number of packets processed (with or
+ *                            without success), that is \e pkts_nr, or 0 if
+ *                            the parameters are invalid
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decompress3
+ */
+size_t rohc_decompress_burst(struct rohc_decomp *const decomp,
+                             const struct rohc_buf *const rohc_packets,
+                             struct rohc_buf *const uncomp_packets,
+                             rohc_status_t *const statuses,
+                             const size_t pkts_nr,
+                             struct rohc_buf *const rcvd_feedback,
+                             struct rohc_buf *const feedback_send)
+{
+	size_t i;
+
+	/* check inputs validity */
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(rohc_packets == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is NULL");
+		             "given rohc_packets is NULL");
 		goto error;
 	}
-	if(rohc_buf_is_malformed(*uncomp_packet))
+	if(uncomp_packets == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is malformed");
+		             "given uncomp_packets is NULL");
 		goto error;
 	}
-	if(!rohc_buf_is_empty(*uncomp_packet))
+	if(statuses == NULL)
 	{
 		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
-		             "given uncomp_packet is not empty");
+		             "given statuses is NULL");
+		goto error;
+	}
+	if(!rohc_decomp_check_feedback_bufs(decomp, rcvd_feedback, feedback_send))
+	{
 		goto error;
 	}
+
+	for(i = 0; i < pkts_nr; i++)
+	{
+		size_t rcvd_feedback_len = 0;
+		size_t feedback_send_len = 0;
+
+		/* fetch the context of the next packet while the current one is
+		 * decompressed */
+		if((i + 1) < pkts_nr)
+		{
+			rohc_decomp_prefetch_ctxt(decomp, rohc_packets[i + 1]);
+		}
+
+		/* hide the feedback collected for the previous packets, so that the
+		 * feedback of the current packet is appended to it */
+		if(rcvd_feedback != NULL)
+		{
+			rcvd_feedback_len = rcvd_feedback->len;
+			rohc_buf_pull(rcvd_feedback, rcvd_feedback_len);
+		}
+		if(feedback_send != NULL)
+		{
+			feedback_send_len = feedback_send->len;
+			rohc_buf_pull(feedback_send, feedback_send_len);
+		}
+
+		statuses[i] = d_decompress_pkt(decomp, rohc_packets[i],
+		                               &(uncomp_packets[i]), false,
+		                               rcvd_feedback, feedback_send);
+
+		/* unhide all feedback */
+		if(rcvd_feedback != NULL)
+		{
+			rohc_buf_push(rcvd_feedback, rcvd_feedback_len);
+		}
+		if(feedback_send != NULL)
+		{
+			rohc_buf_push(feedback_send, feedback_send_len);
+		}
+	}
+
+	return i;
+
+error:
+	return 0;
+}
+
+
+/**
+ * @brief Check the feedback buffers given to the decompression functions
+ *
+ * @param decomp         The ROHC decompressor
+ * @param rcvd_feedback  The buffer for the received feedback, may be NULL
+ * @param feedback_send  The buffer for the feedback to send, may be NULL
+ * @return               true if the buffers are valid, false if not
+ */
+static bool rohc_decomp_check_feedback_bufs(const struct rohc_decomp *const decomp,
+                                            const struct rohc_buf *const rcvd_feedback,
+                                            const struct rohc_buf *const feedback_send)
+{
 	if(rcvd_feedback != NULL)
 	{
 		if(rohc_buf_is_malformed(*rcvd_feedback))
@@ -757,6 +1061,68 @@ rohc_status_t rohc_decompress3(struct rohc_decomp *const decomp,
 		}
 	}
 
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Decompress one ROHC packet into one uncompressed packet
+ *
+ * See \ref rohc_decompress3 for details. The decompressor, the output buffer
+ * pointer and the feedback buffers are checked by the callers.
+ *
+ * @param decomp              The ROHC decompressor
+ * @param rohc_packet         The compressed packet to decompress
+ * @param[out] uncomp_packet  The resulting uncompressed packet
+ * @param inplace             Whether the uncompressed headers shall be moved
+ *                            in front of the payload of the ROHC packet
+ *                            instead of copying the payload, see
+ *                            \ref rohc_decompress_inplace
+ * @param[out] rcvd_feedback  The feedback received from the remote peer,
+ *                            may be NULL
+ * @param[out] feedback_send  The feedback to be transmitted to the remote
+ *                            compressor, may be NULL
+ * @return                    The same values as \ref rohc_decompress3
+ */
+static rohc_status_t d_decompress_pkt(struct rohc_decomp *const decomp,
+                                      const struct rohc_buf rohc_packet,
+                                      struct rohc_buf *const uncomp_packet,
+                                      const bool inplace,
+                                      struct rohc_buf *const rcvd_feedback,
+                                      struct rohc_buf *const feedback_send)
+{
+	rohc_status_t status = ROHC_STATUS_ERROR; /* error status by default */
+	struct rohc_decomp_stream stream;
+
+	/* check inputs validity */
+	if(rohc_buf_is_malformed(rohc_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is malformed");
+		goto error;
+	}
+	if(rohc_buf_is_empty(rohc_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given rohc_packet is empty");
+		goto error;
+	}
+	if(rohc_buf_is_malformed(*uncomp_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is malformed");
+		goto error;
+	}
+	if(!rohc_buf_is_empty(*uncomp_packet))
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "given uncomp_packet is not empty");
+		goto error;
+	}
+
 	decomp->stats.received++;
 	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 	           "decompress the %zu-byte packet #%lu", rohc_packet.len,
@@ -771,8 +1137,8 @@ rohc_status_t rohc_decompress3(struct rohc_decomp *const decomp,
 	}
 
 	/* decode ROHC header */
-	status = d_decode_header(decomp, rohc_packet, uncomp_packet, rcvd_feedback,
-	                         &stream);
+	status = d_decode_header(decomp, rohc_packet, uncomp_packet, inplace,
+	                         rcvd_feedback, &stream);
 	assert(status != ROHC_STATUS_SEGMENT);
 
 	/* handle mode transitions if context was found and it is still valid */
@@ -849,11 +1215,12 @@ rohc_status_t rohc_decompress3(struct rohc_decomp *const decomp,
 			stream.context->num_recv_packets++;
 			stream.context->packet_type = stream.packet_type;
 			stream.context->total_last_uncompressed_size = uncomp_packet->len;
-			stream.context->total_uncompressed_size += uncomp_packet->len;
 			stream.context->total_last_compressed_size = rohc_packet.len;
-			stream.context->total_compressed_size += rohc_packet.len;
-			decomp->stats.total_uncompressed_size += uncomp_packet->len;
-			decomp->stats.total_compressed_size += rohc_packet.len;
+			rohc_decomp_stats_add_bytes(decomp->global_stats, stream.context,
+			                            uncomp_packet->len, rohc_packet.len);
+			rohc_decomp_stats_add_bytes(&decomp->ctxt_stats[stream.context->cid],
+			                            stream.context, uncomp_packet->len,
+			                            rohc_packet.len);
 
 			/* build positive feedback if asked by user and if needed by decompressor */
 			if(!rohc_decomp_feedback_ack(decomp, &stream, feedback_send))
@@ -878,7 +1245,9 @@ rohc_status_t rohc_decompress3(struct rohc_decomp *const decomp,
 		if(stream.context != NULL)
 		{
 			stream.context->num_recv_packets++;
+			rohc_decomp_stats_add_failure(&decomp->ctxt_stats[stream.context->cid]);
 		}
+		rohc_decomp_stats_add_failure(decomp->global_stats);
 		switch(status)
 		{
 			case ROHC_STATUS_MALFORMED:
@@ -921,6 +1290,7 @@ error:
  * @param decomp              The ROHC decompressor
  * @param rohc_packet         The ROHC packet to decode
  * @param[out] uncomp_packet  The uncompressed packet
+ * @param inplace             Whether the payload shall be kept in place
  * @param[out] rcvd_feedback  The feedback received from the remote peer for
  *                            the same-side associated ROHC compressor through
  *                            the feedback channel:
@@ -943,6 +1313,7 @@ error:
 static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
                                      const struct rohc_buf rohc_packet,
                                      struct rohc_buf *const uncomp_packet,
+                                     const bool inplace,
                                      struct rohc_buf *const rcvd_feedback,
                                      struct rohc_decomp_stream *const stream)
 {
@@ -1035,6 +1406,15 @@ static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
 		           "ROHC packet is a %zu-byte %s segment", remain_len,
 		           is_final ? "final" : "non-final");
 
+		/* no RRU buffer without segmentation */
+		if(decomp->mrru == 0)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "unexpected ROHC segment: segmentation is disabled "
+			             "(MRRU = 0)");
+			goto error_malformed;
+		}
+
 		/* store all the remaining ROHC data in RRU */
 		if((decomp->rru_len + remain_len) > decomp->mrru)
 		{
@@ -1233,7 +1613,8 @@ static rohc_status_t d_decode_header(struct rohc_decomp *decomp,
 	 * (may change the initial assumption about the packet type) */
 	status = rohc_decomp_decode_pkt(decomp, stream->context, remain_rohc_data,
 	                                add_cid_len, large_cid_len, uncomp_packet,
-	                                &stream->packet_type, &stream->do_change_mode);
+	                                inplace, &stream->packet_type,
+	                                &stream->do_change_mode);
 	if(status != ROHC_STATUS_OK)
 	{
 		/* decompression failed, free ressources if necessary */
@@ -1299,7 +1680,8 @@ error_no_context:
  *  \li C. Decode extracted bits
  *  \li D. Build uncompressed headers (and check for correct decompression
  *         for UO* packets)
- *  \li E. Copy the payload (if any)
+ *  \li E. Copy the payload (if any), or move the uncompressed headers in
+ *         front of it if decompressing in place
  *  \li F. Update the compression context
  *
  * Steps C and D may be repeated if packet or context repair is attempted
@@ -1311,6 +1693,7 @@ error_no_context:
  * @param add_cid_len          The length of the optional Add-CID field
  * @param large_cid_len        The length of the optional large CID field
  * @param[out] uncomp_packet   The uncompressed packet
+ * @param inplace              Whether the payload shall be kept in place
  * @param[in,out] packet_type  IN:  The type of the ROHC packet to parse
  *                             OUT: The type of the parsed ROHC packet
  * @param[out] do_change_mode  Whether the profile context wants to change
@@ -1326,6 +1709,7 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
                                             const size_t add_cid_len,
                                             const size_t large_cid_len,
                                             struct rohc_buf *const uncomp_packet,
+                                            const bool inplace,
                                             rohc_packet_t *const packet_type,
                                             bool *const do_change_mode)
 {
@@ -1360,9 +1744,11 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
 	                  rohc_get_packet_descr(*packet_type), *packet_type);
 
 	/* let's parse the packet! */
+	rohc_perf_start(parse_start);
 	parsing_ok = profile->parse_pkt(context, rohc_packet, large_cid_len,
 	                                packet_type, extr_crc_bits, extr_bits,
 	                                &rohc_hdr_len);
+	rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_PARSE, parse_start);
 	if(!parsing_ok)
 	{
 		rohc_decomp_warn(context, "failed to parse the %s header",
@@ -1432,8 +1818,10 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
 		 * All bits are now extracted from the packet, let's decode them.
 		 */
 
+		rohc_perf_start(decode_start);
 		decode_ok = profile->decode_bits(context, extr_bits, payload_len,
 		                                 decoded_values);
+		rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_DECODE, decode_start);
 		if(!decode_ok)
 		{
 			rohc_decomp_warn(context, "failed to decode values from bits "
@@ -1451,9 +1839,12 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
 		 */
 
 		/* build the uncompressed headers */
+		rohc_perf_start(build_start);
 		build_ret = profile->build_hdrs(decomp, context, *packet_type, extr_crc_bits,
 		                                decoded_values, payload_len,
-		                                uncomp_packet, &uncomp_hdr_len);
+		                                uncomp_packet, &uncomp_hdr_len,
+		                                &context->volat_ctxt.csums);
+		rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_BUILD, build_start);
 		if(build_ret == ROHC_STATUS_OK)
 		{
 			/* uncompressed headers successfully built and CRC is correct,
@@ -1509,9 +1900,11 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
 			                 "headers (CRC failure)", context->cid);
 
 			/* attempt a context/packet repair */
+			rohc_perf_start(repair_start);
 			try_decoding_again =
 				profile->attempt_repair(decomp, context, rohc_packet.time,
 				                        &context->crc_corr, extr_bits);
+			rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_REPAIR, repair_start);
 
 			if((*packet_type) == ROHC_PACKET_IR_CR)
 			{
@@ -1597,22 +1990,48 @@ static rohc_status_t rohc_decomp_decode_pkt(struct rohc_decomp *const decomp,
 		                 rohc_hdr_len, payload_len, rohc_packet.len);
 		goto error;
 	}
-	if(rohc_buf_avail_len(*uncomp_packet) < payload_len)
+	if(inplace)
+	{
+		/* the uncompressed headers were built in the headroom of the ROHC
+		 * packet, move them just before the payload and return a view on
+		 * the packet, the payload is never copied */
+		size_t uncomp_offset;
+
+		/* the payload of the final segment is located in the RRU */
+		if(rohc_packet.data != uncomp_packet->data)
+		{
+			rohc_decomp_warn(context, "ROHC segments cannot be decompressed in "
+			                 "place");
+			goto error;
+		}
+		uncomp_offset = (payload_data - uncomp_packet->data) - uncomp_hdr_len;
+		memmove(uncomp_packet->data + uncomp_offset,
+		        rohc_buf_data(*uncomp_packet) - uncomp_hdr_len, uncomp_hdr_len);
+		uncomp_packet->max_len = uncomp_offset + uncomp_hdr_len + payload_len;
+		uncomp_packet->offset = uncomp_offset;
+		uncomp_packet->len = uncomp_hdr_len + payload_len;
+		rohc_decomp_debug(context, "uncompressed packet length = %zu bytes, "
+		                  "payload kept in place", uncomp_packet->len);
+	}
+	else if(rohc_buf_avail_len(*uncomp_packet) < payload_len)
 	{
 		rohc_decomp_warn(context, "uncompressed packet too small (%zu bytes "
 		                 "max) for the %zu-byte payload",
 		                 rohc_buf_avail_len(*uncomp_packet), payload_len);
 		goto error_output_too_small;
 	}
-	if(payload_len != 0)
+	else
 	{
-		rohc_buf_append(uncomp_packet, payload_data, payload_len);
-		rohc_buf_pull(uncomp_packet, payload_len);
+		if(payload_len != 0)
+		{
+			rohc_buf_append(uncomp_packet, payload_data, payload_len);
+			rohc_buf_pull(uncomp_packet, payload_len);
+		}
+		/* unhide the uncompressed headers and payload */
+		rohc_buf_push(uncomp_packet, uncomp_hdr_len + payload_len);
+		rohc_decomp_debug(context, "uncompressed packet length = %zu bytes",
+		                  uncomp_packet->len);
 	}
-	/* unhide the uncompressed headers and payload */
-	rohc_buf_push(uncomp_packet, uncomp_hdr_len + payload_len);
-	rohc_decomp_debug(context, "uncompressed packet length = %zu bytes",
-	                  uncomp_packet->len);
 
 
 	/* F. Update the compression context
@@ -1685,7 +2104,9 @@ static bool rohc_decomp_check_ir_crc(const struct rohc_decomp *const decomp,
 	assert(rohc_hdr != NULL);
 	assert(rohc_hdr_len >= (add_cid_len + 2 + large_cid_len + 1));
 
-	crc_table = decomp->crc_table_8;
+	crc_table = rohc_crc_table_8;
+
+	rohc_perf_start(crc_start);
 
 	/* ROHC header before CRC field:
 	 * optional Add-CID + IR type + Profile ID + optional large CID */
@@ -1707,6 +2128,8 @@ static bool rohc_decomp_check_ir_crc(const struct rohc_decomp *const decomp,
 		                         crc_comp, crc_table);
 	}
 
+	rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_CRC, crc_start);
+
 	rohc_decomp_debug(context, "CRC-%d on compressed %zu-byte ROHC header = "
 	                  "0x%x", crc_type, rohc_hdr_len, crc_comp);
 
@@ -1933,7 +2356,7 @@ static bool rohc_decomp_feedback_ack(struct rohc_decomp *const decomp,
 
 		/* build the feedback packet */
 		feedbackp = f_wrap_feedback(&sfeedback, infos->cid, infos->cid_type,
-		                            crc_present, decomp->crc_table_8, &feedbacksize);
+		                            crc_present, rohc_crc_table_8, &feedbacksize);
 		if(feedbackp == NULL)
 		{
 			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
@@ -2265,7 +2688,7 @@ static bool rohc_decomp_feedback_nack(struct rohc_decomp *const decomp,
 
 		/* build the feedback packet */
 		feedbackp = f_wrap_feedback(&sfeedback, infos->cid, infos->cid_type,
-		                            crc_present, decomp->crc_table_8, &feedbacksize);
+		                            crc_present, rohc_crc_table_8, &feedbacksize);
 		if(feedbackp == NULL)
 		{
 			rohc_warning(decomp, ROHC_TRACE_DECOMP, infos->profile_id,
@@ -2361,9 +2784,46 @@ static void rohc_decomp_stats_add_success(struct rohc_decomp_ctxt *const context
                                           const size_t uncomp_hdr_len)
 {
 	context->header_last_compressed_size = comp_hdr_len;
-	context->header_compressed_size += comp_hdr_len;
 	context->header_last_uncompressed_size = uncomp_hdr_len;
-	context->header_uncompressed_size += uncomp_hdr_len;
+}
+
+
+/**
+ * @brief Add one successfully decompressed packet to the given statistics
+ *
+ * The header sizes are the ones of the last packet of the context, recorded
+ * by \ref rohc_decomp_stats_add_success.
+ *
+ * @param stats       The statistics block to update
+ * @param context     The decompression context of the packet
+ * @param uncomp_len  The length (in bytes) of the uncompressed packet
+ * @param comp_len    The length (in bytes) of the ROHC packet
+ */
+static void rohc_decomp_stats_add_bytes(struct rohc_stats *const stats,
+                                        const struct rohc_decomp_ctxt *const context,
+                                        const size_t uncomp_len,
+                                        const size_t comp_len)
+{
+	rohc_stats_write_begin(stats);
+	stats->packets_nr++;
+	stats->uncomp_bytes_nr += uncomp_len;
+	stats->comp_bytes_nr += comp_len;
+	stats->uncomp_hdr_bytes_nr += context->header_last_uncompressed_size;
+	stats->comp_hdr_bytes_nr += context->header_last_compressed_size;
+	rohc_stats_write_end(stats);
+}
+
+
+/**
+ * @brief Add one packet that failed to be decompressed to the given statistics
+ *
+ * @param stats  The statistics block to update
+ */
+static void rohc_decomp_stats_add_failure(struct rohc_stats *const stats)
+{
+	rohc_stats_write_begin(stats);
+	stats->failures_nr++;
+	rohc_stats_write_end(stats);
 }
 
 
@@ -2379,8 +2839,6 @@ static void rohc_decomp_reset_stats(struct rohc_decomp *const decomp)
 	decomp->stats.failed_crc = 0;
 	decomp->stats.failed_no_context = 0;
 	decomp->stats.failed_decomp = 0;
-	decomp->stats.total_uncompressed_size = 0;
-	decomp->stats.total_compressed_size = 0;
 	decomp->stats.corrected_crc_failures = 0;
 	decomp->stats.corrected_sn_wraparounds = 0;
 	decomp->stats.corrected_wrong_sn_updates = 0;
@@ -2484,7 +2942,8 @@ bool rohc_decomp_get_last_packet_info(const struct rohc_decomp *const decomp,
 
 	if(info->version_minor != 0 &&
 	   info->version_minor != 1 &&
-	   info->version_minor != 2)
+	   info->version_minor != 2 &&
+	   info->version_minor != 3)
 	{
 		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
 		           "unsupported minor version (%u) of the structure for "
@@ -2517,6 +2976,20 @@ bool rohc_decomp_get_last_packet_info(const struct rohc_decomp *const decomp,
 			decomp->last_context->header_last_uncompressed_size;
 	}
 
+	/* new fields in 0.3 */
+	if(info->version_minor >= 3)
+	{
+		const struct rohc_decomp_csums *const csums =
+			&decomp->last_context->volat_ctxt.csums;
+		size_t i;
+
+		info->csums_nr = csums->nr;
+		for(i = 0; i < csums->nr; i++)
+		{
+			info->csums[i] = csums->csums[i];
+		}
+	}
+
 	return true;
 
 error:
@@ -2587,8 +3060,8 @@ bool rohc_decomp_get_context_info(const struct rohc_decomp *const decomp,
 		else
 		{
 			info->packets_nr = decomp->contexts[cid]->num_recv_packets;
-			info->comp_bytes_nr = decomp->contexts[cid]->total_compressed_size;
-			info->uncomp_bytes_nr = decomp->contexts[cid]->total_uncompressed_size;
+			info->comp_bytes_nr = decomp->ctxt_stats[cid].comp_bytes_nr;
+			info->uncomp_bytes_nr = decomp->ctxt_stats[cid].uncomp_bytes_nr;
 			info->corrected_crc_failures =
 				decomp->contexts[cid]->corrected_crc_failures;
 			info->corrected_sn_wraparounds =
@@ -2663,8 +3136,8 @@ bool rohc_decomp_get_general_info(const struct rohc_decomp *const decomp,
 		/* base fields for major version 0 */
 		info->contexts_nr = decomp->num_contexts_used;
 		info->packets_nr = decomp->stats.received;
-		info->comp_bytes_nr = decomp->stats.total_compressed_size;
-		info->uncomp_bytes_nr = decomp->stats.total_uncompressed_size;
+		info->comp_bytes_nr = decomp->global_stats->comp_bytes_nr;
+		info->uncomp_bytes_nr = decomp->global_stats->uncomp_bytes_nr;
 
 		/* new fields added by minor versions */
 		switch(info->version_minor)
@@ -2702,6 +3175,182 @@ error:
 }
 
 
+/**
+ * @brief Get the timing counters of the decompressor stages
+ *
+ * Get the time spent in every stage of the decompression and the number of
+ * times every stage was run since the decompressor was created. See
+ * \ref rohc_decomp_perf_stage_t for the list of stages.
+ *
+ * The counters are available only if the library was built with the option
+ * --enable-rohc-perf-counters of the configure script, so that they cost
+ * nothing otherwise. The function fails if they are not available.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_decomp_perf_counters_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *
+ * @param decomp            The ROHC decompressor to get counters from
+ * @param[in,out] counters  The structure where counters will be stored
+ * @return                  true in case of success, false if the counters
+ *                          are not available or in case of error
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_perf_counters_t
+ */
+bool rohc_decomp_get_perf_counters(const struct rohc_decomp *const decomp,
+                                   rohc_decomp_perf_counters_t *const counters)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	if(counters == NULL)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "structure for timing counters is not valid");
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(counters->version_major == 0)
+	{
+		if(counters->version_minor > 0)
+		{
+			rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			           "unsupported minor version (%u) of the structure for "
+			           "timing counters", counters->version_minor);
+			goto error;
+		}
+	}
+	else
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		           "unsupported major version (%u) of the structure for "
+		           "timing counters", counters->version_major);
+		goto error;
+	}
+
+#ifdef ROHC_PERF_COUNTERS
+	memcpy(counters->stages, decomp->perf, sizeof(counters->stages));
+	return true;
+#else
+	rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	             "timing counters are not available, rebuild the library "
+	             "with --enable-rohc-perf-counters");
+#endif
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get a snapshot of the statistics of the decompressor
+ *
+ * Get a consistent snapshot of the statistics of the decompressor. Unlike
+ * the other information functions, this one may be called from any thread,
+ * even while packets are being decompressed: it never blocks the
+ * decompression, and it never emits traces. The decompressor shall not be
+ * destroyed meanwhile.
+ *
+ * To use the function, call it with a pointer on a pre-allocated
+ * \ref rohc_stats_t structure with the \e version_major and
+ * \e version_minor fields set to one of the following supported versions:
+ *  - Major 0, minor 0
+ *
+ * @param decomp         The ROHC decompressor to get statistics from
+ * @param[in,out] stats  The structure where statistics will be stored
+ * @return               true in case of success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_stats_t
+ * @see rohc_decomp_get_ctxt_stats
+ */
+bool rohc_decomp_get_stats(const struct rohc_decomp *const decomp,
+                           rohc_stats_t *const stats)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(stats == NULL)
+	{
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(stats->version_major != 0 || stats->version_minor != 0)
+	{
+		goto error;
+	}
+
+	rohc_stats_read(decomp->global_stats, stats);
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Get a snapshot of the statistics of one decompression context
+ *
+ * Get a consistent snapshot of the statistics of the context identified by
+ * the given CID. The statistics are reset when a new context is created for
+ * the CID, they are kept when the context is destroyed: they are the ones of
+ * the context that uses the CID, or of the last context that used it.
+ *
+ * The function may be called from any thread like
+ * \ref rohc_decomp_get_stats.
+ *
+ * @param decomp         The ROHC decompressor to get statistics from
+ * @param cid            The CID of the context to get statistics for
+ * @param[in,out] stats  The structure where statistics will be stored
+ * @return               true in case of success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_stats_t
+ * @see rohc_decomp_get_stats
+ */
+bool rohc_decomp_get_ctxt_stats(const struct rohc_decomp *const decomp,
+                                const rohc_cid_t cid,
+                                rohc_stats_t *const stats)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+	if(cid > decomp->medium.max_cid)
+	{
+		goto error;
+	}
+	if(stats == NULL)
+	{
+		goto error;
+	}
+
+	/* check compatibility version */
+	if(stats->version_major != 0 || stats->version_minor != 0)
+	{
+		goto error;
+	}
+
+	rohc_stats_read(&decomp->ctxt_stats[cid], stats);
+
+	return true;
+
+error:
+	return false;
+}
+
+
 /**
  * @brief Get the CID type that the decompressor uses
  *
@@ -2781,6 +3430,9 @@ error:
  * upon decompression until the last segment is received (or a non-segment is
  * received). Decompressed data will be returned at that time.
  *
+ * The decompressor allocates a MRRU-byte buffer to reassemble the ROHC
+ * segments, there is no such buffer while segmentation is disabled.
+ *
  * @warning Changing the MRRU value while library is used may lead to
  *          destruction of the current RRU.
  *
@@ -2829,6 +3481,32 @@ bool rohc_decomp_set_mrru(struct rohc_decomp *const decomp,
 		goto error;
 	}
 
+	/* resize the RRU buffer to the new MRRU */
+	if(mrru != decomp->mrru)
+	{
+		uint8_t *rru = NULL;
+
+		if(mrru > 0)
+		{
+			rru = malloc(mrru);
+			if(rru == NULL)
+			{
+				rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+				             "failed to allocate memory for the %zu-byte RRU", mrru);
+				goto error;
+			}
+		}
+		if(decomp->rru_len != 0)
+		{
+			rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+			             "drop the %zu bytes of the partially reassembled RRU",
+			             decomp->rru_len);
+		}
+		free(decomp->rru);
+		decomp->rru = rru;
+		decomp->rru_len = 0;
+	}
+
 	/* set new MRRU */
 	decomp->mrru = mrru;
 	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
@@ -3230,7 +3908,8 @@ bool rohc_decomp_set_features(struct rohc_decomp *const decomp,
 {
 	const rohc_decomp_features_t all_features =
 		ROHC_DECOMP_FEATURE_CRC_REPAIR |
-		ROHC_DECOMP_FEATURE_DUMP_PACKETS;
+		ROHC_DECOMP_FEATURE_DUMP_PACKETS |
+		ROHC_DECOMP_FEATURE_CSUM_OFFLOAD;
 
 	/* decompressor must be valid */
 	if(decomp == NULL)
@@ -3625,6 +4304,120 @@ error:
 }
 
 
+/**
+ * @brief Set the lowest level of the traces printed by the decompressor
+ *
+ * The traces with a lower level are not given to the trace callback. They
+ * are filtered before their arguments are evaluated and before they are
+ * formatted, so filtering them in the library is cheaper than filtering them
+ * in the trace callback. All traces are printed by default.
+ *
+ * The debug and info traces may also be removed from the library at build
+ * time with the --disable-rohc-traces option of the configure script.
+ *
+ * @warning The level can not be modified after library initialization
+ *
+ * @param decomp  The ROHC decompressor
+ * @param level   The lowest level of the traces to print
+ * @return        true on success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_set_traces_cb2
+ */
+bool rohc_decomp_set_traces_level(struct rohc_decomp *const decomp,
+                                  const rohc_trace_level_t level)
+{
+	/* check decompressor validity */
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	/* check the trace level */
+	if(level >= ROHC_TRACE_LEVEL_MAX)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "unknown trace level %d", level);
+		goto error;
+	}
+
+	/* refuse to set a new trace level if decompressor is in use */
+	if(decomp->stats.received > 0)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the trace level after initialization");
+		goto error;
+	}
+
+	decomp->trace_level = level;
+
+	return true;
+
+error:
+	return false;
+}
+
+
+/**
+ * @brief Set the allocator used for the decompression contexts
+ *
+ * The decompression contexts are carved from pools of cache-line-aligned
+ * objects, one pool per size of objects. The pools get their memory from the
+ * given allocator in large blocks, so that the creation of many new contexts
+ * seldom calls it. By default, the standard malloc(3) and free(3) functions
+ * are used.
+ *
+ * The allocator must be set before the first packet is decompressed, and it
+ * cannot be changed once some memory was obtained from it.
+ *
+ * @param decomp     The ROHC decompressor
+ * @param malloc_cb  The callback used to allocate memory,
+ *                   NULL to restore the default allocator
+ * @param free_cb    The callback used to release memory,
+ *                   NULL to restore the default allocator
+ * @param priv_ctxt  An optional private context given to the callbacks,
+ *                   may be NULL
+ * @return           true on success, false otherwise
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_malloc_cb_t
+ * @see rohc_free_cb_t
+ */
+bool rohc_decomp_set_allocator(struct rohc_decomp *const decomp,
+                               rohc_malloc_cb_t malloc_cb,
+                               rohc_free_cb_t free_cb,
+                               void *const priv_ctxt)
+{
+	if(decomp == NULL)
+	{
+		goto error;
+	}
+
+	/* refuse to change the allocator if decompressor is in use */
+	if(decomp->stats.received > 0)
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL, "unable to "
+		           "modify the allocator after initialization");
+		goto error;
+	}
+
+	if(!rohc_mem_set_allocator(&decomp->mem, malloc_cb, free_cb, priv_ctxt))
+	{
+		rohc_error(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL, "failed to "
+		           "set the allocator: both callbacks shall be set or unset, "
+		           "and no context shall be in use");
+		goto error;
+	}
+
+	return true;
+
+error:
+	return false;
+}
+
+
 /*
  * Private functions
  */
@@ -3785,6 +4578,78 @@ static void rohc_decomp_parse_padding(const struct rohc_decomp *const decomp,
 }
 
 
+/**
+ * @brief Prefetch the decompression context of the given ROHC packet
+ *
+ * Peek at the CID of the ROHC packet and bring the matching decompression
+ * context, if any, into the CPU cache. Packets that start with feedback or
+ * that are segments are not examined, and malformed packets are left to the
+ * decompression that will reject them.
+ *
+ * @param decomp  The ROHC decompressor
+ * @param packet  The ROHC packet that will be decompressed next
+ */
+static void rohc_decomp_prefetch_ctxt(const struct rohc_decomp *const decomp,
+                                      const struct rohc_buf packet)
+{
+	const uint8_t *data;
+	size_t len;
+	rohc_cid_t cid;
+
+	if(rohc_buf_is_malformed(packet))
+	{
+		return;
+	}
+	data = rohc_buf_data(packet);
+	len = packet.len;
+
+	/* skip padding */
+	while(len > 0 && rohc_decomp_packet_is_padding(data))
+	{
+		data++;
+		len--;
+	}
+	if(len == 0 || rohc_packet_is_feedback(data[0]) ||
+	   rohc_decomp_packet_is_segment(data))
+	{
+		return;
+	}
+
+	/* peek at the small or large CID */
+	if(decomp->medium.cid_type == ROHC_SMALL_CID)
+	{
+		cid = rohc_add_cid_decode(data, len);
+		if(cid == UINT8_MAX)
+		{
+			cid = 0;
+		}
+	}
+	else
+	{
+		uint32_t large_cid;
+		size_t large_cid_bits_nr;
+		size_t large_cid_len;
+
+		if(len < 2)
+		{
+			return;
+		}
+		large_cid_len = sdvl_decode(data + 1, len - 1, &large_cid,
+		                            &large_cid_bits_nr);
+		if(large_cid_len != 1 && large_cid_len != 2)
+		{
+			return;
+		}
+		cid = large_cid & 0xffff;
+	}
+
+	if(cid <= decomp->medium.max_cid && decomp->contexts[cid] != NULL)
+	{
+		__builtin_prefetch(decomp->contexts[cid], 1, 3);
+	}
+}
+
+
 /**
  * @brief Find the context for the given ROHC packet
  *
@@ -4142,3 +5007,53 @@ static bool rohc_decomp_create_contexts(struct rohc_decomp *const decomp,
 	return true;
 }
 
+
+/**
+ * @brief Create the per-packet scratch areas of the decompression profiles
+ *
+ * Every profile gets one area for the bits extracted from the ROHC packet
+ * being decoded and one area for the values decoded from them. The areas of
+ * all the profiles share one memory block, and each of them starts on a
+ * \ref ROHC_DECOMP_SCRATCH_ALIGN boundary.
+ *
+ * @param decomp  The ROHC decompressor
+ * @return        true if the scratch areas were created, false otherwise
+ */
+static bool rohc_decomp_create_scratch(struct rohc_decomp *const decomp)
+{
+	const size_t align = ROHC_DECOMP_SCRATCH_ALIGN;
+	size_t scratch_len = 0;
+	uint8_t *scratch;
+	size_t i;
+
+	for(i = 0; i < D_NUM_PROFILES; i++)
+	{
+		scratch_len += (rohc_decomp_profiles[i]->extr_bits_len + align - 1) & ~(align - 1);
+		scratch_len += (rohc_decomp_profiles[i]->decoded_len + align - 1) & ~(align - 1);
+	}
+
+	/* one more alignment unit to align the start of the memory block */
+	decomp->scratch_mem = calloc(1, scratch_len + align - 1);
+	if(decomp->scratch_mem == NULL)
+	{
+		rohc_warning(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+		             "cannot allocate memory for the scratch areas");
+		return false;
+	}
+
+	scratch = (uint8_t *) (((uintptr_t) decomp->scratch_mem + align - 1) &
+	                       ~((uintptr_t) align - 1));
+	for(i = 0; i < D_NUM_PROFILES; i++)
+	{
+		decomp->scratch[i].extr_bits = scratch;
+		scratch += (rohc_decomp_profiles[i]->extr_bits_len + align - 1) & ~(align - 1);
+		decomp->scratch[i].decoded_values = scratch;
+		scratch += (rohc_decomp_profiles[i]->decoded_len + align - 1) & ~(align - 1);
+	}
+	rohc_debug(decomp, ROHC_TRACE_DECOMP, ROHC_PROFILE_GENERAL,
+	           "%zu bytes of scratch areas created for %u profiles",
+	           scratch_len, D_NUM_PROFILES);
+
+	return true;
+}
+
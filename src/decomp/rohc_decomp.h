@@ -84,6 +84,41 @@ typedef enum
 } rohc_decomp_state_t;
 
 
+/** The maximum number of checksums left to the caller for one packet */
+#define ROHC_DECOMP_CSUM_MAX  2U
+
+
+/**
+ * @brief One checksum that the decompressor left to the caller
+ *
+ * When the \ref ROHC_DECOMP_FEATURE_CSUM_OFFLOAD feature is enabled, the
+ * decompressor does not compute the checksums of the rebuilt IPv4 headers
+ * unless it needs them to verify the CRC of the ROHC packet (the CRCs cover
+ * the uncompressed headers, so in practice only the checksums of IR and
+ * IR-DYN packets are left). The checksum field is then zeroed, and the
+ * caller (or the NIC) shall compute the Internet checksum over the \e len
+ * bytes at \e start and store it at \e start + \e offset, in the same
+ * way as the Linux CHECKSUM_PARTIAL metadata describes a pending checksum.
+ *
+ * The UDP, UDP-Lite and TCP checksums are always transmitted in ROHC
+ * packets, so the decompressor never leaves them to the caller.
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_last_packet_info_t
+ */
+typedef struct
+{
+	/** The offset (in bytes) of the first byte covered by the checksum, from
+	 *  the beginning of the decompressed packet */
+	unsigned short start;
+	/** The offset (in bytes) of the checksum field, from \e start */
+	unsigned short offset;
+	/** The number of bytes covered by the checksum */
+	unsigned short len;
+} __attribute__((packed)) rohc_decomp_csum_t;
+
+
 /**
  * @brief Some information about the last decompressed packet
  *
@@ -115,6 +150,9 @@ typedef enum
  *    is_duplicated
  *  - Major 0 / Minor = 1 added: corrected_crc_failures,
  *    corrected_sn_wraparounds, corrected_wrong_sn_updates, and packet_type
+ *  - Major 0 / Minor = 2 added: total_last_comp_size, header_last_comp_size,
+ *    total_last_uncomp_size, and header_last_uncomp_size
+ *  - Major 0 / Minor = 3 added: csums_nr and csums
  *
  * @ingroup rohc_decomp
  *
@@ -160,6 +198,14 @@ typedef struct
 	/** The uncompressed size (in bytes) of the last decompressed header */
 	unsigned long header_last_uncomp_size;
 
+	/* added in 0.3 */
+	/** The number of checksums left to the caller in the last decompressed
+	 *  packet (always 0 if \ref ROHC_DECOMP_FEATURE_CSUM_OFFLOAD is not
+	 *  enabled) */
+	unsigned short csums_nr;
+	/** The checksums left to the caller in the last decompressed packet */
+	rohc_decomp_csum_t csums[ROHC_DECOMP_CSUM_MAX];
+
 } __attribute__((packed)) rohc_decomp_last_packet_info_t;
 
 
@@ -281,6 +327,63 @@ typedef struct
 } __attribute__((packed)) rohc_decomp_general_info_t;
 
 
+/**
+ * @brief The stages of the decompression of one packet
+ *
+ * The stages are timed separately if the library was built with the option
+ * --enable-rohc-perf-counters of the configure script. The CRC stage is
+ * nested in the BUILD stage for the CRCs on uncompressed headers: that time
+ * is also accounted in the BUILD stage.
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_get_perf_counters
+ */
+typedef enum
+{
+	/** Parse the ROHC header and extract its bits */
+	ROHC_DECOMP_PERF_PARSE     = 0,
+	/** Decode the extracted bits with the context */
+	ROHC_DECOMP_PERF_DECODE    = 1,
+	/** Build the uncompressed headers from the decoded values */
+	ROHC_DECOMP_PERF_BUILD     = 2,
+	/** Check the CRCs (on IR headers and uncompressed headers) */
+	ROHC_DECOMP_PERF_CRC       = 3,
+	/** Attempt a context repair upon CRC failure */
+	ROHC_DECOMP_PERF_REPAIR    = 4,
+	/** The number of stages */
+	ROHC_DECOMP_PERF_STAGES_NR = 5,
+
+} rohc_decomp_perf_stage_t;
+
+
+/**
+ * @brief The timing counters of the decompressor
+ *
+ * The structure is used by the \ref rohc_decomp_get_perf_counters function
+ * to store the timing counters of the decompressor stages.
+ *
+ * Versioning works as for \ref rohc_decomp_general_info_t.
+ *
+ * Supported versions:
+ *  - major 0 and minor = 0 contains: version_major, version_minor and
+ *    stages.
+ *
+ * @ingroup rohc_decomp
+ *
+ * @see rohc_decomp_get_perf_counters
+ */
+typedef struct
+{
+	/** The major version of this structure */
+	unsigned short version_major;
+	/** The minor version of this structure */
+	unsigned short version_minor;
+	/** The timing counters, one per \ref rohc_decomp_perf_stage_t stage */
+	rohc_perf_counter_t stages[ROHC_DECOMP_PERF_STAGES_NR];
+} __attribute__((packed)) rohc_decomp_perf_counters_t;
+
+
 /**
  * @brief The different features of the ROHC decompressor
  *
@@ -302,6 +405,9 @@ typedef enum
 	ROHC_DECOMP_FEATURE_COMPAT_1_6_x = (1 << 1),
 	/** Dump content of packets in traces (beware: performance impact) */
 	ROHC_DECOMP_FEATURE_DUMP_PACKETS = (1 << 3),
+	/** Leave the IPv4 header checksums to the caller (checksum offload)
+	 *  when no CRC needs them, see \ref rohc_decomp_csum_t */
+	ROHC_DECOMP_FEATURE_CSUM_OFFLOAD = (1 << 4),
 
 } rohc_decomp_features_t;
 
@@ -325,6 +431,21 @@ rohc_status_t ROHC_EXPORT rohc_decompress3(struct rohc_decomp *const decomp,
                                            struct rohc_buf *const feedback_send)
 	__attribute__((warn_unused_result));
 
+rohc_status_t ROHC_EXPORT rohc_decompress_inplace(struct rohc_decomp *const decomp,
+                                                  struct rohc_buf *const pkt,
+                                                  struct rohc_buf *const rcvd_feedback,
+                                                  struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result));
+
+size_t ROHC_EXPORT rohc_decompress_burst(struct rohc_decomp *const decomp,
+                                        const struct rohc_buf *const rohc_packets,
+                                        struct rohc_buf *const uncomp_packets,
+                                        rohc_status_t *const statuses,
+                                        const size_t pkts_nr,
+                                        struct rohc_buf *const rcvd_feedback,
+                                        struct rohc_buf *const feedback_send)
+	__attribute__((warn_unused_result));
+
 
 
 /*
@@ -338,6 +459,19 @@ bool ROHC_EXPORT rohc_decomp_get_general_info(const struct rohc_decomp *const de
                                               rohc_decomp_general_info_t *const info)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_decomp_get_perf_counters(const struct rohc_decomp *const decomp,
+                                               rohc_decomp_perf_counters_t *const counters)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_stats(const struct rohc_decomp *const decomp,
+                                       rohc_stats_t *const stats)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_get_ctxt_stats(const struct rohc_decomp *const decomp,
+                                            const rohc_cid_t cid,
+                                            rohc_stats_t *const stats)
+	__attribute__((warn_unused_result));
+
 bool ROHC_EXPORT rohc_decomp_get_context_info(const struct rohc_decomp *const decomp,
                                               const rohc_cid_t cid,
                                               rohc_decomp_context_info_t *const info)
@@ -437,6 +571,16 @@ bool ROHC_EXPORT rohc_decomp_set_traces_cb2(struct rohc_decomp *const decomp,
                                             void *const priv_ctxt)
 	__attribute__((warn_unused_result));
 
+bool ROHC_EXPORT rohc_decomp_set_traces_level(struct rohc_decomp *const decomp,
+                                              const rohc_trace_level_t level)
+	__attribute__((warn_unused_result));
+
+bool ROHC_EXPORT rohc_decomp_set_allocator(struct rohc_decomp *const decomp,
+                                           rohc_malloc_cb_t malloc_cb,
+                                           rohc_free_cb_t free_cb,
+                                           void *const priv_ctxt)
+	__attribute__((warn_unused_result));
+
 
 #undef ROHC_EXPORT /* do not pollute outside this header */
 
@@ -30,8 +30,11 @@
 #include "rohc_internal.h"
 #include "rohc_decomp.h"
 #include "rohc_traces_internal.h"
+#include "rohc_perf_internal.h"
 #include "feedback_create.h"
 #include "crc.h"
+#include "rohc_mem.h"
+#include "rohc_stats.h"
 
 
 /*
@@ -86,11 +89,6 @@ struct d_statistics
 	/* The number of bad decompressions */
 	unsigned long failed_decomp;
 
-	/** The cumulative size of the compressed packets */
-	unsigned long total_compressed_size;
-	/** The cumulative size of the uncompressed packets */
-	unsigned long total_uncompressed_size;
-
 	/** The cumulative number of successful corrections upon CRC failure */
 	unsigned long corrected_crc_failures;
 	/** The cumulative number of successful corrections of SN wraparound
@@ -136,6 +134,24 @@ struct rohc_ack_stats
 };
 
 
+/** The alignment (in bytes) of the scratch areas of the decompressor */
+#define ROHC_DECOMP_SCRATCH_ALIGN  64U
+
+/**
+ * @brief The scratch area of one decompression profile
+ *
+ * Every context of the profile uses the scratch area to parse and decode
+ * the packet being decompressed.
+ */
+struct rohc_decomp_scratch
+{
+	/** The bits extracted from the ROHC packet being decoded */
+	void *extr_bits;
+	/** The values decoded from the extracted bits and the context */
+	void *decoded_values;
+};
+
+
 /**
  * @brief The ROHC decompressor
  */
@@ -179,31 +195,53 @@ struct rohc_decomp
 
 /** The maximal value for MRRU */
 #define ROHC_MAX_MRRU 65535
-	/** The Reconstructed Reception Unit */
-	uint8_t rru[ROHC_MAX_MRRU];
+	/** The Reconstructed Reception Unit, MRRU bytes allocated by
+	 *  rohc_decomp_set_mrru() (NULL if segmentation is disabled) */
+	uint8_t *rru;
 	/** The length (in bytes) of the Reconstructed Reception Unit */
 	size_t rru_len;
 	/** The Maximum Reconstructed Reception Unit (MRRU) */
 	size_t mrru;
 
 
-	/* CRC-related variables: */
+	/* per-packet scratch areas */
+
+	/** The memory block that holds the scratch areas of all the profiles */
+	uint8_t *scratch_mem;
+	/** The scratch areas, one per decompression profile, aligned on
+	 *  \ref ROHC_DECOMP_SCRATCH_ALIGN bytes */
+	struct rohc_decomp_scratch scratch[D_NUM_PROFILES];
 
-	/** The table to enable fast CRC-3 computation */
-	uint8_t crc_table_3[256];
-	/** The table to enable fast CRC-7 computation */
-	uint8_t crc_table_7[256];
-	/** The table to enable fast CRC-8 computation */
-	uint8_t crc_table_8[256];
+
+	/* memory-related variables */
+
+	/** The pools the contexts are allocated from */
+	struct rohc_mem mem;
 
 
 	/** Some statistics about the decompression processes */
 	struct d_statistics stats;
 
+	/** The memory block that holds the statistics blocks */
+	void *stats_mem;
+	/** The packet and byte counters of the decompressor, may be read by
+	 *  other threads */
+	struct rohc_stats *global_stats;
+	/** The packet and byte counters of the contexts, one block per CID */
+	struct rohc_stats *ctxt_stats;
+
+#ifdef ROHC_PERF_COUNTERS
+	/** The timing counters of the decompression stages, allocated apart from
+	 *  the decompressor so that they may be updated through const pointers */
+	rohc_perf_counter_t *perf;
+#endif
+
 	/** The callback function used to manage traces */
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The lowest level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
 };
 
 
@@ -246,18 +284,35 @@ struct rohc_decomp_crc
 };
 
 
+/** The checksums left to the caller for the packet being decompressed */
+struct rohc_decomp_csums
+{
+	/** The checksums, see \ref rohc_decomp_csum_t */
+	rohc_decomp_csum_t csums[ROHC_DECOMP_CSUM_MAX];
+	/** The number of checksums in \e csums */
+	size_t nr;
+};
+
+
 /**
  * @brief The volatile part of the ROHC decompression context
  *
  * The volatile part of the ROHC decompression context lasts only one single
  * packet. Between two ROHC packets, the volatile part of the context is
  * erased.
+ *
+ * The extracted bits and the decoded values are not owned by the context:
+ * they point to the scratch area that the decompressor reserves for the
+ * profile of the context, since only one packet is decoded at a time.
  */
 struct rohc_decomp_volat_ctxt
 {
 	/** The CRC information extracted from the ROHC packet being parsed */
 	struct rohc_decomp_crc crc;
 
+	/** The checksums of the rebuilt headers left to the caller */
+	struct rohc_decomp_csums csums;
+
 	/** The profile-specific data for bits extracted from the ROHC packet,
 	 * defined by the profiles */
 	void *extr_bits;
@@ -309,14 +364,8 @@ struct rohc_decomp_ctxt
 	/** The type of the last decompressed ROHC packet */
 	rohc_packet_t packet_type;
 
-	/** The cumulated size of the uncompressed packets */
-	unsigned long total_uncompressed_size;
-	/** The cumulated size of the compressed packets */
-	unsigned long total_compressed_size;
-	/** The cumulated size of the uncompressed headers */
-	unsigned long header_uncompressed_size;
-	/** The cumulated size of the compressed headers */
-	unsigned long header_compressed_size;
+	/* the cumulated sizes of the packets and headers of the context are
+	 * stored in the block ctxt_stats[cid] of the decompressor */
 
 	/** The total size of the last uncompressed packet */
 	unsigned long total_last_uncompressed_size;
@@ -351,9 +400,7 @@ typedef bool (*rohc_decomp_new_context_t)(const struct rohc_decomp_ctxt *const c
                                           struct rohc_decomp_volat_ctxt *const volat_ctxt)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-typedef void (*rohc_decomp_free_context_t)(void *const persist_ctxt,
-                                           const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(2)));
+typedef void (*rohc_decomp_free_context_t)(void *const persist_ctxt);
 
 typedef rohc_packet_t (*rohc_decomp_detect_pkt_type_t) (const struct rohc_decomp_ctxt *const context,
                                                         const uint8_t *const rohc_packet,
@@ -383,8 +430,9 @@ typedef rohc_status_t (*rohc_decomp_build_hdrs_t)(const struct rohc_decomp *cons
                                                   const void *const decoded_values,
                                                   const size_t payload_len,
                                                   struct rohc_buf *const uncomp_hdrs,
-                                                  size_t *const uncomp_hdrs_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8)));
+                                                  size_t *const uncomp_hdrs_len,
+                                                  struct rohc_decomp_csums *const csums)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8, 9)));
 
 typedef void (*rohc_decomp_update_ctxt_t)(struct rohc_decomp_ctxt *const context,
                                           const void *const decoded_values,
@@ -417,6 +465,11 @@ struct rohc_decomp_profile
 	/** The maximum number of bits of the Master Sequence Number (MSN) */
 	const size_t msn_max_bits;
 
+	/** The size (in bytes) of the bits extracted from one ROHC packet */
+	const size_t extr_bits_len;
+	/** The size (in bytes) of the values decoded from one ROHC packet */
+	const size_t decoded_len;
+
 	/** @brief The handler used to create the profile-specific part of the
 	 *         decompression context */
 	rohc_decomp_new_context_t new_context;
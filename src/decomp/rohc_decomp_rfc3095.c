@@ -278,15 +278,20 @@ static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
                             const size_t uncomp_hdrs_max_len,
                             size_t *const uncomp_hdrs_len,
                             const size_t payload_size,
-                            const struct list_decomp *const list_decomp)
+                            const struct list_decomp *const list_decomp,
+                            const bool csum_offload)
 	__attribute__((warn_unused_result, nonnull(1, 3, 5)));
 static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_decoded_ip_values decoded,
                               uint8_t *const dest,
                               const size_t uncomp_hdrs_max_len,
                               size_t *const uncomp_hdrs_len,
-                              const size_t payload_size)
+                              const size_t payload_size,
+                              const bool csum_offload)
 	__attribute__((warn_unused_result, nonnull(1, 3, 5)));
+static void leave_uncomp_ipv4_csum(struct rohc_decomp_csums *const csums,
+                                   const size_t ip_hdr_offset)
+	__attribute__((nonnull(1)));
 static bool build_uncomp_ipv6(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_decoded_ip_values decoded,
                               uint8_t *const dest,
@@ -326,6 +331,9 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
                              const uint8_t crc_packet)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3, 5)));
 
+static bool is_crc_static_changed_by_ext3(const struct rohc_extr_bits *const bits)
+	__attribute__((warn_unused_result, nonnull(1), pure));
+
 static bool is_sn_wraparound(const struct rohc_ts cur_arrival_time,
                              const struct rohc_ts arrival_times[ROHC_MAX_ARRIVAL_TIMES],
                              const size_t arrival_times_nr,
@@ -355,6 +363,7 @@ static void reset_extr_bits(const struct rohc_decomp_rfc3095_ctxt *const rfc3095
  * @param[out] volat_ctxt    The volatile part of the decompression context
  * @param trace_cb           The function to call for printing traces
  * @param trace_cb_priv      An optional private context, may be NULL
+ * @param trace_level        The lowest level of the traces to print
  * @param profile_id         The ID of the associated decompression profile
  * @return                   true if the Uncompressed context was successfully
  *                           created, false if a problem occurred
@@ -364,12 +373,14 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
                                 struct rohc_decomp_volat_ctxt *const volat_ctxt,
                                 rohc_trace_callback2_t trace_cb,
                                 void *const trace_cb_priv,
+                                const rohc_trace_level_t trace_level,
                                 const int profile_id)
 {
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
 
 	/* allocate memory for the generic context */
-	*persist_ctxt = calloc(1, sizeof(struct rohc_decomp_rfc3095_ctxt));
+	*persist_ctxt = rohc_mem_zalloc(&context->decompressor->mem,
+	                                sizeof(struct rohc_decomp_rfc3095_ctxt));
 	if((*persist_ctxt) == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -383,7 +394,9 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
 	/* create the Offset IP-ID decoding context for inner IP header */
 	ip_id_offset_init(&rfc3095_ctxt->inner_ip_id_offset_ctxt);
 
-	rfc3095_ctxt->outer_ip_changes = calloc(2, sizeof(struct rohc_decomp_rfc3095_changes));
+	rfc3095_ctxt->outer_ip_changes =
+		rohc_mem_zalloc(&context->decompressor->mem,
+		                2 * sizeof(struct rohc_decomp_rfc3095_changes));
 	if(rfc3095_ctxt->outer_ip_changes == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -391,7 +404,9 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
 		goto free_context;
 	}
 
-	rfc3095_ctxt->inner_ip_changes = calloc(1, sizeof(struct rohc_decomp_rfc3095_changes));
+	rfc3095_ctxt->inner_ip_changes =
+		rohc_mem_zalloc(&context->decompressor->mem,
+		                sizeof(struct rohc_decomp_rfc3095_changes));
 	if(rfc3095_ctxt->inner_ip_changes == NULL)
 	{
 		rohc_error(context->decompressor, ROHC_TRACE_DECOMP, context->profile->id,
@@ -402,9 +417,9 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
 	/* init the context used to compress the list of IPv6 extension headers
 	 * for the outer and inner IP headers */
 	rohc_decomp_list_ipv6_init(&rfc3095_ctxt->list_decomp1,
-	                           trace_cb, trace_cb_priv, profile_id);
+	                           trace_cb, trace_cb_priv, trace_level, profile_id);
 	rohc_decomp_list_ipv6_init(&rfc3095_ctxt->list_decomp2,
-	                           trace_cb, trace_cb_priv, profile_id);
+	                           trace_cb, trace_cb_priv, trace_level, profile_id);
 
 	/* no default next header */
 	rfc3095_ctxt->next_header_proto = 0;
@@ -418,31 +433,13 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
 	/* volatile part of the decompression context */
 	volat_ctxt->crc.type = ROHC_CRC_TYPE_NONE;
 	volat_ctxt->crc.bits_nr = 0;
-	volat_ctxt->extr_bits = malloc(sizeof(struct rohc_extr_bits));
-	if(volat_ctxt->extr_bits == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the RFC3095 decompression context");
-		goto free_inner_ip_changes;
-	}
-	volat_ctxt->decoded_values = malloc(sizeof(struct rohc_decoded_values));
-	if(volat_ctxt->decoded_values == NULL)
-	{
-		rohc_decomp_warn(context, "failed to allocate memory for the volatile part "
-		                 "of one of the RFC3095 decompression context");
-		goto free_extr_bits;
-	}
 
 	return true;
 
-free_extr_bits:
-	zfree(volat_ctxt->extr_bits);
-free_inner_ip_changes:
-	zfree(rfc3095_ctxt->inner_ip_changes);
 free_outer_ip_changes:
-	zfree(rfc3095_ctxt->outer_ip_changes);
+	rohc_mem_zfree(rfc3095_ctxt->outer_ip_changes);
 free_context:
-	zfree(rfc3095_ctxt);
+	rohc_mem_zfree(rfc3095_ctxt);
 quit:
 	return false;
 }
@@ -455,24 +452,23 @@ quit:
  * framework to work.
  *
  * @param rfc3095_ctxt  The generic decompression context
- * @param volat_ctxt    The volatile part of the decompression context
  */
-void rohc_decomp_rfc3095_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
-                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt)
+void rohc_decomp_rfc3095_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt)
 {
-	/* free the volatile part of the decompression context */
-	free(volat_ctxt->decoded_values);
-	free(volat_ctxt->extr_bits);
-
 	/* destroy the information about the IP headers */
-	zfree(rfc3095_ctxt->outer_ip_changes);
-	zfree(rfc3095_ctxt->inner_ip_changes);
+	rohc_mem_zfree(rfc3095_ctxt->outer_ip_changes);
+	rohc_mem_zfree(rfc3095_ctxt->inner_ip_changes);
+
+	/* destroy the contexts used to decompress the lists of IPv6 extension
+	 * headers */
+	rohc_decomp_list_ipv6_free(&rfc3095_ctxt->list_decomp1);
+	rohc_decomp_list_ipv6_free(&rfc3095_ctxt->list_decomp2);
 
 	/* destroy profile-specific part */
-	zfree(rfc3095_ctxt->specific);
+	rohc_mem_zfree(rfc3095_ctxt->specific);
 
 	/* destroy generic context itself */
-	free(rfc3095_ctxt);
+	rohc_mem_free(rfc3095_ctxt);
 }
 
 
@@ -750,12 +746,12 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
 
 	/* check for IP version switch during context re-use */
 	if(context->num_recv_packets >= 1 &&
-	   bits->outer_ip.version != ip_get_version(&rfc3095_ctxt->outer_ip_changes->ip))
+	   bits->outer_ip.version != rfc3095_ctxt->outer_ip_changes->ip.version)
 	{
 		rohc_decomp_debug(context, "outer IP version mismatch (packet = %d, "
 		                  "context = %d) -> context is being reused",
 		                  bits->outer_ip.version,
-		                  ip_get_version(&rfc3095_ctxt->outer_ip_changes->ip));
+		                  rfc3095_ctxt->outer_ip_changes->ip.version);
 		bits->is_context_reused = true;
 	}
 
@@ -805,12 +801,12 @@ static bool parse_ir(const struct rohc_decomp_ctxt *const context,
 
 		/* check for IP version switch during context re-use */
 		if(context->num_recv_packets >= 1 &&
-		   bits->inner_ip.version != ip_get_version(&rfc3095_ctxt->inner_ip_changes->ip))
+		   bits->inner_ip.version != rfc3095_ctxt->inner_ip_changes->ip.version)
 		{
 			rohc_decomp_debug(context, "inner IP version mismatch (packet = %d, "
 			                  "context = %d) -> context is being reused",
 			                  bits->inner_ip.version,
-			                  ip_get_version(&rfc3095_ctxt->inner_ip_changes->ip));
+			                  rfc3095_ctxt->inner_ip_changes->ip.version);
 			bits->is_context_reused = true;
 		}
 	}
@@ -2212,9 +2208,12 @@ static bool parse_uo1id(const struct rohc_decomp_ctxt *const context,
 				                                    rohc_remain_len, *packet_type,
 				                                    bits);
 
-				/* invalid CRC-STATIC cache since some STATIC fields may have changed */
-				rfc3095_ctxt->is_crc_static_3_cached_valid = false;
-				rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				/* invalid CRC-STATIC cache if some STATIC fields may have changed */
+				if(is_crc_static_changed_by_ext3(bits))
+				{
+					rfc3095_ctxt->is_crc_static_3_cached_valid = false;
+					rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				}
 
 				break;
 			}
@@ -2738,9 +2737,12 @@ static bool parse_uor2(const struct rohc_decomp_ctxt *const context,
 				                                    rohc_remain_len, *packet_type,
 				                                    bits);
 
-				/* invalid CRC-STATIC cache since some STATIC fields may have changed */
-				rfc3095_ctxt->is_crc_static_3_cached_valid = false;
-				rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				/* invalid CRC-STATIC cache if some STATIC fields may have changed */
+				if(is_crc_static_changed_by_ext3(bits))
+				{
+					rfc3095_ctxt->is_crc_static_3_cached_valid = false;
+					rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				}
 
 				break;
 			}
@@ -3196,9 +3198,12 @@ static bool parse_uor2rtp_once(const struct rohc_decomp_ctxt *const context,
 				                                    rohc_remain_len, packet_type,
 				                                    bits);
 
-				/* invalid CRC-STATIC cache since some STATIC fields may have changed */
-				rfc3095_ctxt->is_crc_static_3_cached_valid = false;
-				rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				/* invalid CRC-STATIC cache if some STATIC fields may have changed */
+				if(is_crc_static_changed_by_ext3(bits))
+				{
+					rfc3095_ctxt->is_crc_static_3_cached_valid = false;
+					rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				}
 
 				break;
 			}
@@ -3667,9 +3672,12 @@ static bool parse_uor2id_once(const struct rohc_decomp_ctxt *const context,
 				                                    rohc_remain_len, packet_type,
 				                                    bits);
 
-				/* invalid CRC-STATIC cache since some STATIC fields may have changed */
-				rfc3095_ctxt->is_crc_static_3_cached_valid = false;
-				rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				/* invalid CRC-STATIC cache if some STATIC fields may have changed */
+				if(is_crc_static_changed_by_ext3(bits))
+				{
+					rfc3095_ctxt->is_crc_static_3_cached_valid = false;
+					rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				}
 
 				break;
 			}
@@ -4140,9 +4148,12 @@ static bool parse_uor2ts_once(const struct rohc_decomp_ctxt *const context,
 				                                    rohc_remain_len, packet_type,
 				                                    bits);
 
-				/* invalid CRC-STATIC cache since some STATIC fields may have changed */
-				rfc3095_ctxt->is_crc_static_3_cached_valid = false;
-				rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				/* invalid CRC-STATIC cache if some STATIC fields may have changed */
+				if(is_crc_static_changed_by_ext3(bits))
+				{
+					rfc3095_ctxt->is_crc_static_3_cached_valid = false;
+					rfc3095_ctxt->is_crc_static_7_cached_valid = false;
+				}
 
 				break;
 			}
@@ -4950,6 +4961,7 @@ static uint8_t parse_extension_type(const uint8_t *const rohc_ext)
  * @param[out] uncomp_hdrs      The buffer to store the uncompressed headers
  * @param[out] uncomp_hdrs_len  The length of the uncompressed headers written
  *                              into the buffer
+ * @param[out] csums            The checksums left to the caller
  * @return                      Possible values:
  *                               \li ROHC_STATUS_OK if headers are built
  *                                   successfully,
@@ -4965,7 +4977,8 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
                                         const struct rohc_decoded_values *const decoded,
                                         const size_t payload_len,
                                         struct rohc_buf *const uncomp_hdrs,
-                                        size_t *const uncomp_hdrs_len)
+                                        size_t *const uncomp_hdrs_len,
+                                        struct rohc_decomp_csums *const csums)
 {
 	struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
 	uint8_t *uncomp_hdrs_data = rohc_buf_data(*uncomp_hdrs);
@@ -4974,8 +4987,14 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 	uint8_t *inner_ip_hdr;
 	uint8_t *next_header;
 	size_t ip_payload_len = 0;
+	/* the CRC covers the IPv4 checksums, so leave them to the caller only if
+	 * the packet carries no CRC on the uncompressed headers */
+	const bool csum_offload =
+		((decomp->features & ROHC_DECOMP_FEATURE_CSUM_OFFLOAD) != 0 &&
+		 extr_crc->type == ROHC_CRC_TYPE_NONE);
 
 	*uncomp_hdrs_len = 0;
+	csums->nr = 0;
 
 	/* build the IP headers */
 	if(decoded->multiple_ip)
@@ -5021,11 +5040,16 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 		/* build the outer IP header */
 		if(!build_uncomp_ip(context, decoded->outer_ip, uncomp_hdrs_data,
 		                    uncomp_hdrs_max_len, &outer_ip_hdr_len,
-		                    ip_payload_len, &rfc3095_ctxt->list_decomp1))
+		                    ip_payload_len, &rfc3095_ctxt->list_decomp1,
+		                    csum_offload))
 		{
 			rohc_decomp_warn(context, "failed to build the outer IP header");
 			goto error_output_too_small;
 		}
+		if(csum_offload && decoded->outer_ip.version == IPV4)
+		{
+			leave_uncomp_ipv4_csum(csums, *uncomp_hdrs_len);
+		}
 		outer_ip_hdr = uncomp_hdrs_data;
 		uncomp_hdrs_data += outer_ip_hdr_len;
 		*uncomp_hdrs_len += outer_ip_hdr_len;
@@ -5036,11 +5060,16 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 		ip_payload_len -= inner_ip_hdr_len + inner_ip_ext_hdrs_len;
 		if(!build_uncomp_ip(context, decoded->inner_ip, uncomp_hdrs_data,
 		                    uncomp_hdrs_max_len, &inner_ip_hdr_len,
-		                    ip_payload_len, &rfc3095_ctxt->list_decomp2))
+		                    ip_payload_len, &rfc3095_ctxt->list_decomp2,
+		                    csum_offload))
 		{
 			rohc_decomp_warn(context, "failed to build the inner IP header");
 			goto error_output_too_small;
 		}
+		if(csum_offload && decoded->inner_ip.version == IPV4)
+		{
+			leave_uncomp_ipv4_csum(csums, *uncomp_hdrs_len);
+		}
 		inner_ip_hdr = uncomp_hdrs_data;
 		uncomp_hdrs_data += inner_ip_hdr_len;
 		*uncomp_hdrs_len += inner_ip_hdr_len;
@@ -5061,11 +5090,15 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
 		/* build the single IP header */
 		if(!build_uncomp_ip(context, decoded->outer_ip, uncomp_hdrs_data,
 		                    uncomp_hdrs_max_len, &ip_hdr_len, ip_payload_len,
-		                    &rfc3095_ctxt->list_decomp1))
+		                    &rfc3095_ctxt->list_decomp1, csum_offload))
 		{
 			rohc_decomp_warn(context, "failed to build the IP header");
 			goto error_output_too_small;
 		}
+		if(csum_offload && decoded->outer_ip.version == IPV4)
+		{
+			leave_uncomp_ipv4_csum(csums, 0);
+		}
 		outer_ip_hdr = uncomp_hdrs_data;
 		inner_ip_hdr = NULL;
 		uncomp_hdrs_data += ip_hdr_len;
@@ -5138,6 +5171,8 @@ error_output_too_small:
  * @param[out] uncomp_hdrs_len  The length of the IPv4 header
  * @param payload_size          The length of the IP payload
  * @param list_decomp           The list decompressor (IPv6 only)
+ * @param csum_offload          Whether to leave the checksum to the caller
+ *                              (IPv4 only)
  * @return                      true if the IP header is successfully built,
  *                              false if an error occurs
  */
@@ -5147,14 +5182,15 @@ static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
                             const size_t uncomp_hdrs_max_len,
                             size_t *const uncomp_hdrs_len,
                             const size_t payload_size,
-                            const struct list_decomp *const list_decomp)
+                            const struct list_decomp *const list_decomp,
+                            const bool csum_offload)
 {
 	bool is_ok;
 
 	if(decoded.version == IPV4)
 	{
 		is_ok = build_uncomp_ipv4(context, decoded, dest, uncomp_hdrs_max_len,
-		                          uncomp_hdrs_len, payload_size);
+		                          uncomp_hdrs_len, payload_size, csum_offload);
 	}
 	else
 	{
@@ -5175,6 +5211,7 @@ static bool build_uncomp_ip(const struct rohc_decomp_ctxt *const context,
  * @param uncomp_hdrs_max_len   The max length of the IPv4 header
  * @param[out] uncomp_hdrs_len  The length of the IPv4 header
  * @param payload_size          The length of the IPv4 payload
+ * @param csum_offload          Whether to leave the checksum to the caller
  * @return                      true if the IPv4 header is successfully built,
  *                              false if an error occurs
  */
@@ -5183,7 +5220,8 @@ static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
                               uint8_t *const dest,
                               const size_t uncomp_hdrs_max_len,
                               size_t *const uncomp_hdrs_len,
-                              const size_t payload_size)
+                              const size_t payload_size,
+                              const bool csum_offload)
 {
 	struct ipv4_hdr *const ip = (struct ipv4_hdr *) dest;
 
@@ -5219,9 +5257,16 @@ static bool build_uncomp_ipv4(const struct rohc_decomp_ctxt *const context,
 	rohc_decomp_debug(context, "Total Length = 0x%04x (IHL * 4 + %zu)",
 	                  rohc_ntoh16(ip->tot_len), payload_size);
 	ip->check = 0;
-	ip->check = ip_fast_csum(dest, ip->ihl);
-	rohc_decomp_debug(context, "IP checksum = 0x%04x",
-	                  rohc_ntoh16(ip->check));
+	if(csum_offload)
+	{
+		rohc_decomp_debug(context, "IP checksum left to the caller");
+	}
+	else
+	{
+		ip->check = ip_fast_csum(dest, ip->ihl);
+		rohc_decomp_debug(context, "IP checksum = 0x%04x",
+		                  rohc_ntoh16(ip->check));
+	}
 
 	*uncomp_hdrs_len = sizeof(struct ipv4_hdr);
 	return true;
@@ -5231,6 +5276,25 @@ error:
 }
 
 
+/**
+ * @brief Record that the checksum of one rebuilt IPv4 header is left to the
+ *        caller
+ *
+ * @param csums          The checksums left to the caller
+ * @param ip_hdr_offset  The offset (in bytes) of the IPv4 header in the
+ *                       uncompressed headers
+ */
+static void leave_uncomp_ipv4_csum(struct rohc_decomp_csums *const csums,
+                                   const size_t ip_hdr_offset)
+{
+	assert(csums->nr < ROHC_DECOMP_CSUM_MAX);
+	csums->csums[csums->nr].start = ip_hdr_offset;
+	csums->csums[csums->nr].offset = offsetof(struct ipv4_hdr, check);
+	csums->csums[csums->nr].len = sizeof(struct ipv4_hdr);
+	csums->nr++;
+}
+
+
 /**
  * @brief Build an uncompressed IPv6 header.
  *
@@ -5310,11 +5374,36 @@ error:
 }
 
 
+/**
+ * @brief Whether the extension 3 carried fields covered by CRC-STATIC
+ *
+ * The addresses, ports, SPI or SSRC never change during the life of a
+ * context, but the extension 3 may update the TOS/TC, TTL/HL, DF and
+ * Protocol/NH fields of the IP headers, and the Padding and eXtension bits
+ * of the RTP header. If none of them was transmitted, the CRC-STATIC value
+ * cached in the context is still valid.
+ *
+ * @param bits  The bits extracted from the ROHC packet
+ * @return      true if some CRC-STATIC fields may have changed,
+ *              false if they did not change
+ */
+static bool is_crc_static_changed_by_ext3(const struct rohc_extr_bits *const bits)
+{
+	return (bits->outer_ip.tos_nr > 0 || bits->outer_ip.ttl_nr > 0 ||
+	        bits->outer_ip.df_nr > 0 || bits->outer_ip.proto_nr > 0 ||
+	        bits->inner_ip.tos_nr > 0 || bits->inner_ip.ttl_nr > 0 ||
+	        bits->inner_ip.df_nr > 0 || bits->inner_ip.proto_nr > 0 ||
+	        bits->rtp_p_nr > 0 || bits->rtp_x_nr > 0);
+}
+
+
 /**
  * @brief Check whether the CRC on uncompressed header is correct or not
  *
- * TODO: The CRC should be computed only on the CRC-DYNAMIC fields
- *       if the CRC-STATIC fields did not change.
+ * The CRC on the CRC-STATIC fields is cached in the context, so that only
+ * the CRC-DYNAMIC fields are handled for most packets. The cache is updated
+ * only once the CRC is known to be correct, so that a damaged packet cannot
+ * pollute it.
  *
  * @param decomp        The ROHC decompressor
  * @param context       The decompression context
@@ -5335,6 +5424,8 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
 {
 	struct rohc_decomp_rfc3095_ctxt *rfc3095_ctxt;
 	const uint8_t *crc_table;
+	bool is_crc_static_cached;
+	uint8_t crc_static;
 	uint8_t crc_computed;
 
 	assert(decomp != NULL);
@@ -5350,15 +5441,15 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
 	{
 		case ROHC_CRC_TYPE_3:
 			crc_computed = CRC_INIT_3;
-			crc_table = decomp->crc_table_3;
+			crc_table = rohc_crc_table_3;
 			break;
 		case ROHC_CRC_TYPE_7:
 			crc_computed = CRC_INIT_7;
-			crc_table = decomp->crc_table_7;
+			crc_table = rohc_crc_table_7;
 			break;
 		case ROHC_CRC_TYPE_8:
 			crc_computed = CRC_INIT_8;
-			crc_table = decomp->crc_table_8;
+			crc_table = rohc_crc_table_8;
 			break;
 		case ROHC_CRC_TYPE_NONE:
 		default:
@@ -5367,44 +5458,36 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
 			goto error;
 	}
 
+	rohc_perf_start(crc_start);
+
 	/* compute the CRC on CRC-STATIC fields of built uncompressed headers */
 	if(rfc3095_ctxt->is_crc_static_3_cached_valid && crc_type == ROHC_CRC_TYPE_3)
 	{
-		crc_computed = rfc3095_ctxt->crc_static_3_cached;
-		rohc_decomp_debug(context, "use CRC-STATIC-3 = 0x%x from cache", crc_computed);
+		crc_static = rfc3095_ctxt->crc_static_3_cached;
+		is_crc_static_cached = true;
+		rohc_decomp_debug(context, "use CRC-STATIC-3 = 0x%x from cache", crc_static);
 	}
 	else if(rfc3095_ctxt->is_crc_static_7_cached_valid && crc_type == ROHC_CRC_TYPE_7)
 	{
-		crc_computed = rfc3095_ctxt->crc_static_7_cached;
-		rohc_decomp_debug(context, "use CRC-STATIC-7 = 0x%x from cache", crc_computed);
+		crc_static = rfc3095_ctxt->crc_static_7_cached;
+		is_crc_static_cached = true;
+		rohc_decomp_debug(context, "use CRC-STATIC-7 = 0x%x from cache", crc_static);
 	}
 	else
 	{
-		crc_computed = rfc3095_ctxt->compute_crc_static(outer_ip_hdr, inner_ip_hdr,
-		                                                next_header, crc_type,
-		                                                crc_computed, crc_table);
+		crc_static = rfc3095_ctxt->compute_crc_static(outer_ip_hdr, inner_ip_hdr,
+		                                              next_header, crc_type,
+		                                              crc_computed, crc_table);
+		is_crc_static_cached = false;
 		rohc_decomp_debug(context, "compute CRC-STATIC-%d = 0x%x from packet",
-		                  crc_type, crc_computed);
-
-		switch(crc_type)
-		{
-			case ROHC_CRC_TYPE_3:
-				rfc3095_ctxt->crc_static_3_cached = crc_computed;
-				rfc3095_ctxt->is_crc_static_3_cached_valid = true;
-				break;
-			case ROHC_CRC_TYPE_7:
-				rfc3095_ctxt->crc_static_7_cached = crc_computed;
-				rfc3095_ctxt->is_crc_static_7_cached_valid = true;
-				break;
-			default:
-				break;
-		}
+		                  crc_type, crc_static);
 	}
 
 	/* compute the CRC on CRC-DYNAMIC fields of built uncompressed headers */
 	crc_computed = rfc3095_ctxt->compute_crc_dynamic(outer_ip_hdr, inner_ip_hdr,
 	                                                 next_header, crc_type,
-	                                                 crc_computed, crc_table);
+	                                                 crc_static, crc_table);
+	rohc_perf_stop(decomp->perf, ROHC_DECOMP_PERF_CRC, crc_start);
 	rohc_decomp_debug(context, "CRC-%d on uncompressed header = 0x%x",
 	                  crc_type, crc_computed);
 
@@ -5416,6 +5499,24 @@ static bool check_uncomp_crc(const struct rohc_decomp *const decomp,
 		goto error;
 	}
 
+	/* the CRC-STATIC value is correct, cache it for next packets */
+	if(!is_crc_static_cached)
+	{
+		switch(crc_type)
+		{
+			case ROHC_CRC_TYPE_3:
+				rfc3095_ctxt->crc_static_3_cached = crc_static;
+				rfc3095_ctxt->is_crc_static_3_cached_valid = true;
+				break;
+			case ROHC_CRC_TYPE_7:
+				rfc3095_ctxt->crc_static_7_cached = crc_static;
+				rfc3095_ctxt->is_crc_static_7_cached_valid = true;
+				break;
+			default:
+				break;
+		}
+	}
+
 	/* computed CRC matches the one in packet */
 	return true;
 
@@ -5772,9 +5873,9 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 	struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt = context->persist_ctxt;
 	const bool new_inner_ip_hdr = !!(ip_hdr_pos == 2 && !rfc3095_ctxt->multiple_ip);
 	const bool ip_6to4_switch =
-		!!(ip_get_version(&ctxt->ip) == IPV6 && bits->version == IPV4);
+		!!(ctxt->ip.version == IPV6 && bits->version == IPV4);
 	const bool ip_4to6_switch =
-		!!(ip_get_version(&ctxt->ip) == IPV4 && bits->version == IPV6);
+		!!(ctxt->ip.version == IPV4 && bits->version == IPV6);
 
 	assert(ctxt != NULL);
 	assert(decoded != NULL);
@@ -5799,7 +5900,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 	else
 	{
 		/* keep context value */
-		decoded->tos = ip_get_tos(&ctxt->ip);
+		decoded->tos = ctxt->ip.tos;
 	}
 	rohc_decomp_debug(context, "decoded %s TOS/TC = %d", descr, decoded->tos);
 
@@ -5818,7 +5919,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 	else
 	{
 		/* keep context value */
-		decoded->ttl = ip_get_ttl(&ctxt->ip);
+		decoded->ttl = ctxt->ip.ttl;
 	}
 	rohc_decomp_debug(context, "decoded %s TTL/HL = %d", descr, decoded->ttl);
 
@@ -5837,7 +5938,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 	else
 	{
 		/* keep context value */
-		decoded->proto = ip_get_protocol(&ctxt->ip);
+		decoded->proto = ctxt->ip.proto;
 	}
 	rohc_decomp_debug(context, "decoded %s protocol/NH = %d", descr,
 	                  decoded->proto);
@@ -5956,7 +6057,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		{
 			/* the IP-ID of the IPv4 header is constant: retrieve the value
 			 * that is stored in the context */
-			decoded->id = ipv4_get_id(&ctxt->ip);
+			decoded->id = ctxt->ip.id;
 		}
 		else
 		{
@@ -5993,7 +6094,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		else
 		{
 			/* keep context value */
-			decoded->df = ipv4_get_df(&ctxt->ip);
+			decoded->df = ctxt->ip.df;
 		}
 		rohc_decomp_debug(context, "decoded %s DF = %d", descr, decoded->df);
 
@@ -6014,8 +6115,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		else
 		{
 			/* keep context value */
-			const uint32_t saddr_ctxt = ipv4_get_saddr(&ctxt->ip);
-			memcpy(decoded->saddr, &saddr_ctxt, 4);
+			memcpy(decoded->saddr, ctxt->ip.saddr, 4);
 		}
 		rohc_decomp_debug(context, "decoded %s src address = " IPV4_ADDR_FORMAT,
 		                  descr, IPV4_ADDR_RAW(decoded->saddr));
@@ -6037,8 +6137,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		else
 		{
 			/* keep context value */
-			const uint32_t daddr_ctxt = ipv4_get_daddr(&ctxt->ip);
-			memcpy(decoded->daddr, &daddr_ctxt, 4);
+			memcpy(decoded->daddr, ctxt->ip.daddr, 4);
 		}
 		rohc_decomp_debug(context, "decoded %s dst address = " IPV4_ADDR_FORMAT,
 		                  descr, IPV4_ADDR_RAW(decoded->daddr));
@@ -6061,7 +6160,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		else
 		{
 			/* keep context value */
-			decoded->flowid = ip_get_flow_label(&ctxt->ip);
+			decoded->flowid = ctxt->ip.flowid;
 		}
 		rohc_decomp_debug(context, "decoded %s flow label = 0x%05x", descr,
 		                  decoded->flowid);
@@ -6083,8 +6182,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		else
 		{
 			/* keep context value */
-			const struct ipv6_addr *saddr_ctxt = ipv6_get_saddr(&ctxt->ip);
-			memcpy(decoded->saddr, saddr_ctxt, 16);
+			memcpy(decoded->saddr, ctxt->ip.saddr, 16);
 		}
 		rohc_decomp_debug(context, "decoded %s src address = " IPV6_ADDR_FORMAT,
 		                  descr, IPV6_ADDR_RAW(decoded->saddr));
@@ -6106,8 +6204,7 @@ static bool decode_ip_values_from_bits(const struct rohc_decomp_ctxt *const cont
 		else
 		{
 			/* keep context value */
-			const struct ipv6_addr *daddr_ctxt = ipv6_get_daddr(&ctxt->ip);
-			memcpy(decoded->daddr, daddr_ctxt, 16);
+			memcpy(decoded->daddr, ctxt->ip.daddr, 16);
 		}
 		rohc_decomp_debug(context, "decoded %s dst address = " IPV6_ADDR_FORMAT,
 		                  descr, IPV6_ADDR_RAW(decoded->daddr));
@@ -6266,51 +6363,28 @@ void rfc3095_decomp_update_ctxt(struct rohc_decomp_ctxt *const context,
 	rfc3095_ctxt->multiple_ip = decoded->multiple_ip;
 
 	/* update fields related to the outer IP header */
-	ip_set_version(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.version);
-	ip_set_protocol(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.proto);
-	ip_set_tos(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.tos);
-	ip_set_ttl(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.ttl);
-	ip_set_saddr(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.saddr);
-	ip_set_daddr(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.daddr);
+	rfc3095_ctxt->outer_ip_changes->ip = decoded->outer_ip;
 	if(decoded->outer_ip.version == IPV4)
 	{
-		ipv4_set_id(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.id);
 		ip_id_offset_set_ref(&rfc3095_ctxt->outer_ip_id_offset_ctxt,
 		                     decoded->outer_ip.id, decoded->sn, keep_ref_minus_1);
-		ipv4_set_df(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.df);
 		rfc3095_ctxt->outer_ip_changes->nbo = decoded->outer_ip.nbo;
 		rfc3095_ctxt->outer_ip_changes->rnd = decoded->outer_ip.rnd;
 		rfc3095_ctxt->outer_ip_changes->sid = decoded->outer_ip.sid;
 	}
-	else /* IPV6 */
-	{
-		ip_set_flow_label(&rfc3095_ctxt->outer_ip_changes->ip, decoded->outer_ip.flowid);
-	}
 
 	/* update fields related to the inner IP header (if any) */
 	if(rfc3095_ctxt->multiple_ip)
 	{
-		ip_set_version(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.version);
-		ip_set_protocol(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.proto);
-		ip_set_tos(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.tos);
-		ip_set_ttl(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.ttl);
-		ip_set_saddr(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.saddr);
-		ip_set_daddr(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.daddr);
+		rfc3095_ctxt->inner_ip_changes->ip = decoded->inner_ip;
 		if(decoded->inner_ip.version == IPV4)
 		{
-			ipv4_set_id(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.id);
 			ip_id_offset_set_ref(&rfc3095_ctxt->inner_ip_id_offset_ctxt,
 			                     decoded->inner_ip.id, decoded->sn, keep_ref_minus_1);
-			ipv4_set_df(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.df);
 			rfc3095_ctxt->inner_ip_changes->nbo = decoded->inner_ip.nbo;
 			rfc3095_ctxt->inner_ip_changes->rnd = decoded->inner_ip.rnd;
 			rfc3095_ctxt->inner_ip_changes->sid = decoded->inner_ip.sid;
 		}
-		else /* IPV6 */
-		{
-			ip_set_flow_label(&rfc3095_ctxt->inner_ip_changes->ip, decoded->inner_ip.flowid);
-		}
-		rfc3095_ctxt->inner_ip_changes->ip.nl.proto = decoded->inner_ip.proto;
 	}
 
 	/* update context with decoded fields for next header if required */
@@ -6358,7 +6432,7 @@ static void reset_extr_bits(const struct rohc_decomp_rfc3095_ctxt *const rfc3095
 	bits->multiple_ip = rfc3095_ctxt->multiple_ip;
 
 	/* set IP version and NBO/RND flags for outer IP header */
-	bits->outer_ip.version = ip_get_version(&rfc3095_ctxt->outer_ip_changes->ip);
+	bits->outer_ip.version = rfc3095_ctxt->outer_ip_changes->ip.version;
 	bits->outer_ip.nbo = rfc3095_ctxt->outer_ip_changes->nbo;
 	bits->outer_ip.rnd = rfc3095_ctxt->outer_ip_changes->rnd;
 	bits->outer_ip.is_id_enc = true;
@@ -6366,7 +6440,7 @@ static void reset_extr_bits(const struct rohc_decomp_rfc3095_ctxt *const rfc3095
 	/* set IP version and NBO/RND flags for inner IP header (if any) */
 	if(bits->multiple_ip)
 	{
-		bits->inner_ip.version = ip_get_version(&rfc3095_ctxt->inner_ip_changes->ip);
+		bits->inner_ip.version = rfc3095_ctxt->inner_ip_changes->ip.version;
 		bits->inner_ip.nbo = rfc3095_ctxt->inner_ip_changes->nbo;
 		bits->inner_ip.rnd = rfc3095_ctxt->inner_ip_changes->rnd;
 		bits->inner_ip.is_id_enc = true;
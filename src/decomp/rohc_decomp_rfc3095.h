@@ -306,8 +306,8 @@ struct rohc_decoded_values
  */
 struct rohc_decomp_rfc3095_changes
 {
-	/// The IP header
-	struct ip_packet ip;
+	/// The values of the IP header fields
+	struct rohc_decoded_ip_values ip;
 
 	/// Whether the IP-ID is considered as random or not (IPv4 only)
 	int rnd;
@@ -459,12 +459,12 @@ bool rohc_decomp_rfc3095_create(const struct rohc_decomp_ctxt *const context,
                                 struct rohc_decomp_volat_ctxt *const volat_ctxt,
                                 rohc_trace_callback2_t trace_cb,
                                 void *const trace_cb_priv,
+                                const rohc_trace_level_t trace_level,
                                 const int profile_id)
 	__attribute__((warn_unused_result, nonnull(1, 2, 3)));
 
-void rohc_decomp_rfc3095_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt,
-                                 const struct rohc_decomp_volat_ctxt *const volat_ctxt)
-	__attribute__((nonnull(1, 2)));
+void rohc_decomp_rfc3095_destroy(struct rohc_decomp_rfc3095_ctxt *const rfc3095_ctxt)
+	__attribute__((nonnull(1)));
 
 bool rfc3095_decomp_parse_pkt(const struct rohc_decomp_ctxt *const context,
                               const struct rohc_buf rohc_packet,
@@ -482,8 +482,9 @@ rohc_status_t rfc3095_decomp_build_hdrs(const struct rohc_decomp *const decomp,
                                         const struct rohc_decoded_values *const decoded,
                                         const size_t payload_len,
                                         struct rohc_buf *const uncomp_hdrs,
-                                        size_t *const uncomp_hdrs_len)
-	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8)));
+                                        size_t *const uncomp_hdrs_len,
+                                        struct rohc_decomp_csums *const csums)
+	__attribute__((warn_unused_result, nonnull(1, 2, 4, 5, 7, 8, 9)));
 
 bool rfc3095_decomp_decode_bits(const struct rohc_decomp_ctxt *const context,
                                 const struct rohc_extr_bits *const bits,
@@ -209,6 +209,18 @@ static int rohc_list_decode(struct list_decomp *decomp,
 	                        ROHC_LIST_GEN_ID_ANON otherwise */
 	int ret;
 
+	/* allocate the lists the first time one compressed list is received */
+	if(decomp->lists == NULL)
+	{
+		decomp->lists = calloc(ROHC_LIST_GEN_ID_MAX + 1, sizeof(struct rohc_list));
+		if(decomp->lists == NULL)
+		{
+			rd_list_warn(decomp, "failed to allocate memory for the lists of "
+			             "extension headers");
+			goto error;
+		}
+	}
+
 	/* reset the list of the current packet */
 	rohc_list_reset(&decomp->pkt_list);
 
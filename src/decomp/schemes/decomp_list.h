@@ -53,8 +53,9 @@ struct list_decomp
 	/** The translation table */
 	struct rohc_list_item trans_table[ROHC_LIST_MAX_ITEM];
 
-	/** All the possible named lists, indexed by gen_id */
-	struct rohc_list lists[ROHC_LIST_GEN_ID_MAX + 1];
+	/** All the possible named lists, indexed by gen_id: ROHC_LIST_GEN_ID_MAX + 1
+	 *  lists allocated when the first compressed list is received */
+	struct rohc_list *lists;
 
 	/** The temporary packet list (not persistent across packets) */
 	struct rohc_list pkt_list;
@@ -90,6 +91,8 @@ struct list_decomp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The lowest level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
 	/** The profile ID the decompression list was created for */
 	int profile_id;
 };
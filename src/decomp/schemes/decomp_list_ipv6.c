@@ -26,6 +26,7 @@
 #include "schemes/decomp_list_ipv6.h"
 
 #include "rohc_traces_internal.h"
+#include "rohc_debug.h" /* for zfree() */
 
 #include <string.h>
 
@@ -63,11 +64,13 @@ static size_t rohc_build_ip6_extension(const struct list_decomp *const decomp,
  * @param decomp         The context to create
  * @param trace_cb       The function to call for printing traces
  * @param trace_cb_priv  An optional private context, may be NULL
+ * @param trace_level    The lowest level of the traces to print
  * @param profile_id     The ID of the associated decompression profile
  */
 void rohc_decomp_list_ipv6_init(struct list_decomp *const decomp,
                                 rohc_trace_callback2_t trace_cb,
                                 void *const trace_cb_priv,
+                                const rohc_trace_level_t trace_level,
                                 const int profile_id)
 {
 	/* specific callbacks for IPv6 extension headers */
@@ -80,10 +83,28 @@ void rohc_decomp_list_ipv6_init(struct list_decomp *const decomp,
 	/* traces */
 	decomp->trace_callback = trace_cb;
 	decomp->trace_callback_priv = trace_cb_priv;
+	decomp->trace_level = trace_level;
 	decomp->profile_id = profile_id;
 }
 
 
+/**
+ * @brief Free one context for decompressing lists of IPv6 extension headers
+ *
+ * @param decomp  The context to destroy
+ */
+void rohc_decomp_list_ipv6_free(struct list_decomp *const decomp)
+{
+	size_t i;
+
+	for(i = 0; i < ROHC_LIST_MAX_ITEM; i++)
+	{
+		rohc_list_item_free(&decomp->trans_table[i]);
+	}
+	zfree(decomp->lists);
+}
+
+
 /**
  * @brief Check if the item is correct in IPv6 table
  *
@@ -31,8 +31,12 @@
 void rohc_decomp_list_ipv6_init(struct list_decomp *const decomp,
                                 rohc_trace_callback2_t trace_cb,
                                 void *const trace_cb_priv,
+                                const rohc_trace_level_t trace_level,
                                 const int profile_id)
 	__attribute__((nonnull(1)));
 
+void rohc_decomp_list_ipv6_free(struct list_decomp *const decomp)
+	__attribute__((nonnull(1)));
+
 #endif
 
@@ -87,6 +87,8 @@ struct ts_sc_decomp
 	rohc_trace_callback2_t trace_callback;
 	/** The private context of the callback function used to manage traces */
 	void *trace_callback_priv;
+	/** The lowest level of the traces given to the callback function */
+	rohc_trace_level_t trace_level;
 };
 
 
@@ -96,7 +98,8 @@ struct ts_sc_decomp
 
 void d_init_sc(struct ts_sc_decomp *const ts_scaled,
                rohc_trace_callback2_t trace_cb,
-               void *const trace_cb_priv)
+               void *const trace_cb_priv,
+               const rohc_trace_level_t trace_level)
 	__attribute__((nonnull(1)));
 
 void ts_update_context(struct ts_sc_decomp *const ts_sc,
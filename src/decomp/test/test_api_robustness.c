@@ -24,7 +24,10 @@
 
 #include "rohc_decomp.h"
 
+#include "config.h" /* for ROHC_PERF_COUNTERS */
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
 #include <assert.h>
@@ -47,6 +50,11 @@
 	} while(0)
 
 
+static void * test_malloc(void *const priv_ctxt, const size_t size)
+	__attribute__((warn_unused_result));
+static void test_free(void *const priv_ctxt, void *const ptr);
+
+
 /**
  * @brief Test the robustness of the decompression API
  *
@@ -57,6 +65,7 @@
 int main(int argc, char *argv[])
 {
 	struct rohc_decomp *decomp;
+	size_t blocks_nr = 0;
 	bool verbose; /* whether to run in verbose mode or not */
 	int is_failure = 1; /* test fails by default */
 
@@ -111,6 +120,19 @@ int main(int argc, char *argv[])
 		CHECK(rohc_decomp_set_traces_cb2(decomp, fct, decomp) == true);
 	}
 
+	/* rohc_decomp_set_traces_level() */
+	CHECK(rohc_decomp_set_traces_level(NULL, ROHC_TRACE_WARNING) == false);
+	CHECK(rohc_decomp_set_traces_level(decomp, ROHC_TRACE_LEVEL_MAX) == false);
+	CHECK(rohc_decomp_set_traces_level(decomp, ROHC_TRACE_WARNING) == true);
+	CHECK(rohc_decomp_set_traces_level(decomp, ROHC_TRACE_DEBUG) == true);
+
+	/* rohc_decomp_set_allocator() */
+	CHECK(rohc_decomp_set_allocator(NULL, test_malloc, test_free, &blocks_nr) == false);
+	CHECK(rohc_decomp_set_allocator(decomp, test_malloc, NULL, &blocks_nr) == false);
+	CHECK(rohc_decomp_set_allocator(decomp, NULL, test_free, &blocks_nr) == false);
+	CHECK(rohc_decomp_set_allocator(decomp, NULL, NULL, NULL) == true);
+	CHECK(rohc_decomp_set_allocator(decomp, test_malloc, test_free, &blocks_nr) == true);
+
 	/* rohc_decomp_profile_enabled() */
 	CHECK(rohc_decomp_profile_enabled(NULL, ROHC_PROFILE_IP) == false);
 	CHECK(rohc_decomp_profile_enabled(decomp, ROHC_PROFILE_GENERAL) == false);
@@ -235,6 +257,7 @@ int main(int argc, char *argv[])
 	/* rohc_decomp_set_features */
 	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_COMPAT_1_6_x) == false);
 	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_CRC_REPAIR) == true);
+	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_CSUM_OFFLOAD) == true);
 	CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_NONE) == true);
 
 	/* rohc_decompress3() */
@@ -310,6 +333,195 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	/* rohc_decompress_inplace() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		const uint8_t ir[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		const size_t ir_hdr_len = 22;
+		const size_t headroom = 20;
+		uint8_t buf[20 + sizeof(ir)];
+		struct rohc_buf pkt = rohc_buf_init_empty(buf, sizeof(buf));
+		pkt.time = ts;
+		memcpy(buf, ir, sizeof(ir));
+		pkt.len = sizeof(ir);
+		CHECK(rohc_decompress_inplace(NULL, &pkt, NULL, NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_decompress_inplace(decomp, NULL, NULL, NULL) == ROHC_STATUS_ERROR);
+		CHECK(rohc_decompress_inplace(decomp, &pkt, NULL, NULL) == ROHC_STATUS_ERROR);
+		memcpy(buf + 1, ir, sizeof(ir));
+		pkt.offset = 1;
+		pkt.len = sizeof(ir);
+		CHECK(rohc_decompress_inplace(decomp, &pkt, NULL, NULL) == ROHC_STATUS_OUTPUT_TOO_SMALL);
+		CHECK(pkt.len == 0);
+		memcpy(buf + headroom, ir, sizeof(ir));
+		pkt.offset = headroom;
+		pkt.len = sizeof(ir);
+		CHECK(rohc_decompress_inplace(decomp, &pkt, NULL, NULL) == ROHC_STATUS_OK);
+		CHECK(pkt.offset + pkt.len == sizeof(buf));
+		CHECK(pkt.len == 20 + sizeof(ir) - ir_hdr_len);
+		CHECK(memcmp(buf + headroom + ir_hdr_len, ir + ir_hdr_len,
+		             sizeof(ir) - ir_hdr_len) == 0);
+	}
+
+	/* rohc_decompress_burst() */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		const struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		struct rohc_buf pkts[3] = { pkt, pkt, pkt };
+		uint8_t buf2[3][100];
+		struct rohc_buf pkts2[3] =
+		{
+			rohc_buf_init_empty(buf2[0], 100),
+			rohc_buf_init_empty(buf2[1], 100),
+			rohc_buf_init_empty(buf2[2], 100),
+		};
+		rohc_status_t statuses[3];
+		uint8_t buf_full[100];
+		struct rohc_buf pkt_full = rohc_buf_init_full(buf_full, 100, ts);
+		uint8_t buf_feedback[100];
+		struct rohc_buf feedback = rohc_buf_init_empty(buf_feedback, 100);
+
+		CHECK(rohc_decompress_burst(NULL, pkts, pkts2, statuses, 3, NULL, NULL) == 0);
+		CHECK(rohc_decompress_burst(decomp, NULL, pkts2, statuses, 3, NULL, NULL) == 0);
+		CHECK(rohc_decompress_burst(decomp, pkts, NULL, statuses, 3, NULL, NULL) == 0);
+		CHECK(rohc_decompress_burst(decomp, pkts, pkts2, NULL, 3, NULL, NULL) == 0);
+		CHECK(rohc_decompress_burst(decomp, pkts, pkts2, statuses, 3, &pkt_full, NULL) == 0);
+		CHECK(rohc_decompress_burst(decomp, pkts, pkts2, statuses, 3, NULL, &pkt_full) == 0);
+		CHECK(rohc_decompress_burst(decomp, pkts, pkts2, statuses, 0, NULL, NULL) == 0);
+		pkts[1].len = 0;
+		CHECK(rohc_decompress_burst(decomp, pkts, pkts2, statuses, 3, NULL, &feedback) == 3);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(statuses[1] == ROHC_STATUS_ERROR);
+		CHECK(statuses[2] == ROHC_STATUS_OK);
+		CHECK(pkts2[0].len > 0);
+		CHECK(pkts2[1].len == 0);
+		CHECK(pkts2[2].len == pkts2[0].len);
+		CHECK(feedback.offset == 0);
+	}
+
+	/* rohc_decompress_burst() with feedback for several packets */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		/* IR packets for CIDs 1, 2 and 3, the decompressor in O-mode sends one
+		 * ACK for every new context */
+		const uint8_t ir_cids[3] = { 0x01, 0x02, 0x03 };
+		const uint8_t ir_crcs[3] = { 0x5a, 0x27, 0xb3 };
+		uint8_t buf[3][86] =
+		{
+			{
+				0xfd, 0x00, 0x04, 0x00,  0x40, 0x01, 0xc0, 0xa8,
+				0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+				0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+				0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+				0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+				0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+				0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+				0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+				0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+				0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+				0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+			}
+		};
+		struct rohc_buf pkts[3];
+		uint8_t buf2[3][100];
+		struct rohc_buf pkts2[3];
+		rohc_status_t statuses[3];
+		uint8_t buf_feedback[100];
+		struct rohc_buf feedback = rohc_buf_init_empty(buf_feedback, 100);
+		uint8_t expected[100];
+		size_t expected_len = 0;
+		struct rohc_decomp *decomp_burst;
+		struct rohc_decomp *decomp_ref;
+		size_t pos;
+		size_t i;
+
+		decomp_burst = rohc_decomp_new2(ROHC_LARGE_CID, ROHC_SMALL_CID_MAX, ROHC_O_MODE);
+		CHECK(decomp_burst != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp_burst, ROHC_PROFILE_IP) == true);
+		decomp_ref = rohc_decomp_new2(ROHC_LARGE_CID, ROHC_SMALL_CID_MAX, ROHC_O_MODE);
+		CHECK(decomp_ref != NULL);
+		CHECK(rohc_decomp_enable_profile(decomp_ref, ROHC_PROFILE_IP) == true);
+
+		/* decompress the packets one by one to get the expected feedback */
+		for(i = 0; i < 3; i++)
+		{
+			const struct rohc_buf pkt = rohc_buf_init_full(buf[i], sizeof(buf[i]), ts);
+			const struct rohc_buf pkt2 = rohc_buf_init_empty(buf2[i], 100);
+			uint8_t buf_ref[100];
+			struct rohc_buf pkt_ref = rohc_buf_init_empty(buf_ref, 100);
+			uint8_t buf_feedback_ref[100];
+			struct rohc_buf feedback_ref = rohc_buf_init_empty(buf_feedback_ref, 100);
+
+			if(i > 0)
+			{
+				memcpy(buf[i], buf[0], sizeof(buf[0]));
+			}
+			buf[i][1] = ir_cids[i];
+			buf[i][3] = ir_crcs[i];
+			pkts[i] = pkt;
+			pkts2[i] = pkt2;
+
+			CHECK(rohc_decompress3(decomp_ref, pkts[i], &pkt_ref, NULL,
+			                       &feedback_ref) == ROHC_STATUS_OK);
+			CHECK(feedback_ref.len > 0);
+			CHECK((expected_len + feedback_ref.len) <= sizeof(expected));
+			memcpy(expected + expected_len, rohc_buf_data(feedback_ref),
+			       feedback_ref.len);
+			expected_len += feedback_ref.len;
+		}
+
+		/* the feedback of all the packets of the burst is concatenated */
+		CHECK(rohc_decompress_burst(decomp_burst, pkts, pkts2, statuses, 3,
+		                            NULL, &feedback) == 3);
+		CHECK(statuses[0] == ROHC_STATUS_OK);
+		CHECK(statuses[1] == ROHC_STATUS_OK);
+		CHECK(statuses[2] == ROHC_STATUS_OK);
+		CHECK(feedback.offset == 0);
+		CHECK(feedback.len == expected_len);
+		CHECK(memcmp(rohc_buf_data(feedback), expected, expected_len) == 0);
+
+		/* one feedback item per packet, in packet order: every item starts with
+		 * the feedback type and size, then the large CID */
+		for(i = 0, pos = 0; i < 3; i++)
+		{
+			const size_t item_size = rohc_buf_byte_at(feedback, pos) & 0x07;
+			CHECK((rohc_buf_byte_at(feedback, pos) & 0xf8) == 0xf0);
+			CHECK(item_size > 0);
+			CHECK(rohc_buf_byte_at(feedback, pos + 1) == ir_cids[i]);
+			pos += 1 + item_size;
+		}
+		CHECK(pos == feedback.len);
+
+		rohc_decomp_free(decomp_ref);
+		rohc_decomp_free(decomp_burst);
+	}
+
 	/* rohc_decomp_get_last_packet_info() */
 	{
 		rohc_decomp_last_packet_info_t info;
@@ -325,6 +537,47 @@ int main(int argc, char *argv[])
 		CHECK(rohc_decomp_get_last_packet_info(decomp, &info) == true);
 		info.version_minor = 1;
 		CHECK(rohc_decomp_get_last_packet_info(decomp, &info) == true);
+		info.version_minor = 2;
+		CHECK(rohc_decomp_get_last_packet_info(decomp, &info) == true);
+		info.version_minor = 3;
+		CHECK(rohc_decomp_get_last_packet_info(decomp, &info) == true);
+		CHECK(info.csums_nr == 0);
+	}
+
+	/* IPv4 checksum left to the caller with ROHC_DECOMP_FEATURE_CSUM_OFFLOAD */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		const struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		uint8_t buf2[100];
+		struct rohc_buf pkt2 = rohc_buf_init_empty(buf2, 100);
+		rohc_decomp_last_packet_info_t info;
+
+		CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_CSUM_OFFLOAD) == true);
+		CHECK(rohc_decompress3(decomp, pkt, &pkt2, NULL, NULL) == ROHC_STATUS_OK);
+		memset(&info, 0, sizeof(rohc_decomp_last_packet_info_t));
+		info.version_minor = 3;
+		CHECK(rohc_decomp_get_last_packet_info(decomp, &info) == true);
+		CHECK(info.csums_nr == 1);
+		CHECK(info.csums[0].start == 0);
+		CHECK(info.csums[0].offset == 10);
+		CHECK(info.csums[0].len == 20);
+		CHECK(rohc_buf_byte_at(pkt2, 10) == 0x00);
+		CHECK(rohc_buf_byte_at(pkt2, 11) == 0x00);
+		CHECK(rohc_decomp_set_features(decomp, ROHC_DECOMP_FEATURE_NONE) == true);
 	}
 
 	/* rohc_decomp_get_general_info() */
@@ -344,6 +597,135 @@ int main(int argc, char *argv[])
 		CHECK(rohc_decomp_get_general_info(decomp, &info) == true);
 	}
 
+	/* rohc_decomp_get_perf_counters() */
+	{
+		rohc_decomp_perf_counters_t counters;
+		memset(&counters, 0, sizeof(rohc_decomp_perf_counters_t));
+		CHECK(rohc_decomp_get_perf_counters(NULL, &counters) == false);
+		CHECK(rohc_decomp_get_perf_counters(decomp, NULL) == false);
+		counters.version_major = 0xffff;
+		CHECK(rohc_decomp_get_perf_counters(decomp, &counters) == false);
+		counters.version_major = 0;
+		counters.version_minor = 0xffff;
+		CHECK(rohc_decomp_get_perf_counters(decomp, &counters) == false);
+		counters.version_minor = 0;
+#ifdef ROHC_PERF_COUNTERS
+		CHECK(rohc_decomp_get_perf_counters(decomp, &counters) == true);
+		CHECK(counters.stages[ROHC_DECOMP_PERF_PARSE].calls > 0);
+		CHECK(counters.stages[ROHC_DECOMP_PERF_BUILD].calls > 0);
+		CHECK(counters.stages[ROHC_DECOMP_PERF_CRC].calls > 0);
+#else
+		CHECK(rohc_decomp_get_perf_counters(decomp, &counters) == false);
+#endif
+	}
+
+	/* rohc_decomp_get_stats() */
+	{
+		rohc_stats_t stats;
+		memset(&stats, 0, sizeof(rohc_stats_t));
+		CHECK(rohc_decomp_get_stats(NULL, &stats) == false);
+		CHECK(rohc_decomp_get_stats(decomp, NULL) == false);
+		stats.version_major = 0xffff;
+		CHECK(rohc_decomp_get_stats(decomp, &stats) == false);
+		stats.version_major = 0;
+		stats.version_minor = 0xffff;
+		CHECK(rohc_decomp_get_stats(decomp, &stats) == false);
+		stats.version_minor = 0;
+		CHECK(rohc_decomp_get_stats(decomp, &stats) == true);
+		CHECK(stats.packets_nr > 0);
+		CHECK(stats.uncomp_bytes_nr > 0);
+		CHECK(stats.comp_bytes_nr > 0);
+	}
+
+	/* rohc_decomp_get_ctxt_stats() */
+	{
+		rohc_stats_t stats;
+		memset(&stats, 0, sizeof(rohc_stats_t));
+		CHECK(rohc_decomp_get_ctxt_stats(NULL, 0, &stats) == false);
+		CHECK(rohc_decomp_get_ctxt_stats(decomp, ROHC_SMALL_CID_MAX + 1, &stats) == false);
+		CHECK(rohc_decomp_get_ctxt_stats(decomp, 0, NULL) == false);
+		stats.version_major = 0xffff;
+		CHECK(rohc_decomp_get_ctxt_stats(decomp, 0, &stats) == false);
+		stats.version_major = 0;
+		stats.version_minor = 0xffff;
+		CHECK(rohc_decomp_get_ctxt_stats(decomp, 0, &stats) == false);
+		stats.version_minor = 0;
+		CHECK(rohc_decomp_get_ctxt_stats(decomp, 0, &stats) == true);
+		CHECK(stats.packets_nr > 0);
+		CHECK(rohc_decomp_get_ctxt_stats(decomp, ROHC_SMALL_CID_MAX, &stats) == true);
+		CHECK(stats.packets_nr == 0);
+	}
+
+	/* contexts are allocated from the pools, their memory is reused once
+	 * they are destroyed */
+	{
+		const struct rohc_ts ts = { .sec = 0, .nsec = 0 };
+		uint8_t buf[] =
+		{
+			0xfd, 0x00, 0x04, 0xce,  0x40, 0x01, 0xc0, 0xa8,
+			0x13, 0x01, 0xc0, 0xa8,  0x13, 0x05, 0x00, 0x40,
+			0x00, 0x00, 0xa0, 0x00,  0x00, 0x01, 0x08, 0x00,
+			0xe9, 0xc2, 0x9b, 0x42,  0x00, 0x01, 0x66, 0x15,
+			0xa6, 0x45, 0x77, 0x9b,  0x04, 0x00, 0x08, 0x09,
+			0x0a, 0x0b, 0x0c, 0x0d,  0x0e, 0x0f, 0x10, 0x11,
+			0x12, 0x13, 0x14, 0x15,  0x16, 0x17, 0x18, 0x19,
+			0x1a, 0x1b, 0x1c, 0x1d,  0x1e, 0x1f, 0x20, 0x21,
+			0x22, 0x23, 0x24, 0x25,  0x26, 0x27, 0x28, 0x29,
+			0x2a, 0x2b, 0x2c, 0x2d,  0x2e, 0x2f, 0x30, 0x31,
+			0x32, 0x33, 0x34, 0x35,  0x36, 0x37
+		};
+		const struct rohc_buf pkt = rohc_buf_init_full(buf, sizeof(buf), ts);
+		const uint8_t crc = buf[3];
+		uint8_t buf2[100];
+		struct rohc_decomp *decomp2;
+		size_t blocks_nr2 = 0;
+		size_t warm_blocks_nr = 0;
+		size_t round;
+		size_t cid;
+
+		decomp2 = rohc_decomp_new2(ROHC_LARGE_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+		CHECK(decomp2 != NULL);
+		CHECK(rohc_decomp_set_allocator(decomp2, test_malloc, test_free,
+		                                &blocks_nr2) == true);
+		CHECK(rohc_decomp_enable_profile(decomp2, ROHC_PROFILE_IP) == true);
+
+		/* IR packets with a wrong CRC on all CIDs: every context is created,
+		 * then destroyed when the CRC check fails */
+		buf[3] = crc ^ 0xff;
+		for(round = 0; round < 3; round++)
+		{
+			for(cid = 0; cid <= ROHC_SMALL_CID_MAX; cid++)
+			{
+				struct rohc_buf pkt2 = rohc_buf_init_empty(buf2, 100);
+				buf[1] = cid;
+				CHECK(rohc_decompress3(decomp2, pkt, &pkt2, NULL, NULL) != ROHC_STATUS_OK);
+				CHECK(pkt2.len == 0);
+			}
+			if(round == 0)
+			{
+				/* the pools were created and kept */
+				warm_blocks_nr = blocks_nr2;
+				CHECK(warm_blocks_nr > 0);
+			}
+			/* no more memory is needed once the pools are warm */
+			CHECK(blocks_nr2 == warm_blocks_nr);
+		}
+
+		/* one valid IR packet: the new context reuses the memory of the
+		 * destroyed ones */
+		{
+			struct rohc_buf pkt2 = rohc_buf_init_empty(buf2, 100);
+			buf[1] = 0;
+			buf[3] = crc;
+			CHECK(rohc_decompress3(decomp2, pkt, &pkt2, NULL, NULL) == ROHC_STATUS_OK);
+			CHECK(pkt2.len > 0);
+			CHECK(blocks_nr2 == warm_blocks_nr);
+		}
+
+		rohc_decomp_free(decomp2);
+		CHECK(blocks_nr2 == 0);
+	}
+
 	/* rohc_decomp_get_state_descr() */
 	CHECK(strcmp(rohc_decomp_get_state_descr(ROHC_DECOMP_STATE_NC), "No Context") == 0);
 	CHECK(strcmp(rohc_decomp_get_state_descr(ROHC_DECOMP_STATE_SC), "Static Context") == 0);
@@ -354,11 +736,14 @@ int main(int argc, char *argv[])
 	{
 		rohc_trace_callback2_t fct = (rohc_trace_callback2_t) NULL;
 		CHECK(rohc_decomp_set_traces_cb2(decomp, fct, decomp) == false);
+		CHECK(rohc_decomp_set_traces_level(decomp, ROHC_TRACE_WARNING) == false);
+		CHECK(rohc_decomp_set_allocator(decomp, NULL, NULL, NULL) == false);
 	}
 
 	/* rohc_decomp_free() */
 	rohc_decomp_free(NULL);
 	rohc_decomp_free(decomp);
+	CHECK(blocks_nr == 0);
 
 	/* test succeeds */
 	trace(verbose, "all tests are successful\n");
@@ -368,3 +753,39 @@ error:
 	return is_failure;
 }
 
+
+/**
+ * @brief Allocation callback that counts the blocks in use
+ *
+ * @param priv_ctxt  The number of blocks in use
+ * @param size       The number of bytes to allocate
+ * @return           The allocated memory, NULL in case of failure
+ */
+static void * test_malloc(void *const priv_ctxt, const size_t size)
+{
+	size_t *const blocks_nr = priv_ctxt;
+	void *const ptr = malloc(size);
+
+	if(ptr != NULL)
+	{
+		(*blocks_nr)++;
+	}
+
+	return ptr;
+}
+
+
+/**
+ * @brief Release callback that counts the blocks in use
+ *
+ * @param priv_ctxt  The number of blocks in use
+ * @param ptr        The memory to release
+ */
+static void test_free(void *const priv_ctxt, void *const ptr)
+{
+	size_t *const blocks_nr = priv_ctxt;
+
+	assert((*blocks_nr) > 0);
+	(*blocks_nr)--;
+	free(ptr);
+}
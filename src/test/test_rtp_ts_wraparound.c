@@ -142,10 +142,10 @@ bool run_test(bool be_verbose, const unsigned int incr)
 	uint64_t i;
 
 	/* create the RTP TS encoding context */
-	c_init_sc(&ts_sc_comp, ROHC_WLSB_WINDOW_WIDTH, NULL, NULL);
+	c_init_sc(&ts_sc_comp, ROHC_WLSB_WINDOW_WIDTH, NULL, NULL, ROHC_TRACE_DEBUG);
 
 	/* create the RTP TS decoding context */
-	d_init_sc(&ts_sc_decomp, NULL, NULL);
+	d_init_sc(&ts_sc_decomp, NULL, NULL, ROHC_TRACE_DEBUG);
 
 	/* compute the initial value to encode */
 	if(incr == 0)
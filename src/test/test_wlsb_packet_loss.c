@@ -20,6 +20,9 @@
  * @file    test_lsb_decode_packet_loss.c
  * @brief   Test the robustness of LSB encoding/decoding against packet loss
  * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The \e bench mode measures the time required to run the test with several
+ * window widths.
  */
 
 #include "schemes/comp_wlsb.h"
@@ -28,12 +31,16 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 
 
 /** The width of the W-LSB sliding window */
 #define ROHC_WLSB_WINDOW_WIDTH  4U
 
+/** The number of times the test is run for every benchmark */
+#define BENCH_WLSB_RUNS_NR  2000U
+
 
 /** Print trace on stdout only in verbose mode */
 #define trace(is_verbose, format, ...) \
@@ -57,6 +64,9 @@ static bool run_test32_with_shift_param(bool be_verbose,
                                         const size_t win_size,
                                         const size_t loss_nr);
 
+static bool bench_wlsb(const short *const p_params, const size_t p_nums)
+	__attribute__((warn_unused_result, nonnull(1)));
+
 
 /**
  * @brief Test the robustness of LSB encoding/decoding against packet loss
@@ -79,6 +89,7 @@ int main(int argc, char *argv[])
 
 	bool verbose; /* whether to run in verbose mode or not */
 	bool extraverbose; /* whether to run in extra verbose mode or not */
+	bool bench = false; /* whether to run in benchmark mode or not */
 	int is_failure = 1; /* test fails by default */
 
 	const size_t win_size = ROHC_WLSB_WINDOW_WIDTH;
@@ -115,55 +126,72 @@ _Static_assert(ROHC_WLSB_WINDOW_WIDTH > 0,
 			extraverbose = false;
 		}
 	}
+	else if(argc == 2 && strcmp(argv[1], "bench") == 0)
+	{
+		/* run in benchmark mode */
+		verbose = false;
+		extraverbose = false;
+		bench = true;
+	}
 	else
 	{
 		/* invalid usage */
 		printf("test the robustness of LSB encoding/decoding against packet loss\n");
-		printf("usage: %s [verbose [verbose]]\n", argv[0]);
+		printf("usage: %s [verbose [verbose]|bench]\n", argv[0]);
 		goto error;
 	}
 
-	/* run the test with different shift values */
-	for(p_index = 0; p_index < p_nums; p_index++)
+	if(bench)
 	{
-		/* 8-bit field */
-		trace(verbose, "run test with 8-bit field, shift parameter %d, window "
-		      "width %zu, and %zu lost values\n", p_params[p_index], win_size,
-		      loss_nr);
-		if(!run_test8_with_shift_param(extraverbose, p_params[p_index],
-		                               win_size, loss_nr))
-		{
-			fprintf(stderr, "test with 8-bit field and shift parameter %d "
-			        "failed\n", p_params[p_index]);
-			goto error;
-		}
-		trace(extraverbose, "\n");
-
-		/* 16-bit field */
-		trace(verbose, "run test with 16-bit field, shift parameter %d, windows "
-		      "width %zu, and %zu lost values\n", p_params[p_index], win_size,
-		      loss_nr);
-		if(!run_test16_with_shift_param(extraverbose, p_params[p_index],
-		                                win_size, loss_nr))
+		if(!bench_wlsb(p_params, p_nums))
 		{
-			fprintf(stderr, "test with 16-bit field and shift parameter %d "
-			        "failed\n", p_params[p_index]);
 			goto error;
 		}
-		trace(extraverbose, "\n");
-
-		/* 32-bit field */
-		trace(verbose, "run test with 32-bit field, shift parameter %d, windows "
-		      "width %zu, and %zu lost values\n", p_params[p_index], win_size,
-		      loss_nr);
-		if(!run_test32_with_shift_param(extraverbose, p_params[p_index],
-		                                win_size, loss_nr))
+	}
+	else
+	{
+		/* run the test with different shift values */
+		for(p_index = 0; p_index < p_nums; p_index++)
 		{
-			fprintf(stderr, "test with 32-bit field and shift parameter %d "
-			        "failed\n", p_params[p_index]);
-			goto error;
+			/* 8-bit field */
+			trace(verbose, "run test with 8-bit field, shift parameter %d, window "
+			      "width %zu, and %zu lost values\n", p_params[p_index], win_size,
+			      loss_nr);
+			if(!run_test8_with_shift_param(extraverbose, p_params[p_index],
+			                               win_size, loss_nr))
+			{
+				fprintf(stderr, "test with 8-bit field and shift parameter %d "
+				        "failed\n", p_params[p_index]);
+				goto error;
+			}
+			trace(extraverbose, "\n");
+
+			/* 16-bit field */
+			trace(verbose, "run test with 16-bit field, shift parameter %d, windows "
+			      "width %zu, and %zu lost values\n", p_params[p_index], win_size,
+			      loss_nr);
+			if(!run_test16_with_shift_param(extraverbose, p_params[p_index],
+			                                win_size, loss_nr))
+			{
+				fprintf(stderr, "test with 16-bit field and shift parameter %d "
+				        "failed\n", p_params[p_index]);
+				goto error;
+			}
+			trace(extraverbose, "\n");
+
+			/* 32-bit field */
+			trace(verbose, "run test with 32-bit field, shift parameter %d, windows "
+			      "width %zu, and %zu lost values\n", p_params[p_index], win_size,
+			      loss_nr);
+			if(!run_test32_with_shift_param(extraverbose, p_params[p_index],
+			                                win_size, loss_nr))
+			{
+				fprintf(stderr, "test with 32-bit field and shift parameter %d "
+				        "failed\n", p_params[p_index]);
+				goto error;
+			}
+			trace(extraverbose, "\n");
 		}
-		trace(extraverbose, "\n");
 	}
 
 	/* test succeeds */
@@ -475,7 +503,7 @@ static bool run_test32_with_shift_param(bool be_verbose,
 	assert(win_size > 0);
 
 	/* create the W-LSB encoding context */
-	wlsb_init(&wlsb, 32, ROHC_WLSB_WINDOW_WIDTH, p);
+	wlsb_init(&wlsb, 32, win_size, p);
 
 	/* init the LSB decoding context with value 0 */
 	value32 = 0;
@@ -578,3 +606,57 @@ error:
 	return is_success;
 }
 
+
+/**
+ * @brief Measure the time required to run the test with several window widths
+ *
+ * @param p_params  The shift parameters to run test with
+ * @param p_nums    The number of shift parameters
+ * @return          true if all tests succeed, false otherwise
+ */
+static bool bench_wlsb(const short *const p_params, const size_t p_nums)
+{
+	const size_t widths[] = { 4, 16, ROHC_WLSB_WIDTH_MAX };
+	const size_t widths_nr = sizeof(widths) / sizeof(widths[0]);
+	size_t width_idx;
+
+	printf("%6s %14s\n", "width", "us/run");
+
+	for(width_idx = 0; width_idx < widths_nr; width_idx++)
+	{
+		const size_t win_size = widths[width_idx];
+		const size_t loss_nr = win_size - 1;
+		struct timespec start;
+		struct timespec end;
+		double elapsed_ns;
+		size_t run;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for(run = 0; run < BENCH_WLSB_RUNS_NR; run++)
+		{
+			size_t p_index;
+
+			for(p_index = 0; p_index < p_nums; p_index++)
+			{
+				if(!run_test8_with_shift_param(false, p_params[p_index], win_size,
+				                               loss_nr) ||
+				   !run_test16_with_shift_param(false, p_params[p_index], win_size,
+				                                loss_nr) ||
+				   !run_test32_with_shift_param(false, p_params[p_index], win_size,
+				                                loss_nr))
+				{
+					fprintf(stderr, "test with shift parameter %d and window width "
+					        "%zu failed\n", p_params[p_index], win_size);
+					return false;
+				}
+			}
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+
+		elapsed_ns = ((double) (end.tv_sec - start.tv_sec)) * 1e9 +
+		             ((double) (end.tv_nsec - start.tv_nsec));
+		printf("%6zu %14.1f\n", win_size, elapsed_ns / BENCH_WLSB_RUNS_NR / 1e3);
+	}
+
+	return true;
+}
@@ -20,6 +20,9 @@
  * @file    test_lsb_decode_wraparound.c
  * @brief   Test Least Significant Bits (LSB) encoding/decoding at wraparound
  * @author  Didier Barvaux <didier@barvaux.org>
+ *
+ * The \e bench mode measures the time required to W-LSB encode values with
+ * several window widths.
  */
 
 #include "schemes/comp_wlsb.h"
@@ -28,12 +31,16 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <time.h>
 #include <assert.h>
 
 
 /** The width of the W-LSB sliding window */
 #define ROHC_WLSB_WINDOW_WIDTH  4U
 
+/** The number of values to encode for every benchmark */
+#define BENCH_WLSB_VALUES_NR  (4U * 1024U * 1024U)
+
 
 /** Print trace on stdout only in verbose mode */
 #define trace(is_verbose, format, ...) \
@@ -81,6 +88,8 @@ static bool test_wlsb_32(struct c_wlsb *const wlsb,
                          const bool be_verbose)
 	__attribute__((warn_unused_result, nonnull(1, 2)));
 
+static void bench_wlsb(void);
+
 
 /**
  * @brief Test LSB encoding/decoding at wraparound
@@ -103,6 +112,7 @@ int main(int argc, char *argv[])
 
 	bool verbose; /* whether to run in verbose mode or not */
 	bool extraverbose; /* whether to run in extra verbose mode or not */
+	bool bench = false; /* whether to run in benchmark mode or not */
 	int is_failure = 1; /* test fails by default */
 
 	/* do we run in verbose mode ? */
@@ -127,49 +137,63 @@ int main(int argc, char *argv[])
 			extraverbose = false;
 		}
 	}
+	else if(argc == 2 && strcmp(argv[1], "bench") == 0)
+	{
+		/* run in benchmark mode */
+		verbose = false;
+		extraverbose = false;
+		bench = true;
+	}
 	else
 	{
 		/* invalid usage */
 		printf("test the Least Significant Bits (LSB) encoding/decoding at wraparound\n");
-		printf("usage: %s [verbose [verbose]]\n", argv[0]);
+		printf("usage: %s [verbose [verbose]|bench]\n", argv[0]);
 		goto error;
 	}
 
-	/* run the test with different shift values */
-	for(p_index = 0; p_index < p_nums; p_index++)
+	if(bench)
 	{
-		/* 8-bit field */
-		trace(verbose, "run test with 8-bit field and shift parameter %d\n",
-		      p_params[p_index]);
-		if(!run_test8_with_shift_param(extraverbose, p_params[p_index]))
-		{
-			fprintf(stderr, "test with 8-bit field and shift parameter %d "
-			        "failed\n", p_params[p_index]);
-			goto error;
-		}
-		trace(extraverbose, "\n");
-
-		/* 16-bit field */
-		trace(verbose, "run test with 16-bit field and shift parameter %d\n",
-		      p_params[p_index]);
-		if(!run_test16_with_shift_param(extraverbose, p_params[p_index]))
-		{
-			fprintf(stderr, "test with 16-bit field and shift parameter %d "
-			        "failed\n", p_params[p_index]);
-			goto error;
-		}
-		trace(extraverbose, "\n");
-
-		/* 32-bit field */
-		trace(verbose, "run test with 32-bit field and shift parameter %d\n",
-		      p_params[p_index]);
-		if(!run_test32_with_shift_param(extraverbose, p_params[p_index]))
+		bench_wlsb();
+	}
+	else
+	{
+		/* run the test with different shift values */
+		for(p_index = 0; p_index < p_nums; p_index++)
 		{
-			fprintf(stderr, "test with 32-bit field and shift parameter %d "
-			        "failed\n", p_params[p_index]);
-			goto error;
+			/* 8-bit field */
+			trace(verbose, "run test with 8-bit field and shift parameter %d\n",
+			      p_params[p_index]);
+			if(!run_test8_with_shift_param(extraverbose, p_params[p_index]))
+			{
+				fprintf(stderr, "test with 8-bit field and shift parameter %d "
+				        "failed\n", p_params[p_index]);
+				goto error;
+			}
+			trace(extraverbose, "\n");
+
+			/* 16-bit field */
+			trace(verbose, "run test with 16-bit field and shift parameter %d\n",
+			      p_params[p_index]);
+			if(!run_test16_with_shift_param(extraverbose, p_params[p_index]))
+			{
+				fprintf(stderr, "test with 16-bit field and shift parameter %d "
+				        "failed\n", p_params[p_index]);
+				goto error;
+			}
+			trace(extraverbose, "\n");
+
+			/* 32-bit field */
+			trace(verbose, "run test with 32-bit field and shift parameter %d\n",
+			      p_params[p_index]);
+			if(!run_test32_with_shift_param(extraverbose, p_params[p_index]))
+			{
+				fprintf(stderr, "test with 32-bit field and shift parameter %d "
+				        "failed\n", p_params[p_index]);
+				goto error;
+			}
+			trace(extraverbose, "\n");
 		}
-		trace(extraverbose, "\n");
 	}
 
 	/* test succeeds */
@@ -691,3 +715,67 @@ error:
 	return false;
 }
 
+
+/**
+ * @brief Measure the time required to W-LSB encode values
+ *
+ * Values increase by small random steps and wrap around several times. Every
+ * value is encoded, then added to the window as the compressor would do.
+ */
+static void bench_wlsb(void)
+{
+	const size_t widths[] = { 4, 16, ROHC_WLSB_WIDTH_MAX };
+	const size_t widths_nr = sizeof(widths) / sizeof(widths[0]);
+	const size_t fields[] = { 8, 16, 32 };
+	const size_t fields_nr = sizeof(fields) / sizeof(fields[0]);
+	size_t field_idx;
+
+	printf("%-6s %6s %14s\n", "field", "width", "ns/value");
+
+	for(field_idx = 0; field_idx < fields_nr; field_idx++)
+	{
+		const size_t field_bits_nr = fields[field_idx];
+		size_t width_idx;
+
+		for(width_idx = 0; width_idx < widths_nr; width_idx++)
+		{
+			struct c_wlsb wlsb;
+			struct timespec start;
+			struct timespec end;
+			volatile size_t sink = 0;
+			uint32_t seed = 0x12345678;
+			uint32_t value = 0;
+			double elapsed_ns;
+			size_t i;
+
+			wlsb_init(&wlsb, field_bits_nr, widths[width_idx], ROHC_LSB_SHIFT_SN);
+
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for(i = 0; i < BENCH_WLSB_VALUES_NR; i++)
+			{
+				seed = seed * 1103515245U + 12345U;
+				value += 1 + ((seed >> 16) & 0x3);
+
+				if(field_bits_nr == 8)
+				{
+					sink += wlsb_get_k_8bits(&wlsb, value);
+				}
+				else if(field_bits_nr == 16)
+				{
+					sink += wlsb_get_k_16bits(&wlsb, value);
+				}
+				else
+				{
+					sink += wlsb_get_k_32bits(&wlsb, value);
+				}
+				c_add_wlsb(&wlsb, i, value);
+			}
+			clock_gettime(CLOCK_MONOTONIC, &end);
+
+			elapsed_ns = ((double) (end.tv_sec - start.tv_sec)) * 1e9 +
+			             ((double) (end.tv_nsec - start.tv_nsec));
+			printf("%2zu-bit %6zu %14.1f\n", field_bits_nr, widths[width_idx],
+			       elapsed_ns / BENCH_WLSB_VALUES_NR);
+		}
+	}
+}
@@ -64,6 +64,7 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
                                 const size_t mrru,
                                 const bool is_comp_expected_ok,
                                 const size_t expected_segments_nr);
+static int test_decomp_segment_without_mrru(void);
 static void print_rohc_traces(void *const priv_ctxt,
                               const rohc_trace_level_t level,
                               const rohc_trace_entity_t entity,
@@ -141,6 +142,25 @@ int main(int argc, char *argv[])
 		goto error;
 	}
 
+	/* test ROHC segments with very large packet (wrt output buffer) and MRRU
+	 * large enough for the payload and its CRC, but not for the ROHC header
+	 * => segmentation needed, but MRRU forbids it */
+	status |= test_comp_and_decomp(TEST_MAX_ROHC_SIZE * 2,
+	                               TEST_MAX_ROHC_SIZE * 2 -
+	                               sizeof(struct ipv4_hdr) + 4 + 1, false, 0);
+	if(status != 0)
+	{
+		goto error;
+	}
+
+	/* test ROHC segments received while segmentation is disabled at
+	 * decompressor (MRRU = 0) => segments shall be rejected */
+	status |= test_decomp_segment_without_mrru();
+	if(status != 0)
+	{
+		goto error;
+	}
+
 error:
 	return status;
 }
@@ -403,6 +423,12 @@ static int test_comp_and_decomp(const size_t ip_packet_len,
 			fprintf(stderr, "\tfailed to compress ROHC packet\n");
 			goto destroy_decomp;
 		}
+		if(status != ROHC_STATUS_ERROR)
+		{
+			fprintf(stderr, "\tunexpected status %d while compression failure "
+			        "was expected\n", status);
+			goto destroy_decomp;
+		}
 		fprintf(stderr, "\texpected failure to compress packet\n");
 	}
 	else if(!is_comp_expected_ok)
@@ -469,6 +495,74 @@ error:
 }
 
 
+/**
+ * @brief Test that the decompressor rejects ROHC segments if segmentation is
+ *        disabled (MRRU = 0)
+ *
+ * @return  0 in case of success,
+ *          1 in case of failure
+ */
+static int test_decomp_segment_without_mrru(void)
+{
+	/* one empty non-final segment, one final segment with some bytes */
+	const uint8_t segments[][4] = {
+		{ 0xfe },
+		{ 0xff, 0x01, 0x02, 0x03 },
+	};
+	const size_t segments_len[] = { 1, 4 };
+	const struct rohc_ts arrival_time = { .sec = 0, .nsec = 0 };
+	struct rohc_decomp *decomp;
+	uint8_t uncomp_buffer[TEST_MAX_ROHC_SIZE];
+	int is_failure = 1;
+	size_t i;
+
+	fprintf(stderr, "test ROHC segments with MRRU = 0 at decompressor\n");
+
+	decomp = rohc_decomp_new2(ROHC_SMALL_CID, ROHC_SMALL_CID_MAX, ROHC_U_MODE);
+	if(decomp == NULL)
+	{
+		fprintf(stderr, "failed to create the ROHC decompressor\n");
+		goto error;
+	}
+	if(!rohc_decomp_set_traces_cb2(decomp, print_rohc_traces, NULL))
+	{
+		fprintf(stderr, "failed to set the callback for traces on "
+		        "decompressor\n");
+		goto destroy_decomp;
+	}
+
+	for(i = 0; i < 2; i++)
+	{
+		const struct rohc_buf rohc_packet =
+			rohc_buf_init_full((uint8_t *) segments[i], segments_len[i],
+			                   arrival_time);
+		struct rohc_buf uncomp_packet =
+			rohc_buf_init_empty(uncomp_buffer, TEST_MAX_ROHC_SIZE);
+		rohc_status_t status;
+
+		status = rohc_decompress3(decomp, rohc_packet, &uncomp_packet,
+		                          NULL, NULL);
+		if(status != ROHC_STATUS_MALFORMED)
+		{
+			fprintf(stderr, "\t%zu-byte ROHC segment was not rejected "
+			        "(status = %d)\n", segments_len[i], status);
+			goto destroy_decomp;
+		}
+		fprintf(stderr, "\t%zu-byte ROHC segment rejected as expected\n",
+		        segments_len[i]);
+	}
+
+	/* everything went fine */
+	fprintf(stderr, "\n");
+	is_failure = 0;
+
+destroy_decomp:
+	rohc_decomp_free(decomp);
+error:
+	return is_failure;
+}
+
+
 /**
  * @brief Callback to print traces of the ROHC library
  *